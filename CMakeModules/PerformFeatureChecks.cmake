@@ -110,4 +110,8 @@ macro( perform_feature_checks )
     # getc() on platforms where getc_unlocked() doesn't exist.
     check_symbol_exists( getc_unlocked "stdio.h" HAVE_FGETC_NOLOCK )
 
+    # Check for Posix mmap() used by MMAP_LINE_READER.  Fall back to reading the whole
+    # file into memory on platforms where mmap() doesn't exist.
+    check_symbol_exists( mmap "sys/mman.h" HAVE_MMAP )
+
 endmacro( perform_feature_checks )
@@ -199,6 +199,176 @@ if( NOT ( tokensBefore EQUAL tokensAfter ) )
     message( FATAL_ERROR "Duplicate tokens found in file <${inputFile}>." )
 endif()
 
+# Build a perfect hash of the tokens, see KEYWORD_HASH in dsnlexer.h which must use
+# the same hash.  The tokens are spread into buckets, and each bucket gets the first
+# displacement which sends all its tokens to free slots.  The largest buckets are
+# placed first, while most slots are free.  The slot count is the power of 2 above the
+# token count, and is doubled in the unlikely case a bucket cannot be placed.
+# Keep all values below 2^31, older CMake do 32 bit math.
+
+set( letters "abcdefghijklmnopqrstuvwxyz" )
+
+foreach( i RANGE 25 )
+    string( SUBSTRING "${letters}" ${i} 1 ch )
+    math( EXPR code_${ch} "97 + ${i}" )
+endforeach()
+
+foreach( i RANGE 9 )
+    math( EXPR code_${i} "48 + ${i}" )
+endforeach()
+
+set( code__ 95 )
+
+set( hashes "" )
+
+foreach( token ${tokens} )
+    string( LENGTH "${token}" tokenLength )
+    math( EXPR lastChar "${tokenLength} - 1" )
+    set( hash 5381 )
+
+    foreach( i RANGE ${lastChar} )
+        string( SUBSTRING "${token}" ${i} 1 ch )
+        math( EXPR hash "( ${hash} * 33 + ${code_${ch}} ) & 33554431" )
+    endforeach()
+
+    list( APPEND hashes ${hash} )
+endforeach()
+
+# 1 to 2 tokens per bucket, at most 256 buckets: the bucket is given by bits 9 to 16
+# of the hash, and the displacement step by bits 17 to 24.
+set( bucketCount 1 )
+
+while( bucketCount LESS 512 AND bucketCount LESS tokensAfter )
+    math( EXPR bucketCount "${bucketCount} * 2" )
+endwhile()
+
+if( bucketCount GREATER 1 )
+    math( EXPR bucketCount "${bucketCount} / 2" )
+endif()
+
+math( EXPR bucketMask "${bucketCount} - 1" )
+
+set( maxBucketSize 0 )
+
+foreach( b RANGE ${bucketCount} )
+    set( bucket_${b} "" )
+endforeach()
+
+set( ndx 0 )
+
+foreach( hash ${hashes} )
+    math( EXPR b "( ${hash} >> 9 ) & ${bucketMask}" )
+    list( APPEND bucket_${b} ${ndx} )
+    list( LENGTH bucket_${b} bucketSize )
+
+    if( bucketSize GREATER maxBucketSize )
+        set( maxBucketSize ${bucketSize} )
+    endif()
+
+    math( EXPR ndx "${ndx} + 1" )
+endforeach()
+
+set( slotCount 1 )
+
+while( slotCount LESS tokensAfter )
+    math( EXPR slotCount "${slotCount} * 2" )
+endwhile()
+
+math( EXPR lastBucket "${bucketCount} - 1" )
+set( hashDone FALSE )
+
+while( NOT hashDone )
+    math( EXPR slotMask "${slotCount} - 1" )
+    set( hashDone TRUE )
+    set( bucketSize ${maxBucketSize} )
+
+    while( hashDone AND bucketSize GREATER 0 )
+        foreach( b RANGE ${lastBucket} )
+            list( LENGTH bucket_${b} size )
+
+            if( hashDone AND size EQUAL bucketSize )
+                set( d 0 )
+                set( placed FALSE )
+
+                while( NOT placed AND d LESS slotCount )
+                    set( taken "" )
+                    set( placed TRUE )
+
+                    foreach( ndx ${bucket_${b}} )
+                        list( GET hashes ${ndx} hash )
+                        math( EXPR slot "( ${hash} + ${d} * ( ( ${hash} >> 17 ) | 1 ) ) & ${slotMask}" )
+                        list( FIND taken ${slot} dup )
+
+                        if( DEFINED slot_${slotCount}_${slot} OR NOT dup EQUAL -1 )
+                            set( placed FALSE )
+                            break()
+                        endif()
+
+                        list( APPEND taken ${slot} )
+                    endforeach()
+
+                    if( placed )
+                        set( displacement_${b} ${d} )
+                        set( i 0 )
+
+                        foreach( ndx ${bucket_${b}} )
+                            list( GET taken ${i} slot )
+                            set( slot_${slotCount}_${slot} ${ndx} )
+                            math( EXPR i "${i} + 1" )
+                        endforeach()
+                    else()
+                        math( EXPR d "${d} + 1" )
+                    endif()
+                endwhile()
+
+                if( NOT placed )
+                    set( hashDone FALSE )
+                endif()
+            endif()
+        endforeach()
+
+        math( EXPR bucketSize "${bucketSize} - 1" )
+    endwhile()
+
+    if( NOT hashDone )
+        math( EXPR slotCount "${slotCount} * 2" )
+    endif()
+endwhile()
+
+set( displacements "" )
+
+foreach( b RANGE ${lastBucket} )
+    if( NOT DEFINED displacement_${b} )
+        set( displacement_${b} 0 )       # an empty bucket
+    endif()
+
+    math( EXPR col "${b} % 16" )
+
+    if( col EQUAL 0 )
+        set( displacements "${displacements}\n   " )
+    endif()
+
+    set( displacements "${displacements} ${displacement_${b}}," )
+endforeach()
+
+set( slots "" )
+
+foreach( slot RANGE ${slotMask} )
+    if( DEFINED slot_${slotCount}_${slot} )
+        set( ndx ${slot_${slotCount}_${slot}} )
+    else()
+        set( ndx -1 )
+    endif()
+
+    math( EXPR col "${slot} % 16" )
+
+    if( col EQUAL 0 )
+        set( slots "${slots}\n   " )
+    endif()
+
+    set( slots "${slots} ${ndx}," )
+endforeach()
+
 file( WRITE "${outHeaderFile}" "${includeFileHeader}" )
 file( WRITE "${outCppFile}" "${sourceFileHeader}" )
 
@@ -240,6 +410,9 @@ class ${LEXERCLASS} : public DSNLEXER
     static const KEYWORD  keywords[];
     static const unsigned keyword_count;
 
+    /// Auto generated perfect hash of keywords:
+    static const KEYWORD_HASH keywords_hash;
+
 public:
     /**
      * Constructor ( const std::string&, const wxString& )
@@ -248,7 +421,7 @@ public:
      *   If left empty, then _(\"clipboard\") is used.
      */
     ${LEXERCLASS}( const std::string& aSExpression, const wxString& aSource = wxEmptyString ) :
-        DSNLEXER( keywords, keyword_count, aSExpression, aSource )
+        DSNLEXER( keywords, keyword_count, aSExpression, aSource, &keywords_hash )
     {
     }
 
@@ -262,7 +435,7 @@ public:
      * @param aFilename is the name of the opened file, needed for error reporting.
      */
     ${LEXERCLASS}( FILE* aFile, const wxString& aFilename ) :
-        DSNLEXER( keywords, keyword_count, aFile, aFilename )
+        DSNLEXER( keywords, keyword_count, aFile, aFilename, &keywords_hash )
     {
     }
 
@@ -278,7 +451,7 @@ public:
      *  STRING_LINE_READER or FILE_LINE_READER.  No ownership is taken of aLineReader.
      */
     ${LEXERCLASS}( LINE_READER* aLineReader ) :
-        DSNLEXER( keywords, keyword_count, aLineReader )
+        DSNLEXER( keywords, keyword_count, aLineReader, &keywords_hash )
     {
     }
 
@@ -370,6 +543,18 @@ file( APPEND "${outCppFile}"
 const unsigned ${LEXERCLASS}::keyword_count = unsigned( sizeof( ${LEXERCLASS}::keywords )/sizeof( ${LEXERCLASS}::keywords[0] ) );
 
 
+static const unsigned short keywords_displacements[] = {${displacements}
+};
+
+static const short keywords_slots[] = {${slots}
+};
+
+const KEYWORD_HASH ${LEXERCLASS}::keywords_hash = {
+    keywords_displacements, ${bucketMask},
+    keywords_slots, ${slotMask}
+};
+
+
 const char* ${LEXERCLASS}::TokenName( T aTok )
 {
     const char* ret;
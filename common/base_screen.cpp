@@ -43,6 +43,7 @@ BASE_SCREEN::BASE_SCREEN( KICAD_T aType ) :
     EDA_ITEM( aType )
 {
     m_UndoRedoCountMax = DEFAULT_MAX_UNDO_ITEMS;
+    m_UndoRedoSizeMax  = 0;
     m_FirstRedraw      = true;
     m_ScreenNumber     = 1;
     m_NumberOfScreens  = 1;      // Hierarchy: Root: ScreenNumber = 1
@@ -422,6 +423,12 @@ void BASE_SCREEN::PushCommandToUndoList( PICKED_ITEMS_LIST* aNewitem )
         if( extraitems > 0 )
             ClearUndoORRedoList( m_UndoList, extraitems );
     }
+
+    // Delete the oldest items, if the memory budget is exceeded
+    int oversizeitems = OversizeCommandCount( m_UndoList );
+
+    if( oversizeitems > 0 )
+        ClearUndoORRedoList( m_UndoList, oversizeitems );
 }
 
 
@@ -436,6 +443,12 @@ void BASE_SCREEN::PushCommandToRedoList( PICKED_ITEMS_LIST* aNewitem )
         if( extraitems > 0 )
             ClearUndoORRedoList( m_RedoList, extraitems );
     }
+
+    // Delete the oldest items, if the memory budget is exceeded
+    int oversizeitems = OversizeCommandCount( m_RedoList );
+
+    if( oversizeitems > 0 )
+        ClearUndoORRedoList( m_RedoList, oversizeitems );
 }
 
 
@@ -451,6 +464,23 @@ PICKED_ITEMS_LIST* BASE_SCREEN::PopCommandFromRedoList( )
 }
 
 
+int BASE_SCREEN::OversizeCommandCount( const UNDO_REDO_CONTAINER& aList ) const
+{
+    if( m_UndoRedoSizeMax == 0 )
+        return 0;
+
+    const std::vector<PICKED_ITEMS_LIST*>& commands = aList.m_CommandsList;
+
+    size_t  size = aList.GetImageSize();
+    int     count = 0;
+
+    while( size > m_UndoRedoSizeMax && count + 1 < (int) commands.size() )
+        size -= commands[count++]->m_ImageSize;
+
+    return count;
+}
+
+
 #if defined(DEBUG)
 
 void BASE_SCREEN::Show( int nestLevel, std::ostream& os ) const
@@ -46,6 +46,7 @@ ITEM_PICKER::ITEM_PICKER( EDA_ITEM* aItem, UNDO_REDO_T aUndoRedoStatus )
 PICKED_ITEMS_LIST::PICKED_ITEMS_LIST()
 {
     m_Status = UR_UNSPECIFIED;
+    m_ImageSize = 0;
 }
 
 PICKED_ITEMS_LIST::~PICKED_ITEMS_LIST()
@@ -149,6 +150,8 @@ void PICKED_ITEMS_LIST::ClearListAndDeleteItems()
 
         case UR_CHANGED:
         case UR_EXCHANGE_T:
+        case UR_ZONE_OUTLINE:
+        case UR_ZONE_FILL:
             delete wrapper.GetLink();   //  the picker is owner of this item
             break;
 
@@ -349,3 +352,14 @@ PICKED_ITEMS_LIST* UNDO_REDO_CONTAINER::PopCommand()
 
     return NULL;
 }
+
+
+size_t UNDO_REDO_CONTAINER::GetImageSize() const
+{
+    size_t size = 0;
+
+    for( unsigned ii = 0; ii < m_CommandsList.size(); ii++ )
+        size += m_CommandsList[ii]->m_ImageSize;
+
+    return size;
+}
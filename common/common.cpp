@@ -38,6 +38,7 @@
 #include <confirm.h>
 #include <base_units.h>
 #include <reporter.h>
+#include <ki_mutex.h>
 
 #include <wx/process.h>
 #include <wx/config.h>
@@ -259,9 +260,13 @@ int ProcessExecute( const wxString& aCommandLine, int aFlags, wxProcess *callbac
 
 time_t GetNewTimeStamp()
 {
+    // Items are also created by worker threads, e.g. when loading a board
+    static MUTEX  timestamp_mutex;
     static time_t oldTimeStamp;
     time_t newTimeStamp;
 
+    MUTLOCK lock( timestamp_mutex );
+
     newTimeStamp = time( NULL );
 
     if( newTimeStamp <= oldTimeStamp )
@@ -384,7 +389,6 @@ wxString GetKicadConfigPath()
 }
 
 
-#include <ki_mutex.h>
 const wxString ExpandEnvVarSubstitutions( const wxString& aString )
 {
     // wxGetenv( wchar_t* ) is not re-entrant on linux.
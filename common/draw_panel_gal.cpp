@@ -144,6 +144,7 @@ void EDA_DRAW_PANEL_GAL::onPaint( wxPaintEvent& WXUNUSED( aEvent ) )
 
     m_viewControls->UpdateScrollbars();
     m_view->UpdateItems();
+    m_view->PrepareTargets();
     m_gal->BeginDrawing();
     m_gal->ClearScreen( m_painter->GetSettings()->GetBackgroundColor() );
 
@@ -33,6 +33,8 @@
  */
 
 #include <wx/wx.h>
+#include <wx/dir.h>
+#include <wx/filename.h>
 #include <common.h>
 #include <confirm.h>
 #include <macros.h>
@@ -45,6 +47,318 @@
 #include <class_module.h>
 #include <boost/thread.hpp>
 #include <html_messagebox.h>
+#include <richio.h>
+
+#include <map>
+#include <vector>
+
+
+/// Name of the footprint info index file, kept in the KiCad config directory.
+static const wxChar fpIndexFileName[] = wxT( "fp-info-cache" );
+
+/// First line of the index file, bump the version when the layout changes.
+static const char fpIndexHeader[] = "fp-info-cache 1";
+
+
+/// One footprint in the index, the fields a FOOTPRINT_INFO gets from load().
+struct FP_INDEX_ITEM
+{
+    wxString    name;
+    wxString    doc;
+    wxString    keywords;
+    int         pad_count;
+    int         unique_pad_count;
+};
+
+
+/// The footprints of one library, valid as long as the library stamp matches.
+struct FP_INDEX_LIB
+{
+    wxString                    stamp;
+    std::vector<FP_INDEX_ITEM>  items;
+};
+
+
+/// Index of libraries, keyed by plugin type, full URI and options of the library.
+typedef std::map<wxString, FP_INDEX_LIB>    FP_INDEX;
+
+
+/**
+ * Function hashBytes
+ * folds @a aCount bytes into the FNV-1a hash @a aHash.
+ */
+static void hashBytes( unsigned long long& aHash, const void* aBytes, size_t aCount )
+{
+    const unsigned char* p = (const unsigned char*) aBytes;
+
+    for( size_t i = 0;  i < aCount;  ++i )
+    {
+        aHash ^= p[i];
+        aHash *= 0x100000001b3ULL;
+    }
+}
+
+
+static void hashFile( unsigned long long& aHash, const wxString& aFileName )
+{
+    std::string         name = TO_UTF8( aFileName );
+    long long           mtime = wxFileModificationTime( aFileName );
+    unsigned long long  size = wxFileName::GetSize( aFileName ).GetValue();
+
+    hashBytes( aHash, name.c_str(), name.size() + 1 );
+    hashBytes( aHash, &mtime, sizeof( mtime ) );
+    hashBytes( aHash, &size, sizeof( size ) );
+}
+
+
+/**
+ * Function libraryStamp
+ * returns a hash of the names, sizes and modification times of the files making up
+ * the library at @a aPath, which is a single file or a directory of footprint files
+ * depending on the plugin.  Any change to the library changes the stamp.
+ *
+ * @return wxString - the stamp, or empty if @a aPath is not a local file or
+ *  directory, such as a GitHub URL, in which case the library is not indexed.
+ */
+static wxString libraryStamp( const wxString& aPath )
+{
+    unsigned long long hash = 0xcbf29ce484222325ULL;
+
+    if( wxFileName::DirExists( aPath ) )
+    {
+        wxArrayString files;
+
+        wxDir::GetAllFiles( aPath, &files, wxEmptyString, wxDIR_FILES );
+
+        // wxDir does not list in any particular order.
+        files.Sort();
+
+        for( unsigned i = 0;  i < files.GetCount();  ++i )
+            hashFile( hash, files[i] );
+    }
+    else if( wxFileName::FileExists( aPath ) )
+    {
+        hashFile( hash, aPath );
+    }
+    else
+    {
+        return wxEmptyString;
+    }
+
+    return wxString::Format( wxT( "%016llx" ), hash );
+}
+
+
+/**
+ * Function libraryKey
+ * returns the index key of library @a aNickname in @a aTable, or empty if the library
+ * is not in the table.  The key holds everything that decides what the plugin reads.
+ *
+ * @param aURI is where to put the full, substituted URI of the library.
+ */
+static wxString libraryKey( FP_LIB_TABLE* aTable, const wxString& aNickname, wxString* aURI )
+{
+    try
+    {
+        const FP_LIB_TABLE::ROW* row = aTable->FindRow( aNickname );
+
+        *aURI = row->GetFullURI( true );
+
+        return row->GetType() + wxT( '\t' ) + *aURI + wxT( '\t' ) + row->GetOptions();
+    }
+    catch( const IO_ERROR& )
+    {
+        // The loader reports unknown nicknames.
+        return wxEmptyString;
+    }
+}
+
+
+/// Escapes the separators of the index file format in @a aText.
+static void indexEscape( std::string& aOutput, const wxString& aText )
+{
+    std::string text = TO_UTF8( aText );
+
+    for( unsigned i = 0;  i < text.size();  ++i )
+    {
+        switch( text[i] )
+        {
+        case '\\':  aOutput += "\\\\";     break;
+        case '\t':  aOutput += "\\t";      break;
+        case '\n':  aOutput += "\\n";      break;
+        case '\r':  aOutput += "\\r";      break;
+        default:    aOutput += text[i];  break;
+        }
+    }
+}
+
+
+/**
+ * Function indexSplit
+ * splits the index line @a aLine at its tabs and undoes indexEscape() on each field.
+ */
+static std::vector<wxString> indexSplit( const char* aLine )
+{
+    std::vector<wxString>   fields;
+    std::string             field;
+
+    for( const char* p = aLine;  ;  ++p )
+    {
+        if( *p == '\t' || *p == '\n' || *p == '\r' || *p == 0 )
+        {
+            fields.push_back( FROM_UTF8( field.c_str() ) );
+            field.clear();
+
+            if( *p != '\t' )
+                break;
+        }
+        else if( *p == '\\' && p[1] )
+        {
+            ++p;
+
+            switch( *p )
+            {
+            case 't':   field += '\t';   break;
+            case 'n':   field += '\n';   break;
+            case 'r':   field += '\r';   break;
+            default:    field += *p;     break;
+            }
+        }
+        else
+        {
+            field += *p;
+        }
+    }
+
+    return fields;
+}
+
+
+/// Full path of the footprint info index file.
+static wxString indexFileName()
+{
+    wxFileName fn;
+
+    fn.SetPath( GetKicadConfigPath() );
+    fn.SetFullName( fpIndexFileName );
+
+    return fn.GetFullPath();
+}
+
+
+/**
+ * Function loadIndex
+ * reads the footprint info index file into @a aIndex.  A missing, older or damaged
+ * index is not an error, it only means the libraries get parsed again.
+ */
+static void loadIndex( FP_INDEX& aIndex )
+{
+    wxString fileName = indexFileName();
+
+    if( !wxFileName::IsFileReadable( fileName ) )
+        return;
+
+    try
+    {
+        FILE_LINE_READER    reader( fileName );
+        FP_INDEX_LIB*       lib = NULL;
+
+        if( !reader.ReadLine() || strncmp( reader.Line(), fpIndexHeader,
+                                           sizeof( fpIndexHeader ) - 1 ) )
+            return;
+
+        while( reader.ReadLine() )
+        {
+            std::vector<wxString> fields = indexSplit( reader.Line() );
+
+            if( fields[0] == wxT( "L" ) && fields.size() == 3 )
+            {
+                lib = &aIndex[fields[1]];
+                lib->stamp = fields[2];
+                lib->items.clear();
+            }
+            else if( fields[0] == wxT( "F" ) && fields.size() == 6 && lib )
+            {
+                FP_INDEX_ITEM   item;
+                long            pads = 0;
+                long            unique = 0;
+
+                fields[2].ToLong( &pads );
+                fields[3].ToLong( &unique );
+
+                item.name             = fields[1];
+                item.pad_count        = pads;
+                item.unique_pad_count = unique;
+                item.keywords         = fields[4];
+                item.doc              = fields[5];
+
+                lib->items.push_back( item );
+            }
+            else
+            {
+                // Damaged, drop the whole thing rather than trust part of it.
+                aIndex.clear();
+                return;
+            }
+        }
+    }
+    catch( const IO_ERROR& )
+    {
+        aIndex.clear();
+    }
+}
+
+
+/**
+ * Function saveIndex
+ * writes @a aIndex to the footprint info index file.  The file is written under a
+ * unique temporary name and renamed, so another program reading or saving the index
+ * never sees half of it.  Failing to write the index is not an error.
+ */
+static void saveIndex( const FP_INDEX& aIndex )
+{
+    wxString    fileName = indexFileName();
+    wxString    tempFileName = wxFileName::CreateTempFileName( fileName );
+
+    if( tempFileName.IsEmpty() )
+        return;
+
+    try
+    {
+        FILE_OUTPUTFORMATTER    formatter( tempFileName );
+        std::string             line;
+
+        formatter.Print( 0, "%s\n", fpIndexHeader );
+
+        for( FP_INDEX::const_iterator it = aIndex.begin();  it != aIndex.end();  ++it )
+        {
+            line = "L\t";
+            indexEscape( line, it->first );
+            line += '\t';
+            indexEscape( line, it->second.stamp );
+            formatter.Print( 0, "%s\n", line.c_str() );
+
+            for( const FP_INDEX_ITEM& item : it->second.items )
+            {
+                line = "F\t";
+                indexEscape( line, item.name );
+                line += StrPrintf( "\t%d\t%d\t", item.pad_count, item.unique_pad_count );
+                indexEscape( line, item.keywords );
+                line += '\t';
+                indexEscape( line, item.doc );
+                formatter.Print( 0, "%s\n", line.c_str() );
+            }
+        }
+    }
+    catch( const IO_ERROR& )
+    {
+        wxRemoveFile( tempFileName );
+        return;
+    }
+
+    if( !wxRenameFile( tempFileName, fileName, true ) )
+        wxRemoveFile( tempFileName );
+}
 
 
 void FOOTPRINT_INFO::load()
@@ -140,22 +454,113 @@ bool FOOTPRINT_LIST::ReadFootprintFiles( FP_LIB_TABLE* aTable, const wxString* a
     m_errors.clear();
     m_list.clear();
 
+    std::vector< wxString > nicknames;
+
     if( aNickname )
     {
         // single footprint
-        loader_job( aNickname, 1 );
+        nicknames.push_back( *aNickname );
     }
     else
     {
-        std::vector< wxString > nicknames;
-
         // do all of them
         nicknames = aTable->GetLogicalLibs();
+    }
 
-        loader_job( &nicknames[0], nicknames.size() );
+    FP_INDEX    index;
+    FP_INDEX    used;
+    bool        indexChanged = false;
 
-        m_list.sort();
+    loadIndex( index );
+
+    for( unsigned i = 0;  i < nicknames.size();  ++i )
+    {
+        const wxString& nickname = nicknames[i];
+        wxString        uri;
+        wxString        key = libraryKey( aTable, nickname, &uri );
+        wxString        stamp = key.IsEmpty() ? wxString() : libraryStamp( uri );
+
+        FP_INDEX::iterator it = stamp.IsEmpty() ? index.end() : index.find( key );
+
+        if( it != index.end() && it->second.stamp == stamp )
+        {
+            // Library did not change since it was indexed.
+            for( const FP_INDEX_ITEM& item : it->second.items )
+            {
+                addItem( new FOOTPRINT_INFO( this, nickname, item.name, item.doc,
+                                             item.keywords, item.pad_count,
+                                             item.unique_pad_count ) );
+            }
+
+            used.insert( *it );
+            continue;
+        }
+
+        unsigned    first = m_list.size();
+        int         errorCount = m_error_count;
+
+        loader_job( &nickname, 1 );
+
+        if( stamp.IsEmpty() || m_error_count != errorCount )
+            continue;
+
+        FP_INDEX_LIB    lib;
+
+        lib.stamp = stamp;
+
+        for( unsigned ndx = first;  ndx < m_list.size();  )
+        {
+            FOOTPRINT_INFO& fp = m_list[ndx];
+            FP_INDEX_ITEM   item;
+
+            // The getters parse the footprint if it is not loaded yet, which can fail.
+            try
+            {
+                item.name             = fp.GetFootprintName();
+                item.doc              = fp.GetDoc();
+                item.keywords         = fp.GetKeywords();
+                item.pad_count        = fp.GetPadCount();
+                item.unique_pad_count = fp.GetUniquePadCount();
+            }
+            catch( const IO_ERROR& ioe )
+            {
+                ++m_error_count;
+                m_errors.push_back( new IO_ERROR( ioe ) );
+
+                // Not listed, as when loader_job() fails to load it.
+                m_list.erase( m_list.begin() + ndx );
+                continue;
+            }
+
+            lib.items.push_back( item );
+            ++ndx;
+        }
+
+        // Index only a library that read cleanly, so its errors show up again next time.
+        if( m_error_count != errorCount )
+            continue;
+
+        used[key] = lib;
+        indexChanged = true;
+    }
+
+    if( aNickname )
+    {
+        // Keep the rest of the libraries indexed.
+        for( FP_INDEX::iterator it = index.begin();  it != index.end();  ++it )
+            used.insert( *it );
     }
+    else if( used.size() != index.size() )
+    {
+        // Libraries gone from the table are dropped from the index.
+        indexChanged = true;
+    }
+
+    if( indexChanged )
+        saveIndex( used );
+
+    if( !aNickname )
+        m_list.sort();
 
     // The result of this function can be a blend of successes and failures, whose
     // mix is given by the Count()s of the two lists.  The return value indicates whether
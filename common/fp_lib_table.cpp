@@ -739,7 +739,7 @@ void FP_LIB_TABLE::Load( const wxString& aFileName )
     // It's OK if footprint library tables are missing.
     if( wxFileName::IsFileReadable( aFileName ) )
     {
-        FILE_LINE_READER    reader( aFileName );
+        MMAP_LINE_READER    reader( aFileName );
         FP_LIB_TABLE_LEXER  lexer( &reader );
 
         Parse( &lexer );
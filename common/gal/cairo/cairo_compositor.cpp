@@ -31,6 +31,10 @@
 #include <gal/cairo/cairo_compositor.h>
 #include <wx/log.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
 using namespace KIGFX;
 
 CAIRO_COMPOSITOR::CAIRO_COMPOSITOR( cairo_t** aMainContext ) :
@@ -127,6 +131,66 @@ void CAIRO_COMPOSITOR::ClearBuffer()
 }
 
 
+void CAIRO_COMPOSITOR::ClearBuffer( const BOX2I& aArea )
+{
+    const int bpp = sizeof( unsigned int );    // CAIRO_FORMAT_ARGB32
+
+    int left   = std::max( aArea.GetLeft(), 0 );
+    int right  = std::min( aArea.GetRight(), (int) m_width );
+    int top    = std::max( aArea.GetTop(), 0 );
+    int bottom = std::min( aArea.GetBottom(), (int) m_height );
+
+    if( left >= right || top >= bottom )
+        return;
+
+    cairo_surface_flush( m_buffers[m_current].surface );
+
+    unsigned char* pixels = (unsigned char*) m_buffers[m_current].bitmap.get();
+
+    for( int y = top; y < bottom; ++y )
+        memset( pixels + y * m_stride + left * bpp, 0x00, ( right - left ) * bpp );
+
+    cairo_surface_mark_dirty( m_buffers[m_current].surface );
+}
+
+
+void CAIRO_COMPOSITOR::ScrollBuffer( unsigned int aBufferHandle, const VECTOR2I& aDelta )
+{
+    wxASSERT_MSG( aBufferHandle <= usedBuffers(), wxT( "Tried to use a not existing buffer" ) );
+
+    const int bpp = sizeof( unsigned int );    // CAIRO_FORMAT_ARGB32
+    const int width = m_width, height = m_height;
+
+    if( std::abs( aDelta.x ) >= width || std::abs( aDelta.y ) >= height )
+        return;     // nothing stays on the screen
+
+    const CAIRO_BUFFER& buffer = m_buffers[aBufferHandle - 1];
+    unsigned char* pixels = (unsigned char*) buffer.bitmap.get();
+
+    int srcX  = std::max( -aDelta.x, 0 );
+    int dstX  = std::max( aDelta.x, 0 );
+    int count = ( width - std::abs( aDelta.x ) ) * bpp;
+
+    cairo_surface_flush( buffer.surface );
+
+    // Rows are copied in the order that does not overwrite the ones still to be moved
+    if( aDelta.y > 0 )
+    {
+        for( int y = height - 1; y >= aDelta.y; --y )
+            memmove( pixels + y * m_stride + dstX * bpp,
+                     pixels + ( y - aDelta.y ) * m_stride + srcX * bpp, count );
+    }
+    else
+    {
+        for( int y = 0; y < height + aDelta.y; ++y )
+            memmove( pixels + y * m_stride + dstX * bpp,
+                     pixels + ( y - aDelta.y ) * m_stride + srcX * bpp, count );
+    }
+
+    cairo_surface_mark_dirty( buffer.surface );
+}
+
+
 void CAIRO_COMPOSITOR::DrawBuffer( unsigned int aBufferHandle )
 {
     wxASSERT_MSG( aBufferHandle <= usedBuffers(), wxT( "Tried to use a not existing buffer" ) );
@@ -107,11 +107,38 @@ void CAIRO_GAL::BeginDrawing()
     initSurface();
 
     if( !validCompositor )
+    {
         setCompositor();
 
+        // New buffers have no contents to keep
+        redrawArea.clear();
+    }
+
     compositor->SetMainContext( context );
     compositor->SetBuffer( mainBuffer );
 
+    // The clip has to be set outside of the group, so it is kept when the group is painted
+    cairo_reset_clip( currentContext );
+
+    if( !redrawArea.empty() )
+    {
+        cairo_matrix_t matrix;
+
+        // The area is given in screen coordinates
+        cairo_get_matrix( currentContext, &matrix );
+        cairo_identity_matrix( currentContext );
+        cairo_new_path( currentContext );
+
+        for( const BOX2I& rect : redrawArea )
+        {
+            cairo_rectangle( currentContext, rect.GetX(), rect.GetY(),
+                             rect.GetWidth(), rect.GetHeight() );
+        }
+
+        cairo_clip( currentContext );
+        cairo_set_matrix( currentContext, &matrix );
+    }
+
     // Cairo grouping prevents display of overlapping items on the same layer in the lighter color
     cairo_push_group( currentContext );
 }
@@ -155,6 +182,9 @@ void CAIRO_GAL::EndDrawing()
     blitCursor( dc );
 
     deinitSurface();
+
+    // The next frame is drawn on the whole screen, unless told otherwise
+    redrawArea.clear();
 }
 
 
@@ -785,13 +815,53 @@ void CAIRO_GAL::ClearTarget( RENDER_TARGET aTarget )
         break;
     }
 
-    compositor->ClearBuffer();
+    if( redrawArea.empty() || aTarget == TARGET_OVERLAY )
+    {
+        compositor->ClearBuffer();
+    }
+    else
+    {
+        for( const BOX2I& rect : redrawArea )
+            compositor->ClearBuffer( rect );
+    }
 
     // Restore the previous state
     compositor->SetBuffer( currentBuffer );
 }
 
 
+void CAIRO_GAL::SetRedrawArea( const std::vector<BOX2I>& aArea )
+{
+    redrawArea = aArea;
+}
+
+
+bool CAIRO_GAL::ScrollTargets( const VECTOR2I& aDelta )
+{
+    // Buffers are recreated together with the compositor, there is nothing to move
+    if( !validCompositor )
+        return false;
+
+    // Cached and noncached items are rendered to the same buffer
+    compositor->ScrollBuffer( mainBuffer, aDelta );
+
+    return true;
+}
+
+
+void CAIRO_GAL::ComputeWorldScreenMatrix()
+{
+    GAL::ComputeWorldScreenMatrix();
+
+    // Keep the world origin on a whole pixel, so a pan at a given scale moves the drawn
+    // contents by whole pixels and ScrollTargets() can reuse them. The drawing moves by
+    // less than half a pixel.
+    worldScreenMatrix.m_data[0][2] = floor( worldScreenMatrix.m_data[0][2] + 0.5 );
+    worldScreenMatrix.m_data[1][2] = floor( worldScreenMatrix.m_data[1][2] + 0.5 );
+    screenWorldMatrix = worldScreenMatrix.Inverse();
+}
+
+
 void CAIRO_GAL::SetCursorSize( unsigned int aCursorSize )
 {
     GAL::SetCursorSize( aCursorSize );
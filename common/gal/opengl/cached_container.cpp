@@ -35,6 +35,7 @@
 #include <gal/opengl/shader.h>
 #include <confirm.h>
 #include <wx/log.h>
+#include <wx/thread.h>
 #include <list>
 #ifdef __WXDEBUG__
 #include <profile.h>
@@ -313,9 +314,13 @@ bool CACHED_CONTAINER::defragment( VERTEX* aTarget )
 
         if( aTarget == NULL )
         {
-            DisplayError( NULL, wxString::Format(
-                          wxT( "CACHED_CONTAINER::defragment: Run out of memory (malloc %d bytes)" ),
-                          size ) );
+            // Worker threads filling a staging container (see VIEW::recacheParallel()) must
+            // not open dialogs
+            if( wxIsMainThread() )
+                DisplayError( NULL, wxString::Format(
+                              wxT( "CACHED_CONTAINER::defragment: Run out of memory (malloc %d bytes)" ),
+                              size ) );
+
             return false;
         }
     }
@@ -440,10 +445,12 @@ bool CACHED_CONTAINER::resizeContainer( unsigned int aNewSize )
 
         if( newContainer == NULL )
         {
-            DisplayError( NULL, wxString::Format(
-                          wxT( "CACHED_CONTAINER::resizeContainer:\n"
-                               "Run out of memory (malloc %d bytes)" ),
-                          size ) );
+            if( wxIsMainThread() )
+                DisplayError( NULL, wxString::Format(
+                              wxT( "CACHED_CONTAINER::resizeContainer:\n"
+                                   "Run out of memory (malloc %d bytes)" ),
+                              size ) );
+
             return false;
         }
 
@@ -463,10 +470,12 @@ bool CACHED_CONTAINER::resizeContainer( unsigned int aNewSize )
 
         if( newContainer == NULL )
         {
-            DisplayError( NULL, wxString::Format(
-                          wxT( "CACHED_CONTAINER::resizeContainer:\n"
-                               "Run out of memory (realloc from %d to %d bytes)" ),
-                          m_currentSize * sizeof( VERTEX ), size ) );
+            if( wxIsMainThread() )
+                DisplayError( NULL, wxString::Format(
+                              wxT( "CACHED_CONTAINER::resizeContainer:\n"
+                                   "Run out of memory (realloc from %d to %d bytes)" ),
+                              m_currentSize * sizeof( VERTEX ), size ) );
+
             return false;
         }
 
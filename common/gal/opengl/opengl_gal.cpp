@@ -102,15 +102,6 @@ OPENGL_GAL::OPENGL_GAL( wxWindow* aParent, wxEvtHandler* aMouseListener,
     // Grid color settings are different in Cairo and OpenGL
     SetGridColor( COLOR4D( 0.8, 0.8, 0.8, 0.1 ) );
 
-    // Tesselator initialization
-    tesselator = gluNewTess();
-    InitTesselatorCallbacks( tesselator );
-
-    if( tesselator == NULL )
-        throw std::runtime_error( "Could not create the tesselator" );
-
-    gluTessProperty( tesselator, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_POSITIVE );
-
     currentManager = &nonCachedManager;
 }
 
@@ -119,7 +110,6 @@ OPENGL_GAL::~OPENGL_GAL()
 {
     glFlush();
 
-    gluDeleteTess( tesselator );
     ClearCache();
 }
 
@@ -227,7 +217,27 @@ void OPENGL_GAL::EndDrawing()
 }
 
 
-void OPENGL_GAL::DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
+VERTEX_GAL::VERTEX_GAL() :
+    currentManager( NULL )
+{
+    // Tesselator initialization
+    tesselator = gluNewTess();
+    InitTesselatorCallbacks( tesselator );
+
+    if( tesselator == NULL )
+        throw std::runtime_error( "Could not create the tesselator" );
+
+    gluTessProperty( tesselator, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_POSITIVE );
+}
+
+
+VERTEX_GAL::~VERTEX_GAL()
+{
+    gluDeleteTess( tesselator );
+}
+
+
+void VERTEX_GAL::DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
 {
     const VECTOR2D  startEndVector = aEndPoint - aStartPoint;
     double          lineAngle = startEndVector.Angle();
@@ -245,7 +255,7 @@ void OPENGL_GAL::DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoin
 }
 
 
-void OPENGL_GAL::DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint,
+void VERTEX_GAL::DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint,
                               double aWidth )
 {
     VECTOR2D startEndVector = aEndPoint - aStartPoint;
@@ -290,7 +300,7 @@ void OPENGL_GAL::DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& aEndP
 }
 
 
-void OPENGL_GAL::DrawCircle( const VECTOR2D& aCenterPoint, double aRadius )
+void VERTEX_GAL::DrawCircle( const VECTOR2D& aCenterPoint, double aRadius )
 {
     if( isFillEnabled )
     {
@@ -348,7 +358,7 @@ void OPENGL_GAL::DrawCircle( const VECTOR2D& aCenterPoint, double aRadius )
 }
 
 
-void OPENGL_GAL::DrawArc( const VECTOR2D& aCenterPoint, double aRadius, double aStartAngle,
+void VERTEX_GAL::DrawArc( const VECTOR2D& aCenterPoint, double aRadius, double aStartAngle,
                           double aEndAngle )
 {
     if( aRadius <= 0 )
@@ -411,7 +421,7 @@ void OPENGL_GAL::DrawArc( const VECTOR2D& aCenterPoint, double aRadius, double a
 }
 
 
-void OPENGL_GAL::DrawRectangle( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
+void VERTEX_GAL::DrawRectangle( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
 {
     // Compute the diagonal points of the rectangle
     VECTOR2D diagonalPointA( aEndPoint.x, aStartPoint.y );
@@ -448,7 +458,7 @@ void OPENGL_GAL::DrawRectangle( const VECTOR2D& aStartPoint, const VECTOR2D& aEn
 }
 
 
-void OPENGL_GAL::DrawPolyline( const std::deque<VECTOR2D>& aPointList )
+void VERTEX_GAL::DrawPolyline( const std::deque<VECTOR2D>& aPointList )
 {
     if( aPointList.empty() )
         return;
@@ -476,7 +486,7 @@ void OPENGL_GAL::DrawPolyline( const std::deque<VECTOR2D>& aPointList )
 }
 
 
-void OPENGL_GAL::DrawPolyline( const VECTOR2D aPointList[], int aListSize )
+void VERTEX_GAL::DrawPolyline( const VECTOR2D aPointList[], int aListSize )
 {
     currentManager->Color( strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
 
@@ -499,7 +509,7 @@ void OPENGL_GAL::DrawPolyline( const VECTOR2D aPointList[], int aListSize )
 }
 
 
-void OPENGL_GAL::DrawPolygon( const std::deque<VECTOR2D>& aPointList )
+void VERTEX_GAL::DrawPolygon( const std::deque<VECTOR2D>& aPointList )
 {
     currentManager->Shader( SHADER_NONE );
     currentManager->Color( fillColor.r, fillColor.g, fillColor.b, fillColor.a );
@@ -532,7 +542,7 @@ void OPENGL_GAL::DrawPolygon( const std::deque<VECTOR2D>& aPointList )
 }
 
 
-void OPENGL_GAL::DrawPolygon( const VECTOR2D aPointList[], int aListSize )
+void VERTEX_GAL::DrawPolygon( const VECTOR2D aPointList[], int aListSize )
 {
     currentManager->Shader( SHADER_NONE );
     currentManager->Color( fillColor.r, fillColor.g, fillColor.b, fillColor.a );
@@ -567,7 +577,7 @@ void OPENGL_GAL::DrawPolygon( const VECTOR2D aPointList[], int aListSize )
 }
 
 
-void OPENGL_GAL::DrawCurve( const VECTOR2D& aStartPoint, const VECTOR2D& aControlPointA,
+void VERTEX_GAL::DrawCurve( const VECTOR2D& aStartPoint, const VECTOR2D& aControlPointA,
                             const VECTOR2D& aControlPointB, const VECTOR2D& aEndPoint )
 {
     // FIXME The drawing quality needs to be improved
@@ -660,31 +670,31 @@ void OPENGL_GAL::Transform( const MATRIX3x3D& aTransformation )
 }
 
 
-void OPENGL_GAL::Rotate( double aAngle )
+void VERTEX_GAL::Rotate( double aAngle )
 {
     currentManager->Rotate( aAngle, 0.0f, 0.0f, 1.0f );
 }
 
 
-void OPENGL_GAL::Translate( const VECTOR2D& aVector )
+void VERTEX_GAL::Translate( const VECTOR2D& aVector )
 {
     currentManager->Translate( aVector.x, aVector.y, 0.0f );
 }
 
 
-void OPENGL_GAL::Scale( const VECTOR2D& aScale )
+void VERTEX_GAL::Scale( const VECTOR2D& aScale )
 {
     currentManager->Scale( aScale.x, aScale.y, 0.0f );
 }
 
 
-void OPENGL_GAL::Save()
+void VERTEX_GAL::Save()
 {
     currentManager->PushMatrix();
 }
 
 
-void OPENGL_GAL::Restore()
+void VERTEX_GAL::Restore()
 {
     currentManager->PopMatrix();
 }
@@ -741,6 +751,87 @@ void OPENGL_GAL::ClearCache()
 }
 
 
+GAL* OPENGL_GAL::CreateStage()
+{
+    STAGING_GAL* stage = new STAGING_GAL;
+
+    stage->screenSize       = screenSize;
+    stage->worldUnitLength  = worldUnitLength;
+    stage->screenDPI        = screenDPI;
+    stage->lookAtPoint      = lookAtPoint;
+    stage->zoomFactor       = zoomFactor;
+    stage->flipX            = flipX;
+    stage->flipY            = flipY;
+    stage->depthRange       = depthRange;
+    stage->ComputeWorldScreenMatrix();
+
+    return stage;
+}
+
+
+void OPENGL_GAL::MergeStage( GAL* aStage, std::vector<int>& aGroups )
+{
+    STAGING_GAL* stage = dynamic_cast<STAGING_GAL*>( aStage );
+
+    wxCHECK_RET( stage, wxT( "MergeStage: the stage was not created by this GAL" ) );
+
+    aGroups.resize( stage->stagedGroups.size() );
+
+    for( unsigned int i = 0; i < stage->stagedGroups.size(); ++i )
+    {
+        const VERTEX_ITEM& staged = *stage->stagedGroups[i];
+
+        // The vertices are copied as they are, they have been transformed by the stage
+        std::shared_ptr<VERTEX_ITEM> newItem( new VERTEX_ITEM( cachedManager ) );
+        int groupNumber = getNewGroupNumber();
+        groups.insert( std::make_pair( groupNumber, newItem ) );
+
+        if( staged.GetSize() > 0 )
+            cachedManager.PutVertices( staged.GetVertices(), staged.GetSize() );
+
+        cachedManager.FinishItem();
+        aGroups[i] = groupNumber;
+    }
+
+    stage->ClearCache();
+}
+
+
+STAGING_GAL::STAGING_GAL() :
+    manager( true, INITIAL_SIZE )
+{
+    currentManager = &manager;
+}
+
+
+STAGING_GAL::~STAGING_GAL()
+{
+    // The groups have to be freed before their container
+    stagedGroups.clear();
+}
+
+
+int STAGING_GAL::BeginGroup()
+{
+    stagedGroups.push_back( std::shared_ptr<VERTEX_ITEM>( new VERTEX_ITEM( manager ) ) );
+
+    return stagedGroups.size() - 1;
+}
+
+
+void STAGING_GAL::EndGroup()
+{
+    manager.FinishItem();
+}
+
+
+void STAGING_GAL::ClearCache()
+{
+    stagedGroups.clear();
+    manager.Clear();
+}
+
+
 void OPENGL_GAL::SaveScreen()
 {
     wxASSERT_MSG( false, wxT( "Not implemented yet" ) );
@@ -839,7 +930,7 @@ void OPENGL_GAL::drawGridLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEnd
 }
 
 
-void OPENGL_GAL::drawLineQuad( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
+void VERTEX_GAL::drawLineQuad( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
 {
     /* Helper drawing:                   ____--- v3       ^
      *                           ____---- ...   \          \
@@ -889,7 +980,7 @@ void OPENGL_GAL::drawLineQuad( const VECTOR2D& aStartPoint, const VECTOR2D& aEnd
 }
 
 
-void OPENGL_GAL::drawSemiCircle( const VECTOR2D& aCenterPoint, double aRadius, double aAngle )
+void VERTEX_GAL::drawSemiCircle( const VECTOR2D& aCenterPoint, double aRadius, double aAngle )
 {
     if( isFillEnabled )
     {
@@ -905,7 +996,7 @@ void OPENGL_GAL::drawSemiCircle( const VECTOR2D& aCenterPoint, double aRadius, d
 }
 
 
-void OPENGL_GAL::drawFilledSemiCircle( const VECTOR2D& aCenterPoint, double aRadius,
+void VERTEX_GAL::drawFilledSemiCircle( const VECTOR2D& aCenterPoint, double aRadius,
                                        double aAngle )
 {
     Save();
@@ -934,7 +1025,7 @@ void OPENGL_GAL::drawFilledSemiCircle( const VECTOR2D& aCenterPoint, double aRad
 }
 
 
-void OPENGL_GAL::drawStrokedSemiCircle( const VECTOR2D& aCenterPoint, double aRadius,
+void VERTEX_GAL::drawStrokedSemiCircle( const VECTOR2D& aCenterPoint, double aRadius,
                                         double aAngle )
 {
     double outerRadius = aRadius + ( lineWidth / 2 );
@@ -1155,7 +1246,7 @@ void OPENGL_GAL::OPENGL_TEST::error( const std::string& aError )
 void CALLBACK VertexCallback( GLvoid* aVertexPtr, void* aData )
 {
     GLdouble* vertex = static_cast<GLdouble*>( aVertexPtr );
-    OPENGL_GAL::TessParams* param = static_cast<OPENGL_GAL::TessParams*>( aData );
+    VERTEX_GAL::TessParams* param = static_cast<VERTEX_GAL::TessParams*>( aData );
     VERTEX_MANAGER* vboManager = param->vboManager;
 
     if( vboManager )
@@ -1168,7 +1259,7 @@ void CALLBACK CombineCallback( GLdouble coords[3],
                                GLfloat weight[4], GLdouble** dataOut, void* aData )
 {
     GLdouble* vertex = new GLdouble[3];
-    OPENGL_GAL::TessParams* param = static_cast<OPENGL_GAL::TessParams*>( aData );
+    VERTEX_GAL::TessParams* param = static_cast<VERTEX_GAL::TessParams*>( aData );
 
     // Save the pointer so we can delete it later
     param->intersectPoints.push_back( boost::shared_array<GLdouble>( vertex ) );
@@ -36,12 +36,12 @@
 
 using namespace KIGFX;
 
-VERTEX_CONTAINER* VERTEX_CONTAINER::MakeContainer( bool aCached )
+VERTEX_CONTAINER* VERTEX_CONTAINER::MakeContainer( bool aCached, unsigned int aSize )
 {
     if( aCached )
-        return new CACHED_CONTAINER;
+        return new CACHED_CONTAINER( aSize );
     else
-        return new NONCACHED_CONTAINER;
+        return new NONCACHED_CONTAINER( aSize );
 }
 
 
@@ -34,13 +34,16 @@
 #include <gal/opengl/gpu_manager.h>
 #include <gal/opengl/vertex_item.h>
 #include <confirm.h>
+#include <wx/thread.h>
+
+#include <cstring>
 
 using namespace KIGFX;
 
-VERTEX_MANAGER::VERTEX_MANAGER( bool aCached ) :
+VERTEX_MANAGER::VERTEX_MANAGER( bool aCached, unsigned int aSize ) :
     m_noTransform( true ), m_transform( 1.0f )
 {
-    m_container.reset( VERTEX_CONTAINER::MakeContainer( aCached ) );
+    m_container.reset( VERTEX_CONTAINER::MakeContainer( aCached, aSize ) );
     m_gpu.reset( GPU_MANAGER::MakeManager( m_container.get() ) );
 
     // There is no shader used by default
@@ -59,7 +62,8 @@ void VERTEX_MANAGER::Vertex( GLfloat aX, GLfloat aY, GLfloat aZ ) const
 
     if( newVertex == NULL )
     {
-        if( show_err )
+        // Staging managers are filled by worker threads, which cannot open dialogs
+        if( show_err && wxIsMainThread() )
         {
             DisplayError( NULL, wxT( "VERTEX_MANAGER::Vertex: Vertex allocation error" ) );
             show_err = false;
@@ -82,7 +86,7 @@ void VERTEX_MANAGER::Vertices( const VERTEX aVertices[], unsigned int aSize ) co
 
     if( newVertex == NULL )
     {
-        if( show_err )
+        if( show_err && wxIsMainThread() )
         {
             DisplayError( NULL, wxT( "VERTEX_MANAGER::Vertices: Vertex allocation error" ) );
             show_err = false;
@@ -99,6 +103,28 @@ void VERTEX_MANAGER::Vertices( const VERTEX aVertices[], unsigned int aSize ) co
 }
 
 
+void VERTEX_MANAGER::PutVertices( const VERTEX aVertices[], unsigned int aSize ) const
+{
+    // flag to avoid hanging by calling DisplayError too many times:
+    static bool show_err = true;
+
+    VERTEX* newVertex = m_container->Allocate( aSize );
+
+    if( newVertex == NULL )
+    {
+        if( show_err )
+        {
+            DisplayError( NULL, wxT( "VERTEX_MANAGER::PutVertices: Vertex allocation error" ) );
+            show_err = false;
+        }
+
+        return;
+    }
+
+    memcpy( newVertex, aVertices, aSize * VertexSize );
+}
+
+
 void VERTEX_MANAGER::SetItem( VERTEX_ITEM& aItem ) const
 {
     m_container->SetItem( &aItem );
@@ -0,0 +1,226 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+
+#if defined( __AVX__ )
+#include <immintrin.h>
+#elif defined( __SSE2__ ) || defined( _M_X64 )
+#include <emmintrin.h>
+#define SEG_BATCH_SSE2
+#endif
+
+#include <math/box2.h>
+#include <geometry/seg_batch.h>
+#include <geometry/shape_line_chain.h>
+
+// the arrays of bounding boxes are padded to a multiple of this
+static const int VECTOR_WIDTH = 4;
+
+// coordinate of the padding entries: their bounding box is farther than any margin
+static const double FAR_AWAY = 1e300;
+
+
+static inline void segBox( const SEG& aSeg, double aBox[4] )
+{
+    aBox[0] = std::min( aSeg.A.x, aSeg.B.x );
+    aBox[1] = std::max( aSeg.A.x, aSeg.B.x );
+    aBox[2] = std::min( aSeg.A.y, aSeg.B.y );
+    aBox[3] = std::max( aSeg.A.y, aSeg.B.y );
+}
+
+
+void SEG_BATCH::Clear()
+{
+    m_segs.clear();
+    m_xMin.clear();
+    m_xMax.clear();
+    m_yMin.clear();
+    m_yMax.clear();
+}
+
+
+void SEG_BATCH::Reserve( int aCount )
+{
+    int padded = ( aCount + VECTOR_WIDTH - 1 ) / VECTOR_WIDTH * VECTOR_WIDTH;
+
+    m_segs.reserve( aCount );
+    m_xMin.reserve( padded );
+    m_xMax.reserve( padded );
+    m_yMin.reserve( padded );
+    m_yMax.reserve( padded );
+}
+
+
+void SEG_BATCH::Add( const SEG& aSeg )
+{
+    int n = m_segs.size();
+
+    if( n % VECTOR_WIDTH == 0 )
+    {
+        m_xMin.resize( n + VECTOR_WIDTH, FAR_AWAY );
+        m_xMax.resize( n + VECTOR_WIDTH, FAR_AWAY );
+        m_yMin.resize( n + VECTOR_WIDTH, FAR_AWAY );
+        m_yMax.resize( n + VECTOR_WIDTH, FAR_AWAY );
+    }
+
+    double box[4];
+    segBox( aSeg, box );
+
+    m_xMin[n] = box[0];
+    m_xMax[n] = box[1];
+    m_yMin[n] = box[2];
+    m_yMax[n] = box[3];
+
+    m_segs.push_back( aSeg );
+}
+
+
+void SEG_BATCH::Add( const SHAPE_LINE_CHAIN& aChain )
+{
+    Reserve( Size() + aChain.SegmentCount() );
+
+    for( int i = 0; i < aChain.SegmentCount(); i++ )
+        Add( aChain.CSegment( i ) );
+}
+
+
+int SEG_BATCH::nextCandidate( const double aBox[4], double aMargin, int aFirst ) const
+{
+    int n = m_segs.size();
+    int i = aFirst;
+
+#if defined( __AVX__ )
+    // go back to the start of the vector holding aFirst, the preceding entries are masked
+    int skip = i % VECTOR_WIDTH;
+    i -= skip;
+
+    const __m256d qxMin = _mm256_set1_pd( aBox[0] );
+    const __m256d qxMax = _mm256_set1_pd( aBox[1] );
+    const __m256d qyMin = _mm256_set1_pd( aBox[2] );
+    const __m256d qyMax = _mm256_set1_pd( aBox[3] );
+    const __m256d margin = _mm256_set1_pd( aMargin );
+
+    for( ; i < n; i += 4 )
+    {
+        // distance between the boxes along each axis, negative if they overlap
+        __m256d gx = _mm256_max_pd( _mm256_sub_pd( qxMin, _mm256_loadu_pd( &m_xMax[i] ) ),
+                                    _mm256_sub_pd( _mm256_loadu_pd( &m_xMin[i] ), qxMax ) );
+        __m256d gy = _mm256_max_pd( _mm256_sub_pd( qyMin, _mm256_loadu_pd( &m_yMax[i] ) ),
+                                    _mm256_sub_pd( _mm256_loadu_pd( &m_yMin[i] ), qyMax ) );
+        __m256d distant = _mm256_or_pd( _mm256_cmp_pd( gx, margin, _CMP_GT_OQ ),
+                                        _mm256_cmp_pd( gy, margin, _CMP_GT_OQ ) );
+
+        int hits = ~_mm256_movemask_pd( distant ) & ( 0xf << skip ) & 0xf;
+        skip = 0;
+
+        for( int k = 0; hits; k++, hits >>= 1 )
+        {
+            if( hits & 1 )
+                return i + k;
+        }
+    }
+
+    return -1;
+#elif defined( SEG_BATCH_SSE2 )
+    int skip = i % 2;
+    i -= skip;
+
+    const __m128d qxMin = _mm_set1_pd( aBox[0] );
+    const __m128d qxMax = _mm_set1_pd( aBox[1] );
+    const __m128d qyMin = _mm_set1_pd( aBox[2] );
+    const __m128d qyMax = _mm_set1_pd( aBox[3] );
+    const __m128d margin = _mm_set1_pd( aMargin );
+
+    for( ; i < n; i += 2 )
+    {
+        __m128d gx = _mm_max_pd( _mm_sub_pd( qxMin, _mm_loadu_pd( &m_xMax[i] ) ),
+                                 _mm_sub_pd( _mm_loadu_pd( &m_xMin[i] ), qxMax ) );
+        __m128d gy = _mm_max_pd( _mm_sub_pd( qyMin, _mm_loadu_pd( &m_yMax[i] ) ),
+                                 _mm_sub_pd( _mm_loadu_pd( &m_yMin[i] ), qyMax ) );
+        __m128d distant = _mm_or_pd( _mm_cmpgt_pd( gx, margin ), _mm_cmpgt_pd( gy, margin ) );
+
+        int hits = ~_mm_movemask_pd( distant ) & ( 0x3 << skip ) & 0x3;
+        skip = 0;
+
+        if( hits & 1 )
+            return i;
+        else if( hits & 2 )
+            return i + 1;
+    }
+
+    return -1;
+#else
+    for( ; i < n; i++ )
+    {
+        double gx = std::max( aBox[0] - m_xMax[i], m_xMin[i] - aBox[1] );
+        double gy = std::max( aBox[2] - m_yMax[i], m_yMin[i] - aBox[3] );
+
+        if( gx <= aMargin && gy <= aMargin )
+            return i;
+    }
+
+    return -1;
+#endif
+}
+
+
+int SEG_BATCH::Collide( const SEG& aSeg, int aClearance, int aFirst ) const
+{
+    double box[4];
+    segBox( aSeg, box );
+
+    const BOX2I segBox2( aSeg.A, aSeg.B - aSeg.A );
+    BOX2I::ecoord_type dist_sq = (BOX2I::ecoord_type) aClearance * aClearance;
+
+    // boxes closer than aClearance are closer than aClearance along both axes
+    for( int i = nextCandidate( box, aClearance, aFirst ); i >= 0;
+         i = nextCandidate( box, aClearance, i + 1 ) )
+    {
+        const SEG& s = m_segs[i];
+
+        if( BOX2I( s.A, s.B - s.A ).SquaredDistance( segBox2 ) < dist_sq &&
+            s.Collide( aSeg, aClearance ) )
+            return i;
+    }
+
+    return -1;
+}
+
+
+int SEG_BATCH::Candidates( const SEG& aSeg, int aMargin, std::vector<int>& aIndices ) const
+{
+    double box[4];
+    int count = 0;
+
+    segBox( aSeg, box );
+
+    for( int i = nextCandidate( box, aMargin, 0 ); i >= 0;
+         i = nextCandidate( box, aMargin, i + 1 ) )
+    {
+        aIndices.push_back( i );
+        count++;
+    }
+
+    return count;
+}
@@ -0,0 +1,225 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include <geometry/seg_tree.h>
+#include <geometry/shape_line_chain.h>
+
+typedef VECTOR2I::extended_type ecoord;
+
+// orders edges by the position of their center along one axis
+struct compareEdgeCenter
+{
+    compareEdgeCenter( const std::vector<SEG>& aEdges, bool aAlongX ) :
+        m_edges( aEdges ), m_alongX( aAlongX )
+    {}
+
+    bool operator()( int aA, int aB ) const
+    {
+        const SEG& a = m_edges[aA];
+        const SEG& b = m_edges[aB];
+
+        // twice the center, to stay exact
+        if( m_alongX )
+            return (ecoord) a.A.x + a.B.x < (ecoord) b.A.x + b.B.x;
+        else
+            return (ecoord) a.A.y + a.B.y < (ecoord) b.A.y + b.B.y;
+    }
+
+    const std::vector<SEG>& m_edges;
+    bool m_alongX;
+};
+
+
+// squared distance between a point and a box, 0 if the point is inside
+static ecoord boxSquaredDistance( const VECTOR2I& aMin, const VECTOR2I& aMax, const VECTOR2I& aP )
+{
+    ecoord dx = 0, dy = 0;
+
+    if( aP.x < aMin.x )
+        dx = (ecoord) aMin.x - aP.x;
+    else if( aP.x > aMax.x )
+        dx = (ecoord) aP.x - aMax.x;
+
+    if( aP.y < aMin.y )
+        dy = (ecoord) aMin.y - aP.y;
+    else if( aP.y > aMax.y )
+        dy = (ecoord) aP.y - aMax.y;
+
+    return dx * dx + dy * dy;
+}
+
+
+SEG_TREE::SEG_TREE( const SHAPE_LINE_CHAIN& aChain )
+{
+    int n = aChain.PointCount();
+
+    if( n < 2 )
+        return;
+
+    m_edges.reserve( n );
+    m_order.reserve( n );
+
+    for( int i = 0; i < n; i++ )
+    {
+        m_edges.push_back( SEG( aChain.CPoint( i ), aChain.CPoint( i + 1 ), i ) );
+        m_order.push_back( i );
+    }
+
+    // a balanced tree of n / LEAF_SIZE leaves has less than twice as many nodes
+    m_nodes.reserve( 2 * ( n / LEAF_SIZE + 1 ) );
+
+    build( 0, n );
+}
+
+
+const BOX2I SEG_TREE::BBox() const
+{
+    if( m_nodes.empty() )
+        return BOX2I();
+
+    const NODE& root = m_nodes[0];
+
+    return BOX2I( root.m_min, root.m_max - root.m_min );
+}
+
+
+int SEG_TREE::build( int aFirst, int aCount )
+{
+    int index = m_nodes.size();
+    m_nodes.push_back( NODE() );
+
+    VECTOR2I bmin( INT_MAX, INT_MAX ), bmax( INT_MIN, INT_MIN );
+    ecoord cminX = LLONG_MAX, cmaxX = LLONG_MIN, cminY = LLONG_MAX, cmaxY = LLONG_MIN;
+
+    for( int i = aFirst; i < aFirst + aCount; i++ )
+    {
+        const SEG& edge = m_edges[m_order[i]];
+
+        bmin.x = std::min( bmin.x, std::min( edge.A.x, edge.B.x ) );
+        bmin.y = std::min( bmin.y, std::min( edge.A.y, edge.B.y ) );
+        bmax.x = std::max( bmax.x, std::max( edge.A.x, edge.B.x ) );
+        bmax.y = std::max( bmax.y, std::max( edge.A.y, edge.B.y ) );
+
+        ecoord cx = (ecoord) edge.A.x + edge.B.x;
+        ecoord cy = (ecoord) edge.A.y + edge.B.y;
+
+        cminX = std::min( cminX, cx );
+        cmaxX = std::max( cmaxX, cx );
+        cminY = std::min( cminY, cy );
+        cmaxY = std::max( cmaxY, cy );
+    }
+
+    m_nodes[index].m_min = bmin;
+    m_nodes[index].m_max = bmax;
+
+    if( aCount <= LEAF_SIZE )
+    {
+        m_nodes[index].m_first = aFirst;
+        m_nodes[index].m_count = aCount;
+        return index;
+    }
+
+    // median split along the longest extent of the edge centers
+    int half = aCount / 2;
+    compareEdgeCenter cmp( m_edges, cmaxX - cminX >= cmaxY - cminY );
+
+    std::nth_element( m_order.begin() + aFirst, m_order.begin() + aFirst + half,
+                      m_order.begin() + aFirst + aCount, cmp );
+
+    build( aFirst, half );
+
+    int second = build( aFirst + half, aCount - half );
+
+    // m_nodes may have been reallocated by the recursive calls
+    m_nodes[index].m_first = second;
+    m_nodes[index].m_count = 0;
+
+    return index;
+}
+
+
+int SEG_TREE::Nearest( const VECTOR2I& aP, int aCount, int& aDist ) const
+{
+    int best = -1;
+
+    aDist = INT_MAX;
+
+    if( !m_nodes.empty() )
+        nearest( 0, aP, aCount, best, aDist );
+
+    return best;
+}
+
+
+void SEG_TREE::nearest( int aNode, const VECTOR2I& aP, int aCount, int& aBest, int& aDist ) const
+{
+    const NODE& node = m_nodes[aNode];
+
+    if( node.m_count > 0 )
+    {
+        for( int i = node.m_first; i < node.m_first + node.m_count; i++ )
+        {
+            int e = m_order[i];
+
+            if( e >= aCount )
+                continue;
+
+            int d = m_edges[e].Distance( aP );
+
+            if( d < aDist || ( d == aDist && e < aBest ) )
+            {
+                aDist = d;
+                aBest = e;
+            }
+        }
+
+        return;
+    }
+
+    int children[2] = { aNode + 1, node.m_first };
+    ecoord dist[2];
+
+    for( int i = 0; i < 2; i++ )
+        dist[i] = boxSquaredDistance( m_nodes[children[i]].m_min, m_nodes[children[i]].m_max, aP );
+
+    // visit the closest child first, to shrink aDist early
+    if( dist[1] < dist[0] )
+    {
+        std::swap( children[0], children[1] );
+        std::swap( dist[0], dist[1] );
+    }
+
+    for( int i = 0; i < 2; i++ )
+    {
+        // SEG::Distance() truncates the exact distance, which is never below the distance
+        // to the box: skip the boxes which can't hold an edge at aDist or closer
+        if( aDist != INT_MAX && dist[i] >= (ecoord) ( aDist + 1 ) * ( aDist + 1 ) )
+            continue;
+
+        nearest( children[i], aP, aCount, aBest, aDist );
+    }
+}
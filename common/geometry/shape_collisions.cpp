@@ -31,6 +31,7 @@
 #include <geometry/shape_rect.h>
 #include <geometry/shape_segment.h>
 #include <geometry/shape_convex.h>
+#include <geometry/seg_batch.h>
 
 typedef VECTOR2I::extended_type ecoord;
 
@@ -217,11 +218,32 @@ static inline bool Collide( const SHAPE_CIRCLE& aA, const SHAPE_SEGMENT& aSeg, i
 }
 
 
+// below this number of segment pairs, building a SEG_BATCH costs more than it saves
+static const int MIN_BATCH_PAIRS = 32;
+
 static inline bool Collide( const SHAPE_LINE_CHAIN& aA, const SHAPE_LINE_CHAIN& aB, int aClearance,
                             bool aNeedMTV, VECTOR2I& aMTV )
 {
-    for( int i = 0; i < aB.SegmentCount(); i++ )
-        if( aA.Collide( aB.CSegment( i ), aClearance ) )
+    if( aA.SegmentCount() * aB.SegmentCount() < MIN_BATCH_PAIRS )
+    {
+        for( int i = 0; i < aB.SegmentCount(); i++ )
+            if( aA.Collide( aB.CSegment( i ), aClearance ) )
+                return true;
+
+        return false;
+    }
+
+    // the segment test is symmetric: store the longest chain in the batch
+    const SHAPE_LINE_CHAIN& stored = aA.SegmentCount() >= aB.SegmentCount() ? aA : aB;
+    const SHAPE_LINE_CHAIN& tested = aA.SegmentCount() >= aB.SegmentCount() ? aB : aA;
+
+    static thread_local SEG_BATCH batch;
+
+    batch.Clear();
+    batch.Add( stored );
+
+    for( int i = 0; i < tested.SegmentCount(); i++ )
+        if( batch.Collide( tested.CSegment( i ), aClearance ) >= 0 )
             return true;
 
     return false;
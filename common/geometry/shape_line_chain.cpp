@@ -24,9 +24,174 @@
 
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_circle.h>
+#include <geometry/seg_batch.h>
+#include <geometry/seg_tree.h>
 
 using boost::optional;
 
+// tests the segments of a line chain against aSeg, as SHAPE_LINE_CHAIN::Collide() does
+struct segCollider
+{
+    segCollider( const SEG& aSeg, int aClearance, int aSegmentCount ) :
+        m_seg( aSeg ),
+        m_box( aSeg.A, aSeg.B - aSeg.A ),
+        m_clearance( aClearance ),
+        m_distSq( (BOX2I::ecoord_type) aClearance * aClearance ),
+        m_segmentCount( aSegmentCount ),
+        m_collides( false )
+    {}
+
+    bool operator()( const SEG& aEdge )
+    {
+        if( aEdge.Index() >= m_segmentCount )
+            return true;
+
+        BOX2I box( aEdge.A, aEdge.B - aEdge.A );
+
+        if( m_box.SquaredDistance( box ) < m_distSq && aEdge.Collide( m_seg, m_clearance ) )
+        {
+            m_collides = true;
+            return false;
+        }
+
+        return true;
+    }
+
+    const SEG& m_seg;
+    BOX2I m_box;
+    int m_clearance;
+    BOX2I::ecoord_type m_distSq;
+    int m_segmentCount;
+    bool m_collides;
+};
+
+
+// looks for a segment of a line chain passing by a point, as SHAPE_LINE_CHAIN::PointOnEdge()
+struct pointOnEdgeFinder
+{
+    pointOnEdgeFinder( const VECTOR2I& aP, int aSegmentCount ) :
+        m_p( aP ),
+        m_segmentCount( aSegmentCount ),
+        m_found( false )
+    {}
+
+    bool operator()( const SEG& aEdge )
+    {
+        if( aEdge.Index() >= m_segmentCount )
+            return true;
+
+        if( aEdge.A == m_p || aEdge.B == m_p || aEdge.Distance( m_p ) <= 1 )
+        {
+            m_found = true;
+            return false;
+        }
+
+        return true;
+    }
+
+    const VECTOR2I& m_p;
+    int m_segmentCount;
+    bool m_found;
+};
+
+
+// collects the indices of the segments following a given one in a line chain
+struct segIndexCollector
+{
+    segIndexCollector( int aAfter, int aSegmentCount, std::vector<int>& aIndices ) :
+        m_after( aAfter ),
+        m_segmentCount( aSegmentCount ),
+        m_indices( aIndices )
+    {}
+
+    bool operator()( const SEG& aEdge )
+    {
+        if( aEdge.Index() > m_after && aEdge.Index() < m_segmentCount )
+            m_indices.push_back( aEdge.Index() );
+
+        return true;
+    }
+
+    int m_after;
+    int m_segmentCount;
+    std::vector<int>& m_indices;
+};
+
+
+// even-odd crossing test of a point against the edges of a polygon: the edges may be
+// given in any order, a point on an edge stops the test
+struct edgeCrossingCounter
+{
+    edgeCrossingCounter( const VECTOR2I& aP ) :
+        m_p( aP ),
+        m_inside( false ),
+        m_onEdge( false )
+    {}
+
+    bool operator()( const SEG& aEdge )
+    {
+        const VECTOR2I& ip = aEdge.A;
+        const VECTOR2I& ipNext = aEdge.B;
+
+        if( ipNext.y == m_p.y )
+        {
+            if( ( ipNext.x == m_p.x ) || ( ip.y == m_p.y &&
+                ( ( ipNext.x > m_p.x ) == ( ip.x < m_p.x ) ) ) )
+            {
+                m_onEdge = true;
+                return false;
+            }
+        }
+
+        if( ( ip.y < m_p.y ) != ( ipNext.y < m_p.y ) )
+        {
+            if( ip.x >= m_p.x && ipNext.x > m_p.x )
+            {
+                m_inside = !m_inside;
+            }
+            else if( ip.x >= m_p.x || ipNext.x > m_p.x )
+            {
+                int64_t d = (int64_t)( ip.x - m_p.x ) * (int64_t)( ipNext.y - m_p.y ) -
+                            (int64_t)( ipNext.x - m_p.x ) * (int64_t)( ip.y - m_p.y );
+
+                if( !d )
+                {
+                    m_onEdge = true;
+                    return false;
+                }
+
+                if( ( d > 0 ) == ( ipNext.y > ip.y ) )
+                    m_inside = !m_inside;
+            }
+        }
+
+        return true;
+    }
+
+    const VECTOR2I& m_p;
+    bool m_inside;
+    bool m_onEdge;
+};
+
+
+std::shared_ptr<const SEG_TREE> SHAPE_LINE_CHAIN::SegmentTree() const
+{
+    if( PointCount() < SEG_TREE::MIN_SEGMENTS )
+        return std::shared_ptr<const SEG_TREE>();
+
+    std::shared_ptr<const SEG_TREE> tree = std::atomic_load( &m_segTree );
+
+    if( !tree )
+    {
+        // concurrent readers may build the tree twice, they keep the same result
+        tree = std::make_shared<const SEG_TREE>( *this );
+        std::atomic_store( &m_segTree, tree );
+    }
+
+    return tree;
+}
+
+
 bool SHAPE_LINE_CHAIN::Collide( const VECTOR2I& aP, int aClearance ) const
 {
     // fixme: ugly!
@@ -37,6 +202,22 @@ bool SHAPE_LINE_CHAIN::Collide( const VECTOR2I& aP, int aClearance ) const
 
 bool SHAPE_LINE_CHAIN::Collide( const SEG& aSeg, int aClearance ) const
 {
+    std::shared_ptr<const SEG_TREE> tree = SegmentTree();
+
+    if( tree )
+    {
+        // segments closer than aClearance have bounding boxes closer than that on each axis
+        segCollider collider( aSeg, aClearance, SegmentCount() );
+        VECTOR2I vmin( std::min( aSeg.A.x, aSeg.B.x ) - aClearance,
+                       std::min( aSeg.A.y, aSeg.B.y ) - aClearance );
+        VECTOR2I vmax( std::max( aSeg.A.x, aSeg.B.x ) + aClearance,
+                       std::max( aSeg.A.y, aSeg.B.y ) + aClearance );
+
+        tree->Query( vmin, vmax, collider );
+
+        return collider.m_collides;
+    }
+
     BOX2I box_a( aSeg.A, aSeg.B - aSeg.A );
     BOX2I::ecoord_type dist_sq = (BOX2I::ecoord_type) aClearance * aClearance;
 
@@ -64,6 +245,7 @@ const SHAPE_LINE_CHAIN SHAPE_LINE_CHAIN::Reverse() const
 
     reverse( a.m_points.begin(), a.m_points.end() );
     a.m_closed = m_closed;
+    a.invalidateTree();
 
     return a;
 }
@@ -88,6 +270,8 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const VECTOR2I&
     if( aStartIndex < 0 )
         aStartIndex += PointCount();
 
+    invalidateTree();
+
     if( aStartIndex == aEndIndex )
         m_points[aStartIndex] = aP;
     else
@@ -108,6 +292,7 @@ void SHAPE_LINE_CHAIN::Replace( int aStartIndex, int aEndIndex, const SHAPE_LINE
 
     m_points.erase( m_points.begin() + aStartIndex, m_points.begin() + aEndIndex + 1 );
     m_points.insert( m_points.begin() + aStartIndex, aLine.m_points.begin(), aLine.m_points.end() );
+    invalidateTree();
 }
 
 
@@ -120,6 +305,7 @@ void SHAPE_LINE_CHAIN::Remove( int aStartIndex, int aEndIndex )
         aStartIndex += PointCount();
 
     m_points.erase( m_points.begin() + aStartIndex, m_points.begin() + aEndIndex + 1 );
+    invalidateTree();
 }
 
 
@@ -130,6 +316,14 @@ int SHAPE_LINE_CHAIN::Distance( const VECTOR2I& aP ) const
     if( IsClosed() && PointInside( aP ) )
         return 0;
 
+    std::shared_ptr<const SEG_TREE> tree = SegmentTree();
+
+    if( tree )
+    {
+        tree->Nearest( aP, SegmentCount(), d );
+        return d;
+    }
+
     for( int s = 0; s < SegmentCount(); s++ )
         d = std::min( d, CSegment( s ).Distance( aP ) );
 
@@ -167,6 +361,7 @@ int SHAPE_LINE_CHAIN::Split( const VECTOR2I& aP )
     if( ii >= 0 )
     {
         m_points.insert( m_points.begin() + ii + 1, aP );
+        invalidateTree();
 
         return ii + 1;
     }
@@ -254,6 +449,13 @@ int SHAPE_LINE_CHAIN::Intersect( const SHAPE_LINE_CHAIN& aChain, INTERSECTIONS&
 {
     BOX2I bb_other = aChain.BBox();
 
+    // reused by the next calls, to spare the allocations
+    static thread_local SEG_BATCH other;
+    static thread_local std::vector<int> candidates;
+
+    other.Clear();
+    other.Add( aChain );
+
     for( int s1 = 0; s1 < SegmentCount(); s1++ )
     {
         const SEG& a = CSegment( s1 );
@@ -262,9 +464,14 @@ int SHAPE_LINE_CHAIN::Intersect( const SHAPE_LINE_CHAIN& aChain, INTERSECTIONS&
         if( !bb_other.Intersects( bb_cur ) )
             continue;
 
-        for( int s2 = 0; s2 < aChain.SegmentCount(); s2++ )
+        // the segments which may intersect a or contain one of its ends (SEG::Contains()
+        // accepts points up to a unit away, after rounding)
+        candidates.clear();
+        other.Candidates( a, 2, candidates );
+
+        for( int s2 : candidates )
         {
-            const SEG& b = aChain.CSegment( s2 );
+            const SEG& b = other.Segment( s2 );
             INTERSECTION is;
 
             if( a.Collinear( b ) )
@@ -351,6 +558,17 @@ bool SHAPE_LINE_CHAIN::PointOnEdge( const VECTOR2I& aP ) const
 	else if( PointCount() == 1 )
         return m_points[0] == aP;
 
+    std::shared_ptr<const SEG_TREE> tree = SegmentTree();
+
+    if( tree )
+    {
+        pointOnEdgeFinder finder( aP, SegmentCount() );
+
+        tree->Query( aP - VECTOR2I( 1, 1 ), aP + VECTOR2I( 1, 1 ), finder );
+
+        return finder.m_found;
+    }
+
     for( int i = 0; i < SegmentCount(); i++ )
     {
         const SEG s = CSegment( i );
@@ -366,48 +584,113 @@ bool SHAPE_LINE_CHAIN::PointOnEdge( const VECTOR2I& aP ) const
 }
 
 
+bool SHAPE_LINE_CHAIN::PointInPolygon( const VECTOR2I& aP ) const
+{
+    if( PointCount() < 3 )
+        return false;
+
+    edgeCrossingCounter counter( aP );
+    std::shared_ptr<const SEG_TREE> tree = SegmentTree();
+
+    if( tree )
+    {
+        const BOX2I bbox = tree->BBox();
+
+        if( !bbox.Contains( aP ) )
+            return false;
+
+        // only the edges reaching the horizontal half-line from aP to the right count
+        tree->Query( aP, VECTOR2I( bbox.GetRight(), aP.y ), counter );
+    }
+    else
+    {
+        if( !BBox().Contains( aP ) )
+            return false;
+
+        for( int i = 0; i < PointCount(); i++ )
+        {
+            if( !counter( SEG( CPoint( i ), CPoint( i + 1 ) ) ) )
+                break;
+        }
+    }
+
+    return counter.m_onEdge || counter.m_inside;
+}
+
+
+bool SHAPE_LINE_CHAIN::selfIntersection( int aS1, int aS2, INTERSECTION& aIs ) const
+{
+    const VECTOR2I s2a = CSegment( aS2 ).A, s2b = CSegment( aS2 ).B;
+
+    if( aS1 + 1 != aS2 && CSegment( aS1 ).Contains( s2a ) )
+    {
+        aIs.p = s2a;
+    }
+    else if( CSegment( aS1 ).Contains( s2b ) &&
+             // for closed polylines, the ending point of the
+             // last segment == starting point of the first segment
+             // this is a normal case, not self intersecting case
+             !( IsClosed() && aS1 == 0 && aS2 == SegmentCount()-1 ) )
+    {
+        aIs.p = s2b;
+    }
+    else
+    {
+        OPT_VECTOR2I p = CSegment( aS1 ).Intersect( CSegment( aS2 ), true );
+
+        if( !p )
+            return false;
+
+        aIs.p = *p;
+    }
+
+    aIs.our = CSegment( aS1 );
+    aIs.their = CSegment( aS2 );
+
+    return true;
+}
+
+
 const optional<SHAPE_LINE_CHAIN::INTERSECTION> SHAPE_LINE_CHAIN::SelfIntersecting() const
 {
-    for( int s1 = 0; s1 < SegmentCount(); s1++ )
+    INTERSECTION is;
+    std::shared_ptr<const SEG_TREE> tree = SegmentTree();
+
+    if( tree )
     {
-        for( int s2 = s1 + 1; s2 < SegmentCount(); s2++ )
+        std::vector<int> candidates;
+
+        for( int s1 = 0; s1 < SegmentCount(); s1++ )
         {
-            const VECTOR2I s2a = CSegment( s2 ).A, s2b = CSegment( s2 ).B;
+            // intersecting or touching segments have overlapping bounding boxes
+            const SEG s = CSegment( s1 );
+            VECTOR2I vmin( std::min( s.A.x, s.B.x ) - 1, std::min( s.A.y, s.B.y ) - 1 );
+            VECTOR2I vmax( std::max( s.A.x, s.B.x ) + 1, std::max( s.A.y, s.B.y ) + 1 );
+            segIndexCollector collector( s1, SegmentCount(), candidates );
 
-            if( s1 + 1 != s2 && CSegment( s1 ).Contains( s2a ) )
-            {
-                INTERSECTION is;
-                is.our = CSegment( s1 );
-                is.their = CSegment( s2 );
-                is.p = s2a;
-                return is;
-            }
-            else if( CSegment( s1 ).Contains( s2b ) &&
-                     // for closed polylines, the ending point of the
-                     // last segment == starting point of the first segment
-                     // this is a normal case, not self intersecting case
-                     !( IsClosed() && s1 == 0 && s2 == SegmentCount()-1 ) )
-            {
-                INTERSECTION is;
-                is.our = CSegment( s1 );
-                is.their = CSegment( s2 );
-                is.p = s2b;
-                return is;
-            }
-            else
-            {
-                OPT_VECTOR2I p = CSegment( s1 ).Intersect( CSegment( s2 ), true );
+            candidates.clear();
+            tree->Query( vmin, vmax, collector );
 
-                if( p )
-                {
-                    INTERSECTION is;
-                    is.our = CSegment( s1 );
-                    is.their = CSegment( s2 );
-                    is.p = *p;
+            // report the same intersection as the scan below
+            std::sort( candidates.begin(), candidates.end() );
+
+            for( int s2 : candidates )
+            {
+                if( selfIntersection( s1, s2, is ) )
                     return is;
-                }
             }
         }
+
+        return optional<INTERSECTION>();
+    }
+
+    for( int s1 = 0; s1 < SegmentCount(); s1++ )
+    {
+        for( int s2 = s1 + 1; s2 < SegmentCount(); s2++ )
+        {
+            if( selfIntersection( s1, s2, is ) )
+                return is;
+        }
     }
 
     return optional<INTERSECTION>();
@@ -425,7 +708,10 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
     else if( PointCount() == 2 )
     {
         if( m_points[0] == m_points[1] )
+        {
             m_points.pop_back();
+            invalidateTree();
+        }
 
         return *this;
     }
@@ -446,6 +732,7 @@ SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
     }
 
     m_points.clear();
+    invalidateTree();
     np = pts_unique.size();
 
     i = 0;
@@ -487,6 +774,10 @@ const VECTOR2I SHAPE_LINE_CHAIN::NearestPoint( const VECTOR2I& aP ) const
 {
     int min_d = INT_MAX;
     int nearest = 0;
+    std::shared_ptr<const SEG_TREE> tree = SegmentTree();
+
+    if( tree )
+        return CSegment( tree->Nearest( aP, SegmentCount(), min_d ) ).NearestPoint( aP );
 
     for( int i = 0; i < SegmentCount(); i++ )
     {
@@ -569,6 +860,7 @@ bool SHAPE_LINE_CHAIN::Parse( std::stringstream& aStream )
     int n_pts;
 
     m_points.clear();
+    invalidateTree();
     aStream >> n_pts;
     aStream >> m_closed;
 
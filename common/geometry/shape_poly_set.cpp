@@ -31,6 +31,11 @@
 #include <set>
 #include <list>
 #include <algorithm>
+#include <atomic>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
 
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
@@ -38,6 +43,9 @@
 
 using namespace ClipperLib;
 
+// number of strips of the tiled booleans, 0 = automatic
+static std::atomic<int> s_tileCount( 0 );
+
 SHAPE_POLY_SET::SHAPE_POLY_SET() :
     SHAPE( SH_POLY_SET )
 {
@@ -207,12 +215,26 @@ const SHAPE_LINE_CHAIN SHAPE_POLY_SET::convertFromClipper( const Path& aPath )
 void SHAPE_POLY_SET::booleanOp( ClipType aType, const SHAPE_POLY_SET& aOtherShape,
                                 POLYGON_MODE aFastMode )
 {
+    booleanOp( aType, *this, aOtherShape, aFastMode );
+}
+
+
+void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType,
+                                const SHAPE_POLY_SET& aShape,
+                                const SHAPE_POLY_SET& aOtherShape,
+                                POLYGON_MODE aFastMode )
+{
+    int tiles = tileCount( aShape, aOtherShape );
+
+    if( tiles > 1 && booleanOpTiled( aType, aShape, aOtherShape, aFastMode, tiles ) )
+        return;
+
     Clipper c;
 
     if( aFastMode == PM_STRICTLY_SIMPLE )
         c.StrictlySimple( true );
 
-    for( const POLYGON& poly : m_polys )
+    for( const POLYGON& poly : aShape.m_polys )
     {
         for( unsigned int i = 0; i < poly.size(); i++ )
             c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ), ptSubject, true );
@@ -232,33 +254,401 @@ void SHAPE_POLY_SET::booleanOp( ClipType aType, const SHAPE_POLY_SET& aOtherShap
 }
 
 
-void SHAPE_POLY_SET::booleanOp( ClipperLib::ClipType aType,
-                                const SHAPE_POLY_SET& aShape,
-                                const SHAPE_POLY_SET& aOtherShape,
-                                POLYGON_MODE aFastMode )
+void SHAPE_POLY_SET::SetTileCount( int aTiles )
 {
-    Clipper c;
+    s_tileCount = std::max( aTiles, 0 );
+}
 
-    if( aFastMode == PM_STRICTLY_SIMPLE )
-        c.StrictlySimple( true );
 
-    for( const POLYGON& poly : aShape.m_polys )
+int SHAPE_POLY_SET::tileCount( const SHAPE_POLY_SET& aShape, const SHAPE_POLY_SET& aOtherShape )
+{
+    int tiles = s_tileCount;
+
+    if( tiles > 0 )
+        return tiles;
+
+#ifdef USE_OPENMP
+    // nested parallel regions are serialized: the strips would be computed one by one
+    if( omp_in_parallel() )
+        return 1;
+
+    if( aShape.TotalVertices() + aOtherShape.TotalVertices() < TILING_MIN_VERTICES )
+        return 1;
+
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+
+// Extent and size of a polygon, used to split the operands in strips
+struct POLY_EXTENT
+{
+    int m_xMin;
+    int m_xMax;
+    int m_yMin;
+    int m_yMax;
+    int m_vertices;
+};
+
+
+static POLY_EXTENT polygonExtent( const SHAPE_POLY_SET::POLYGON& aPoly )
+{
+    POLY_EXTENT ext;
+
+    ext.m_xMin = ext.m_yMin = std::numeric_limits<int>::max();
+    ext.m_xMax = ext.m_yMax = std::numeric_limits<int>::min();
+    ext.m_vertices = 0;
+
+    for( const SHAPE_LINE_CHAIN& path : aPoly )
     {
-        for( unsigned int i = 0; i < poly.size(); i++ )
-            c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ), ptSubject, true );
+        for( int i = 0; i < path.PointCount(); i++ )
+        {
+            const VECTOR2I& p = path.CPoint( i );
+
+            ext.m_xMin = std::min( ext.m_xMin, p.x );
+            ext.m_xMax = std::max( ext.m_xMax, p.x );
+            ext.m_yMin = std::min( ext.m_yMin, p.y );
+            ext.m_yMax = std::max( ext.m_yMax, p.y );
+        }
+
+        ext.m_vertices += path.PointCount();
     }
 
-    for( const POLYGON& poly : aOtherShape.m_polys )
+    return ext;
+}
+
+
+struct compareExtentCenter
+{
+    bool operator()( const POLY_EXTENT& aA, const POLY_EXTENT& aB ) const
     {
-        for( unsigned int i = 0; i < poly.size(); i++ )
-            c.AddPath( convertToClipper( poly[i], i > 0 ? false : true ), ptClip, true );
+        return (int64_t) aA.m_xMin + aA.m_xMax < (int64_t) aB.m_xMin + aB.m_xMax;
+    }
+};
+
+
+/**
+ * Chooses the abscissas of the borders between aTiles strips, so that the centers of the
+ * polygons hold about the same number of vertices in each strip.
+ * @return the borders, in increasing order (possibly fewer than aTiles - 1).
+ */
+static std::vector<int> stripBorders( std::vector<POLY_EXTENT> aExtents, int aTiles )
+{
+    std::vector<int> borders;
+    int64_t total = 0, sum = 0;
+    int xMin = std::numeric_limits<int>::max();
+    int xMax = std::numeric_limits<int>::min();
+
+    for( const POLY_EXTENT& ext : aExtents )
+    {
+        total += ext.m_vertices;
+        xMin = std::min( xMin, ext.m_xMin );
+        xMax = std::max( xMax, ext.m_xMax );
+    }
+
+    std::sort( aExtents.begin(), aExtents.end(), compareExtentCenter() );
+
+    for( const POLY_EXTENT& ext : aExtents )
+    {
+        sum += ext.m_vertices;
+
+        if( (int) borders.size() == aTiles - 1 )
+            break;
+
+        if( sum * aTiles < total * ( (int64_t) borders.size() + 1 ) )
+            continue;
+
+        int x = ( (int64_t) ext.m_xMin + ext.m_xMax ) / 2;
+
+        if( x > xMin && x < xMax && ( borders.empty() || x > borders.back() ) )
+            borders.push_back( x );
+    }
+
+    return borders;
+}
+
+
+/**
+ * Adds the polygons of an operand overlapping the strip [aLeft, aRight] to a clipper.
+ * aLeft and aRight are ignored for the first and the last strip. The polygons crossing the
+ * sides of the strip are cut by it first: the boolean operations only depend on the area
+ * filled by each operand, which is kept in the strip. Unlike the cut paths of a clipping
+ * of each path, the cut polygons have no coincident edges along the sides, which Clipper
+ * could merge in degenerate outputs (like holes joined to their outlines by their edges).
+ */
+static void addStripPaths( Clipper& aClipper, PolyType aType,
+                           const std::vector<ClipperLib::Paths>& aPolys,
+                           const std::vector<POLY_EXTENT>& aExtents,
+                           int aLeft, bool aClipLeft, int aRight, bool aClipRight )
+{
+    Clipper cutter;
+    bool cut = false;
+    int xMin = std::numeric_limits<int>::max(), yMin = std::numeric_limits<int>::max();
+    int xMax = std::numeric_limits<int>::min(), yMax = std::numeric_limits<int>::min();
+
+    for( unsigned int i = 0; i < aPolys.size(); i++ )
+    {
+        const POLY_EXTENT& ext = aExtents[i];
+
+        if( ( aClipLeft && ext.m_xMax < aLeft ) || ( aClipRight && ext.m_xMin > aRight ) )
+            continue;
+
+        if( ( aClipLeft && ext.m_xMin < aLeft ) || ( aClipRight && ext.m_xMax > aRight ) )
+        {
+            cutter.AddPaths( aPolys[i], ptSubject, true );
+            cut = true;
+
+            xMin = std::min( xMin, ext.m_xMin );
+            xMax = std::max( xMax, ext.m_xMax );
+            yMin = std::min( yMin, ext.m_yMin );
+            yMax = std::max( yMax, ext.m_yMax );
+        }
+        else
+        {
+            aClipper.AddPaths( aPolys[i], aType, true );
+        }
+    }
+
+    if( !cut )
+        return;
+
+    Path strip;
+    Paths pieces;
+
+    if( aClipLeft )
+        xMin = aLeft;
+
+    if( aClipRight )
+        xMax = aRight;
+
+    strip.push_back( IntPoint( xMin, yMin ) );
+    strip.push_back( IntPoint( xMax, yMin ) );
+    strip.push_back( IntPoint( xMax, yMax ) );
+    strip.push_back( IntPoint( xMin, yMax ) );
+
+    cutter.AddPath( strip, ptClip, true );
+    cutter.Execute( ctIntersection, pieces, pftNonZero, pftNonZero );
+
+    aClipper.AddPaths( pieces, aType, true );
+}
+
+
+// Tells if a path comes within aMargin of one of the (sorted) borders
+static bool nearBorder( const SHAPE_LINE_CHAIN& aPath, const std::vector<int>& aBorders,
+                        int aMargin )
+{
+    BOX2I box = aPath.BBox();
+    std::vector<int>::const_iterator it = std::lower_bound( aBorders.begin(), aBorders.end(),
+                                                            box.GetX() - aMargin );
+
+    return it != aBorders.end() && *it <= box.GetRight() + aMargin;
+}
+
+
+static bool onContour( const SHAPE_LINE_CHAIN& aPath, const VECTOR2I& aP )
+{
+    // polygon contours are closed, even if the line chains are not marked so
+    return aPath.PointOnEdge( aP ) ||
+           SEG( aPath.CPoint( -1 ), aPath.CPoint( 0 ) ).Distance( aP ) <= 1;
+}
+
+
+/**
+ * Finds the polygon of aPolys which filled area holds the hole aHole. The filled areas of
+ * the polygons are disjoint, the hole is tested by its first vertex lying on no contour.
+ * @return the index of the polygon, -1 if there is none.
+ */
+static int holeOwner( const std::vector<SHAPE_POLY_SET::POLYGON>& aPolys,
+                      const std::vector<BOX2I>& aBoxes, const SHAPE_LINE_CHAIN& aHole )
+{
+    for( int k = 0; k < aHole.PointCount(); k++ )
+    {
+        const VECTOR2I& p = aHole.CPoint( k );
+        bool ambiguous = false;
+
+        for( unsigned int i = 0; i < aPolys.size() && !ambiguous; i++ )
+        {
+            const SHAPE_POLY_SET::POLYGON& poly = aPolys[i];
+
+            if( !aBoxes[i].Contains( p ) )
+                continue;
+
+            if( onContour( poly[0], p ) )
+            {
+                ambiguous = true;
+                break;
+            }
+
+            if( !poly[0].PointInPolygon( p ) )
+                continue;
+
+            bool inHole = false;
+
+            for( unsigned int j = 1; j < poly.size() && !ambiguous && !inHole; j++ )
+            {
+                if( onContour( poly[j], p ) )
+                    ambiguous = true;
+                else if( poly[j].PointInPolygon( p ) )
+                    inHole = true;
+            }
+
+            if( !ambiguous && !inHole )
+                return i;
+        }
+
+        if( !ambiguous )
+            return -1;
+    }
+
+    return -1;
+}
+
+
+bool SHAPE_POLY_SET::booleanOpTiled( ClipType aType, const SHAPE_POLY_SET& aShape,
+                                     const SHAPE_POLY_SET& aOtherShape,
+                                     POLYGON_MODE aFastMode, int aTiles )
+{
+    // the operands, converted once, with their extents
+    std::vector<Paths> subjects, clips;
+    std::vector<POLY_EXTENT> subjectExtents, clipExtents;
+
+    for( int pass = 0; pass < 2; pass++ )
+    {
+        const SHAPE_POLY_SET& set = pass ? aOtherShape : aShape;
+        std::vector<Paths>& paths = pass ? clips : subjects;
+        std::vector<POLY_EXTENT>& extents = pass ? clipExtents : subjectExtents;
+
+        for( const POLYGON& poly : set.m_polys )
+        {
+            if( poly.empty() )
+                continue;
+
+            Paths polyPaths;
+
+            for( unsigned int i = 0; i < poly.size(); i++ )
+                polyPaths.push_back( convertToClipper( poly[i], i > 0 ? false : true ) );
+
+            POLY_EXTENT ext = polygonExtent( poly );
+
+            if( ext.m_vertices == 0 )
+                continue;
+
+            paths.push_back( polyPaths );
+            extents.push_back( ext );
+        }
+    }
+
+    std::vector<POLY_EXTENT> allExtents( subjectExtents );
+    allExtents.insert( allExtents.end(), clipExtents.begin(), clipExtents.end() );
+
+    std::vector<int> borders = stripBorders( allExtents, aTiles );
+    int strips = borders.size() + 1;
+
+    if( strips < 2 )
+        return false;
+
+    std::vector<SHAPE_POLY_SET> stripResults( strips );
+
+#ifdef USE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for( int i = 0; i < strips; i++ )
+    {
+        Clipper c;
+
+        if( aFastMode == PM_STRICTLY_SIMPLE )
+            c.StrictlySimple( true );
+
+        int left = i > 0 ? borders[i - 1] - TILING_OVERLAP : 0;
+        int right = i < strips - 1 ? borders[i] + TILING_OVERLAP : 0;
+
+        addStripPaths( c, ptSubject, subjects, subjectExtents, left, i > 0, right, i < strips - 1 );
+        addStripPaths( c, ptClip, clips, clipExtents, left, i > 0, right, i < strips - 1 );
+
+        PolyTree solution;
+
+        c.Execute( aType, solution, pftNonZero, pftNonZero );
+
+        stripResults[i].importTree( &solution );
+    }
+
+    // The strips overlap along the borders, where both neighbours compute the same polygons
+    // (up to the rounding of the points where the edges were clipped). The polygons away
+    // from the overlaps are final. The others are merged, without their holes away from the
+    // overlaps, which are put back in the merged polygons afterwards: the merge is then
+    // a small job, even when the strips hold thousands of holes. Merging overlapping
+    // pieces rather than pieces meeting exactly on the borders matters: Clipper doesn't
+    // always join the common edges of touching polygons, nor of touching holes.
+    std::vector<POLYGON> result;
+    std::vector<SHAPE_LINE_CHAIN> innerHoles;
+    Clipper stitcher;
+
+    for( int i = 0; i < strips; i++ )
+    {
+        for( POLYGON& poly : stripResults[i].m_polys )
+        {
+            // a hole can't reach an overlap without its outline
+            if( !nearBorder( poly[0], borders, TILING_OVERLAP ) )
+            {
+                result.push_back( poly );
+                continue;
+            }
+
+            stitcher.AddPath( convertToClipper( poly[0], true ), ptSubject, true );
+
+            for( unsigned int j = 1; j < poly.size(); j++ )
+            {
+                if( nearBorder( poly[j], borders, TILING_OVERLAP ) )
+                    stitcher.AddPath( convertToClipper( poly[j], false ), ptSubject, true );
+                else
+                    innerHoles.push_back( poly[j] );
+            }
+        }
     }
 
     PolyTree solution;
+    SHAPE_POLY_SET stitched;
 
-    c.Execute( aType, solution, pftNonZero, pftNonZero );
+    stitcher.Execute( ctUnion, solution, pftNonZero, pftNonZero );
 
-    importTree( &solution );
+    // A strictly simple merge of the pieces is very slow, as they share many edges in the
+    // overlaps (Clipper joins the common edges one at a time): merge them first, then make
+    // the merged polygons strictly simple.
+    if( aFastMode == PM_STRICTLY_SIMPLE )
+    {
+        Paths merged;
+        Clipper simplifier;
+
+        PolyTreeToPaths( solution, merged );
+        simplifier.StrictlySimple( true );
+        simplifier.AddPaths( merged, ptSubject, true );
+        simplifier.Execute( ctUnion, solution, pftNonZero, pftNonZero );
+    }
+
+    stitched.importTree( &solution );
+
+    std::vector<BOX2I> boxes;
+
+    for( const POLYGON& poly : stitched.m_polys )
+        boxes.push_back( poly[0].BBox() );
+
+    for( const SHAPE_LINE_CHAIN& hole : innerHoles )
+    {
+        int owner = holeOwner( stitched.m_polys, boxes, hole );
+
+        // shouldn't happen: let the caller run the whole operation at once
+        if( owner < 0 )
+            return false;
+
+        stitched.m_polys[owner].push_back( hole );
+    }
+
+    result.insert( result.end(), stitched.m_polys.begin(), stitched.m_polys.end() );
+    m_polys.swap( result );
+
+    return true;
 }
 
 
@@ -298,13 +688,54 @@ void SHAPE_POLY_SET::BooleanIntersection( const SHAPE_POLY_SET& a, const SHAPE_P
 }
 
 
+// The coefficients 1.0 - cos( M_PI/n ) used by Inflate(), for n = 1 .. N
+template <int N>
+struct ARC_TOLERANCE_TABLE
+{
+    ARC_TOLERANCE_TABLE()
+    {
+        m_factor[0] = 0.0;
+
+        for( int n = 1; n <= N; n++ )
+            m_factor[n] = 1.0 - cos( M_PI/n );
+    }
+
+    double m_factor[N+1];
+};
+
+
 void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
 {
     // A static table to avoid repetitive calculations of the coefficient
     // 1.0 - cos( M_PI/aCircleSegmentsCount)
     // aCircleSegmentsCount is most of time <= 64 and usually 8, 12, 16, 32
+    // The table is built when first used (the initialization of a local static
+    // is thread safe), because zones are filled by several threads
     #define SEG_CNT_MAX 64
-    static double arc_tolerance_factor[SEG_CNT_MAX+1];
+    static const ARC_TOLERANCE_TABLE<SEG_CNT_MAX> arc_tolerance_factor;
+
+    // Calculate the arc tolerance (arc error) from the seg count by circle.
+    // the seg count is nn = M_PI / acos(1.0 - c.ArcTolerance / abs(aFactor))
+    // see:
+    // www.angusj.com/delphi/clipper/documentation/Docs/Units/ClipperLib/Classes/ClipperOffset/Properties/ArcTolerance.htm
+
+    if( aCircleSegmentsCount < 6 )  // avoid incorrect aCircleSegmentsCount values
+        aCircleSegmentsCount = 6;
+
+    double coeff;
+
+    if( aCircleSegmentsCount > SEG_CNT_MAX )
+        coeff = 1.0 - cos( M_PI/aCircleSegmentsCount);
+    else
+        coeff = arc_tolerance_factor.m_factor[aCircleSegmentsCount];
+
+    double arcTolerance = std::abs( aFactor ) * coeff;
+
+    // a deflated set is not the union of its deflated parts: only inflations are tiled
+    int tiles = aFactor > 0 ? tileCount( *this, SHAPE_POLY_SET() ) : 1;
+
+    if( tiles > 1 && inflateTiled( aFactor, arcTolerance, tiles ) )
+        return;
 
     ClipperOffset c;
 
@@ -316,31 +747,67 @@ void SHAPE_POLY_SET::Inflate( int aFactor, int aCircleSegmentsCount )
 
     PolyTree solution;
 
-    // Calculate the arc tolerance (arc error) from the seg count by circle.
-    // the seg count is nn = M_PI / acos(1.0 - c.ArcTolerance / abs(aFactor))
-    // see:
-    // www.angusj.com/delphi/clipper/documentation/Docs/Units/ClipperLib/Classes/ClipperOffset/Properties/ArcTolerance.htm
+    c.ArcTolerance = arcTolerance;
+    c.Execute( solution, aFactor );
 
-    if( aCircleSegmentsCount < 6 )  // avoid incorrect aCircleSegmentsCount values
-        aCircleSegmentsCount = 6;
+    importTree( &solution );
+}
 
-    double coeff;
 
-    if( aCircleSegmentsCount > SEG_CNT_MAX || arc_tolerance_factor[aCircleSegmentsCount] == 0 )
+bool SHAPE_POLY_SET::inflateTiled( int aFactor, double aArcTolerance, int aTiles )
+{
+    std::vector<POLY_EXTENT> extents;
+
+    for( const POLYGON& poly : m_polys )
+        extents.push_back( polygonExtent( poly ) );
+
+    // each polygon goes to the group of the strip holding its center
+    std::vector<int> borders = stripBorders( extents, aTiles );
+
+    if( borders.empty() )
+        return false;
+
+    std::vector<SHAPE_POLY_SET> groups( borders.size() + 1 );
+
+    for( unsigned int i = 0; i < m_polys.size(); i++ )
     {
-        coeff = 1.0 - cos( M_PI/aCircleSegmentsCount);
+        int center = ( (int64_t) extents[i].m_xMin + extents[i].m_xMax ) / 2;
+        int group = std::upper_bound( borders.begin(), borders.end(), center ) - borders.begin();
 
-        if( aCircleSegmentsCount <= SEG_CNT_MAX )
-            arc_tolerance_factor[aCircleSegmentsCount] = coeff;
+        groups[group].m_polys.push_back( m_polys[i] );
     }
-    else
-        coeff = arc_tolerance_factor[aCircleSegmentsCount];
 
-    c.ArcTolerance = std::abs( aFactor ) * coeff;
+#ifdef USE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for( int i = 0; i < (int) groups.size(); i++ )
+    {
+        ClipperOffset c;
 
-    c.Execute( solution, aFactor );
+        for( const POLYGON& poly : groups[i].m_polys )
+        {
+            for( unsigned int j = 0; j < poly.size(); j++ )
+                c.AddPath( convertToClipper( poly[j], j > 0 ? false : true ), jtRound,
+                           etClosedPolygon );
+        }
 
-    importTree( &solution );
+        PolyTree solution;
+
+        c.ArcTolerance = aArcTolerance;
+        c.Execute( solution, aFactor );
+
+        groups[i].importTree( &solution );
+    }
+
+    // the inflated groups overlap near the borders of the strips: merge them
+    m_polys.clear();
+
+    for( const SHAPE_POLY_SET& group : groups )
+        m_polys.insert( m_polys.end(), group.m_polys.begin(), group.m_polys.end() );
+
+    booleanOp( ctUnion, SHAPE_POLY_SET(), PM_FAST );
+
+    return true;
 }
 
 
@@ -578,9 +1045,13 @@ void SHAPE_POLY_SET::Fracture( POLYGON_MODE aFastMode )
 {
     Simplify( aFastMode ); // remove overlapping holes/degeneracy
 
-    for( POLYGON& paths : m_polys )
+    // polygons are fractured independently
+#ifdef USE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 1) if( tileCount( *this, SHAPE_POLY_SET() ) > 1 )
+#endif
+    for( int i = 0; i < (int) m_polys.size(); i++ )
     {
-        fractureSingle( paths );
+        fractureSingle( m_polys[i] );
     }
 }
 
@@ -738,66 +1209,8 @@ bool SHAPE_POLY_SET::Contains( const VECTOR2I& aP, int aSubpolyIndex ) const
 
 bool SHAPE_POLY_SET::pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN& aPath ) const
 {
-    int result = 0;
-    int cnt = aPath.PointCount();
-
-    if ( !aPath.BBox().Contains( aP ) ) // test with bounding box first
-        return false;
-
-    if( cnt < 3 )
-        return false;
-
-    VECTOR2I ip = aPath.CPoint( 0 );
-
-    for( int i = 1; i <= cnt; ++i )
-    {
-        VECTOR2I ipNext = ( i == cnt ? aPath.CPoint( 0 ) : aPath.CPoint( i ) );
-
-        if( ipNext.y == aP.y )
-        {
-            if( ( ipNext.x == aP.x ) || ( ip.y == aP.y &&
-                ( ( ipNext.x > aP.x ) == ( ip.x < aP.x ) ) ) )
-                return true;
-        }
-
-        if( ( ip.y < aP.y ) != ( ipNext.y < aP.y ) )
-        {
-            if( ip.x >= aP.x )
-            {
-                if( ipNext.x > aP.x )
-                    result = 1 - result;
-                else
-                {
-                    int64_t d = (int64_t)( ip.x - aP.x ) * (int64_t)( ipNext.y - aP.y ) -
-                                (int64_t)( ipNext.x - aP.x ) * (int64_t)( ip.y - aP.y );
-
-                    if( !d )
-                        return true;
-
-                    if( ( d > 0 ) == ( ipNext.y > ip.y ) )
-                        result = 1 - result;
-                }
-            }
-            else
-            {
-                if( ipNext.x > aP.x )
-                {
-                    int64_t d = (int64_t)( ip.x - aP.x ) * (int64_t)( ipNext.y - aP.y ) -
-                                (int64_t)( ipNext.x - aP.x ) * (int64_t)( ip.y - aP.y );
-
-                if( !d )
-                    return true;
-
-                if( ( d > 0 ) == ( ipNext.y > ip.y ) )
-                    result = 1 - result;
-                }
-            }
-        }
-
-        ip = ipNext;
-    }
-
-    return result ? true : false;
+    // large outlines (zones) are tested through their segment tree
+    return aPath.PointInPolygon( aP );
 }
 
 
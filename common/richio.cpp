@@ -25,10 +25,19 @@
 
 
 #include <cstdarg>
-#include <config.h> // HAVE_FGETC_NOLOCK
+#include <config.h> // HAVE_FGETC_NOLOCK, HAVE_MMAP
 
 #include <richio.h>
 
+#if defined( HAVE_MMAP )
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/// Files smaller than this are read into memory rather than mapped: reading them costs
+/// little, and a copy can't fault if the file is truncated while it is parsed.
+static const off_t MMAP_MIN_SIZE = 1024 * 1024;
+#endif
+
 
 // Fall back to getc() when getc_unlocked() is not available on the target platform.
 #if !defined( HAVE_FGETC_NOLOCK )
@@ -273,6 +282,176 @@ char* FILE_LINE_READER::ReadLine() throw( IO_ERROR )
 }
 
 
+long FILE_LINE_READER::RemainingLength() const
+{
+    long pos = ftell( fp );
+
+    if( pos < 0 || fseek( fp, 0, SEEK_END ) != 0 )
+        return -1;
+
+    long end = ftell( fp );
+
+    fseek( fp, pos, SEEK_SET );
+
+    return end < pos ? -1 : end - pos;
+}
+
+
+MEMORY_LINE_READER::MEMORY_LINE_READER( const char* aBuffer, size_t aLength,
+            const wxString& aSource, unsigned aStartingLineNumber,
+            unsigned aMaxLineLength ) :
+    LINE_READER( aMaxLineLength ),
+    buf( aBuffer ),
+    bufLen( aLength ),
+    ndx( 0 )
+{
+    source  = aSource;
+    lineNum = aStartingLineNumber;
+}
+
+
+const char* MEMORY_LINE_READER::ReadLineView() throw( IO_ERROR )
+{
+    size_t len = 0;
+
+    if( ndx < bufLen )
+    {
+        const char* nl = (const char*) memchr( buf + ndx, '\n', bufLen - ndx );
+
+        if( nl )
+            len = nl - ( buf + ndx ) + 1;     // include the newline, so +1
+        else
+            len = bufLen - ndx;
+    }
+
+    if( len > maxLineLength )
+        THROW_IO_ERROR( _( "Maximum line length exceeded" ) );
+
+    const char* ret = buf + ndx;
+
+    length = len;
+    ndx += len;
+
+    // lineNum is incremented even if there was no line read, because this
+    // leads to better error reporting when we hit an end of file.
+    ++lineNum;
+
+    return length ? ret : NULL;
+}
+
+
+char* MEMORY_LINE_READER::ReadLine() throw( IO_ERROR )
+{
+    const char* view = ReadLineView();
+
+    if( length+1 > capacity )   // +1 for terminating nul
+    {
+        unsigned len = length;
+
+        // expandCapacity() keeps the current line, which is not the one read
+        length = 0;
+        expandCapacity( len+1 );
+        length = len;
+    }
+
+    if( length )
+        memcpy( line, view, length );
+
+    line[length] = 0;
+
+    return length ? line : NULL;
+}
+
+
+MMAP_LINE_READER::MMAP_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber,
+            unsigned aMaxLineLength ) throw( IO_ERROR ) :
+    MEMORY_LINE_READER( NULL, 0, aFileName, aStartingLineNumber, aMaxLineLength ),
+    mapped( false )
+{
+    FILE* fp = wxFopen( aFileName, wxT( "rb" ) );
+
+    if( !fp )
+    {
+        wxString msg = wxString::Format(
+            _( "Unable to open filename '%s' for reading" ), aFileName.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+
+    bool ok = true;
+
+#if defined( HAVE_MMAP )
+    struct stat st;
+
+    if( fstat( fileno( fp ), &st ) == 0 )
+    {
+        bufLen = st.st_size;
+
+        // small files, including empty ones which cannot be mapped, are read below
+        if( st.st_size >= MMAP_MIN_SIZE )
+        {
+            void* data = mmap( NULL, bufLen, PROT_READ, MAP_PRIVATE, fileno( fp ), 0 );
+
+            if( data != MAP_FAILED )
+            {
+                // the file is parsed from start to end
+                madvise( data, bufLen, MADV_SEQUENTIAL );
+
+                buf    = (const char*) data;
+                mapped = true;
+            }
+        }
+    }
+    else
+        ok = false;
+#endif
+
+    // no mmap(), a small file, or mmap() failed on this file: read the file at once instead
+    if( ok && !mapped )
+    {
+        ok = fseek( fp, 0, SEEK_END ) == 0;
+
+        long size = ok ? ftell( fp ) : -1;
+
+        if( size > 0 && fseek( fp, 0, SEEK_SET ) == 0 )
+        {
+            char* data = new char[size];
+
+            bufLen = fread( data, 1, size, fp );
+            buf    = data;
+        }
+        else
+        {
+            ok = size == 0;
+            bufLen = 0;
+        }
+    }
+
+    fclose( fp );
+
+    if( !ok )
+    {
+        wxString msg = wxString::Format(
+            _( "Unable to read file '%s'" ), aFileName.GetData() );
+        THROW_IO_ERROR( msg );
+    }
+}
+
+
+MMAP_LINE_READER::~MMAP_LINE_READER()
+{
+#if defined( HAVE_MMAP )
+    if( mapped )
+    {
+        munmap( (void*) buf, bufLen );
+        return;
+    }
+#endif
+
+    delete[] buf;
+}
+
+
 STRING_LINE_READER::STRING_LINE_READER( const std::string& aString, const wxString& aSource ) :
     LINE_READER( LINE_READER_LINE_DEFAULT_MAX ),
     lines( aString ),
@@ -36,6 +36,10 @@
 #include <profile.h>
 #endif /* PROFILE  */
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
 using namespace KIGFX;
 
 VIEW::VIEW( bool aIsDynamic ) :
@@ -44,7 +48,8 @@ VIEW::VIEW( bool aIsDynamic ) :
     m_minScale( 4.0 ), m_maxScale( 15000 ),
     m_painter( NULL ),
     m_gal( NULL ),
-    m_dynamic( aIsDynamic )
+    m_dynamic( aIsDynamic ),
+    m_parallelCaching( false )
 {
     m_boundary.SetMaximum();
     m_needsUpdate.reserve( 32768 );
@@ -92,6 +97,8 @@ void VIEW::Add( VIEW_ITEM* aItem )
     aItem->ViewGetLayers( layers, layers_count );
     aItem->saveLayers( layers, layers_count );
 
+    aItem->saveBBox();
+
     if( m_dynamic )
         aItem->viewAssign( this );
 
@@ -99,7 +106,7 @@ void VIEW::Add( VIEW_ITEM* aItem )
     {
         VIEW_LAYER& l = m_layers[layers[i]];
         l.items->Insert( aItem );
-        MarkTargetDirty( l.target );
+        markAreaDirty( l.target, aItem->m_viewBBox );
     }
 
     aItem->ViewUpdate( VIEW_ITEM::ALL );
@@ -130,7 +137,7 @@ void VIEW::Remove( VIEW_ITEM* aItem )
     {
         VIEW_LAYER& l = m_layers[layers[i]];
         l.items->Remove( aItem );
-        MarkTargetDirty( l.target );
+        markAreaDirty( l.target, aItem->m_viewBBox );
 
         // Clear the GAL cache
         int prevGroup = aItem->getGroup( layers[i] );
@@ -338,8 +345,20 @@ void VIEW::SetCenter( const VECTOR2D& aCenter )
     m_gal->SetLookAtPoint( m_center );
     m_gal->ComputeWorldScreenMatrix();
 
-    // Redraw everything after the viewport has changed
-    MarkDirty();
+    const MATRIX3x3D& matrix = m_gal->GetWorldScreenMatrix();
+
+    if( m_gal->HasPersistentTargets() && matrix.m_data[0][0] == m_drawnMatrix.m_data[0][0]
+            && matrix.m_data[1][1] == m_drawnMatrix.m_data[1][1] )
+    {
+        // A pan: PrepareTargets() scrolls the targets if the GAL moved them by whole pixels,
+        // and redraws them otherwise
+        MarkTargetDirty( TARGET_OVERLAY );
+    }
+    else
+    {
+        // Redraw everything after the viewport has changed
+        MarkDirty();
+    }
 }
 
 
@@ -577,40 +596,104 @@ void VIEW::UpdateAllLayersOrder()
 
 struct VIEW::drawItem
 {
-    drawItem( VIEW* aView, int aLayer ) :
-        view( aView ), layer( aLayer )
+    drawItem( VIEW* aView, int aLayer, double aMinSize, const std::vector<BOX2I>* aArea ) :
+        view( aView ), layer( aLayer ), minSize( aMinSize ), area( aArea )
     {
     }
 
     bool operator()( VIEW_ITEM* aItem )
     {
+        const BOX2I& bbox = aItem->m_viewBBox;
+
         // Conditions that have te be fulfilled for an item to be drawn
         bool drawCondition = aItem->isRenderable() &&
                              aItem->ViewGetLOD( layer ) < view->m_scale;
         if( !drawCondition )
             return true;
 
+        if( area && !inArea( bbox ) )
+            return true;
+
+        // An item smaller than a pixel still covers a pixel once stroked, so instead of
+        // being skipped it is drawn as a single pixel, unless its cached group is ready
+        if( std::max( bbox.GetWidth(), bbox.GetHeight() ) < minSize &&
+                !( view->IsCached( layer ) && aItem->getGroup( layer ) >= 0 ) )
+        {
+            drawPlaceholder( aItem, bbox );
+            return true;
+        }
+
         view->draw( aItem, layer );
 
         return true;
     }
 
+    void drawPlaceholder( VIEW_ITEM* aItem, const BOX2I& aBBox )
+    {
+        GAL*        gal = view->m_gal;
+        VECTOR2D    half( minSize / 2.0, minSize / 2.0 );
+        VECTOR2D    center = aBBox.Centre();
+
+        gal->SetIsStroke( false );
+        gal->SetIsFill( true );
+        gal->SetFillColor( view->m_painter->GetSettings()->GetColor( aItem, layer ) );
+        gal->DrawRectangle( center - half, center + half );
+    }
+
+    bool inArea( const BOX2I& aBBox ) const
+    {
+        for( const BOX2I& rect : *area )
+        {
+            if( aBBox.GetRight() >= rect.GetLeft() && aBBox.GetLeft() <= rect.GetRight() &&
+                aBBox.GetBottom() >= rect.GetTop() && aBBox.GetTop() <= rect.GetBottom() )
+                return true;
+        }
+
+        return false;
+    }
+
     VIEW* view;
     int layer, layers[VIEW_MAX_LAYERS];
+    double minSize;                     ///< smaller items are drawn as a pixel
+    const std::vector<BOX2I>* area;     ///< if set, only the items touching it are drawn
 };
 
 
 void VIEW::redrawRect( const BOX2I& aRect )
 {
+    std::vector<BOX2I> area;
+    BOX2I areaBBox;
+
+    // The area of a partial redraw, in world coordinates
+    for( const BOX2I& tiles : m_redrawArea )
+    {
+        VECTOR2D origin = ToWorld( tiles.GetOrigin() );
+        BOX2I rect( origin, ToWorld( tiles.GetEnd() ) - origin );
+        rect.Normalize();
+
+        if( area.empty() )
+            areaBBox = rect;
+        else
+            areaBBox.Merge( rect );
+
+        area.push_back( rect );
+    }
+
+    // Size of a pixel, in world coordinates
+    double pixelSize = std::fabs( ToWorld( 1.0 ) );
+
     for( VIEW_LAYER* l : m_orderedLayers )
     {
         if( l->visible && IsTargetDirty( l->target ) && areRequiredLayersEnabled( l->id ) )
         {
-            drawItem drawFunc( this, l->id );
+            // The overlay is always drawn entirely, as it is cleared entirely
+            bool overlay = ( l->target == TARGET_OVERLAY );
+            bool partial = !overlay && !area.empty();
+            drawItem drawFunc( this, l->id, overlay ? 0.0 : pixelSize, partial ? &area : NULL );
 
             m_gal->SetTarget( l->target );
             m_gal->SetLayerDepth( l->renderingOrder );
-            l->items->Query( aRect, drawFunc );
+            l->items->Query( partial ? areaBBox : aRect, drawFunc );
         }
     }
 }
@@ -725,6 +808,24 @@ struct VIEW::recacheItem
 };
 
 
+struct VIEW::collectItem
+{
+    collectItem( std::vector<VIEW_ITEM*>& aItems ) :
+        items( aItems )
+    {
+    }
+
+    bool operator()( VIEW_ITEM* aItem )
+    {
+        items.push_back( aItem );
+
+        return true;
+    }
+
+    std::vector<VIEW_ITEM*>& items;
+};
+
+
 void VIEW::Clear()
 {
     BOX2I r;
@@ -747,10 +848,187 @@ void VIEW::Clear()
         l->items->RemoveAll();
     }
 
+    // Areas of the removed items are not tracked
+    MarkDirty();
+
     m_gal->ClearCache();
 }
 
 
+/// Marks the tiles touched by a rectangle given in screen coordinates
+static void markTiles( std::vector<char>& aTiles, const VECTOR2I& aCount, const BOX2D& aRect )
+{
+    const double size = VIEW::DIRTY_TILE_SIZE;
+
+    // Clamp before converting, the rectangle may lie far outside of the screen
+    double left   = std::max( aRect.GetLeft() / size, 0.0 );
+    double right  = std::min( aRect.GetRight() / size, aCount.x - 1.0 );
+    double top    = std::max( aRect.GetTop() / size, 0.0 );
+    double bottom = std::min( aRect.GetBottom() / size, aCount.y - 1.0 );
+
+    for( int y = floor( top ); y <= floor( bottom ); ++y )
+    {
+        for( int x = floor( left ); x <= floor( right ); ++x )
+            aTiles[y * aCount.x + x] = 1;
+    }
+}
+
+
+/**
+ * Function mergeTiles()
+ * Converts the marked tiles to rectangles: runs of tiles in a row, joined with the runs
+ * spanning the same columns in the following rows.
+ * @return false if all tiles are marked.
+ */
+static bool mergeTiles( const std::vector<char>& aTiles, const VECTOR2I& aCount,
+                        const VECTOR2I& aScreenSize, std::vector<BOX2I>& aRects )
+{
+    const int size = VIEW::DIRTY_TILE_SIZE;
+    int marked = 0;
+
+    // Rectangles ending on the previous row and on the current one
+    std::vector<int> open, next;
+
+    for( int y = 0; y < aCount.y; ++y )
+    {
+        int top    = y * size;
+        int bottom = std::min( top + size, aScreenSize.y );
+
+        next.clear();
+
+        for( int x = 0; x < aCount.x; )
+        {
+            if( !aTiles[y * aCount.x + x] )
+            {
+                ++x;
+                continue;
+            }
+
+            int first = x;
+
+            while( x < aCount.x && aTiles[y * aCount.x + x] )
+                ++x;
+
+            marked += x - first;
+
+            int left  = first * size;
+            int right = std::min( x * size, aScreenSize.x );
+            bool joined = false;
+
+            for( int i : open )
+            {
+                if( aRects[i].GetLeft() == left && aRects[i].GetRight() == right )
+                {
+                    aRects[i].SetHeight( bottom - aRects[i].GetTop() );
+                    next.push_back( i );
+                    joined = true;
+                    break;
+                }
+            }
+
+            if( !joined )
+            {
+                next.push_back( aRects.size() );
+                aRects.push_back( BOX2I( VECTOR2I( left, top ),
+                                         VECTOR2I( right - left, bottom - top ) ) );
+            }
+        }
+
+        open.swap( next );
+    }
+
+    return marked < aCount.x * aCount.y;
+}
+
+
+void VIEW::PrepareTargets()
+{
+    const MATRIX3x3D& matrix = m_gal->GetWorldScreenMatrix();
+    const VECTOR2I& screenSize = m_gal->GetScreenPixelSize();
+
+    m_redrawArea.clear();
+
+    if( !m_gal->HasPersistentTargets() )
+        return;
+
+    // A changed screen size or scale invalidates the targets contents
+    bool redrawAll = m_dirtyTargets[TARGET_CACHED] || m_dirtyTargets[TARGET_NONCACHED] ||
+                     screenSize != m_drawnScreenSize ||
+                     matrix.m_data[0][0] != m_drawnMatrix.m_data[0][0] ||
+                     matrix.m_data[1][1] != m_drawnMatrix.m_data[1][1];
+
+    VECTOR2I tileCount( ( screenSize.x + DIRTY_TILE_SIZE - 1 ) / DIRTY_TILE_SIZE,
+                        ( screenSize.y + DIRTY_TILE_SIZE - 1 ) / DIRTY_TILE_SIZE );
+    std::vector<char> tiles( tileCount.x * tileCount.y, 0 );
+
+    if( !redrawAll )
+    {
+        VECTOR2D offset( matrix.m_data[0][2] - m_drawnMatrix.m_data[0][2],
+                         matrix.m_data[1][2] - m_drawnMatrix.m_data[1][2] );
+        VECTOR2I delta( KiROUND( offset.x ), KiROUND( offset.y ) );
+
+        if( delta != VECTOR2I( 0, 0 ) )
+        {
+            // SetCenter() pans by whole pixels, anything else cannot be scrolled
+            if( std::fabs( offset.x - delta.x ) > 0.01 || std::fabs( offset.y - delta.y ) > 0.01 ||
+                std::abs( delta.x ) >= screenSize.x || std::abs( delta.y ) >= screenSize.y ||
+                !m_gal->ScrollTargets( delta ) )
+            {
+                redrawAll = true;
+            }
+            else
+            {
+                // Strips uncovered by the scroll
+                if( delta.x > 0 )
+                    markTiles( tiles, tileCount, BOX2D( VECTOR2D( 0, 0 ),
+                               VECTOR2D( delta.x, screenSize.y ) ) );
+                else if( delta.x < 0 )
+                    markTiles( tiles, tileCount, BOX2D( VECTOR2D( screenSize.x + delta.x, 0 ),
+                               VECTOR2D( -delta.x, screenSize.y ) ) );
+
+                if( delta.y > 0 )
+                    markTiles( tiles, tileCount, BOX2D( VECTOR2D( 0, 0 ),
+                               VECTOR2D( screenSize.x, delta.y ) ) );
+                else if( delta.y < 0 )
+                    markTiles( tiles, tileCount, BOX2D( VECTOR2D( 0, screenSize.y + delta.y ),
+                               VECTOR2D( screenSize.x, -delta.y ) ) );
+            }
+        }
+    }
+
+    if( !redrawAll )
+    {
+        // Areas of the changed items, wherever the scroll moved them
+        for( const BOX2I& area : m_dirtyAreas )
+        {
+            VECTOR2D origin = ToScreen( area.GetOrigin() );
+            BOX2D rect( origin, ToScreen( area.GetEnd() ) - origin );
+            rect.Normalize();
+            rect.Inflate( DIRTY_AREA_MARGIN );
+
+            markTiles( tiles, tileCount, rect );
+        }
+
+        redrawAll = !mergeTiles( tiles, tileCount, screenSize, m_redrawArea );
+    }
+
+    if( redrawAll )
+    {
+        m_redrawArea.clear();
+        MarkTargetDirty( TARGET_CACHED );
+        MarkTargetDirty( TARGET_NONCACHED );
+    }
+    else if( !m_redrawArea.empty() )
+    {
+        m_gal->SetRedrawArea( m_redrawArea );
+    }
+
+    m_dirtyAreas.clear();
+    m_drawnMatrix = matrix;
+    m_drawnScreenSize = screenSize;
+}
+
+
 void VIEW::ClearTargets()
 {
     if( IsTargetDirty( TARGET_CACHED ) || IsTargetDirty( TARGET_NONCACHED ) )
@@ -788,6 +1066,7 @@ void VIEW::Redraw()
     markTargetClean( TARGET_CACHED );
     markTargetClean( TARGET_NONCACHED );
     markTargetClean( TARGET_OVERLAY );
+    m_redrawArea.clear();
 
 #ifdef PROFILE
     prof_end( &totalRealTime );
@@ -836,7 +1115,8 @@ void VIEW::clearGroupCache()
 }
 
 
-void VIEW::invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags )
+void VIEW::invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags,
+                           std::vector<VIEW_ITEM*>* aRecached )
 {
     // updateLayers updates geometry too, so we do not have to update both of them at the same time
     if( aUpdateFlags & VIEW_ITEM::LAYERS )
@@ -855,15 +1135,23 @@ void VIEW::invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags )
         if( IsCached( layerId ) )
         {
             if( aUpdateFlags & ( VIEW_ITEM::GEOMETRY | VIEW_ITEM::LAYERS ) )
-                updateItemGeometry( aItem, layerId );
+            {
+                if( !aRecached )
+                    updateItemGeometry( aItem, layerId );
+            }
             else if( aUpdateFlags & VIEW_ITEM::COLOR )
+            {
                 updateItemColor( aItem, layerId );
+            }
         }
 
         // Mark those layers as dirty, so the VIEW will be refreshed
-        MarkTargetDirty( m_layers[layerId].target );
+        markAreaDirty( m_layers[layerId].target, aItem->m_viewBBox );
     }
 
+    if( aRecached && ( aUpdateFlags & ( VIEW_ITEM::GEOMETRY | VIEW_ITEM::LAYERS ) ) )
+        aRecached->push_back( aItem );
+
     aItem->clearUpdateFlags();
 }
 
@@ -924,18 +1212,162 @@ void VIEW::updateItemGeometry( VIEW_ITEM* aItem, int aLayer )
 }
 
 
+bool VIEW::recacheParallel( const std::vector<VIEW_ITEM*>& aItems )
+{
+#ifdef USE_OPENMP
+    int threads = omp_get_max_threads();
+
+    if( !m_parallelCaching || threads < 2 || (int) aItems.size() < MIN_PARALLEL_ITEMS )
+        return false;
+
+    // Every thread draws to its own GAL stage, with its own painter
+    std::vector<GAL*> stages;
+    std::vector<PAINTER*> painters;
+
+    for( int i = 0; i < threads; ++i )
+    {
+        GAL* stage = m_gal->CreateStage();
+        PAINTER* painter = stage ? m_painter->Clone( stage ) : NULL;
+
+        if( !painter )
+        {
+            delete stage;
+            break;
+        }
+
+        stages.push_back( stage );
+        painters.push_back( painter );
+    }
+
+    bool done = stages.size() > 1;
+
+    if( done )
+    {
+        // Items drawn by the worker threads and items that have to be drawn on this thread
+        std::vector<VIEW_ITEM*> staged;
+        std::vector<VIEW_ITEM*> serial;
+
+        staged.reserve( aItems.size() );
+
+        // Remove previously cached groups, the worker threads do not access the GAL. The painter
+        // computes here the item data cached on demand, so the worker threads only read items.
+        for( VIEW_ITEM* item : aItems )
+        {
+            int layers[VIEW_MAX_LAYERS], layers_count;
+            item->getLayers( layers, layers_count );
+
+            if( m_painter->PrepareDraw( item ) )
+                staged.push_back( item );
+            else
+                serial.push_back( item );
+
+            for( int i = 0; i < layers_count; ++i )
+            {
+                int group = item->getGroup( layers[i] );
+
+                if( group >= 0 && IsCached( layers[i] ) )
+                {
+                    m_gal->DeleteGroup( group );
+                    item->setGroup( layers[i], -1 );
+                }
+            }
+        }
+
+        // Thread that has drawn each item, the item groups are numbered in its stage
+        std::vector<int> owners( staged.size() );
+
+        #pragma omp parallel num_threads( stages.size() )
+        {
+            int thread = omp_get_thread_num();
+            GAL* gal = stages[thread];
+            PAINTER* painter = painters[thread];
+
+            #pragma omp for schedule( dynamic, 64 )
+            for( int i = 0; i < (int) staged.size(); ++i )
+            {
+                VIEW_ITEM* item = staged[i];
+                int layers[VIEW_MAX_LAYERS], layers_count;
+
+                owners[i] = thread;
+                item->getLayers( layers, layers_count );
+
+                for( int j = 0; j < layers_count; ++j )
+                {
+                    if( !IsCached( layers[j] ) )
+                        continue;
+
+                    gal->SetLayerDepth( m_layers.at( layers[j] ).renderingOrder );
+
+                    int group = gal->BeginGroup();
+                    item->setGroup( layers[j], group );
+                    painter->Draw( item, layers[j] );
+                    gal->EndGroup();
+                }
+            }
+        }
+
+        // Move the groups to the GAL cache, then renumber them in the items
+        std::vector< std::vector<int> > groups( stages.size() );
+
+        for( unsigned int i = 0; i < stages.size(); ++i )
+            m_gal->MergeStage( stages[i], groups[i] );
+
+        for( unsigned int i = 0; i < staged.size(); ++i )
+        {
+            VIEW_ITEM* item = staged[i];
+            int layers[VIEW_MAX_LAYERS], layers_count;
+
+            item->getLayers( layers, layers_count );
+
+            for( int j = 0; j < layers_count; ++j )
+            {
+                if( IsCached( layers[j] ) )
+                    item->setGroup( layers[j], groups[owners[i]][item->getGroup( layers[j] )] );
+            }
+        }
+
+        for( VIEW_ITEM* item : serial )
+        {
+            int layers[VIEW_MAX_LAYERS], layers_count;
+
+            item->getLayers( layers, layers_count );
+
+            for( int j = 0; j < layers_count; ++j )
+            {
+                if( IsCached( layers[j] ) )
+                    updateItemGeometry( item, layers[j] );
+            }
+        }
+    }
+
+    for( unsigned int i = 0; i < stages.size(); ++i )
+    {
+        delete painters[i];
+        delete stages[i];
+    }
+
+    return done;
+#else
+    return false;
+#endif /* USE_OPENMP */
+}
+
+
 void VIEW::updateBbox( VIEW_ITEM* aItem )
 {
     int layers[VIEW_MAX_LAYERS], layers_count;
+    BOX2I prevBBox = aItem->m_viewBBox;
 
     aItem->ViewGetLayers( layers, layers_count );
+    aItem->saveBBox();
 
     for( int i = 0; i < layers_count; ++i )
     {
         VIEW_LAYER& l = m_layers[layers[i]];
         l.items->Remove( aItem );
         l.items->Insert( aItem );
-        MarkTargetDirty( l.target );
+        markAreaDirty( l.target, prevBBox );
+        markAreaDirty( l.target, aItem->m_viewBBox );
     }
 }
 
@@ -951,7 +1383,7 @@ void VIEW::updateLayers( VIEW_ITEM* aItem )
     {
         VIEW_LAYER& l = m_layers[layers[i]];
         l.items->Remove( aItem );
-        MarkTargetDirty( l.target );
+        markAreaDirty( l.target, aItem->m_viewBBox );
 
         if( IsCached( l.id ) )
         {
@@ -969,13 +1401,46 @@ void VIEW::updateLayers( VIEW_ITEM* aItem )
     // Add the item to new layer set
     aItem->ViewGetLayers( layers, layers_count );
     aItem->saveLayers( layers, layers_count );
+    aItem->saveBBox();
 
     for( int i = 0; i < layers_count; i++ )
     {
         VIEW_LAYER& l = m_layers[layers[i]];
         l.items->Insert( aItem );
-        MarkTargetDirty( l.target );
+        markAreaDirty( l.target, aItem->m_viewBBox );
+    }
+}
+
+
+void VIEW::markAreaDirty( int aTarget, const BOX2I& aArea )
+{
+    if( aTarget == TARGET_OVERLAY || !m_gal || !m_gal->HasPersistentTargets() )
+    {
+        MarkTargetDirty( aTarget );
+        return;
+    }
+
+    // Cached and noncached targets are always redrawn together
+    if( m_dirtyTargets[TARGET_CACHED] || m_dirtyTargets[TARGET_NONCACHED] )
+        return;
+
+    // Items mark their area once for each layer
+    for( int i = std::max( (int) m_dirtyAreas.size() - 2, 0 ); i < (int) m_dirtyAreas.size(); ++i )
+    {
+        if( m_dirtyAreas[i].GetOrigin() == aArea.GetOrigin() &&
+            m_dirtyAreas[i].GetSize() == aArea.GetSize() )
+            return;
+    }
+
+    if( (int) m_dirtyAreas.size() >= MAX_DIRTY_AREAS )
+    {
+        m_dirtyAreas.clear();
+        MarkTargetDirty( TARGET_CACHED );
+        MarkTargetDirty( TARGET_NONCACHED );
+        return;
     }
+
+    m_dirtyAreas.push_back( aArea );
 }
 
 
@@ -1008,16 +1473,41 @@ void VIEW::RecacheAllItems( bool aImmediately )
     prof_start( &totalRealTime );
 #endif /* PROFILE */
 
+    std::vector<VIEW_ITEM*> items;
+
+    if( aImmediately && m_parallelCaching )
+    {
+        collectItem visitor( items );
+
+        for( LAYER_MAP_ITER i = m_layers.begin(); i != m_layers.end(); ++i )
+        {
+            VIEW_LAYER* l = &( ( *i ).second );
+
+            if( IsCached( l->id ) )
+                l->items->Query( r, visitor );
+        }
+
+        // Items on several layers are drawn by a single thread
+        std::sort( items.begin(), items.end() );
+        items.erase( std::unique( items.begin(), items.end() ), items.end() );
+    }
+
+    bool recached = recacheParallel( items );
+
     for( LAYER_MAP_ITER i = m_layers.begin(); i != m_layers.end(); ++i )
     {
         VIEW_LAYER* l = &( ( *i ).second );
 
         if( IsCached( l->id ) )
         {
-            m_gal->SetTarget( l->target );
-            m_gal->SetLayerDepth( l->renderingOrder );
-            recacheItem visitor( this, m_gal, l->id, aImmediately );
-            l->items->Query( r, visitor );
+            if( !recached )
+            {
+                m_gal->SetTarget( l->target );
+                m_gal->SetLayerDepth( l->renderingOrder );
+                recacheItem visitor( this, m_gal, l->id, aImmediately );
+                l->items->Query( r, visitor );
+            }
+
             MarkTargetDirty( l->target );
         }
     }
@@ -1033,15 +1523,34 @@ void VIEW::RecacheAllItems( bool aImmediately )
 
 void VIEW::UpdateItems()
 {
+    // Items whose geometry is updated at once, see recacheParallel()
+    std::vector<VIEW_ITEM*> recached;
+    bool parallel = m_parallelCaching && (int) m_needsUpdate.size() >= MIN_PARALLEL_ITEMS;
+
     // Update items that need this
     for( VIEW_ITEM* item : m_needsUpdate )
     {
         assert( item->viewRequiredUpdate() != VIEW_ITEM::NONE );
 
-        invalidateItem( item, item->viewRequiredUpdate() );
+        invalidateItem( item, item->viewRequiredUpdate(), parallel ? &recached : NULL );
     }
 
     m_needsUpdate.clear();
+
+    if( recached.empty() || recacheParallel( recached ) )
+        return;
+
+    for( VIEW_ITEM* item : recached )
+    {
+        int layers[VIEW_MAX_LAYERS], layers_count;
+        item->getLayers( layers, layers_count );
+
+        for( int i = 0; i < layers_count; ++i )
+        {
+            if( IsCached( layers[i] ) )
+                updateItemGeometry( item, layers[i] );
+        }
+    }
 }
 
 
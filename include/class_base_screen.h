@@ -84,6 +84,7 @@ private:
     wxPoint     m_scrollCenter;     ///< Current scroll center point in logical units.
     wxPoint     m_MousePosition;    ///< Mouse cursor coordinate in logical units.
     int         m_UndoRedoCountMax; ///< undo/Redo command Max depth
+    size_t      m_UndoRedoSizeMax;  ///< undo/Redo history memory budget in bytes, 0 for no limit
 
     /**
      * The cross hair position in logical (drawing) units.  The cross hair is not the cursor
@@ -298,6 +299,13 @@ public:
      */
     virtual PICKED_ITEMS_LIST* PopCommandFromRedoList();
 
+    /**
+     * Function OversizeCommandCount
+     * @return The count of oldest commands of \a aList to delete to bring it within the
+     *         memory budget.  The newest command is never counted.
+     */
+    int OversizeCommandCount( const UNDO_REDO_CONTAINER& aList ) const;
+
     int GetUndoCommandCount() const
     {
         return m_UndoList.m_CommandsList.size();
@@ -310,6 +318,17 @@ public:
 
     int GetMaxUndoItems() const { return m_UndoRedoCountMax; }
 
+    size_t GetMaxUndoSize() const { return m_UndoRedoSizeMax; }
+
+    /**
+     * Function SetMaxUndoSize
+     * sets the memory budget of the undo and of the redo history, in bytes.  When the
+     * item copies held by a history exceed it, its oldest commands are deleted.  Only
+     * commands which have their PICKED_ITEMS_LIST::m_ImageSize set count.
+     * @param aMax The budget in bytes, or 0 for no limit.
+     */
+    void SetMaxUndoSize( size_t aMax ) { m_UndoRedoSizeMax = aMax; }
+
     void SetMaxUndoItems( int aMax )
     {
         if( aMax >= 0 && aMax < ABS_MAX_UNDO_ITEMS )
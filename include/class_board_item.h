@@ -34,6 +34,7 @@
 #include <base_struct.h>
 #include <gr_basic.h>
 #include <layers_id_colors_and_visibility.h>
+#include <class_undoredo_container.h>
 
 /// Abbrevation for fomatting internal units to a string.
 #define FMT_IU     BOARD_ITEM::FormatInternalUnits
@@ -169,6 +170,21 @@ public:
      */
     void SwapData( BOARD_ITEM* aImage );
 
+    /**
+     * Function UndoRedoPicked
+     * puts this item back in its state before (undo) or after (redo) a command in which
+     * it is picked with \a aStatus, from what the command saved:
+     *  - UR_CHANGED, UR_ZONE_OUTLINE, UR_ZONE_FILL: data is exchanged with the copy \a aImage
+     *  - UR_MOVED: the item is moved by \a aTransformPoint, the move vector of the command
+     *  - UR_ROTATED, UR_ROTATED_CLOCKWISE: the item is rotated by \a aRotationAngle around
+     *    \a aTransformPoint
+     *  - UR_FLIPPED: the item is flipped around \a aTransformPoint
+     * It is used by PCB_EDIT_FRAME::PutDataInPreviousState(), and is defined with it.
+     * @return false if \a aStatus is not one of these commands.
+     */
+    bool UndoRedoPicked( UNDO_REDO_T aStatus, BOARD_ITEM* aImage, const wxPoint& aTransformPoint,
+                         double aRotationAngle, bool aRedo );
+
     /**
      * Function IsOnLayer
      * tests to see if this object is on the given layer.  Is virtual so
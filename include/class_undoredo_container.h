@@ -73,6 +73,10 @@ enum UNDO_REDO_T {
                             // the current module when changed)
     UR_LIBEDIT,             // Specific to the component editor (libedit creates a full copy
                             // of the current component when changed)
+    UR_ZONE_OUTLINE,        // Specific to Pcbnew: outline or settings of a zone changed, its copy
+                            // has no filled areas. Undo by exchanging all but the filled areas
+    UR_ZONE_FILL,           // Specific to Pcbnew: filled areas of a zone changed, undo by
+                            // exchanging them with the ones of the copy
     UR_EXCHANGE_T           ///< Use for changing the schematic text type where swapping
                             ///< data structure is insufficient to restor the change.
 };
@@ -135,6 +139,9 @@ public:
                                    * UR_UNSPECIFIED */
     wxPoint m_TransformPoint;     /* used to undo redo command by the same command: usually
                                    * need to know the rotate point or the move vector */
+    size_t  m_ImageSize;          /* estimated size in bytes of the item copies held by the
+                                   * list, to keep the undo/redo history within a memory
+                                   * budget.  0 when not estimated */
 
 private:
     std::vector <ITEM_PICKER> m_ItemsList;
@@ -322,6 +329,12 @@ public:
     PICKED_ITEMS_LIST* PopCommand();
 
     void ClearCommandList();
+
+    /**
+     * Function GetImageSize
+     * @return The estimated size in bytes of the item copies held by all the commands.
+     */
+    size_t GetImageSize() const;
 };
 
 
@@ -0,0 +1,124 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file disjoint_set.h
+ * @brief A union-find structure, used to build clusters of connected items.
+ */
+
+#ifndef DISJOINT_SET_H
+#define DISJOINT_SET_H
+
+#include <algorithm>
+#include <vector>
+
+
+/**
+ * Class DISJOINT_SET
+ * stores a partition of the integers 0 .. size-1 in disjoint sets (clusters).
+ * Union() and Find() run in quasi constant time (path halving, and the root of
+ * a merged set is always the smallest element, so results do not depend
+ * on the order of the merges).
+ */
+class DISJOINT_SET
+{
+public:
+    DISJOINT_SET( int aSize = 0 )
+    {
+        Reset( aSize );
+    }
+
+    /**
+     * Function Reset
+     * puts each element 0 .. aSize-1 in its own set.
+     */
+    void Reset( int aSize )
+    {
+        m_parent.resize( aSize );
+
+        for( int ii = 0; ii < aSize; ++ii )
+            m_parent[ii] = ii;
+    }
+
+    /**
+     * Function Add
+     * adds a new element, in its own set.
+     * @return the new element.
+     */
+    int Add()
+    {
+        m_parent.push_back( m_parent.size() );
+        return m_parent.size() - 1;
+    }
+
+    int Size() const
+    {
+        return m_parent.size();
+    }
+
+    /**
+     * Function Find
+     * @return the root of the set containing aElement, i.e. its smallest element.
+     */
+    int Find( int aElement )
+    {
+        while( m_parent[aElement] != aElement )
+        {
+            m_parent[aElement] = m_parent[m_parent[aElement]];
+            aElement = m_parent[aElement];
+        }
+
+        return aElement;
+    }
+
+    /**
+     * Function Union
+     * merges the sets containing aA and aB.
+     * @return the root of the merged set.
+     */
+    int Union( int aA, int aB )
+    {
+        aA = Find( aA );
+        aB = Find( aB );
+
+        if( aA == aB )
+            return aA;
+
+        if( aB < aA )
+            std::swap( aA, aB );
+
+        m_parent[aB] = aA;
+
+        return aA;
+    }
+
+    bool Connected( int aA, int aB )
+    {
+        return Find( aA ) == Find( aB );
+    }
+
+private:
+    std::vector<int> m_parent;
+};
+
+#endif  // DISJOINT_SET_H
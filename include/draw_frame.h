@@ -35,6 +35,7 @@ class EDA_HOTKEY;
 
 #define DEFAULT_MAX_UNDO_ITEMS 0
 #define ABS_MAX_UNDO_ITEMS (INT_MAX / 2)
+#define DEFAULT_MAX_UNDO_SIZE (64 * 1024 * 1024)   ///< undo/redo history budget in bytes
 
 /**
  * Class EDA_DRAW_FRAME
@@ -26,6 +26,7 @@
 #define DSNLEXER_H_
 
 #include <stdio.h>
+#include <string.h>
 #include <string>
 #include <vector>
 #include <hashtables.h>
@@ -42,6 +43,59 @@ struct KEYWORD
     const char* name;       ///< unique keyword.
     int         token;      ///< a zero based index into an array of KEYWORDs
 };
+
+
+/**
+ * Struct KEYWORD_HASH
+ * is a perfect hash of a KEYWORD table, generated along with the table by the
+ * TokenList2DsnLexer CMake script.  Looking up a word takes one hash and one
+ * string compare, and nothing is built at run time.
+ * <p>
+ * The hash h of a word is computed by Hash().  The word is in bucket
+ * ( h >> 9 ) & bucketMask, and the displacement d of its bucket gives its slot:
+ * ( h + d * ( ( h >> 17 ) | 1 ) ) & slotMask.  The generator must use the same hash.
+ */
+struct KEYWORD_HASH
+{
+    const unsigned short* displacements;    ///< displacement of each bucket
+    unsigned              bucketMask;       ///< bucket count - 1, the bucket count is a power of 2
+    const short*          slots;            ///< KEYWORD index in each slot, or -1 if free
+    unsigned              slotMask;         ///< slot count - 1, the slot count is a power of 2
+
+    static unsigned Hash( const char* aWord, size_t aLength )
+    {
+        unsigned hash = 5381;
+
+        for( const char* end = aWord + aLength; aWord < end; ++aWord )
+            hash = ( hash * 33 + (unsigned char) *aWord ) & 0x1FFFFFF;
+
+        return hash;
+    }
+
+    /**
+     * Function Find
+     * @return int - the token of @a aWord in @a aKeywords, or -1 if not a keyword.
+     * @param aWord is the word to look up, not necessarily nul terminated.
+     * @param aLength is the number of bytes of @a aWord.
+     * @param aKeywords is the KEYWORD table this hash was generated for.
+     */
+    int Find( const char* aWord, size_t aLength, const KEYWORD* aKeywords ) const
+    {
+        unsigned hash = Hash( aWord, aLength );
+        unsigned d    = displacements[( hash >> 9 ) & bucketMask];
+        int      ndx  = slots[( hash + d * ( ( hash >> 17 ) | 1 ) ) & slotMask];
+
+        if( ndx < 0 )
+            return -1;
+
+        const char* name = aKeywords[ndx].name;
+
+        if( strncmp( name, aWord, aLength ) != 0 || name[aLength] != '\0' )
+            return -1;
+
+        return aKeywords[ndx].token;
+    }
+};
 #endif
 
 // something like this macro can be used to help initialize a KEYWORD table.
@@ -107,10 +161,12 @@ protected:
 
     int                 curTok;                 ///< the current token obtained on last NextTok()
     std::string         curText;                ///< the text of the current token
+    std::string         curLine;                ///< nul terminated copy of the current line, see CurLine()
 
     const KEYWORD*      keywords;               ///< table sorted by CMake for bsearch()
     unsigned            keywordCount;           ///< count of keywords table
-    KEYWORD_MAP         keyword_hash;           ///< fast, specialized "C string" hashtable
+    const KEYWORD_HASH* keywordsHash;           ///< perfect hash of keywords, or NULL
+    KEYWORD_MAP         keyword_hash;           ///< fast, specialized "C string" hashtable, used without keywordsHash
 
     void init();
 
@@ -118,13 +174,15 @@ protected:
     {
         if( reader )
         {
-            reader->ReadLine();
+            // The line may be a view into the reader's storage, which is not nul
+            // terminated: it is only read up to limit.
+            const char* line = reader->ReadLineView();
 
             unsigned len = reader->Length();
 
-            // start may have changed in ReadLine(), which can resize and
+            // start may have changed in ReadLineView(), which can resize and
             // relocate reader's line buffer.
-            start = reader->Line();
+            start = line ? line : dummy;
 
             next  = start;
             limit = next + len;
@@ -169,9 +227,11 @@ public:
      * @param aKeywordCount is the count of tokens in aKeywordTable.
      * @param aFile is an open file, which will be closed when this is destructed.
      * @param aFileName is the name of the file
+     * @param aKeywordsHash is an optional perfect hash of aKeywordTable.
      */
     DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-              FILE* aFile, const wxString& aFileName );
+              FILE* aFile, const wxString& aFileName,
+              const KEYWORD_HASH* aKeywordsHash = NULL );
 
     /**
      * Constructor ( const KEYWORD*, unsigned, const std::string&, const wxString& )
@@ -182,9 +242,11 @@ public:
      * @param aKeywordCount is the count of tokens in aKeywordTable.
      * @param aSExpression is text to feed through a STRING_LINE_READER
      * @param aSource is a description of aSExpression, used for error reporting.
+     * @param aKeywordsHash is an optional perfect hash of aKeywordTable.
      */
     DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-              const std::string& aSExpression, const wxString& aSource = wxEmptyString );
+              const std::string& aSExpression, const wxString& aSource = wxEmptyString,
+              const KEYWORD_HASH* aKeywordsHash = NULL );
 
     /**
      * Constructor ( const std::string&, const wxString& )
@@ -209,9 +271,11 @@ public:
      *
      * @param aLineReader is any subclassed instance of LINE_READER, such as
      *  STRING_LINE_READER or FILE_LINE_READER.  No ownership is taken.
+     *
+     * @param aKeywordsHash is an optional perfect hash of aKeywordTable.
      */
     DSNLEXER( const KEYWORD* aKeywordTable, unsigned aKeywordCount,
-              LINE_READER* aLineReader = NULL );
+              LINE_READER* aLineReader = NULL, const KEYWORD_HASH* aKeywordsHash = NULL );
 
     virtual ~DSNLEXER();
 
@@ -516,7 +580,10 @@ public:
      */
     const char* CurLine()
     {
-        return (const char*)(*reader);
+        // The current line may be a view into the reader's storage, see readLine(),
+        // so it is copied to be nul terminated.
+        curLine.assign( start, limit );
+        return curLine.c_str();
     }
 
     /**
@@ -74,6 +74,26 @@ public:
 #endif
     }
 
+    /**
+     * Constructor
+     * makes an already loaded #FOOTPRINT_INFO from fields stored in the footprint
+     * info index, so the footprint does not have to be parsed again.
+     */
+    FOOTPRINT_INFO( FOOTPRINT_LIST* aOwner, const wxString& aNickname,
+                    const wxString& aFootprintName, const wxString& aDoc,
+                    const wxString& aKeywords, int aPadCount, int aUniquePadCount ) :
+        m_owner( aOwner ),
+        m_loaded( true ),
+        m_nickname( aNickname ),
+        m_fpname( aFootprintName ),
+        m_num( 0 ),
+        m_pad_count( aPadCount ),
+        m_unique_pad_count( aUniquePadCount ),
+        m_doc( aDoc ),
+        m_keywords( aKeywords )
+    {
+    }
+
     const wxString& GetDoc()
     {
         ensure_loaded();
@@ -236,6 +256,11 @@ public:
     /**
      * Function ReadFootprintFiles
      * reads all the footprints provided by the combination of aTable and aNickname.
+     * <p>
+     * The fields of every library read are kept in an index file in the KiCad config
+     * directory, keyed by library URI and a stamp of the library files' names, sizes
+     * and modification times.  A library whose stamp did not change since the last
+     * call is taken from the index and is not parsed again.
      *
      * @param aTable defines all the libraries.
      * @param aNickname is the library to read from, or if NULL means read all
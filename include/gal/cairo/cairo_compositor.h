@@ -32,6 +32,7 @@
 #define CAIRO_COMPOSITOR_H_
 
 #include <gal/compositor.h>
+#include <math/box2.h>
 #include <cairo.h>
 #include <boost/smart_ptr/shared_array.hpp>
 #include <deque>
@@ -65,6 +66,24 @@ public:
     /// @copydoc COMPOSITOR::ClearBuffer()
     virtual void ClearBuffer();
 
+    /**
+     * Function ClearBuffer()
+     * Clears a part of the currently used buffer.
+     *
+     * @param aArea is the rectangle to be cleared, in pixels. It is clipped to the buffer size.
+     */
+    void ClearBuffer( const BOX2I& aArea );
+
+    /**
+     * Function ScrollBuffer()
+     * Moves the contents of a buffer by a number of pixels. The uncovered part of the buffer
+     * keeps its previous contents.
+     *
+     * @param aBufferHandle is the buffer to be moved.
+     * @param aDelta is the displacement, in pixels.
+     */
+    void ScrollBuffer( unsigned int aBufferHandle, const VECTOR2I& aDelta );
+
     /// @copydoc COMPOSITOR::DrawBuffer()
     virtual void DrawBuffer( unsigned int aBufferHandle );
 
@@ -227,6 +227,21 @@ public:
     /// @copydoc GAL::ClearTarget()
     virtual void ClearTarget( RENDER_TARGET aTarget );
 
+    /// @copydoc GAL::HasPersistentTargets()
+    virtual bool HasPersistentTargets() const
+    {
+        return true;
+    }
+
+    /// @copydoc GAL::SetRedrawArea()
+    virtual void SetRedrawArea( const std::vector<BOX2I>& aArea );
+
+    /// @copydoc GAL::ScrollTargets()
+    virtual bool ScrollTargets( const VECTOR2I& aDelta );
+
+    /// @copydoc GAL::ComputeWorldScreenMatrix()
+    virtual void ComputeWorldScreenMatrix();
+
     // -------
     // Cursor
     // -------
@@ -274,6 +289,7 @@ private:
     unsigned int            overlayBuffer;          ///< Handle to the overlay buffer
     RENDER_TARGET           currentTarget;          ///< Current rendering target
     bool                    validCompositor;        ///< Compositor initialization flag
+    std::vector<BOX2I>      redrawArea;             ///< Area of the main buffer to be redrawn
 
     // Variables related to wxWidgets
     wxWindow*               parentWindow;           ///< Parent window
@@ -30,8 +30,10 @@
 #include <deque>
 #include <stack>
 #include <limits>
+#include <vector>
 
 #include <math/matrix3x3.h>
+#include <math/box2.h>
 
 #include <gal/color4d.h>
 #include <gal/definitions.h>
@@ -440,6 +442,24 @@ public:
      */
     virtual void ClearCache() {};
 
+    /**
+     * @brief Create a GAL which stores groups in its own memory, without using the graphics
+     * device, so groups may be created there by another thread while this GAL is in use.
+     * The view settings (world scale, flipping, depth range) are copied from this GAL.
+     *
+     * @return the new GAL, owned by the caller, or NULL if the groups cannot be created apart.
+     */
+    virtual GAL* CreateStage() { return NULL; };
+
+    /**
+     * @brief Move the groups created in a GAL returned by CreateStage() to this GAL.
+     *
+     * @param aStage is the GAL the groups were created in, it is left empty.
+     * @param aGroups receives the numbers of the groups in this GAL, indexed by their numbers
+     * in aStage.
+     */
+    virtual void MergeStage( GAL* aStage, std::vector<int>& aGroups ) {};
+
     // --------------------------------------------------------
     // Handling the world <-> screen transformation
     // --------------------------------------------------------
@@ -639,6 +659,33 @@ public:
      */
     virtual void ClearTarget( RENDER_TARGET aTarget ) {};
 
+    /**
+     * @brief Tells if the contents of the cached and noncached targets are kept between frames,
+     * so they may be cleared and redrawn only partially (see SetRedrawArea()).
+     *
+     * @return True if the targets are persistent.
+     */
+    virtual bool HasPersistentTargets() const { return false; };
+
+    /**
+     * @brief Restricts clearing and drawing on the cached and noncached targets to a set of
+     * rectangles for the next frame. Has to be called before BeginDrawing(), the restriction
+     * is removed by EndDrawing(). An empty set means the whole screen.
+     *
+     * @param aArea is the set of rectangles, in screen coordinates.
+     */
+    virtual void SetRedrawArea( const std::vector<BOX2I>& aArea ) {};
+
+    /**
+     * @brief Moves the contents of the cached and noncached targets, after the view was panned
+     * by a whole number of pixels. The uncovered parts of the targets have to be redrawn.
+     * Has to be called outside of BeginDrawing() / EndDrawing().
+     *
+     * @param aDelta is the displacement, in pixels.
+     * @return False if the targets could not be moved and have to be redrawn entirely.
+     */
+    virtual bool ScrollTargets( const VECTOR2I& aDelta ) { return false; };
+
     // -------------
     // Grid methods
     // -------------
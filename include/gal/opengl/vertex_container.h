@@ -40,11 +40,15 @@ class SHADER;
 class VERTEX_CONTAINER
 {
 public:
+    ///< Default initial size of a container (expressed in vertices)
+    static const unsigned int defaultInitSize = 1048576;
+
     /**
      * Function MakeContainer()
      * Returns a pointer to a new container of an appropriate type.
+     * @param aSize is the initial size of the container (expressed in vertices).
      */
-    static VERTEX_CONTAINER* MakeContainer( bool aCached );
+    static VERTEX_CONTAINER* MakeContainer( bool aCached, unsigned int aSize = defaultInitSize );
 
     virtual ~VERTEX_CONTAINER();
 
@@ -167,9 +171,6 @@ protected:
     {
         return m_currentSize - m_freeSpace;
     }
-
-    ///< Default initial size of a container (expressed in vertices)
-    static const unsigned int defaultInitSize = 1048576;
 };
 } // namespace KIGFX
 
@@ -35,6 +35,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/glm.hpp>
 #include <gal/opengl/vertex_common.h>
+#include <gal/opengl/vertex_container.h>
 #include <gal/color4d.h>
 #include <stack>
 #include <memory>
@@ -44,7 +45,6 @@ namespace KIGFX
 {
 class SHADER;
 class VERTEX_ITEM;
-class VERTEX_CONTAINER;
 class GPU_MANAGER;
 
 class VERTEX_MANAGER
@@ -55,8 +55,9 @@ public:
      *
      * @param aCached says if vertices should be cached in GPU or system memory. For data that
      * does not change every frame, it is better to store vertices in GPU memory.
+     * @param aSize is the initial size of the container (expressed in vertices).
      */
-    VERTEX_MANAGER( bool aCached );
+    VERTEX_MANAGER( bool aCached, unsigned int aSize = VERTEX_CONTAINER::defaultInitSize );
 
     /**
      * Function Vertex()
@@ -96,6 +97,17 @@ public:
      */
     void Vertices( const VERTEX aVertices[], unsigned int aSize ) const;
 
+    /**
+     * Function PutVertices()
+     * adds vertices to the currently set item as they are: their color, shader parameters and
+     * coordinates are kept, the current transformation matrix is not applied. It is used to move
+     * items between managers.
+     *
+     * @param aVertices contains vertices to be added
+     * @param aSize is the number of vertices to be added.
+     */
+    void PutVertices( const VERTEX aVertices[], unsigned int aSize ) const;
+
     /**
      * Function Color()
      * changes currently used color that will be applied to newly added vertices.
@@ -0,0 +1,108 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __SEG_BATCH_H
+#define __SEG_BATCH_H
+
+#include <vector>
+
+#include <geometry/seg.h>
+
+class SHAPE_LINE_CHAIN;
+
+/**
+ * Class SEG_BATCH
+ *
+ * A set of segments stored as a structure of arrays: the bounding boxes of the segments
+ * are kept in separate arrays of coordinates, so that a segment can be tested against
+ * several segments of the batch at once with SIMD instructions (AVX when built with
+ * KICAD_USE_AVX2, SSE2 on x86-64, plain C++ elsewhere).
+ *
+ * The vector code only rejects the segments lying too far away. The remaining ones are
+ * tested by the exact integer code of SEG and BOX2I, so the results are the same as those
+ * of the segment by segment loops of SHAPE_LINE_CHAIN.
+ */
+class SEG_BATCH
+{
+public:
+    SEG_BATCH() {}
+
+    SEG_BATCH( const SHAPE_LINE_CHAIN& aChain )
+    {
+        Add( aChain );
+    }
+
+    void Clear();
+    void Reserve( int aCount );
+
+    void Add( const SEG& aSeg );
+
+    ///> Adds all segments of a line chain
+    void Add( const SHAPE_LINE_CHAIN& aChain );
+
+    int Size() const
+    {
+        return m_segs.size();
+    }
+
+    const SEG& Segment( int aIndex ) const
+    {
+        return m_segs[aIndex];
+    }
+
+    /**
+     * Function Collide()
+     * Looks for a segment of the batch colliding with aSeg, with the same test as
+     * SHAPE_LINE_CHAIN::Collide( const SEG&, int ): the bounding boxes of the segments
+     * must be closer than aClearance, and SEG::Collide() must report a collision.
+     * @param aSeg is the segment to test.
+     * @param aClearance is the minimum distance between the segments.
+     * @param aFirst is the index of the first segment of the batch to test.
+     * @return the index of the first colliding segment, -1 if there is none.
+     */
+    int Collide( const SEG& aSeg, int aClearance, int aFirst = 0 ) const;
+
+    /**
+     * Function Candidates()
+     * Finds the segments of the batch whose bounding box is not farther than aMargin from
+     * the bounding box of aSeg along any axis.
+     * @param aIndices receives the indices of the segments, in increasing order.
+     * @return the number of segments found.
+     */
+    int Candidates( const SEG& aSeg, int aMargin, std::vector<int>& aIndices ) const;
+
+private:
+    ///> Returns the index of the first segment from aFirst which bounding box is within
+    ///> aMargin of aBox (xmin, xmax, ymin, ymax), -1 if there is none
+    int nextCandidate( const double aBox[4], double aMargin, int aFirst ) const;
+
+    std::vector<SEG> m_segs;
+
+    ///> bounding boxes, padded to a multiple of the vector width with empty entries
+    std::vector<double> m_xMin;
+    std::vector<double> m_xMax;
+    std::vector<double> m_yMin;
+    std::vector<double> m_yMax;
+};
+
+#endif    // __SEG_BATCH_H
@@ -0,0 +1,160 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __SEG_TREE_H
+#define __SEG_TREE_H
+
+#include <algorithm>
+#include <vector>
+
+#include <math/box2.h>
+#include <geometry/seg.h>
+
+class SHAPE_LINE_CHAIN;
+
+/**
+ * Class SEG_TREE
+ *
+ * A bounding volume hierarchy over the edges of a line chain, built once and never
+ * modified. The edges are those of the chain taken as a polygon: the segment joining the
+ * last point to the first one is indexed even if the chain is not closed, so the callers
+ * which need the segments of an open chain only must skip its index (PointCount() - 1).
+ *
+ * The nodes are stored depth first in a single array: the first child of a node follows
+ * it, the index of the second one is stored in the node.
+ */
+class SEG_TREE
+{
+public:
+    ///> Line chains with fewer segments are faster to scan than to index
+    static const int MIN_SEGMENTS = 32;
+
+    SEG_TREE( const SHAPE_LINE_CHAIN& aChain );
+
+    ///> Returns the bounding box of all edges
+    const BOX2I BBox() const;
+
+    int EdgeCount() const
+    {
+        return m_edges.size();
+    }
+
+    const SEG& Edge( int aIndex ) const
+    {
+        return m_edges[aIndex];
+    }
+
+    /**
+     * Function Query()
+     * Calls aVisitor for each edge whose bounding box overlaps the box [aMin, aMax]
+     * (bounds included), in no particular order. The visitor is called with the edge
+     * (a SEG carrying its index) and returns false to stop the search.
+     * @return false if the search was stopped by the visitor.
+     */
+    template <class VISITOR>
+    bool Query( const VECTOR2I& aMin, const VECTOR2I& aMax, VISITOR& aVisitor ) const
+    {
+        int stack[MAX_DEPTH];
+        int top = 0;
+
+        if( m_nodes.empty() )
+            return true;
+
+        stack[top++] = 0;
+
+        while( top > 0 )
+        {
+            const NODE& node = m_nodes[stack[--top]];
+
+            if( node.m_max.x < aMin.x || node.m_min.x > aMax.x ||
+                node.m_max.y < aMin.y || node.m_min.y > aMax.y )
+                continue;
+
+            if( node.m_count > 0 )
+            {
+                for( int i = node.m_first; i < node.m_first + node.m_count; i++ )
+                {
+                    const SEG& edge = m_edges[m_order[i]];
+
+                    if( std::max( edge.A.x, edge.B.x ) < aMin.x ||
+                        std::min( edge.A.x, edge.B.x ) > aMax.x ||
+                        std::max( edge.A.y, edge.B.y ) < aMin.y ||
+                        std::min( edge.A.y, edge.B.y ) > aMax.y )
+                        continue;
+
+                    if( !aVisitor( edge ) )
+                        return false;
+                }
+            }
+            else
+            {
+                stack[top++] = node.m_first;
+                stack[top++] = &node - &m_nodes[0] + 1;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Function Nearest()
+     * Finds the edge nearest to aP among the edges [0, aCount), with the distance
+     * computed by SEG::Distance(). Among edges at the same distance, the one with the
+     * lowest index is returned, as the linear scans of SHAPE_LINE_CHAIN do.
+     * @param aDist receives the distance of the edge.
+     * @return the index of the edge, -1 if there is none.
+     */
+    int Nearest( const VECTOR2I& aP, int aCount, int& aDist ) const;
+
+private:
+    ///> Maximum edges in a leaf
+    static const int LEAF_SIZE = 4;
+
+    ///> Depth of the stack used to walk the tree, enough for any 32-bit edge count
+    static const int MAX_DEPTH = 64;
+
+    struct NODE
+    {
+        VECTOR2I m_min;
+        VECTOR2I m_max;
+
+        ///> first edge in m_order (leaves) or index of the second child (inner nodes)
+        int m_first;
+
+        ///> number of edges, 0 for inner nodes
+        int m_count;
+    };
+
+    int build( int aFirst, int aCount );
+
+    void nearest( int aNode, const VECTOR2I& aP, int aCount, int& aBest, int& aDist ) const;
+
+    std::vector<SEG> m_edges;
+
+    ///> edge indices, grouped by leaf
+    std::vector<int> m_order;
+
+    std::vector<NODE> m_nodes;
+};
+
+#endif    // __SEG_TREE_H
@@ -27,6 +27,7 @@
 
 #include <vector>
 #include <sstream>
+#include <memory>
 
 #include <boost/optional.hpp>
 
@@ -34,6 +35,8 @@
 #include <geometry/shape.h>
 #include <geometry/seg.h>
 
+class SEG_TREE;
+
 /**
  * Class SHAPE_LINE_CHAIN
  *
@@ -79,9 +82,25 @@ public:
      * Copy Constructor
      */
     SHAPE_LINE_CHAIN( const SHAPE_LINE_CHAIN& aShape ) :
-        SHAPE( SH_LINE_CHAIN ), m_points( aShape.m_points ), m_closed( aShape.m_closed )
+        SHAPE( SH_LINE_CHAIN ), m_points( aShape.m_points ), m_closed( aShape.m_closed ),
+        m_segTree( std::atomic_load( &aShape.m_segTree ) )
     {}
 
+    /**
+     * Assignment operator
+     * Like the copy constructor, reads the edge tree of aShape atomically, because
+     * SegmentTree() can store it from another thread at the same time.
+     */
+    SHAPE_LINE_CHAIN& operator=( const SHAPE_LINE_CHAIN& aShape )
+    {
+        m_points = aShape.m_points;
+        m_closed = aShape.m_closed;
+        m_bbox = aShape.m_bbox;
+        m_segTree = std::atomic_load( &aShape.m_segTree );
+
+        return *this;
+    }
+
     /**
      * Constructor
      * Initializes a 2-point line chain (a single segment)
@@ -137,6 +156,7 @@ public:
     {
         m_points.clear();
         m_closed = false;
+        invalidateTree();
     }
 
     /**
@@ -149,6 +169,7 @@ public:
     void SetClosed( bool aClosed )
     {
         m_closed = aClosed;
+        invalidateTree();
     }
 
     /**
@@ -192,12 +213,15 @@ public:
      *
      * Returns a segment referencing to the segment (index) in the line chain.
      * Modifying ends of the returned segment will modify corresponding points in the line chain.
+     * The returned segment must not be modified after another query on the line chain.
      * @param aIndex: index of the segment in the line chain. Negative values are counted from
      * the end (i.e. -1 means the last segment in the line chain)
      * @return SEG referenced to given segment in the line chain
      */
     SEG Segment( int aIndex )
     {
+        invalidateTree();
+
         if( aIndex < 0 )
             aIndex += SegmentCount();
 
@@ -231,12 +255,15 @@ public:
     /**
      * Function Point()
      *
-     * Returns a reference to a given point in the line chain.
+     * Returns a reference to a given point in the line chain. The point must not be
+     * modified through the reference after another query on the line chain.
      * @param aIndex index of the point
      * @return reference to the point
      */
     VECTOR2I& Point( int aIndex )
     {
+        invalidateTree();
+
         if( aIndex < 0 )
             aIndex += PointCount();
 
@@ -345,6 +372,7 @@ public:
         {
             m_points.push_back( aP );
             m_bbox.Merge( aP );
+            invalidateTree();
         }
     }
 
@@ -359,7 +387,9 @@ public:
         if( aOtherLine.PointCount() == 0 )
             return;
 
-        else if( PointCount() == 0 || aOtherLine.CPoint( 0 ) != CPoint( -1 ) )
+        invalidateTree();
+
+        if( PointCount() == 0 || aOtherLine.CPoint( 0 ) != CPoint( -1 ) )
         {
             const VECTOR2I p = aOtherLine.CPoint( 0 );
             m_points.push_back( p );
@@ -377,6 +407,7 @@ public:
     void Insert( int aVertex, const VECTOR2I& aP )
     {
         m_points.insert( m_points.begin() + aVertex, aP );
+        invalidateTree();
     }
 
     /**
@@ -507,6 +538,16 @@ public:
      */
      bool PointInside( const VECTOR2I& aP ) const;
 
+    /**
+     * Function PointInPolygon()
+     *
+     * Checks if point aP lies inside the polygon (convex or not) defined by the line
+     * chain, with the even-odd rule. The line chain is taken as closed.
+     * @param aP point to check
+     * @return true if the point is inside the polygon or on its edge.
+     */
+    bool PointInPolygon( const VECTOR2I& aP ) const;
+
     /**
      * Function PointOnEdge()
      *
@@ -577,6 +618,8 @@ public:
     {
         for( std::vector<VECTOR2I>::iterator i = m_points.begin(); i != m_points.end(); ++i )
             (*i) += aVector;
+
+        invalidateTree();
     }
 
     bool IsSolid() const
@@ -584,7 +627,27 @@ public:
         return false;
     }
 
+    /**
+     * Function SegmentTree()
+     *
+     * Returns the bounding volume hierarchy of the edges of the line chain, built by the
+     * first query after a change of the line chain. The distance, collision and point in
+     * polygon queries use it, so that they don't scan every segment. Copies of the line
+     * chain share the tree until they are changed.
+     * @return the tree, or an empty pointer for line chains with fewer than
+     * SEG_TREE::MIN_SEGMENTS points, which are scanned instead.
+     */
+    std::shared_ptr<const SEG_TREE> SegmentTree() const;
+
 private:
+    ///> Tests segments aS1 and aS2 (aS1 < aS2) for a self-intersection, fills aIs if found
+    bool selfIntersection( int aS1, int aS2, INTERSECTION& aIs ) const;
+
+    void invalidateTree()
+    {
+        m_segTree.reset();
+    }
+
     /// array of vertices
     std::vector<VECTOR2I> m_points;
 
@@ -593,6 +656,9 @@ private:
 
     /// cached bounding box
     BOX2I m_bbox;
+
+    /// edge tree, built on demand by SegmentTree() (shared by copies, reset on changes)
+    mutable std::shared_ptr<const SEG_TREE> m_segTree;
 };
 
 #endif // __SHAPE_LINE_CHAIN
@@ -289,6 +289,17 @@ class SHAPE_POLY_SET : public SHAPE
         void BooleanIntersection( const SHAPE_POLY_SET& a, const SHAPE_POLY_SET& b,
                                   POLYGON_MODE aFastMode );
 
+        /**
+         * Function SetTileCount()
+         * Sets the number of vertical strips the boolean operations (and the inflation)
+         * of large polygon sets are split into. Each strip is computed by its own thread,
+         * then the polygons crossing the strip borders are merged.
+         * @param aTiles is the number of strips: 1 disables the tiling, 0 (default) uses one
+         * strip per thread, for operands of at least TILING_MIN_VERTICES vertices, outside
+         * of parallel regions only. Other values force the tiling, whatever the operands are.
+         */
+        static void SetTileCount( int aTiles );
+
         ///> Performs outline inflation/deflation, using round corners.
         void Inflate( int aFactor, int aCircleSegmentsCount );
 
@@ -348,7 +359,18 @@ class SHAPE_POLY_SET : public SHAPE
         ///> Deletes aIdx-th polygon from the set
         void DeletePolygon( int aIdx );
 
+        ///> Exchanges the polygons with the ones of aOther, without copying them
+        void Swap( SHAPE_POLY_SET& aOther )
+        {
+            m_polys.swap( aOther.m_polys );
+        }
+
     private:
+        ///> Operands with fewer vertices are not tiled in the automatic mode
+        static const int TILING_MIN_VERTICES = 20000;
+
+        ///> Half width of the band along each border computed by both neighbour strips
+        static const int TILING_OVERLAP = 100;
 
         SHAPE_LINE_CHAIN& getContourForCorner( int aCornerId, int& aIndexWithinContour );
         VECTOR2I& vertex( int aCornerId );
@@ -376,10 +398,30 @@ class SHAPE_POLY_SET : public SHAPE
                         const SHAPE_POLY_SET& aShape,
                         const SHAPE_POLY_SET& aOtherShape, POLYGON_MODE aFastMode );
 
+        /**
+         * Function booleanOpTiled
+         * Computes booleanOp() on overlapping vertical strips of the operands, in parallel,
+         * and merges the polygons of the strips reaching the overlaps.
+         * @param aTiles is the number of strips.
+         * @return false if the operands can't be split, the result is not set then.
+         */
+        bool booleanOpTiled( ClipperLib::ClipType aType,
+                             const SHAPE_POLY_SET& aShape,
+                             const SHAPE_POLY_SET& aOtherShape, POLYGON_MODE aFastMode,
+                             int aTiles );
+
+        ///> Inflates groups of neighbour polygons in parallel, then merges them (aFactor > 0)
+        ///> @return false if the set can't be split, it is left untouched then.
+        bool inflateTiled( int aFactor, double aArcTolerance, int aTiles );
+
+        ///> Returns the number of strips booleans on the operands are split into
+        static int tileCount( const SHAPE_POLY_SET& aShape, const SHAPE_POLY_SET& aOtherShape );
+
         bool pointInPolygon( const VECTOR2I& aP, const SHAPE_LINE_CHAIN& aPath ) const;
 
-        const ClipperLib::Path convertToClipper( const SHAPE_LINE_CHAIN& aPath, bool aRequiredOrientation );
-        const SHAPE_LINE_CHAIN convertFromClipper( const ClipperLib::Path& aPath );
+        static const ClipperLib::Path convertToClipper( const SHAPE_LINE_CHAIN& aPath,
+                                                        bool aRequiredOrientation );
+        static const SHAPE_LINE_CHAIN convertFromClipper( const ClipperLib::Path& aPath );
 
         typedef std::vector<POLYGON> Polyset;
 
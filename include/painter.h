@@ -290,6 +290,32 @@ public:
      */
     virtual RENDER_SETTINGS* GetSettings() = 0;
 
+    /**
+     * Function Clone
+     * Returns a new painter with the same settings, drawing to another GAL. It is used to draw
+     * items from several threads at once, each of them with its own painter and GAL.
+     * @param aGal is the GAL the new painter draws to.
+     * @return The new painter (owned by the caller) or NULL if the painter cannot be copied.
+     */
+    virtual PAINTER* Clone( GAL* aGal ) const
+    {
+        return NULL;
+    }
+
+    /**
+     * Function PrepareDraw
+     * Is called on the main thread for every item before it is drawn by a clone of the painter
+     * on a worker thread. It computes the item data cached on demand that is read by Draw(), so
+     * the worker threads only read the items.
+     * @param aItem is the item to be drawn.
+     * @return false if the item cannot be drawn by a painter clone and has to be drawn on the
+     * main thread instead (e.g. it is drawn with VIEW_ITEM::ViewDraw()).
+     */
+    virtual bool PrepareDraw( const VIEW_ITEM* aItem ) const
+    {
+        return false;
+    }
+
     /**
      * Function Draw
      * Takes an instance of VIEW_ITEM and passes it to a function that know how to draw the item.
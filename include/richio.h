@@ -253,6 +253,21 @@ public:
      */
     virtual char* ReadLine() throw( IO_ERROR ) = 0;
 
+    /**
+     * Function ReadLineView
+     * reads a line of text like ReadLine() does, but may return it straight from the
+     * storage of the reader instead of copying it into the line buffer.  The returned
+     * text is <b>not</b> nul terminated: only Length() bytes are valid, and they must
+     * not be modified.  Line() is not updated by a reader which returns a view.
+     * The text is valid at least until the next read.
+     * @return const char* - The beginning of the read line, or NULL if EOF.
+     * @throw IO_ERROR when a line is too long.
+     */
+    virtual const char* ReadLineView() throw( IO_ERROR )
+    {
+        return ReadLine();
+    }
+
     /**
      * Function GetSource
      * returns the name of the source of the lines in an abstract sense.
@@ -302,6 +317,16 @@ public:
     {
         return length;
     }
+
+    /**
+     * Function RemainingLength
+     * returns the number of bytes which are not read yet, or -1 if the reader
+     * cannot tell it without reading them.
+     */
+    virtual long RemainingLength() const
+    {
+        return -1;
+    }
 };
 
 
@@ -367,6 +392,8 @@ public:
 
     char* ReadLine() throw( IO_ERROR );   // see LINE_READER::ReadLine() description
 
+    long RemainingLength() const;       // see LINE_READER::RemainingLength() description
+
     /**
      * Function Rewind
      * rewinds the file and resets the line number back to zero.  Line number
@@ -380,6 +407,100 @@ public:
 };
 
 
+/**
+ * Class MEMORY_LINE_READER
+ * is a LINE_READER that reads the lines of a memory buffer owned by the caller, which
+ * must stay unchanged while the reader is used.  Lines are handed out from ReadLineView()
+ * without copying them.  ReadLine() still copies the line into the nul terminated line
+ * buffer, for the users which need it.
+ */
+class MEMORY_LINE_READER : public LINE_READER
+{
+protected:
+    const char* buf;        ///< the text, not nul terminated.
+    size_t      bufLen;     ///< no. bytes in buf.
+    size_t      ndx;        ///< offset in buf of the next line.
+
+public:
+
+    /**
+     * Constructor MEMORY_LINE_READER
+     *
+     * @param aBuffer is the text to read, which is not copied.
+     * @param aLength is the no. bytes of @a aBuffer.
+     * @param aSource describes the text, for error reporting purposes.
+     *
+     * @param aStartingLineNumber is the initial line number to report on error.
+     *  Internally it is incremented by one after each read, so the first
+     *  reported line number will always be one greater than what is provided here.
+     *
+     * @param aMaxLineLength is the maximum allowed line length.
+     */
+    MEMORY_LINE_READER( const char* aBuffer, size_t aLength, const wxString& aSource,
+            unsigned aStartingLineNumber = 0,
+            unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX );
+
+    char* ReadLine() throw( IO_ERROR );   // see LINE_READER::ReadLine() description
+
+    const char* ReadLineView() throw( IO_ERROR );  // see LINE_READER::ReadLineView() description
+
+    long RemainingLength() const        // see LINE_READER::RemainingLength() description
+    {
+        return bufLen - ndx;
+    }
+
+    /**
+     * Function Rewind
+     * goes back to the start of the text and resets the line number back to zero.
+     * Line number will go to 1 on first read.
+     */
+    void Rewind()
+    {
+        ndx = 0;
+        lineNum = 0;
+    }
+};
+
+
+/**
+ * Class MMAP_LINE_READER
+ * is a MEMORY_LINE_READER that maps a whole file into memory.
+ * <p>
+ * On platforms without mmap(), and for files under 1 MB such as footprints and library
+ * tables, the file is read into memory at once.  A mapped file must not be truncated
+ * while it is read: on POSIX systems, reading a page beyond the new end of the file
+ * raises SIGBUS.  Files which another program may rewrite in place must be read with
+ * a FILE_LINE_READER.
+ */
+class MMAP_LINE_READER : public MEMORY_LINE_READER
+{
+protected:
+    bool        mapped;     ///< true if buf is mapped, else allocated with new[].
+
+public:
+
+    /**
+     * Constructor MMAP_LINE_READER
+     * maps @a aFileName into memory.  The file itself is closed before returning.
+     *
+     * @param aFileName is the name of the file to map and to use for error reporting purposes.
+     *
+     * @param aStartingLineNumber is the initial line number to report on error.
+     *  Internally it is incremented by one after each read, so the first
+     *  reported line number will always be one greater than what is provided here.
+     *
+     * @param aMaxLineLength is the maximum allowed line length.
+     *
+     * @throw IO_ERROR if @a aFileName cannot be opened or read.
+     */
+    MMAP_LINE_READER( const wxString& aFileName,
+            unsigned aStartingLineNumber = 0,
+            unsigned aMaxLineLength = LINE_READER_LINE_DEFAULT_MAX ) throw( IO_ERROR );
+
+    ~MMAP_LINE_READER();
+};
+
+
 /**
  * Class STRING_LINE_READER
  * is a LINE_READER that reads from a multiline 8 bit wide std::string
@@ -413,6 +534,11 @@ public:
     STRING_LINE_READER( const STRING_LINE_READER& aStartingPoint );
 
     char* ReadLine() throw( IO_ERROR );    // see LINE_READER::ReadLine() description
+
+    long RemainingLength() const           // see LINE_READER::RemainingLength() description
+    {
+        return lines.length() - ndx;
+    }
 };
 
 
@@ -529,6 +655,19 @@ public:
      */
     int PRINTF_FUNC Print( int nestLevel, const char* fmt, ... ) throw( IO_ERROR );
 
+    /**
+     * Function Write
+     * writes a byte buffer to the output stream as is, without the copy made by Print().
+     *
+     * @param aOutBuf is the start of the buffer to write.
+     * @param aCount tells how many bytes to write.
+     * @throw IO_ERROR, if there is a problem outputting, such as a full disk.
+     */
+    void Write( const char* aOutBuf, int aCount ) throw( IO_ERROR )
+    {
+        write( aOutBuf, aCount );
+    }
+
     /**
      * Function GetQuoteChar
      * performs quote character need determination.
@@ -31,6 +31,7 @@
 #include <unordered_map>
 
 #include <math/box2.h>
+#include <math/matrix3x3.h>
 #include <gal/definitions.h>
 
 namespace KIGFX
@@ -449,6 +450,15 @@ public:
      */
     void UpdateAllLayersOrder();
 
+    /**
+     * Function PrepareTargets()
+     * Limits the next frame to the tiles of the screen that have changed since the previous
+     * one, if the GAL keeps the contents of its targets (see GAL::HasPersistentTargets()).
+     * The targets are scrolled if the view was panned. Has to be called before
+     * GAL::BeginDrawing().
+     */
+    void PrepareTargets();
+
     /**
      * Function ClearTargets()
      * Clears targets that are marked as dirty.
@@ -457,7 +467,7 @@ public:
 
     /**
      * Function Redraw()
-     * Immediately redraws the whole view.
+     * Immediately redraws the whole view, or the area set by PrepareTargets().
      */
     void Redraw();
 
@@ -469,6 +479,20 @@ public:
      */
     void RecacheAllItems( bool aForceNow = false );
 
+    /**
+     * Function SetParallelCaching()
+     * Enables tessellating items on several threads when many of them are recached at once
+     * (RecacheAllItems(), UpdateItems()). Each thread draws with its own copy of the painter
+     * (see PAINTER::Clone()) to its own GAL stage (see GAL::CreateStage()), the stages are merged
+     * to the GAL cache afterwards. It may be enabled only if the items can be drawn concurrently;
+     * a single item is always drawn by one thread.
+     * @param aEnabled tells if the items may be tessellated on several threads.
+     */
+    void SetParallelCaching( bool aEnabled )
+    {
+        m_parallelCaching = aEnabled;
+    }
+
     /**
      * Function IsDynamic()
      * Tells if the VIEW is dynamic (ie. can be changed, for example displaying PCBs in a window)
@@ -505,6 +529,10 @@ public:
     {
         wxASSERT( aTarget < TARGETS_NUMBER );
 
+        // Changed areas are tracked for the cached and noncached targets only
+        if( aTarget != TARGET_OVERLAY && ( !m_dirtyAreas.empty() || !m_redrawArea.empty() ) )
+            return true;
+
         return m_dirtyTargets[aTarget];
     }
 
@@ -565,6 +593,8 @@ public:
 
     static const int VIEW_MAX_LAYERS = 256;      ///< maximum number of layers that may be shown
 
+    static const int DIRTY_TILE_SIZE = 64;       ///< size of the tiles redrawn separately, in pixels
+
 private:
     struct VIEW_LAYER
     {
@@ -586,6 +616,7 @@ private:
     // Function objects that need to access VIEW/VIEW_ITEM private/protected members
     struct clearLayerCache;
     struct recacheItem;
+    struct collectItem;
     struct drawItem;
     struct unlinkItem;
     struct updateItemsColor;
@@ -603,6 +634,15 @@ private:
         m_dirtyTargets[aTarget] = false;
     }
 
+    /**
+     * Function markAreaDirty()
+     * Marks an area of a target to be redrawn. The whole target is marked dirty if the GAL
+     * is not able to redraw it partially.
+     * @param aTarget is the target.
+     * @param aArea is the area, in world coordinates.
+     */
+    void markAreaDirty( int aTarget, const BOX2I& aArea );
+
     /**
      * Function draw()
      * Draws an item, but on a specified layers. It has to be marked that some of drawing settings
@@ -647,8 +687,11 @@ private:
      * Manages dirty flags & redraw queueing when updating an item.
      * @param aItem is the item to be updated.
      * @param aUpdateFlags determines the way an item is refreshed.
+     * @param aRecached if not NULL, receives the item instead of updating its geometry, so the
+     * geometry of several items may be updated at once.
      */
-    void invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags );
+    void invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags,
+                         std::vector<VIEW_ITEM*>* aRecached = NULL );
 
     /// Updates colors that are used for an item to be drawn
     void updateItemColor( VIEW_ITEM* aItem, int aLayer );
@@ -656,6 +699,15 @@ private:
     /// Updates all informations needed to draw an item
     void updateItemGeometry( VIEW_ITEM* aItem, int aLayer );
 
+    /**
+     * Function recacheParallel()
+     * Redraws the cached groups of items on several threads, if parallel caching is enabled and
+     * supported by the GAL and the painter.
+     * @param aItems are the items to be redrawn, each of them listed once.
+     * @return false if nothing was done, the items have to be redrawn by updateItemGeometry().
+     */
+    bool recacheParallel( const std::vector<VIEW_ITEM*>& aItems );
+
     /// Updates bounding box of an item
     void updateBbox( VIEW_ITEM* aItem );
 
@@ -711,6 +763,30 @@ private:
     /// Flags to mark targets as dirty, so they have to be redrawn on the next refresh event
     bool m_dirtyTargets[TARGETS_NUMBER];
 
+    /// Areas of the cached and noncached targets to be redrawn, in world coordinates
+    std::vector<BOX2I> m_dirtyAreas;
+
+    /// Tiles redrawn in the current frame, in screen coordinates (empty if the whole screen)
+    std::vector<BOX2I> m_redrawArea;
+
+    /// World to screen transformation the cached and noncached targets were drawn with
+    MATRIX3x3D m_drawnMatrix;
+
+    /// Screen size the cached and noncached targets were drawn with
+    VECTOR2I m_drawnScreenSize;
+
+    /// Above this count, changed areas are not tracked and the targets are redrawn entirely
+    static const int MAX_DIRTY_AREAS = 4096;
+
+    /// Items may be drawn slightly outside of their bounding boxes (antialiasing)
+    static const int DIRTY_AREA_MARGIN = 2;
+
+    /// Are the items tessellated on several threads, when possible?
+    bool m_parallelCaching;
+
+    /// Fewer items are recached faster by a single thread
+    static const int MIN_PARALLEL_ITEMS = 512;
+
     /// Rendering order modifier for layers that are marked as top layers
     static const int TOP_LAYER_MODIFIER;
 
@@ -304,6 +304,19 @@ protected:
     /// Stores layer numbers used by the item.
     std::bitset<VIEW::VIEW_MAX_LAYERS> m_layers;
 
+    /// Bounding box the item is indexed with, so the area it covers may be redrawn after a change.
+    BOX2I m_viewBBox;
+
+    /**
+     * Function saveBBox()
+     * Saves the bounding box the item is indexed with.
+     */
+    void saveBBox()
+    {
+        m_viewBBox = ViewBBox();
+        m_viewBBox.Normalize();
+    }
+
     /**
      * Function saveLayers()
      * Saves layers used by the item.
@@ -65,6 +65,7 @@ class REPORTER;
 struct PARSE_ERROR;
 struct IO_ERROR;
 class FP_LIB_TABLE;
+class wxProgressDialog;
 
 namespace PCB { struct IFACE; }     // KIFACE_I is in pcbnew.cpp
 
@@ -189,6 +190,20 @@ protected:
      */
     void duplicateZone( wxDC* aDC, ZONE_CONTAINER* aZone );
 
+    /**
+     * Function fillZonesInParallel
+     * fills all zones (but keepout zones) of the board, calculating the filled areas
+     * of several zones at the same time on worker threads, and commits the results
+     * in priority order. The filled areas are the same as when zones are filled
+     * one by one by Fill_Zone().
+     * Used by Fill_All_Zones().
+     * @param aProgressDialog = the progress bar to update, or NULL
+     * @param aErrors = receives a message for each zone which cannot be filled.
+     *  The messages are created after the parallel fill, on the calling thread.
+     * @return the count of filled zones (less than the zone count if the fill was aborted)
+     */
+    int fillZonesInParallel( wxProgressDialog* aProgressDialog, wxArrayString& aErrors );
+
     /**
      * Function moveExact
      * Move the selected item exactly
@@ -526,6 +541,14 @@ public:
     TRACK * OnHotkeyBeginRoute( wxDC* aDC );
 
     void OnCloseWindow( wxCloseEvent& Event );
+
+    /**
+     * Function OnIdle
+     * runs the incremental DRC (see DRC::RunIncrementalTests()) when items were changed
+     * since the last DRC run and no edit is in progress.
+     */
+    void OnIdle( wxIdleEvent& aEvent );
+
     void Process_Special_Functions( wxCommandEvent& event );
     void Tracks_and_Vias_Size_Event( wxCommandEvent& event );
     void OnSelectTool( wxCommandEvent& aEvent );
@@ -43,6 +43,7 @@
 #include <class_edge_mod.h>
 
 #include <ratsnest_data.h>
+#include <drc_stuff.h>
 
 #include <tools/selection_tool.h>
 #include <tool/tool_manager.h>
@@ -98,6 +99,14 @@
  *      mirror (Y) and flip list of items (undo/redo is made by mirror or flip items)
  *      so they are handled specifically.
  *
+ *   Zones hold their outline and their filled areas, which can be much larger.  An edit
+ *   changing only one of them saves only that part:
+ *      UR_ZONE_OUTLINE: the copy has no filled areas, undo/redo exchanges all but them
+ *      UR_ZONE_FILL: undo/redo exchanges only the filled areas with the ones of the copy
+ *
+ *   The undo and redo lists are kept within a memory budget (BASE_SCREEN::SetMaxUndoSize()),
+ *   using the estimated size of the copies they hold, see setUndoImageSize().
+ *
  */
 
 
@@ -307,6 +316,150 @@ void BOARD_ITEM::SwapData( BOARD_ITEM* aImage )
 }
 
 
+bool BOARD_ITEM::UndoRedoPicked( UNDO_REDO_T aStatus, BOARD_ITEM* aImage,
+                                 const wxPoint& aTransformPoint, double aRotationAngle,
+                                 bool aRedo )
+{
+    switch( aStatus )
+    {
+    case UR_CHANGED:
+        SwapData( aImage );
+        break;
+
+    case UR_ZONE_OUTLINE:
+        wxASSERT( Type() == PCB_ZONE_AREA_T && aImage->Type() == PCB_ZONE_AREA_T );
+        static_cast<ZONE_CONTAINER*>( this )->SwapOutline( static_cast<ZONE_CONTAINER*>( aImage ) );
+        break;
+
+    case UR_ZONE_FILL:
+        wxASSERT( Type() == PCB_ZONE_AREA_T && aImage->Type() == PCB_ZONE_AREA_T );
+        static_cast<ZONE_CONTAINER*>( this )->SwapFill( static_cast<ZONE_CONTAINER*>( aImage ) );
+        break;
+
+    case UR_MOVED:
+        Move( aRedo ? aTransformPoint : -aTransformPoint );
+        break;
+
+    case UR_ROTATED:
+        Rotate( aTransformPoint, aRedo ? aRotationAngle : -aRotationAngle );
+        break;
+
+    case UR_ROTATED_CLOCKWISE:
+        Rotate( aTransformPoint, aRedo ? -aRotationAngle : aRotationAngle );
+        break;
+
+    case UR_FLIPPED:
+        Flip( aTransformPoint );
+        break;
+
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+
+/* Returns the estimated size in bytes of aItem, a copy held by an undo/redo command. */
+static size_t undoImageSize( const BOARD_ITEM* aItem )
+{
+    switch( aItem->Type() )
+    {
+    case PCB_MODULE_T:
+    {
+        const MODULE* module = static_cast<const MODULE*>( aItem );
+        size_t size = sizeof( MODULE ) + 2 * sizeof( TEXTE_MODULE );    // reference and value
+
+        size += module->Pads().GetCount() * sizeof( D_PAD );
+
+        for( const BOARD_ITEM* item = module->GraphicalItems(); item; item = item->Next() )
+        {
+            if( item->Type() == PCB_MODULE_EDGE_T )
+                size += sizeof( EDGE_MODULE ) + sizeof( wxPoint ) *
+                        static_cast<const EDGE_MODULE*>( item )->GetPolyPoints().size();
+            else
+                size += sizeof( TEXTE_MODULE );
+        }
+
+        return size;
+    }
+
+    case PCB_ZONE_AREA_T:
+    {
+        const ZONE_CONTAINER* zone = static_cast<const ZONE_CONTAINER*>( aItem );
+
+        return sizeof( ZONE_CONTAINER ) + zone->GetNumCorners() * sizeof( CPolyPt )
+               + zone->GetFilledPolysList().TotalVertices() * sizeof( VECTOR2I )
+               + zone->FillSegments().size() * sizeof( SEGMENT );
+    }
+
+    case PCB_LINE_T:
+        return sizeof( DRAWSEGMENT ) + sizeof( wxPoint ) *
+               static_cast<const DRAWSEGMENT*>( aItem )->GetPolyPoints().size();
+
+    case PCB_TRACE_T:       return sizeof( TRACK );
+    case PCB_VIA_T:         return sizeof( VIA );
+    case PCB_TEXT_T:        return sizeof( TEXTE_PCB );
+    case PCB_TARGET_T:      return sizeof( PCB_TARGET );
+    case PCB_DIMENSION_T:   return sizeof( DIMENSION );
+
+    default:
+        return sizeof( BOARD_ITEM );
+    }
+}
+
+
+/**
+ * Function setUndoImageSize
+ * estimates the size of the item copies held by \a aCommand, i.e. the old state of the
+ * changed items and the deleted items, for the undo/redo memory budget.  It has to be
+ * called again once the command was undone or redone, as the copies are exchanged with
+ * the items.
+ */
+static void setUndoImageSize( PICKED_ITEMS_LIST* aCommand )
+{
+    aCommand->m_ImageSize = 0;
+
+    for( unsigned ii = 0; ii < aCommand->GetCount(); ii++ )
+    {
+        switch( aCommand->GetPickedItemStatus( ii ) )
+        {
+        case UR_CHANGED:
+        case UR_ZONE_OUTLINE:
+        case UR_ZONE_FILL:
+            if( aCommand->GetPickedItemLink( ii ) )
+                aCommand->m_ImageSize +=
+                        undoImageSize( (BOARD_ITEM*) aCommand->GetPickedItemLink( ii ) );
+            break;
+
+        case UR_DELETED:
+            aCommand->m_ImageSize += undoImageSize( (BOARD_ITEM*) aCommand->GetPickedItem( ii ) );
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+
+/**
+ * Function cloneUndoImage
+ * returns the copy of \a aItem saved by a \a aCommandType command, i.e. the item without
+ * its filled areas for UR_ZONE_OUTLINE, and the full item otherwise.
+ */
+static EDA_ITEM* cloneUndoImage( const BOARD_ITEM* aItem, UNDO_REDO_T aCommandType )
+{
+    if( aCommandType == UR_ZONE_OUTLINE )
+    {
+        wxASSERT( aItem->Type() == PCB_ZONE_AREA_T );
+        return static_cast<const ZONE_CONTAINER*>( aItem )->CloneWithoutFill();
+    }
+
+    return aItem->Clone();
+}
+
+
 void PCB_EDIT_FRAME::SaveCopyInUndoList( BOARD_ITEM*    aItem,
                                          UNDO_REDO_T    aCommandType,
                                          const wxPoint& aTransformPoint )
@@ -325,6 +478,15 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( BOARD_ITEM*    aItem,
             return;
     }
 
+    // The item will be changed: the incremental DRC must test it again
+    if( m_drc )
+    {
+        if( aCommandType == UR_DELETED )
+            m_drc->MarkDeleted( aItem );
+        else
+            m_drc->MarkDirty( aItem );
+    }
+
     PICKED_ITEMS_LIST* commandToUndo = new PICKED_ITEMS_LIST();
 
     commandToUndo->m_TransformPoint = aTransformPoint;
@@ -334,8 +496,10 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( BOARD_ITEM*    aItem,
     switch( aCommandType )
     {
     case UR_CHANGED:                        // Create a copy of item
+    case UR_ZONE_OUTLINE:
+    case UR_ZONE_FILL:
         if( itemWrapper.GetLink() == NULL ) // When not null, the copy is already done
-            itemWrapper.SetLink( aItem->Clone() );
+            itemWrapper.SetLink( cloneUndoImage( aItem, aCommandType ) );
         commandToUndo->PushItem( itemWrapper );
         break;
 
@@ -366,6 +530,8 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( BOARD_ITEM*    aItem,
 
     if( commandToUndo->GetCount() )
     {
+        setUndoImageSize( commandToUndo );
+
         /* Save the copy in undo list */
         GetScreen()->PushCommandToUndoList( commandToUndo );
 
@@ -438,9 +604,19 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( const PICKED_ITEMS_LIST& aItemsList,
 
         wxASSERT( item );
 
+        if( m_drc )
+        {
+            if( command == UR_DELETED )
+                m_drc->MarkDeleted( item );
+            else
+                m_drc->MarkDirty( item );
+        }
+
         switch( command )
         {
         case UR_CHANGED:
+        case UR_ZONE_OUTLINE:
+        case UR_ZONE_FILL:
 
             /* If needed, create a copy of item, and put in undo list
              * in the picker, as link
@@ -448,7 +624,7 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( const PICKED_ITEMS_LIST& aItemsList,
              */
             if( commandToUndo->GetPickedItemLink( ii ) == NULL )
             {
-                EDA_ITEM* cloned = item->Clone();
+                EDA_ITEM* cloned = cloneUndoImage( item, command );
                 commandToUndo->SetPickedItemLink( cloned, ii );
             }
             break;
@@ -475,6 +651,8 @@ void PCB_EDIT_FRAME::SaveCopyInUndoList( const PICKED_ITEMS_LIST& aItemsList,
 
     if( commandToUndo->GetCount() )
     {
+        setUndoImageSize( commandToUndo );
+
         /* Save the copy in undo list */
         GetScreen()->PushCommandToUndoList( commandToUndo );
 
@@ -539,6 +717,9 @@ void PCB_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
 
         item->ClearFlags();
 
+        if( m_drc )
+            m_drc->MarkDirty( item );
+
         // see if we must rebuild ratsnets and pointers lists
         switch( item->Type() )
         {
@@ -561,6 +742,8 @@ void PCB_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
         switch( aList->GetPickedItemStatus( ii ) )
         {
         case UR_CHANGED:    /* Exchange old and new data for each item */
+        case UR_ZONE_OUTLINE:
+        case UR_ZONE_FILL:
         {
             BOARD_ITEM* image = (BOARD_ITEM*) aList->GetPickedItemLink( ii );
 
@@ -574,7 +757,8 @@ void PCB_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
             view->Remove( item );
             ratsnest->Remove( item );
 
-            item->SwapData( image );
+            item->UndoRedoPicked( status, image, aList->m_TransformPoint, m_rotationAngle,
+                                  aRedoCommand );
 
             // Update all pads/drawings/texts, as they become invalid
             // for the VIEW after SwapData() called for modules
@@ -595,6 +779,9 @@ void PCB_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
             aList->SetPickedItemStatus( UR_DELETED, ii );
             GetBoard()->Remove( item );
 
+            if( m_drc )
+                m_drc->MarkDeleted( item );
+
             if( item->Type() == PCB_MODULE_T )
             {
                 MODULE* module = static_cast<MODULE*>( item );
@@ -621,27 +808,17 @@ void PCB_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
             break;
 
         case UR_MOVED:
-            item->Move( aRedoCommand ? aList->m_TransformPoint : -aList->m_TransformPoint );
-            item->ViewUpdate( KIGFX::VIEW_ITEM::GEOMETRY );
-            ratsnest->Update( item );
-            break;
-
         case UR_ROTATED:
-            item->Rotate( aList->m_TransformPoint,
-                          aRedoCommand ? m_rotationAngle : -m_rotationAngle );
-            item->ViewUpdate( KIGFX::VIEW_ITEM::GEOMETRY );
-            ratsnest->Update( item );
-            break;
-
         case UR_ROTATED_CLOCKWISE:
-            item->Rotate( aList->m_TransformPoint,
-                          aRedoCommand ? -m_rotationAngle : m_rotationAngle );
+            item->UndoRedoPicked( status, NULL, aList->m_TransformPoint, m_rotationAngle,
+                                  aRedoCommand );
             item->ViewUpdate( KIGFX::VIEW_ITEM::GEOMETRY );
             ratsnest->Update( item );
             break;
 
         case UR_FLIPPED:
-            item->Flip( aList->m_TransformPoint );
+            item->UndoRedoPicked( status, NULL, aList->m_TransformPoint, m_rotationAngle,
+                                  aRedoCommand );
             item->ViewUpdate( KIGFX::VIEW_ITEM::LAYERS );
             ratsnest->Update( item );
             break;
@@ -696,6 +873,7 @@ void PCB_EDIT_FRAME::RestoreCopyFromUndoList( wxCommandEvent& aEvent )
 
     /* Put the old list in RedoList */
     List->ReversePickersListOrder();
+    setUndoImageSize( List );
     GetScreen()->PushCommandToRedoList( List );
 
     OnModify();
@@ -723,6 +901,7 @@ void PCB_EDIT_FRAME::RestoreCopyFromRedoList( wxCommandEvent& aEvent )
 
     /* Put the old list in UndoList */
     List->ReversePickersListOrder();
+    setUndoImageSize( List );
     GetScreen()->PushCommandToUndoList( List );
 
     OnModify();
@@ -71,6 +71,12 @@ ZONE_CONTAINER::ZONE_CONTAINER( BOARD* aBoard ) :
 
 
 ZONE_CONTAINER::ZONE_CONTAINER( const ZONE_CONTAINER& aZone ) :
+    ZONE_CONTAINER( aZone, true )
+{
+}
+
+
+ZONE_CONTAINER::ZONE_CONTAINER( const ZONE_CONTAINER& aZone, bool aCopyFill ) :
     BOARD_CONNECTED_ITEM( aZone )
 {
     m_smoothedPoly = NULL;
@@ -81,7 +87,7 @@ ZONE_CONTAINER::ZONE_CONTAINER( const ZONE_CONTAINER& aZone ) :
 
     // For corner moving, corner index to drag, or -1 if no selection
     m_CornerSelection = -1;
-    m_IsFilled = aZone.m_IsFilled;
+    m_IsFilled = aCopyFill && aZone.m_IsFilled;
     m_ZoneClearance = aZone.m_ZoneClearance;     // clearance value
     m_ZoneMinThickness = aZone.m_ZoneMinThickness;
     m_FillMode = aZone.m_FillMode;               // Filling mode (segments/polygons)
@@ -90,8 +96,12 @@ ZONE_CONTAINER::ZONE_CONTAINER( const ZONE_CONTAINER& aZone ) :
     m_PadConnection = aZone.m_PadConnection;
     m_ThermalReliefGap = aZone.m_ThermalReliefGap;
     m_ThermalReliefCopperBridge = aZone.m_ThermalReliefCopperBridge;
-    m_FilledPolysList.Append( aZone.m_FilledPolysList );
-    m_FillSegmList = aZone.m_FillSegmList;      // vector <> copy
+
+    if( aCopyFill )
+    {
+        m_FilledPolysList.Append( aZone.m_FilledPolysList );
+        m_FillSegmList = aZone.m_FillSegmList;      // vector <> copy
+    }
 
     m_isKeepout = aZone.m_isKeepout;
     m_doNotAllowCopperPour = aZone.m_doNotAllowCopperPour;
@@ -109,6 +119,7 @@ ZONE_CONTAINER::~ZONE_CONTAINER()
 {
     delete m_Poly;
     m_Poly = NULL;
+    delete m_smoothedPoly;
 }
 
 
@@ -118,6 +129,50 @@ EDA_ITEM* ZONE_CONTAINER::Clone() const
 }
 
 
+ZONE_CONTAINER* ZONE_CONTAINER::CloneWithoutFill() const
+{
+    return new ZONE_CONTAINER( *this, false );
+}
+
+
+void ZONE_CONTAINER::SwapOutline( ZONE_CONTAINER* aImage )
+{
+    std::swap( m_Poly, aImage->m_Poly );
+    std::swap( m_smoothedPoly, aImage->m_smoothedPoly );
+    std::swap( m_Layer, aImage->m_Layer );
+
+    int netcode = GetNetCode();
+    SetNetCode( aImage->GetNetCode() );
+    aImage->SetNetCode( netcode );
+
+    m_CornerSelection = -1;
+    aImage->m_CornerSelection = -1;
+
+    std::swap( m_cornerSmoothingType, aImage->m_cornerSmoothingType );
+    std::swap( m_cornerRadius, aImage->m_cornerRadius );
+    std::swap( m_priority, aImage->m_priority );
+    std::swap( m_isKeepout, aImage->m_isKeepout );
+    std::swap( m_doNotAllowCopperPour, aImage->m_doNotAllowCopperPour );
+    std::swap( m_doNotAllowVias, aImage->m_doNotAllowVias );
+    std::swap( m_doNotAllowTracks, aImage->m_doNotAllowTracks );
+    std::swap( m_PadConnection, aImage->m_PadConnection );
+    std::swap( m_ZoneClearance, aImage->m_ZoneClearance );
+    std::swap( m_ZoneMinThickness, aImage->m_ZoneMinThickness );
+    std::swap( m_ArcToSegmentsCount, aImage->m_ArcToSegmentsCount );
+    std::swap( m_ThermalReliefGap, aImage->m_ThermalReliefGap );
+    std::swap( m_ThermalReliefCopperBridge, aImage->m_ThermalReliefCopperBridge );
+    std::swap( m_FillMode, aImage->m_FillMode );
+}
+
+
+void ZONE_CONTAINER::SwapFill( ZONE_CONTAINER* aImage )
+{
+    m_FilledPolysList.Swap( aImage->m_FilledPolysList );
+    m_FillSegmList.swap( aImage->m_FillSegmList );
+    std::swap( m_IsFilled, aImage->m_IsFilled );
+}
+
+
 bool ZONE_CONTAINER::UnFill()
 {
     bool change = ( !m_FilledPolysList.IsEmpty() ) ||
@@ -39,6 +39,7 @@
 #include <layers_id_colors_and_visibility.h>
 #include <PolyLine.h>
 #include <class_zone_settings.h>
+#include <zone_hole_cache.h>
 
 
 class EDA_RECT;
@@ -277,7 +278,7 @@ public:
      * removed from solid areas
      * if not null:
      * Only the zone outline (with holes, if any) is stored in aOutlineBuffer
-     * with holes linked. Therefore only one polygon is created
+     * with holes linked. Therefore only one polygon is created, and the zone is not modified
      *
      * When aOutlineBuffer is not null, his function calls
      * AddClearanceAreasPolygonsToPolysList() to add holes for pads and tracks
@@ -285,6 +286,34 @@ public:
      */
     bool BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET* aOutlineBuffer = NULL );
 
+    /**
+     * Function BuildFilledPolysList
+     * Build the smoothed outline and the filled polygons (m_FilledPolysList) of the zone,
+     * i.e. BuildFilledSolidAreasPolygons() without the creation of fill segments.
+     * Only this zone is modified: the items of aPcb (other zones included) are only read,
+     * so different zones can be filled at the same time by different threads.
+     * @return true if OK, false if the solid polygons cannot be built
+     * @param aPcb: the current board (can be NULL for non copper zones)
+     */
+    bool BuildFilledPolysList( BOARD* aPcb );
+
+    /**
+     * Function SwapFilledAreas
+     * exchanges the smoothed outline, the filled polygons, the fill segments,
+     * the fill status and the hole cache of this zone and aZone.
+     * Used to commit a filling calculated in a copy of this zone.
+     * @param aZone = the zone to swap filled areas with
+     */
+    void SwapFilledAreas( ZONE_CONTAINER& aZone );
+
+    /**
+     * Function GetHoleCache
+     * @return the clearance polygons of the pads and tracks removed from the zone by the
+     * last fill, used to build only the polygons of items changed since.
+     * This cache is not copied with the zone.
+     */
+    ZONE_HOLE_CACHE& GetHoleCache() { return m_holeCache; }
+
     /**
      * Function AddClearanceAreasPolygonsToPolysList
      * Add non copper areas polygons (pads and tracks with clearance)
@@ -527,6 +556,30 @@ public:
 
     virtual EDA_ITEM* Clone() const;
 
+    /**
+     * Function CloneWithoutFill
+     * returns a copy of this zone without its filled polygons and fill segments,
+     * which are not copied at all, for a copy which is going to be filled or for
+     * the undo copy of an outline edit (UR_ZONE_OUTLINE).
+     */
+    ZONE_CONTAINER* CloneWithoutFill() const;
+
+    /**
+     * Function SwapOutline
+     * exchanges the outline, the layer, the net and the settings of this zone with the
+     * ones of \a aImage, used to undo and redo UR_ZONE_OUTLINE changes.  The filled
+     * areas of both zones are left alone.
+     */
+    void SwapOutline( ZONE_CONTAINER* aImage );
+
+    /**
+     * Function SwapFill
+     * exchanges the filled polygons, the fill segments and the fill status of this zone
+     * with the ones of \a aImage, without copying them.  It is used to undo and redo
+     * UR_ZONE_FILL changes.
+     */
+    void SwapFill( ZONE_CONTAINER* aImage );
+
     /**
      * Accessors to parameters used in Keepout zones:
      */
@@ -547,10 +600,20 @@ public:
 
 
 private:
+    ZONE_CONTAINER( const ZONE_CONTAINER& aZone, bool aCopyFill );
+
     void buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeatures );
 
+    /**
+     * Function buildSmoothedPoly
+     * @return a new corner-smoothed version of m_Poly, to be deleted by the caller.
+     * The zone is not modified.
+     */
+    CPolyLine* buildSmoothedPoly() const;
+
     CPolyLine*            m_Poly;                ///< Outline of the zone.
     CPolyLine*            m_smoothedPoly;        // Corner-smoothed version of m_Poly
+    ZONE_HOLE_CACHE       m_holeCache;           ///< Clearance polygons of the last fill
     int                   m_cornerSmoothingType;
     unsigned int          m_cornerRadius;
 
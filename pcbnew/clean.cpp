@@ -30,12 +30,14 @@
 
 
 #include <fctsys.h>
+#include <algorithm>
 #include <class_drawpanel.h>
 #include <wxPcbStruct.h>
 #include <pcbnew.h>
 #include <class_board.h>
 #include <class_track.h>
 #include <connect.h>
+#include <connectivity.h>
 #include <dialog_cleaning_options.h>
 #include <ratsnest_data.h>
 
@@ -108,7 +110,8 @@ private:
     const ZONE_CONTAINER* zoneForTrackEndpoint( const TRACK *aTrack,
             ENDPOINT_T aEndPoint );
 
-    bool testTrackEndpointDangling( TRACK *aTrack, ENDPOINT_T aEndPoint );
+    bool testTrackEndpointDangling( CONNECTED_CLUSTERS& aConnections, TRACK *aTrack,
+                                    ENDPOINT_T aEndPoint );
 };
 
 /* Install the cleanup dialog frame to know what should be cleaned
@@ -318,13 +321,40 @@ const ZONE_CONTAINER* TRACKS_CLEANER::zoneForTrackEndpoint( const TRACK *aTrack,
             top_layer, bottom_layer, aTrack->GetNetCode() );
 }
 
+/* Utility: returns the first track or via (other than aExcluded) connected to an anchor
+ * of aTrack and having an end exactly on aPosition
+ */
+static TRACK* trackEndingAt( const CONNECTED_CLUSTERS& aConnections, const TRACK* aTrack,
+                             int aAnchor, const wxPoint& aPosition, const TRACK* aExcluded )
+{
+    const std::vector<BOARD_CONNECTED_ITEM*>& links = aConnections.GetLinks( aTrack, aAnchor );
+
+    for( unsigned ii = 0; ii < links.size(); ii++ )
+    {
+        if( links[ii]->Type() != PCB_TRACE_T && links[ii]->Type() != PCB_VIA_T )
+            continue;
+
+        TRACK* other = static_cast<TRACK*>( links[ii] );
+
+        if( other != aExcluded &&
+                ( other->GetStart() == aPosition || other->GetEnd() == aPosition ) )
+            return other;
+    }
+
+    return NULL;
+}
+
 /** Utility: does the endpoint unconnected processed for one endpoint of one track
  * Returns true if the track must be deleted, false if not necessarily */
-bool TRACKS_CLEANER::testTrackEndpointDangling( TRACK *aTrack, ENDPOINT_T aEndPoint )
+bool TRACKS_CLEANER::testTrackEndpointDangling( CONNECTED_CLUSTERS& aConnections,
+                                                TRACK *aTrack, ENDPOINT_T aEndPoint )
 {
     bool flag_erase = false;
 
-    TRACK* other = aTrack->GetTrack( m_Brd->m_Track, NULL, aEndPoint, true, false );
+    // A via has only one anchor
+    int anchor = ( aTrack->Type() == PCB_VIA_T ) ? 0 : aEndPoint;
+    TRACK* other = trackEndingAt( aConnections, aTrack, anchor,
+                                  aTrack->GetEndPoint( aEndPoint ), NULL );
 
     if( (other == NULL) && (zoneForTrackEndpoint( aTrack, aEndPoint ) == NULL) )
         flag_erase = true; // Start endpoint is neither on pad, zone or other track
@@ -344,16 +374,12 @@ bool TRACKS_CLEANER::testTrackEndpointDangling( TRACK *aTrack, ENDPOINT_T aEndPo
         if( via )
         {
             // search for another segment following the via
-            aTrack->SetState( BUSY, true );
-
-            other = via->GetTrack( m_Brd->m_Track, NULL, aEndPoint, true, false );
+            other = trackEndingAt( aConnections, via, 0, via->GetStart(), aTrack );
 
             // There is a via on the start but it goes nowhere
             if( (other == NULL) &&
                     (zoneForTrackEndpoint( via, aEndPoint ) == NULL) )
                 flag_erase = true;
-
-            aTrack->SetState( BUSY, false );
         }
     }
 
@@ -364,6 +390,9 @@ bool TRACKS_CLEANER::testTrackEndpointDangling( TRACK *aTrack, ENDPOINT_T aEndPo
  *  Delete dangling tracks
  *  Vias:
  *  If a via is only connected to a dangling track, it also will be removed
+ *  The connections between track ends are kept in a CONNECTED_CLUSTERS, updated
+ *  when a track is deleted, so only the tracks connected to a deleted track are
+ *  tested again, instead of the whole track list.
  */
 bool TRACKS_CLEANER::deleteUnconnectedTracks()
 {
@@ -371,46 +400,77 @@ bool TRACKS_CLEANER::deleteUnconnectedTracks()
         return false;
 
     bool modified = false;
-    bool item_erased;
-    do // Iterate when at least one track is deleted
+
+    // Pads are not stored: track ends on pads are flagged by buildTrackConnectionInfo()
+    CONNECTED_CLUSTERS connections;
+    std::vector<TRACK*> candidates;
+
+    for( TRACK *track = m_Brd->m_Track; track != NULL; track = track->Next() )
     {
-        item_erased = false;
-        TRACK* next_track;
-        for( TRACK *track = m_Brd->m_Track; track != NULL; track = next_track )
-        {
-            next_track = track->Next();
+        connections.Add( track );
+        candidates.push_back( track );
+    }
+
+    // candidates is used as a stack: test the tracks in list order
+    std::reverse( candidates.begin(), candidates.end() );
+
+    while( !candidates.empty() )
+    {
+        TRACK* track = candidates.back();
+        candidates.pop_back();
+
+        if( !connections.Contains( track ) )    // already deleted
+            continue;
 
-            bool flag_erase = false; // Start without a good reason to erase it
+        bool flag_erase = false; // Start without a good reason to erase it
 
-            /* if a track endpoint is not connected to a pad, test if
-             * the endpoint is connected to another track or to a zone.
-             * For via test, an enhancement could be to test if
-             * connected to 2 items on different layers. Currently
-             * a via must be connected to 2 items, that can be on the
-             * same layer */
+        /* if a track endpoint is not connected to a pad, test if
+         * the endpoint is connected to another track or to a zone.
+         * For via test, an enhancement could be to test if
+         * connected to 2 items on different layers. Currently
+         * a via must be connected to 2 items, that can be on the
+         * same layer */
 
-            // Check if there is nothing attached on the start
-            if( !(track->GetState( START_ON_PAD )) )
-                flag_erase |= testTrackEndpointDangling( track, ENDPOINT_START );
+        // Check if there is nothing attached on the start
+        if( !(track->GetState( START_ON_PAD )) )
+            flag_erase |= testTrackEndpointDangling( connections, track, ENDPOINT_START );
 
-            // Check if there is nothing attached on the end
-            if( !(track->GetState( END_ON_PAD )) )
-                flag_erase |= testTrackEndpointDangling( track, ENDPOINT_END );
+        // Check if there is nothing attached on the end
+        if( !(track->GetState( END_ON_PAD )) )
+            flag_erase |= testTrackEndpointDangling( connections, track, ENDPOINT_END );
 
-            if( flag_erase )
+        if( flag_erase )
+        {
+            /* a track connected to the deleted track, directly or through a via,
+             * now perhaps is not connected and should be tested again */
+            for( int ii = 0; ii < connections.GetAnchorCount( track ); ii++ )
             {
-                // remove segment from board
-                m_Brd->GetRatsnest()->Remove( track );
-                track->ViewRelease();
-                track->DeleteStructure();
-
-                /* keep iterating, because a track connected to the deleted track
-                 * now perhaps is not connected and should be deleted */
-                item_erased = true;
-                modified = true;
+                const std::vector<BOARD_CONNECTED_ITEM*>& links = connections.GetLinks( track, ii );
+
+                for( unsigned jj = 0; jj < links.size(); jj++ )
+                {
+                    TRACK* other = static_cast<TRACK*>( links[jj] );
+                    candidates.push_back( other );
+
+                    if( other->Type() != PCB_VIA_T )
+                        continue;
+
+                    const std::vector<BOARD_CONNECTED_ITEM*>& next = connections.GetLinks( other, 0 );
+
+                    for( unsigned kk = 0; kk < next.size(); kk++ )
+                        candidates.push_back( static_cast<TRACK*>( next[kk] ) );
+                }
             }
+
+            // remove segment from board
+            connections.Remove( track );
+            m_Brd->GetRatsnest()->Remove( track );
+            track->ViewRelease();
+            track->DeleteStructure();
+
+            modified = true;
         }
-    } while( item_erased );
+    }
 
     return modified;
 }
@@ -0,0 +1,431 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file connectivity.cpp
+ */
+
+#include <fctsys.h>
+#include <algorithm>
+#include <unordered_set>
+
+#include <common.h>
+#include <trigo.h>
+#include <class_track.h>
+#include <class_pad.h>
+
+#include <connectivity.h>
+
+
+/* Collects the anchors found by an R-tree search
+ */
+struct CONNECTED_CLUSTERS::ANCHOR_COLLECTOR
+{
+    std::vector<ANCHOR*>& m_result;
+
+    ANCHOR_COLLECTOR( std::vector<ANCHOR*>& aResult ) :
+        m_result( aResult )
+    {}
+
+    bool operator()( ANCHOR* aAnchor )
+    {
+        m_result.push_back( aAnchor );
+        return true;
+    }
+};
+
+
+/* Stores the area where the anchors connected to an anchor are searched
+ */
+static void setAnchorArea( int aMin[2], int aMax[2], const EDA_RECT& aArea )
+{
+    aMin[0] = aArea.GetX();
+    aMin[1] = aArea.GetY();
+    aMax[0] = aArea.GetRight();
+    aMax[1] = aArea.GetBottom();
+}
+
+
+CONNECTED_CLUSTERS::CONNECTED_CLUSTERS()
+{
+}
+
+
+void CONNECTED_CLUSTERS::Clear()
+{
+    m_anchors.RemoveAll();
+    m_items.clear();
+    m_clusters.Reset( 0 );
+    m_clusterSizes.clear();
+    m_splitItems.clear();
+}
+
+
+bool CONNECTED_CLUSTERS::Add( BOARD_CONNECTED_ITEM* aItem )
+{
+    KICAD_T type = aItem->Type();
+
+    if( type != PCB_TRACE_T && type != PCB_VIA_T && type != PCB_PAD_T )
+        return false;
+
+    std::pair<ENTRY_MAP::iterator, bool> inserted = m_items.insert(
+            std::make_pair( aItem, ENTRY() ) );
+
+    if( !inserted.second )
+        return false;
+
+    ENTRY& entry = inserted.first->second;
+
+    entry.m_item = aItem;
+    entry.m_cluster = m_clusters.Add();
+    m_clusterSizes.push_back( 1 );
+
+    if( type == PCB_PAD_T )
+    {
+        // The pad shape is searched, and its position (tested by the other pads)
+        D_PAD*   pad = static_cast<D_PAD*>( aItem );
+        EDA_RECT area( pad->ShapePos(), wxSize( 0, 0 ) );
+
+        area.Inflate( pad->GetBoundingRadius() + 1 );
+        area.Merge( pad->GetPosition() );
+
+        entry.m_anchorCount = 1;
+        entry.m_anchors[0].m_pos = pad->GetPosition();
+        setAnchorArea( entry.m_anchors[0].m_min, entry.m_anchors[0].m_max, area );
+    }
+    else
+    {
+        TRACK* track = static_cast<TRACK*>( aItem );
+
+        entry.m_anchorCount = ( type == PCB_VIA_T ) ? 1 : 2;
+
+        for( int ii = 0; ii < entry.m_anchorCount; ++ii )
+        {
+            ANCHOR&  anchor = entry.m_anchors[ii];
+            EDA_RECT area( track->GetEndPoint( (ENDPOINT_T) ii ), wxSize( 0, 0 ) );
+
+            area.Inflate( track->GetWidth() / 2 + 1 );
+
+            anchor.m_pos = track->GetEndPoint( (ENDPOINT_T) ii );
+            setAnchorArea( anchor.m_min, anchor.m_max, area );
+        }
+    }
+
+    // Two connected anchors are in the area of each other, so only the anchors
+    // found in the area of the new ones have to be tested
+    std::vector<ANCHOR*> found;
+    ANCHOR_COLLECTOR     collector( found );
+
+    for( int ii = 0; ii < entry.m_anchorCount; ++ii )
+    {
+        ANCHOR& anchor = entry.m_anchors[ii];
+
+        anchor.m_entry = &entry;
+
+        found.clear();
+        m_anchors.Search( anchor.m_min, anchor.m_max, collector );
+
+        for( unsigned jj = 0; jj < found.size(); ++jj )
+        {
+            ANCHOR& other = *found[jj];
+
+            if( !connected( anchor, other ) )
+                continue;
+
+            if( std::find( anchor.m_links.begin(), anchor.m_links.end(),
+                           other.m_entry->m_item ) == anchor.m_links.end() )
+                anchor.m_links.push_back( other.m_entry->m_item );
+
+            if( std::find( other.m_links.begin(), other.m_links.end(),
+                           aItem ) == other.m_links.end() )
+                other.m_links.push_back( aItem );
+
+            merge( entry, *other.m_entry );
+        }
+    }
+
+    // Anchors are inserted after the search, so an item is not connected to itself
+    for( int ii = 0; ii < entry.m_anchorCount; ++ii )
+    {
+        ANCHOR& anchor = entry.m_anchors[ii];
+        m_anchors.Insert( anchor.m_min, anchor.m_max, &anchor );
+    }
+
+    return true;
+}
+
+
+bool CONNECTED_CLUSTERS::Remove( BOARD_CONNECTED_ITEM* aItem )
+{
+    ENTRY_MAP::iterator it = m_items.find( aItem );
+
+    if( it == m_items.end() )
+        return false;
+
+    ENTRY& entry = it->second;
+
+    for( int ii = 0; ii < entry.m_anchorCount; ++ii )
+    {
+        ANCHOR& anchor = entry.m_anchors[ii];
+
+        m_anchors.Remove( anchor.m_min, anchor.m_max, &anchor );
+
+        for( unsigned jj = 0; jj < anchor.m_links.size(); ++jj )
+        {
+            ENTRY& other = m_items.find( anchor.m_links[jj] )->second;
+
+            for( int kk = 0; kk < other.m_anchorCount; ++kk )
+            {
+                std::vector<BOARD_CONNECTED_ITEM*>& links = other.m_anchors[kk].m_links;
+                links.erase( std::remove( links.begin(), links.end(), aItem ), links.end() );
+            }
+
+            // The cluster of the neighbours can be split
+            m_splitItems.push_back( other.m_item );
+        }
+    }
+
+    m_items.erase( it );
+
+    return true;
+}
+
+
+void CONNECTED_CLUSTERS::Update( BOARD_CONNECTED_ITEM* aItem )
+{
+    Remove( aItem );
+    Add( aItem );
+}
+
+
+int CONNECTED_CLUSTERS::GetCluster( const BOARD_CONNECTED_ITEM* aItem )
+{
+    regroup();
+
+    ENTRY_MAP::const_iterator it = m_items.find( aItem );
+
+    if( it == m_items.end() )
+        return -1;
+
+    return m_clusters.Find( it->second.m_cluster );
+}
+
+
+int CONNECTED_CLUSTERS::GetClusterSize( const BOARD_CONNECTED_ITEM* aItem )
+{
+    int cluster = GetCluster( aItem );
+
+    return cluster < 0 ? 0 : m_clusterSizes[cluster];
+}
+
+
+bool CONNECTED_CLUSTERS::AreConnected( const BOARD_CONNECTED_ITEM* aItem,
+                                       const BOARD_CONNECTED_ITEM* aOther )
+{
+    int cluster = GetCluster( aItem );
+
+    return cluster >= 0 && cluster == GetCluster( aOther );
+}
+
+
+void CONNECTED_CLUSTERS::GetClusterItems( const BOARD_CONNECTED_ITEM* aItem,
+                                          std::vector<BOARD_CONNECTED_ITEM*>& aItems ) const
+{
+    ENTRY_MAP::const_iterator it = m_items.find( aItem );
+
+    if( it == m_items.end() )
+        return;
+
+    // A cluster is made of the items reachable through the links
+    std::unordered_set<const BOARD_CONNECTED_ITEM*> visited;
+    unsigned first = aItems.size();
+
+    visited.insert( aItem );
+    aItems.push_back( it->second.m_item );
+
+    for( unsigned ii = first; ii < aItems.size(); ++ii )
+    {
+        const ENTRY& entry = m_items.find( aItems[ii] )->second;
+
+        for( int jj = 0; jj < entry.m_anchorCount; ++jj )
+        {
+            const std::vector<BOARD_CONNECTED_ITEM*>& links = entry.m_anchors[jj].m_links;
+
+            for( unsigned kk = 0; kk < links.size(); ++kk )
+            {
+                if( visited.insert( links[kk] ).second )
+                    aItems.push_back( links[kk] );
+            }
+        }
+    }
+}
+
+
+int CONNECTED_CLUSTERS::GetAnchorCount( const BOARD_CONNECTED_ITEM* aItem ) const
+{
+    ENTRY_MAP::const_iterator it = m_items.find( aItem );
+
+    return it == m_items.end() ? 0 : it->second.m_anchorCount;
+}
+
+
+const std::vector<BOARD_CONNECTED_ITEM*>& CONNECTED_CLUSTERS::GetLinks(
+        const BOARD_CONNECTED_ITEM* aItem, int aAnchor ) const
+{
+    static const std::vector<BOARD_CONNECTED_ITEM*> noLinks;
+
+    ENTRY_MAP::const_iterator it = m_items.find( aItem );
+
+    if( it == m_items.end() || aAnchor < 0 || aAnchor >= it->second.m_anchorCount )
+        return noLinks;
+
+    return it->second.m_anchors[aAnchor].m_links;
+}
+
+
+bool CONNECTED_CLUSTERS::connected( const ANCHOR& aAnchor, const ANCHOR& aOther ) const
+{
+    const BOARD_CONNECTED_ITEM* item = aAnchor.m_entry->m_item;
+    const BOARD_CONNECTED_ITEM* other = aOther.m_entry->m_item;
+
+    if( item->GetNetCode() != other->GetNetCode() )
+        return false;
+
+    if( !( item->GetLayerSet() & other->GetLayerSet() & LSET::AllCuMask() ).any() )
+        return false;
+
+    const D_PAD* pad = dyn_cast<const D_PAD*>( item );
+    const D_PAD* otherPad = dyn_cast<const D_PAD*>( other );
+
+    if( pad && otherPad )
+        return pad->HitTest( otherPad->GetPosition() ) || otherPad->HitTest( pad->GetPosition() );
+
+    if( pad )
+        return pad->HitTest( aOther.m_pos );
+
+    if( otherPad )
+        return otherPad->HitTest( aAnchor.m_pos );
+
+    int dist_max = std::max( static_cast<const TRACK*>( item )->GetWidth(),
+                             static_cast<const TRACK*>( other )->GetWidth() ) / 2;
+
+    return KiROUND( EuclideanNorm( aAnchor.m_pos - aOther.m_pos ) ) <= dist_max;
+}
+
+
+void CONNECTED_CLUSTERS::merge( const ENTRY& aEntry, const ENTRY& aOther )
+{
+    int cluster = m_clusters.Find( aEntry.m_cluster );
+    int other = m_clusters.Find( aOther.m_cluster );
+
+    if( cluster == other )
+        return;
+
+    int size = m_clusterSizes[cluster] + m_clusterSizes[other];
+
+    m_clusterSizes[ m_clusters.Union( cluster, other ) ] = size;
+}
+
+
+/* Each group of items still linked together gets a new cluster.  All the items left in a split
+ * cluster are reached: a path from one of them to a removed item ends with a neighbour of
+ * a removed item.  The new DISJOINT_SET elements are numbered from the current size, which
+ * tells the items already regrouped.
+ */
+void CONNECTED_CLUSTERS::regroup()
+{
+    if( m_splitItems.empty() )
+        return;
+
+    int firstNew = m_clusters.Size();
+    std::vector<ENTRY*> stack;
+
+    for( unsigned ii = 0; ii < m_splitItems.size(); ++ii )
+    {
+        ENTRY_MAP::iterator it = m_items.find( m_splitItems[ii] );
+
+        // Removed after its neighbour, or already regrouped
+        if( it == m_items.end() || it->second.m_cluster >= firstNew )
+            continue;
+
+        int cluster = m_clusters.Add();
+        int size = 0;
+
+        it->second.m_cluster = cluster;
+        stack.push_back( &it->second );
+
+        while( !stack.empty() )
+        {
+            ENTRY* entry = stack.back();
+            stack.pop_back();
+            size++;
+
+            for( int jj = 0; jj < entry->m_anchorCount; ++jj )
+            {
+                const std::vector<BOARD_CONNECTED_ITEM*>& links = entry->m_anchors[jj].m_links;
+
+                for( unsigned kk = 0; kk < links.size(); ++kk )
+                {
+                    ENTRY& next = m_items.find( links[kk] )->second;
+
+                    if( next.m_cluster < firstNew )
+                    {
+                        next.m_cluster = cluster;
+                        stack.push_back( &next );
+                    }
+                }
+            }
+        }
+
+        m_clusterSizes.push_back( size );
+    }
+
+    m_splitItems.clear();
+
+    if( m_clusters.Size() > 2 * (int) m_items.size() + 1024 )
+        compact();
+}
+
+
+void CONNECTED_CLUSTERS::compact()
+{
+    std::vector<int> newCluster( m_clusters.Size(), -1 );
+    std::vector<int> sizes;
+
+    for( ENTRY_MAP::iterator it = m_items.begin(); it != m_items.end(); ++it )
+    {
+        ENTRY& entry = it->second;
+        int root = m_clusters.Find( entry.m_cluster );
+
+        if( newCluster[root] < 0 )
+        {
+            newCluster[root] = sizes.size();
+            sizes.push_back( m_clusterSizes[root] );
+        }
+
+        entry.m_cluster = newCluster[root];
+    }
+
+    m_clusters.Reset( sizes.size() );
+    m_clusterSizes.swap( sizes );
+}
@@ -0,0 +1,198 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file connectivity.h
+ * @brief An incremental index of the copper connections between tracks, vias and pads.
+ */
+
+#ifndef CONNECTIVITY_H
+#define CONNECTIVITY_H
+
+#include <unordered_map>
+#include <vector>
+
+#include <class_board_connected_item.h>
+#include <disjoint_set.h>
+#include <geometry/rtree.h>
+
+
+/**
+ * Class CONNECTED_CLUSTERS
+ * groups tracks, vias and pads in clusters of items connected by copper, and keeps
+ * the clusters up to date when items are added or removed, so the connections of an item
+ * can be queried without rebuilding the connections of its whole net.
+ *
+ * Two items are connected when they are on the same net, share a copper layer, and:
+ *  - for two tracks or vias: an end of one is not farther than half of the largest width
+ *    from an end of the other (the rule used by CONNECTIONS::SearchConnectedTracks()),
+ *  - for a track or via and a pad: an end of the track is inside the pad,
+ *  - for two pads: the position of one pad is inside the other one.
+ * Zones are not handled: connections through copper areas are merged afterwards
+ * by Merge_SubNets_Connected_By_CopperAreas().
+ *
+ * The ends of the items (anchors) are stored in an R-tree, so adding an item only tests
+ * the anchors around its own anchors, and clusters are merged in a DISJOINT_SET in quasi
+ * constant time.  Removing an item only unlinks it from its neighbours; because it can split
+ * its cluster, the items left in this cluster are regrouped by walking their links on the
+ * next cluster query, so a series of removals costs one walk of the clusters they touched.
+ *
+ * Stored items must be removed before they are deleted.  Update() must be called after
+ * a change of the position, shape, layers or net of a stored item.
+ */
+class CONNECTED_CLUSTERS
+{
+public:
+    CONNECTED_CLUSTERS();
+
+    /**
+     * Function Clear
+     * removes all items.
+     */
+    void Clear();
+
+    /**
+     * Function Add
+     * stores a track, a via or a pad, and connects it to the items already stored.
+     * @return false if aItem is not a track, a via or a pad, or is already stored.
+     */
+    bool Add( BOARD_CONNECTED_ITEM* aItem );
+
+    /**
+     * Function Remove
+     * removes an item and its connections.
+     * @return false if aItem was not stored.
+     */
+    bool Remove( BOARD_CONNECTED_ITEM* aItem );
+
+    /**
+     * Function Update
+     * connects again an item after a change of its geometry, layers or net.
+     */
+    void Update( BOARD_CONNECTED_ITEM* aItem );
+
+    bool Contains( const BOARD_CONNECTED_ITEM* aItem ) const
+    {
+        return m_items.count( aItem ) != 0;
+    }
+
+    int GetItemCount() const
+    {
+        return m_items.size();
+    }
+
+    /**
+     * Function GetCluster
+     * @return the identifier of the cluster of aItem, or -1 if aItem is not stored.
+     * Identifiers are valid until the next call to Add() or Remove().
+     */
+    int GetCluster( const BOARD_CONNECTED_ITEM* aItem );
+
+    /**
+     * Function GetClusterSize
+     * @return the count of items in the cluster of aItem (1 for an item connected to nothing),
+     * or 0 if aItem is not stored.
+     */
+    int GetClusterSize( const BOARD_CONNECTED_ITEM* aItem );
+
+    /**
+     * Function AreConnected
+     * @return true if aItem and aOther are stored and in the same cluster.
+     */
+    bool AreConnected( const BOARD_CONNECTED_ITEM* aItem, const BOARD_CONNECTED_ITEM* aOther );
+
+    /**
+     * Function GetClusterItems
+     * fills aItems with the items in the cluster of aItem, aItem included.
+     */
+    void GetClusterItems( const BOARD_CONNECTED_ITEM* aItem,
+                          std::vector<BOARD_CONNECTED_ITEM*>& aItems ) const;
+
+    /**
+     * Function GetAnchorCount
+     * @return the count of anchors of aItem: 2 for a track (its ends), 1 for a via or a pad
+     * (its position), 0 if aItem is not stored.
+     */
+    int GetAnchorCount( const BOARD_CONNECTED_ITEM* aItem ) const;
+
+    /**
+     * Function GetLinks
+     * @return the items directly connected to an anchor of aItem.
+     * @param aAnchor is ENDPOINT_START or ENDPOINT_END for a track, 0 for a via or a pad.
+     */
+    const std::vector<BOARD_CONNECTED_ITEM*>& GetLinks( const BOARD_CONNECTED_ITEM* aItem,
+                                                        int aAnchor ) const;
+
+private:
+    struct ENTRY;
+
+    struct ANCHOR
+    {
+        ENTRY*  m_entry;                                ///< the item owning this anchor
+        wxPoint m_pos;
+        int     m_min[2];                               ///< area searched for connections
+        int     m_max[2];
+        std::vector<BOARD_CONNECTED_ITEM*> m_links;     ///< items connected to this anchor
+    };
+
+    struct ENTRY
+    {
+        BOARD_CONNECTED_ITEM* m_item;
+        int     m_cluster;                              ///< element of m_clusters
+        int     m_anchorCount;
+        ANCHOR  m_anchors[2];
+    };
+
+    struct ANCHOR_COLLECTOR;
+
+    typedef RTree<ANCHOR*, int, 2, float> ANCHOR_TREE;
+
+    // Entries are referenced by their anchors, so they must not move: this is a node based map
+    typedef std::unordered_map<const BOARD_CONNECTED_ITEM*, ENTRY> ENTRY_MAP;
+
+    // Anchors point to the entries, so a copy would share them
+    CONNECTED_CLUSTERS( const CONNECTED_CLUSTERS& );
+    CONNECTED_CLUSTERS& operator=( const CONNECTED_CLUSTERS& );
+
+    ///> Returns true if the items of two anchors are connected at these anchors.
+    bool connected( const ANCHOR& aAnchor, const ANCHOR& aOther ) const;
+
+    ///> Merges the clusters of two entries.
+    void merge( const ENTRY& aEntry, const ENTRY& aOther );
+
+    ///> Gives new clusters to the items of the clusters split by Remove().
+    void regroup();
+
+    ///> Renumbers the clusters, to drop the DISJOINT_SET elements which are no longer used.
+    void compact();
+
+    ENTRY_MAP           m_items;
+    ANCHOR_TREE         m_anchors;
+    DISJOINT_SET        m_clusters;
+    std::vector<int>    m_clusterSizes;     ///< item count of each root of m_clusters
+
+    ///> Neighbours of the items removed since the last regroup()
+    std::vector<const BOARD_CONNECTED_ITEM*> m_splitItems;
+};
+
+#endif  // CONNECTIVITY_H
@@ -76,6 +76,7 @@ void DIALOG_DRC_CONTROL::InitValues()
     AddUnitSymbol( *m_MicroViaMinTitle );
 
     m_DeleteCurrentMarkerButton->Enable( false );
+    m_IncrementalCtrl->SetValue( m_tester->IsIncrementalMode() );
 
     Layout();      // adding the units above expanded Clearance text, now resize.
 
@@ -123,6 +124,7 @@ void DIALOG_DRC_CONTROL::OnStartdrcClick( wxCommandEvent& event )
                            true,        // DRC test for zones enabled
                            true,        // DRC test for keepout areas enabled
                            reportName, m_CreateRptCtrl->IsChecked() );
+    m_tester->SetIncrementalMode( m_IncrementalCtrl->IsChecked() );
 
     DelDRCMarkers();
 
@@ -190,6 +192,7 @@ void DIALOG_DRC_CONTROL::OnListUnconnectedClick( wxCommandEvent& event )
                            true,        // DRC test for zones enabled
                            true,        // DRC test for keepout areas enabled
                            reportName, m_CreateRptCtrl->IsChecked() );
+    m_tester->SetIncrementalMode( m_IncrementalCtrl->IsChecked() );
 
     DelDRCMarkers();
 
@@ -250,6 +253,7 @@ void DIALOG_DRC_CONTROL::OnOkClick( wxCommandEvent& event )
 {
     SetReturnCode( wxID_OK );
     SetDrcParmeters();
+    m_tester->SetIncrementalMode( m_IncrementalCtrl->IsChecked() );
 
     m_tester->DestroyDialog( wxID_OK );
 }
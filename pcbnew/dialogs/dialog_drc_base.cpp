@@ -97,6 +97,11 @@ DIALOG_DRC_CONTROL_BASE::DIALOG_DRC_CONTROL_BASE( wxWindow* parent, wxWindowID i
 	
 	bSizer7->Add( ReportFileSizer, 0, wxEXPAND|wxTOP|wxBOTTOM|wxRIGHT, 5 );
 	
+	m_IncrementalCtrl = new wxCheckBox( this, wxID_ANY, _("Test changes after each edit"), wxDefaultPosition, wxDefaultSize, 0 );
+	m_IncrementalCtrl->SetToolTip( _("After a DRC run, test again the clearances of the changed items") );
+	
+	bSizer7->Add( m_IncrementalCtrl, 0, wxALL, 5 );
+	
 	
 	sbSizerOptions->Add( bSizer7, 1, wxEXPAND, 5 );
 	
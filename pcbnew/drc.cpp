@@ -39,6 +39,7 @@
 #include <class_pad.h>
 #include <class_zone.h>
 #include <class_pcb_text.h>
+#include <class_marker_pcb.h>
 #include <class_draw_panel_gal.h>
 #include <view/view.h>
 #include <geometry/seg.h>
@@ -50,8 +51,40 @@
 #include <drc_stuff.h>
 
 #include <dialog_drc.h>
+#include <drc_item_index.h>
 #include <wx/progdlg.h>
 
+#include <set>
+
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
+
+/* Returns the number of DRC objects needed to run tests in parallel:
+ * one per thread, because tests store intermediate results in the DRC object
+ */
+static int drcThreadCount()
+{
+#ifdef USE_OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+
+static int drcThreadId()
+{
+#ifdef USE_OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
 
 void DRC::ShowDialog()
 {
@@ -108,6 +141,9 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
     m_doUnconnectedTest = true;     // enable unconnected tests
     m_doZonesTest = true;           // enable zone to items clearance tests
     m_doKeepoutTest = true;         // enable keepout areas to items clearance tests
+    m_useSpatialIndex = true;       // use spatially indexed, multi-threaded clearance tests
+    m_doIncrementalTests = false;   // do not test the changed items after each edit
+    m_baselineBoard = NULL;
     m_abortDRC = false;
     m_drcInProgress = false;
 
@@ -116,6 +152,7 @@ DRC::DRC( PCB_EDIT_FRAME* aPcbWindow )
     // m_rptFilename set to empty by its constructor
 
     m_currentMarker = NULL;
+    m_recordViolations = false;
 
     m_segmAngle  = 0;
     m_segmLength = 0;
@@ -135,6 +172,16 @@ DRC::~DRC()
 }
 
 
+DRC* DRC::newWorker() const
+{
+    DRC* worker = new DRC( m_mainWindow );
+
+    worker->m_recordViolations = true;
+
+    return worker;
+}
+
+
 int DRC::Drc( TRACK* aRefSegm, TRACK* aList )
 {
     updatePointers();
@@ -189,6 +236,10 @@ void DRC::RunTests( wxTextCtrl* aMessages )
     }
 
     // someone should have cleared the two lists before calling this.
+    m_clearanceMarkers.clear();
+    m_dirtyItems.clear();
+    m_dirtyAreas.clear();
+    m_baselineBoard = NULL;
 
     if( !testNetClasses() )
     {
@@ -224,7 +275,14 @@ void DRC::RunTests( wxTextCtrl* aMessages )
         wxSafeYield();
     }
 
-    testTracks( aMessages ? aMessages->GetParent() : m_mainWindow, true );
+    if( m_useSpatialIndex )
+        testTracksIndexed( aMessages ? aMessages->GetParent() : m_mainWindow, true );
+    else
+        testTracks( aMessages ? aMessages->GetParent() : m_mainWindow, true );
+
+    // The clearance markers are now known for the whole board:
+    // next changes can be tested by RunIncrementalTests()
+    m_baselineBoard = m_pcb;
 
     // Before testing segments and unconnected, refill all zones:
     // this is a good caution, because filled areas can be outdated.
@@ -313,6 +371,265 @@ void DRC::updatePointers()
 }
 
 
+void DRC::addClearanceMarker( MARKER_PCB* aMarker, const BOARD_ITEM* aRefItem )
+{
+    m_pcb->Add( aMarker );
+    m_mainWindow->GetGalCanvas()->GetView()->Add( aMarker );
+    m_clearanceMarkers[aMarker] = aRefItem;
+}
+
+
+void DRC::SetIncrementalMode( bool aEnable )
+{
+    m_doIncrementalTests = aEnable;
+
+    if( !aEnable )
+    {
+        m_dirtyItems.clear();
+        m_dirtyAreas.clear();
+    }
+}
+
+
+void DRC::ClearIncrementalData()
+{
+    m_clearanceMarkers.clear();
+    m_dirtyItems.clear();
+    m_dirtyAreas.clear();
+    m_baselineBoard = NULL;
+}
+
+
+void DRC::MarkDirty( const BOARD_ITEM* aItem )
+{
+    if( !m_doIncrementalTests || m_baselineBoard != m_mainWindow->GetBoard() )
+        return;
+
+    switch( aItem->Type() )
+    {
+    case PCB_PAD_T:
+    case PCB_MODULE_TEXT_T:
+    case PCB_MODULE_EDGE_T:
+        aItem = aItem->GetParent();
+        break;
+
+    default:
+        break;
+    }
+
+    if( aItem == NULL )
+        return;
+
+    std::map<const BOARD_ITEM*, EDA_RECT>::iterator it = m_dirtyItems.find( aItem );
+
+    if( it == m_dirtyItems.end() )
+        m_dirtyItems[aItem] = aItem->GetBoundingBox();
+    else
+        it->second.Merge( aItem->GetBoundingBox() );
+}
+
+
+void DRC::MarkDeleted( const BOARD_ITEM* aItem )
+{
+    if( !m_doIncrementalTests || m_baselineBoard != m_mainWindow->GetBoard() )
+        return;
+
+    // The parent of a deleted pad stays on board: it is only changed
+    if( aItem->Type() == PCB_PAD_T || aItem->Type() == PCB_MODULE_TEXT_T
+        || aItem->Type() == PCB_MODULE_EDGE_T )
+    {
+        MarkDirty( aItem );
+        return;
+    }
+
+    EDA_RECT area = aItem->GetBoundingBox();
+
+    std::map<const BOARD_ITEM*, EDA_RECT>::iterator it = m_dirtyItems.find( aItem );
+
+    if( it != m_dirtyItems.end() )
+    {
+        area.Merge( it->second );
+        m_dirtyItems.erase( it );
+    }
+
+    m_dirtyAreas.push_back( area );
+}
+
+
+void DRC::RunIncrementalTests()
+{
+    updatePointers();
+
+    if( m_baselineBoard != m_pcb )
+    {
+        // The clearance tests were never run for this board: there is nothing to keep
+        m_clearanceMarkers.clear();
+        m_dirtyItems.clear();
+        m_dirtyAreas.clear();
+
+        if( m_doPad2PadTest )
+            testPad2Pad();
+
+        if( m_useSpatialIndex )
+            testTracksIndexed( m_mainWindow, false );
+        else
+            testTracks( m_mainWindow, false );
+
+        m_baselineBoard = m_pcb;
+        updatePointers();
+        return;
+    }
+
+    if( m_dirtyItems.empty() && m_dirtyAreas.empty() )
+        return;
+
+    // Ensure the pad list is up to date:
+    if( (m_pcb->m_Status_Pcb & LISTE_RATSNEST_ITEM_OK) == 0 )
+        m_mainWindow->Compile_Ratsnest( NULL, true );
+
+    DRC_ITEM_INDEX index( m_pcb );
+
+    const std::vector<TRACK*>& tracks = index.GetTracks();
+
+    // Items still on board, used to know if the pointers we have are valid
+    std::set<const BOARD_ITEM*> boardItems( tracks.begin(), tracks.end() );
+
+    for( MODULE* module = m_pcb->m_Modules; module; module = module->Next() )
+    {
+        boardItems.insert( module );
+
+        for( D_PAD* pad = module->Pads(); pad; pad = pad->Next() )
+            boardItems.insert( pad );
+    }
+
+    // Collect the items to test again: the changed ones, and the ones near
+    // the area covered by a changed item, before or after the change.
+    std::set<const BOARD_ITEM*> retest;
+    std::vector<TRACK*>         nearTracks;
+    std::vector<D_PAD*>         nearPads;
+
+    for( std::map<const BOARD_ITEM*, EDA_RECT>::iterator it = m_dirtyItems.begin();
+         it != m_dirtyItems.end(); ++it )
+    {
+        EDA_RECT area = it->second;
+
+        if( boardItems.count( it->first ) )
+        {
+            const BOARD_ITEM* item = it->first;
+
+            area.Merge( item->GetBoundingBox() );
+            retest.insert( item );
+
+            if( item->Type() == PCB_MODULE_T )
+            {
+                for( D_PAD* pad = static_cast<const MODULE*>( item )->Pads(); pad; pad = pad->Next() )
+                    retest.insert( pad );
+            }
+        }
+
+        index.QueryArea( area, nearTracks, nearPads );
+        retest.insert( nearTracks.begin(), nearTracks.end() );
+        retest.insert( nearPads.begin(), nearPads.end() );
+    }
+
+    for( unsigned ii = 0; ii < m_dirtyAreas.size(); ++ii )
+    {
+        index.QueryArea( m_dirtyAreas[ii], nearTracks, nearPads );
+        retest.insert( nearTracks.begin(), nearTracks.end() );
+        retest.insert( nearPads.begin(), nearPads.end() );
+    }
+
+    m_dirtyItems.clear();
+    m_dirtyAreas.clear();
+
+    // Delete the clearance markers of the items to test again, or no longer on board
+    std::set<MARKER_PCB*> boardMarkers;
+
+    for( int ii = 0; ii < m_pcb->GetMARKERCount(); ++ii )
+        boardMarkers.insert( m_pcb->GetMARKER( ii ) );
+
+    for( std::map<MARKER_PCB*, const BOARD_ITEM*>::iterator it = m_clearanceMarkers.begin();
+         it != m_clearanceMarkers.end(); )
+    {
+        MARKER_PCB* marker = it->first;
+
+        if( !boardMarkers.count( marker ) )
+        {
+            // already deleted by the user
+            m_clearanceMarkers.erase( it++ );
+            continue;
+        }
+
+        if( !retest.count( it->second ) && boardItems.count( it->second ) )
+        {
+            ++it;
+            continue;
+        }
+
+        if( m_mainWindow->GetCurItem() == marker )
+            m_mainWindow->SetCurItem( NULL );
+
+        m_mainWindow->GetGalCanvas()->GetView()->Remove( marker );
+        m_pcb->Remove( marker );
+        delete marker;
+
+        m_clearanceMarkers.erase( it++ );
+    }
+
+    // Test the pads again, in the same order as testPad2Pad()
+    if( m_doPad2PadTest )
+    {
+        std::vector<D_PAD*> sortedPads;
+
+        m_pcb->GetSortedPadListByXthenYCoord( sortedPads );
+
+        int     max_size = maxPadBoundingRadius( sortedPads );
+        D_PAD** listEnd = &sortedPads[ sortedPads.size() ];
+
+        for( unsigned i = 0; i < sortedPads.size(); ++i )
+        {
+            D_PAD* pad = sortedPads[i];
+
+            if( !retest.count( pad ) )
+                continue;
+
+            int    x_limit = max_size + pad->GetClearance() +
+                             pad->GetBoundingRadius() + pad->GetPosition().x;
+
+            if( !doPadToPadsDrc( pad, &sortedPads[i], listEnd, x_limit ) )
+            {
+                wxASSERT( m_currentMarker );
+                addClearanceMarker( m_currentMarker, pad );
+                m_currentMarker = 0;
+            }
+        }
+    }
+
+    // Test the tracks again, in the same order as testTracks()
+    std::vector<D_PAD*> pads;
+    std::vector<TRACK*> candidates;
+
+    for( int ii = 0; ii < (int) tracks.size() - 1; ++ii )
+    {
+        if( !retest.count( tracks[ii] ) )
+            continue;
+
+        index.QueryPads( tracks[ii], pads );
+        index.QueryTracks( tracks[ii], ii + 1, candidates );
+
+        if( !doTrackDrc( tracks[ii], NULL, true, &pads, &candidates ) )
+        {
+            wxASSERT( m_currentMarker );
+            addClearanceMarker( m_currentMarker, tracks[ii] );
+            m_currentMarker = 0;
+        }
+    }
+
+    // update the m_ui listboxes
+    updatePointers();
+}
+
+
 bool DRC::doNetClass( NETCLASSPTR nc, wxString& msg )
 {
     bool ret = true;
@@ -423,18 +740,15 @@ bool DRC::testNetClasses()
 }
 
 
-void DRC::testPad2Pad()
+/* Returns the max size of the pads (used to stop the pad to pad test)
+ */
+static int maxPadBoundingRadius( const std::vector<D_PAD*>& aPads )
 {
-    std::vector<D_PAD*> sortedPads;
-
-    m_pcb->GetSortedPadListByXthenYCoord( sortedPads );
-
-    // find the max size of the pads (used to stop the test)
     int max_size = 0;
 
-    for( unsigned i = 0; i < sortedPads.size(); ++i )
+    for( unsigned i = 0; i < aPads.size(); ++i )
     {
-        D_PAD* pad = sortedPads[i];
+        D_PAD* pad = aPads[i];
 
         // GetBoundingRadius() is the radius of the minimum sized circle fully containing the pad
         int radius = pad->GetBoundingRadius();
@@ -442,9 +756,62 @@ void DRC::testPad2Pad()
             max_size = radius;
     }
 
+    return max_size;
+}
+
+
+void DRC::testPad2Pad()
+{
+    std::vector<D_PAD*> sortedPads;
+
+    m_pcb->GetSortedPadListByXthenYCoord( sortedPads );
+
+    // find the max size of the pads (used to stop the test)
+    int max_size = maxPadBoundingRadius( sortedPads );
+
     // Test the pads
     D_PAD** listEnd = &sortedPads[ sortedPads.size() ];
 
+    if( m_useSpatialIndex )
+    {
+        // Each pad is tested by a worker DRC object of the current thread.
+        // Violations are stored by pad, and their markers are created and added
+        // to the board on this thread, in the serial order
+        boost::ptr_vector<DRC> workers;
+
+        for( int ii = 0; ii < drcThreadCount(); ++ii )
+            workers.push_back( newWorker() );
+
+        std::vector<DRC_VIOLATION> violations( sortedPads.size() );
+        int padCount = sortedPads.size();
+
+#ifdef USE_OPENMP
+        #pragma omp parallel for schedule(dynamic, 64)
+#endif
+        for( int i = 0; i < padCount; ++i )
+        {
+            DRC&   worker = workers[drcThreadId()];
+            D_PAD* pad = sortedPads[i];
+
+            int    x_limit = max_size + pad->GetClearance() +
+                             pad->GetBoundingRadius() + pad->GetPosition().x;
+
+            if( !worker.doPadToPadsDrc( pad, &sortedPads[i], listEnd, x_limit ) )
+            {
+                violations[i] = worker.m_violation;
+                worker.m_violation = DRC_VIOLATION();
+            }
+        }
+
+        for( unsigned i = 0; i < violations.size(); ++i )
+        {
+            if( violations[i].m_errorCode )
+                addClearanceMarker( createMarker( violations[i] ), sortedPads[i] );
+        }
+
+        return;
+    }
+
     for( unsigned i = 0; i< sortedPads.size(); ++i )
     {
         D_PAD* pad = sortedPads[i];
@@ -455,8 +822,7 @@ void DRC::testPad2Pad()
         if( !doPadToPadsDrc( pad, &sortedPads[i], listEnd, x_limit ) )
         {
             wxASSERT( m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+            addClearanceMarker( m_currentMarker, pad );
             m_currentMarker = 0;
         }
     }
@@ -508,8 +874,7 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
         if( !doTrackDrc( segm, segm->Next(), true ) )
         {
             wxASSERT( m_currentMarker );
-            m_pcb->Add( m_currentMarker );
-            m_mainWindow->GetGalCanvas()->GetView()->Add( m_currentMarker );
+            addClearanceMarker( m_currentMarker, segm );
             m_currentMarker = 0;
         }
     }
@@ -519,6 +884,88 @@ void DRC::testTracks( wxWindow *aActiveWindow, bool aShowProgressBar )
 }
 
 
+void DRC::testTracksIndexed( wxWindow *aActiveWindow, bool aShowProgressBar )
+{
+    DRC_ITEM_INDEX index( m_pcb );
+
+    const std::vector<TRACK*>& tracks = index.GetTracks();
+
+    // Like testTracks(), the last track is not tested: it has no following track
+    int count = (int) tracks.size() - 1;
+
+    if( count <= 0 )
+        return;
+
+    wxProgressDialog * progressDialog = NULL;
+    const int delta = 500;  // This is the number of tests between 2 calls to the
+                            // progress bar
+    int deltamax = count/delta;
+
+    if( aShowProgressBar && deltamax > 3 )
+    {
+        progressDialog = new wxProgressDialog( _( "Track clearances" ), wxEmptyString,
+                                               deltamax, aActiveWindow,
+                                               wxPD_AUTO_HIDE | wxPD_CAN_ABORT |
+                                               wxPD_APP_MODAL | wxPD_ELAPSED_TIME );
+        progressDialog->Update( 0, wxEmptyString );
+    }
+
+    boost::ptr_vector<DRC> workers;
+
+    for( int ii = 0; ii < drcThreadCount(); ++ii )
+        workers.push_back( newWorker() );
+
+    std::vector<DRC_VIOLATION> violations( count );
+
+    // Tracks are tested by blocks of delta items, so the progress bar can be updated,
+    // and the test aborted, from this (the UI) thread between two blocks.
+    // The markers of the violations found by the workers are created on this thread.
+    for( int blockStart = 0; blockStart < count; blockStart += delta )
+    {
+        int blockEnd = std::min( blockStart + delta, count );
+
+#ifdef USE_OPENMP
+        #pragma omp parallel for schedule(dynamic, 16)
+#endif
+        for( int ii = blockStart; ii < blockEnd; ++ii )
+        {
+            DRC&                worker = workers[drcThreadId()];
+            std::vector<D_PAD*> pads;
+            std::vector<TRACK*> candidates;
+
+            index.QueryPads( tracks[ii], pads );
+            index.QueryTracks( tracks[ii], ii + 1, candidates );
+
+            if( !worker.doTrackDrc( tracks[ii], NULL, true, &pads, &candidates ) )
+            {
+                violations[ii] = worker.m_violation;
+                worker.m_violation = DRC_VIOLATION();
+            }
+        }
+
+        for( int ii = blockStart; ii < blockEnd; ++ii )
+        {
+            if( violations[ii].m_errorCode )
+                addClearanceMarker( createMarker( violations[ii] ), tracks[ii] );
+        }
+
+        if( progressDialog )
+        {
+            if( !progressDialog->Update( blockEnd / delta, wxEmptyString ) )
+                break;  // Aborted by user
+#ifdef __WXMAC__
+            // Work around a dialog z-order issue on OS X
+            if( blockEnd / delta == deltamax )
+                aActiveWindow->Raise();
+#endif
+        }
+    }
+
+    if( progressDialog )
+        progressDialog->Destroy();
+}
+
+
 void DRC::testUnconnected()
 {
     if( (m_pcb->m_Status_Pcb & LISTE_RATSNEST_ITEM_OK) == 0 )
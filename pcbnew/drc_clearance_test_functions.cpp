@@ -134,7 +134,23 @@ bool convex2pointDRC( wxPoint* aTref, int aTrefCount, wxPoint aPcompare, int aDi
 }
 
 
-bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
+/* Returns the track to test after aTrack: the next candidate of aCandidates when
+ * they were preselected (aIdx is the index of this next candidate), else the next
+ * track of the list
+ */
+static TRACK* nextTrackToTest( TRACK* aTrack, const std::vector<TRACK*>* aCandidates,
+                               unsigned& aIdx )
+{
+    if( !aCandidates )
+        return aTrack->Next();
+
+    return aIdx < aCandidates->size() ? (*aCandidates)[aIdx++] : NULL;
+}
+
+
+bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads,
+                      const std::vector<D_PAD*>* aPadCandidates,
+                      const std::vector<TRACK*>* aTrackCandidates )
 {
     TRACK*    track;
     wxPoint   delta;           // lenght on X and Y axis of segments
@@ -260,11 +276,11 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
     // Compute the min distance to pads
     if( testPads )
     {
-        unsigned pad_count = m_pcb->GetPadCount();
+        unsigned pad_count = aPadCandidates ? aPadCandidates->size() : m_pcb->GetPadCount();
 
         for( unsigned ii = 0;  ii<pad_count;  ++ii )
         {
-            D_PAD* pad = m_pcb->GetPad( ii );
+            D_PAD* pad = aPadCandidates ? (*aPadCandidates)[ii] : m_pcb->GetPad( ii );
 
             /* No problem if pads are on an other layer,
              * But if a drill hole exists	(a pad on a single layer can have a hole!)
@@ -326,7 +342,12 @@ bool DRC::doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool testPads )
     // Test the reference segment with other track segments
     wxPoint segStartPoint;
     wxPoint segEndPoint;
-    for( track = aStart; track; track = track->Next() )
+    unsigned candidateIdx = 0;
+
+    if( aTrackCandidates )
+        aStart = nextTrackToTest( NULL, aTrackCandidates, candidateIdx );
+
+    for( track = aStart; track; track = nextTrackToTest( track, aTrackCandidates, candidateIdx ) )
     {
         // No problem if segments have the same net code:
         if( net_code_ref == track->GetNetCode() )
@@ -0,0 +1,214 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file drc_item_index.cpp
+ */
+
+#include <fctsys.h>
+#include <algorithm>
+
+#include <class_board.h>
+#include <class_track.h>
+#include <class_pad.h>
+
+#include <drc_item_index.h>
+
+
+/* Returns the area covered by the copper of a track or a via (round ends included)
+ */
+static EDA_RECT trackArea( const TRACK* aTrack )
+{
+    EDA_RECT area( aTrack->GetStart(), wxSize( 0, 0 ) );
+
+    if( aTrack->Type() != PCB_VIA_T )
+        area.Merge( aTrack->GetEnd() );
+
+    area.Normalize();
+    area.Inflate( aTrack->GetWidth() / 2 + 1 );
+
+    return area;
+}
+
+
+/* Returns the area covered by a pad shape and its hole
+ */
+static EDA_RECT padArea( const D_PAD* aPad )
+{
+    EDA_RECT area( aPad->ShapePos(), wxSize( 0, 0 ) );
+    area.Inflate( aPad->GetBoundingRadius() + 1 );
+
+    const wxSize& drill = aPad->GetDrillSize();
+
+    if( drill.x || drill.y )
+    {
+        EDA_RECT hole( aPad->GetPosition(), wxSize( 0, 0 ) );
+        hole.Inflate( std::max( drill.x, drill.y ) / 2 + 1 );
+        area.Merge( hole );
+    }
+
+    return area;
+}
+
+
+/* Collects the item indexes found by an R-tree search
+ */
+struct INDEX_COLLECTOR
+{
+    std::vector<int>& m_result;
+    int               m_firstIndex;
+
+    INDEX_COLLECTOR( std::vector<int>& aResult, int aFirstIndex ) :
+        m_result( aResult ), m_firstIndex( aFirstIndex )
+    {}
+
+    bool operator()( int aIndex )
+    {
+        if( aIndex >= m_firstIndex )
+            m_result.push_back( aIndex );
+
+        return true;
+    }
+};
+
+
+DRC_ITEM_INDEX::DRC_ITEM_INDEX( BOARD* aBoard ) :
+    m_board( aBoard ),
+    m_maxClearance( 0 )
+{
+    for( TRACK* track = aBoard->m_Track; track; track = track->Next() )
+    {
+        int      index = m_tracks.size();
+        EDA_RECT area = trackArea( track );
+
+        const int mmin[2] = { area.GetX(), area.GetY() };
+        const int mmax[2] = { area.GetRight(), area.GetBottom() };
+
+        for( LSEQ cu = ( track->GetLayerSet() & LSET::AllCuMask() ).CuStack();  cu;  ++cu )
+            m_trackTrees[*cu].Insert( mmin, mmax, index );
+
+        m_tracks.push_back( track );
+        m_maxClearance = std::max( m_maxClearance, track->GetClearance( NULL ) );
+    }
+
+    for( unsigned ii = 0; ii < aBoard->GetPadCount(); ++ii )
+    {
+        D_PAD* pad = aBoard->GetPad( ii );
+
+        // padArea() also primes the lazily computed bounding radius of the pad,
+        // which must not be computed later from concurrent DRC threads.
+        EDA_RECT area = padArea( pad );
+
+        const int mmin[2] = { area.GetX(), area.GetY() };
+        const int mmax[2] = { area.GetRight(), area.GetBottom() };
+
+        m_padTree.Insert( mmin, mmax, (int) ii );
+
+        m_maxClearance = std::max( m_maxClearance, pad->GetClearance( NULL ) );
+    }
+}
+
+
+void DRC_ITEM_INDEX::queryTree( INDEX_TREE& aTree, const EDA_RECT& aArea, int aFirstIndex,
+                                std::vector<int>& aResult )
+{
+    const int mmin[2] = { aArea.GetX(), aArea.GetY() };
+    const int mmax[2] = { aArea.GetRight(), aArea.GetBottom() };
+
+    INDEX_COLLECTOR collector( aResult, aFirstIndex );
+
+    aTree.Search( mmin, mmax, collector );
+}
+
+
+void DRC_ITEM_INDEX::QueryTracks( const TRACK* aRefSeg, int aFirstIndex,
+                                  std::vector<TRACK*>& aResult )
+{
+    std::vector<int> found;
+    EDA_RECT         area = trackArea( aRefSeg );
+
+    area.Inflate( m_maxClearance );
+
+    for( LSEQ cu = ( aRefSeg->GetLayerSet() & LSET::AllCuMask() ).CuStack();  cu;  ++cu )
+        queryTree( m_trackTrees[*cu], area, aFirstIndex, found );
+
+    // A via is stored in each of its layers, and the tests must be made in list order
+    std::sort( found.begin(), found.end() );
+    found.erase( std::unique( found.begin(), found.end() ), found.end() );
+
+    aResult.clear();
+    aResult.reserve( found.size() );
+
+    for( unsigned ii = 0; ii < found.size(); ++ii )
+        aResult.push_back( m_tracks[found[ii]] );
+}
+
+
+void DRC_ITEM_INDEX::QueryPads( const TRACK* aRefSeg, std::vector<D_PAD*>& aResult )
+{
+    std::vector<int> found;
+    EDA_RECT         area = trackArea( aRefSeg );
+
+    area.Inflate( m_maxClearance );
+
+    queryTree( m_padTree, area, 0, found );
+
+    std::sort( found.begin(), found.end() );
+
+    aResult.clear();
+    aResult.reserve( found.size() );
+
+    for( unsigned ii = 0; ii < found.size(); ++ii )
+        aResult.push_back( m_board->GetPad( found[ii] ) );
+}
+
+
+void DRC_ITEM_INDEX::QueryArea( const EDA_RECT& aArea, std::vector<TRACK*>& aTracks,
+                                std::vector<D_PAD*>& aPads )
+{
+    std::vector<int> found;
+    EDA_RECT         area = aArea;
+
+    area.Normalize();
+    area.Inflate( m_maxClearance );
+
+    for( int layer = 0; layer < MAX_CU_LAYERS; ++layer )
+        queryTree( m_trackTrees[layer], area, 0, found );
+
+    std::sort( found.begin(), found.end() );
+    found.erase( std::unique( found.begin(), found.end() ), found.end() );
+
+    aTracks.clear();
+
+    for( unsigned ii = 0; ii < found.size(); ++ii )
+        aTracks.push_back( m_tracks[found[ii]] );
+
+    found.clear();
+    queryTree( m_padTree, area, 0, found );
+    std::sort( found.begin(), found.end() );
+
+    aPads.clear();
+
+    for( unsigned ii = 0; ii < found.size(); ++ii )
+        aPads.push_back( m_board->GetPad( found[ii] ) );
+}
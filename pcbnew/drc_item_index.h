@@ -0,0 +1,119 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file drc_item_index.h
+ */
+
+#ifndef DRC_ITEM_INDEX_H
+#define DRC_ITEM_INDEX_H
+
+#include <vector>
+
+#include <layers_id_colors_and_visibility.h>
+#include <geometry/rtree.h>
+
+class BOARD;
+class TRACK;
+class D_PAD;
+class EDA_RECT;
+
+
+/**
+ * Class DRC_ITEM_INDEX
+ * is a read-only spatial index of the copper items of a BOARD, used by the DRC
+ * to find the pads and tracks which may violate a clearance rule against a
+ * reference item, instead of walking the whole track list or pad list.
+ *
+ * Items are stored by their index in the board order (m_Track list order for tracks,
+ * BOARD::GetPad() order for pads), and queries return candidates sorted by this index,
+ * so the tests made on the candidates are done in the same order as the full sweep,
+ * and report the same first error.
+ *
+ * Tracks and vias are indexed in one R-tree per copper layer.  Pads are stored in a single
+ * R-tree, because the DRC tests their holes on all copper layers.
+ *
+ * Once built, the index can be queried simultaneously from several threads.
+ */
+class DRC_ITEM_INDEX
+{
+public:
+    DRC_ITEM_INDEX( BOARD* aBoard );
+
+    /**
+     * Function GetTracks
+     * @return the tracks and vias of the board, in m_Track list order.
+     */
+    const std::vector<TRACK*>& GetTracks() const { return m_tracks; }
+
+    /**
+     * Function GetMaxClearance
+     * @return the biggest clearance value used by a pad or a track of the board.
+     */
+    int GetMaxClearance() const { return m_maxClearance; }
+
+    /**
+     * Function QueryTracks
+     * collects the tracks and vias which can be closer than the clearance to aRefSeg,
+     * on one of its copper layers.
+     * @param aRefSeg is the reference track or via.
+     * @param aFirstIndex is the index of the first track to consider.  Tracks stored
+     *  before it are ignored (this mimics a test against aRefSeg->Next() and following).
+     * @param aResult is filled with the candidates, in m_Track list order.
+     */
+    void QueryTracks( const TRACK* aRefSeg, int aFirstIndex, std::vector<TRACK*>& aResult );
+
+    /**
+     * Function QueryPads
+     * collects the pads (or pad holes) which can be closer than the clearance to aRefSeg.
+     * @param aRefSeg is the reference track or via.
+     * @param aResult is filled with the candidates, in BOARD::GetPad() order.
+     */
+    void QueryPads( const TRACK* aRefSeg, std::vector<D_PAD*>& aResult );
+
+    /**
+     * Function QueryArea
+     * collects the tracks, vias and pads which can be closer than the clearance to
+     * a board area, on any copper layer.
+     * @param aArea is the area to search.
+     * @param aTracks is filled with the tracks found, in m_Track list order.
+     * @param aPads is filled with the pads found, in BOARD::GetPad() order.
+     */
+    void QueryArea( const EDA_RECT& aArea, std::vector<TRACK*>& aTracks,
+                    std::vector<D_PAD*>& aPads );
+
+private:
+    typedef RTree<int, int, 2, float> INDEX_TREE;
+
+    void queryTree( INDEX_TREE& aTree, const EDA_RECT& aArea, int aFirstIndex,
+                    std::vector<int>& aResult );
+
+    BOARD*              m_board;
+    std::vector<TRACK*> m_tracks;
+    int                 m_maxClearance;
+
+    INDEX_TREE          m_trackTrees[MAX_CU_LAYERS];
+    INDEX_TREE          m_padTree;
+};
+
+#endif  // DRC_ITEM_INDEX_H
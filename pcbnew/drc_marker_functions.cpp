@@ -49,6 +49,15 @@
 MARKER_PCB* DRC::fillMarker( const TRACK* aTrack, BOARD_ITEM* aItem, int aErrorCode,
                              MARKER_PCB* fillMe )
 {
+    if( m_recordViolations )
+    {
+        m_violation = DRC_VIOLATION();
+        m_violation.m_track = aTrack;
+        m_violation.m_item = aItem;
+        m_violation.m_errorCode = aErrorCode;
+        return NULL;
+    }
+
     wxString textA = aTrack->GetSelectMenuText();
     wxString textB;
 
@@ -127,6 +136,15 @@ MARKER_PCB* DRC::fillMarker( const TRACK* aTrack, BOARD_ITEM* aItem, int aErrorC
 
 MARKER_PCB* DRC::fillMarker( D_PAD* aPad, BOARD_ITEM* aItem, int aErrorCode, MARKER_PCB* fillMe )
 {
+    if( m_recordViolations )
+    {
+        m_violation = DRC_VIOLATION();
+        m_violation.m_pad = aPad;
+        m_violation.m_item = aItem;
+        m_violation.m_errorCode = aErrorCode;
+        return NULL;
+    }
+
     wxString textA = aPad->GetSelectMenuText();
     wxString textB;
 
@@ -167,6 +185,15 @@ MARKER_PCB* DRC::fillMarker( D_PAD* aPad, BOARD_ITEM* aItem, int aErrorCode, MAR
 }
 
 
+MARKER_PCB* DRC::createMarker( const DRC_VIOLATION& aViolation )
+{
+    if( aViolation.m_track )
+        return fillMarker( aViolation.m_track, aViolation.m_item, aViolation.m_errorCode, NULL );
+
+    return fillMarker( aViolation.m_pad, aViolation.m_item, aViolation.m_errorCode, NULL );
+}
+
+
 MARKER_PCB* DRC::fillMarker( ZONE_CONTAINER* aArea, int aErrorCode, MARKER_PCB* fillMe )
 {
     wxString textA = aArea->GetSelectMenuText();
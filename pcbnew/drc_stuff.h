@@ -29,9 +29,12 @@
 #ifndef _DRC_STUFF_H
 #define _DRC_STUFF_H
 
+#include <map>
 #include <memory>
 #include <vector>
 
+#include <class_eda_rect.h>
+
 #define OK_DRC  0
 #define BAD_DRC 1
 
@@ -140,6 +143,29 @@ public:
 typedef std::vector<DRC_ITEM*> DRC_LIST;
 
 
+/**
+ * Struct DRC_VIOLATION
+ * is what a worker DRC object records of a track or pad clearance violation.  Markers
+ * and their messages (made with wxString and translations) cannot be created on
+ * worker threads, so they are created from the violations after the parallel tests.
+ */
+struct DRC_VIOLATION
+{
+    const TRACK*    m_track;        ///< the reference track, or NULL for a pad
+    D_PAD*          m_pad;          ///< the reference pad, when m_track is NULL
+    BOARD_ITEM*     m_item;         ///< the other item, or NULL
+    int             m_errorCode;    ///< 0 when there is no violation
+
+    DRC_VIOLATION() :
+        m_track( NULL ),
+        m_pad( NULL ),
+        m_item( NULL ),
+        m_errorCode( 0 )
+    {
+    }
+};
+
+
 /**
  * Class DRC
  * is the Design Rule Checker, and performs all the DRC tests.  The output of
@@ -162,11 +188,16 @@ private:
     bool     m_doZonesTest;
     bool     m_doKeepoutTest;
     bool     m_doCreateRptFile;
+    bool     m_useSpatialIndex;     ///< use the spatially indexed, multi-threaded clearance tests
+    bool     m_doIncrementalTests;  ///< test the changed items again after each edit
 
     wxString m_rptFilename;
 
     MARKER_PCB* m_currentMarker;
 
+    bool          m_recordViolations;   ///< record violations instead of creating markers
+    DRC_VIOLATION m_violation;          ///< the last violation recorded
+
     bool        m_abortDRC;
     bool        m_drcInProgress;
 
@@ -199,6 +230,19 @@ private:
 
     DRC_LIST            m_unconnected;  ///< list of unconnected pads, as DRC_ITEMs
 
+    /* Data used by the incremental DRC (see RunIncrementalTests()):
+     * the pad and track clearance markers, with the reference item they were created for,
+     * the items changed since the last run, with the area they covered when marked,
+     * and the areas of the items deleted since the last run.
+     * Items are only recorded when the incremental mode is on, and are forgotten when
+     * deleted (see MarkDeleted()).  Markers can still be deleted by the user, so the
+     * pointers are only dereferenced after being found in the board.
+     */
+    BOARD*                                  m_baselineBoard;    ///< board tested by the last run
+    std::map<MARKER_PCB*, const BOARD_ITEM*> m_clearanceMarkers;
+    std::map<const BOARD_ITEM*, EDA_RECT>   m_dirtyItems;
+    std::vector<EDA_RECT>                   m_dirtyAreas;
+
 
     /**
      * Function updatePointers
@@ -207,6 +251,13 @@ private:
      */
     void updatePointers();
 
+    /**
+     * Function addClearanceMarker
+     * adds a marker created by the pad or track clearance tests to the board and the view,
+     * and remembers the item tested when it was created, for the incremental DRC.
+     */
+    void addClearanceMarker( MARKER_PCB* aMarker, const BOARD_ITEM* aRefItem );
+
 
     /**
      * Function fillMarker
@@ -252,6 +303,20 @@ private:
      */
     MARKER_PCB* fillMarker( int aErrorCode, const wxString& aMessage, MARKER_PCB* fillMe );
 
+    /**
+     * Function newWorker
+     * creates a DRC object for the parallel clearance tests, which records the
+     * violations (see m_violation) rather than creating markers.
+     */
+    DRC* newWorker() const;
+
+    /**
+     * Function createMarker
+     * creates the marker of a violation recorded by a worker DRC object.
+     * Must be called from the main thread.
+     */
+    MARKER_PCB* createMarker( const DRC_VIOLATION& aViolation );
+
 
     //-----<categorical group tests>-----------------------------------------
 
@@ -277,6 +342,15 @@ private:
      */
     void testTracks( wxWindow * aActiveWindow, bool aShowProgressBar );
 
+    /**
+     * Function testTracksIndexed
+     * performs the same tests as testTracks(), but each track is only tested against
+     * the pads and tracks found near it in a DRC_ITEM_INDEX, and the tracks are tested
+     * in parallel (when OpenMP is available).
+     * Markers are added to the board in the same order as testTracks() does.
+     */
+    void testTracksIndexed( wxWindow * aActiveWindow, bool aShowProgressBar );
+
     void testPad2Pad();
 
     void testUnconnected();
@@ -308,10 +382,16 @@ private:
      * @param aRefSeg The segment to test
      * @param aStart The head of a list of tracks to test against (usually BOARD::m_Track)
      * @param doPads true if should do pads test
+     * @param aPadCandidates if not NULL, the pads to test against, instead of all
+     *          the board pads.
+     * @param aTrackCandidates if not NULL, the tracks to test against, instead of
+     *          aStart and following tracks.
      * @return bool - true if no poblems, else false and m_currentMarker is
      *          filled in with the problem information.
      */
-    bool doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool doPads = true );
+    bool doTrackDrc( TRACK* aRefSeg, TRACK* aStart, bool doPads = true,
+                     const std::vector<D_PAD*>* aPadCandidates = NULL,
+                     const std::vector<TRACK*>* aTrackCandidates = NULL );
 
     /**
      * Function doTrackKeepoutDrc
@@ -475,6 +555,48 @@ public:
         m_doCreateRptFile   = aSaveReport;
     }
 
+    /**
+     * Function SetSpatialIndexMode
+     * selects how the pad and track clearance tests are run by RunTests().
+     * @param aEnable = true to test each item only against its neighbours found in
+     *  a per layer R-tree, using all the available cores; false to use the
+     *  sorted list sweeps.  Both modes create the same markers, in the same order.
+     */
+    void SetSpatialIndexMode( bool aEnable )
+    {
+        m_useSpatialIndex = aEnable;
+    }
+
+    /**
+     * Function SetIncrementalMode
+     * enables or disables the incremental DRC: when enabled, the pad and track clearances
+     * of the items changed after a DRC run are tested again after each edit
+     * (see RunIncrementalTests()).  Disabling it forgets the changed items.
+     */
+    void SetIncrementalMode( bool aEnable );
+
+    bool IsIncrementalMode() const
+    {
+        return m_doIncrementalTests;
+    }
+
+    /**
+     * Function ClearIncrementalData
+     * forgets the clearance markers and the changed items recorded for the incremental
+     * DRC, which then waits for the next RunTests().  Called when the board is replaced.
+     */
+    void ClearIncrementalData();
+
+    /**
+     * Function NeedsIncrementalTests
+     * @return true if the incremental mode is on and items were changed since the last
+     *  DRC run on the current board.
+     */
+    bool NeedsIncrementalTests() const
+    {
+        return m_doIncrementalTests && ( !m_dirtyItems.empty() || !m_dirtyAreas.empty() );
+    }
+
 
     /**
      * Function RunTests
@@ -491,6 +613,36 @@ public:
      */
     void ListUnconnectedPads();
 
+    /**
+     * Function MarkDirty
+     * records that aItem is about to be changed, added or deleted, so the next call to
+     * RunIncrementalTests() tests it again, with the items near its current area and
+     * near the area it covers now (before the change).
+     * This is called from the undo/redo commands, for each item stored in the undo list.
+     * Pads and module texts are recorded as their parent module.
+     * Nothing is recorded if the incremental mode is off, or if the clearance tests were
+     * not run on the current board.
+     */
+    void MarkDirty( const BOARD_ITEM* aItem );
+
+    /**
+     * Function MarkDeleted
+     * records that aItem is removed from the board: its area is kept, to test again the
+     * items near it, but the item itself is forgotten, because it can be freed before the
+     * next call to RunIncrementalTests().
+     */
+    void MarkDeleted( const BOARD_ITEM* aItem );
+
+    /**
+     * Function RunIncrementalTests
+     * runs the pad and track clearance tests, only for the items changed since the last
+     * DRC run (see MarkDirty()) and the items near them.  The clearance markers of these
+     * items are replaced, all other markers are kept.
+     * If the clearance tests were never run on the current board, they are run on the
+     * whole board.
+     */
+    void RunIncrementalTests();
+
     /**
      * @return a pointer to the current marker (last created marker
      */
@@ -31,6 +31,7 @@
 #include <eagle_plugin.h>
 #include <pcad2kicadpcb_plugin/pcad_plugin.h>
 #include <gpcb_plugin.h>
+#include <snapshot_plugin.h>
 #include <config.h>
 
 #if defined(BUILD_GITHUB_PLUGIN)
@@ -98,6 +99,9 @@ PLUGIN* IO_MGR::PluginFind( PCB_FILE_T aFileType )
 #else
         THROW_IO_ERROR( "BUILD_GITHUB_PLUGIN not enabled in cmake build environment" );
 #endif
+
+    case KICAD_SNAPSHOT:
+        return new SNAPSHOT_PLUGIN();
     }
 
     return NULL;
@@ -142,6 +146,9 @@ const wxString IO_MGR::ShowType( PCB_FILE_T aType )
 
     case GITHUB:
         return wxString( wxT( "Github" ) );
+
+    case KICAD_SNAPSHOT:
+        return wxString( wxT( "KiCad-Snapshot" ) );
     }
 }
 
@@ -170,6 +177,9 @@ IO_MGR::PCB_FILE_T IO_MGR::EnumFromStr( const wxString& aType )
     if( aType == wxT( "Github" ) )
         return GITHUB;
 
+    if( aType == wxT( "KiCad-Snapshot" ) )
+        return KICAD_SNAPSHOT;
+
     // wxASSERT( blow up here )
 
     return PCB_FILE_T( -1 );
@@ -78,6 +78,7 @@ public:
         PCAD,
         GEDA_PCB,       ///< Geda PCB file formats.
         GITHUB,         ///< Read only http://github.com repo holding pretty footprints
+        KICAD_SNAPSHOT, ///< Binary board snapshot, for autosave and crash recovery.
 
         // add your type here.
 
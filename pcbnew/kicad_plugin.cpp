@@ -51,8 +51,13 @@
 #include <wx/filename.h>
 #include <wx/wfstream.h>
 #include <boost/ptr_container/ptr_map.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
 #include <memory.h>
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
 using namespace PCB_KEYS_T;
 
 #define FMTIU        BOARD_ITEM::FormatInternalUnits
@@ -63,6 +68,36 @@ using namespace PCB_KEYS_T;
  */
 static const wxString traceFootprintLibrary( wxT( "KicadFootprintLib" ) );
 
+/// Board item lists shorter than this are formatted sequentially
+static const int    PARALLEL_SAVE_MIN_ITEMS = 256;
+
+/// No. of board items formatted in parallel before their text is written out
+static const int    PARALLEL_SAVE_BLOCK_ITEMS = 1024;
+
+
+/* Returns the number of threads used to format the board items
+ */
+static int saveThreadCount()
+{
+#ifdef USE_OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+
+/* Returns the index of the calling thread in the board item formatting loop
+ */
+static int saveThreadNum()
+{
+#ifdef USE_OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
 ///> Removes empty nets (i.e. with node count equal zero) from net classes
 void filterNetClass( const BOARD& aBoard, NETCLASS& aNetClass )
 {
@@ -90,7 +125,7 @@ class FP_CACHE_ITEM
 {
     wxFileName              m_file_name; ///< The the full file name and path of the footprint to cache.
     wxDateTime              m_mod_time;  ///< The last file modified time stamp.
-    std::auto_ptr<MODULE>   m_module;
+    std::auto_ptr<MODULE>   m_module;    ///< NULL until the footprint file is parsed.
 
 public:
     FP_CACHE_ITEM( MODULE* aModule, const wxFileName& aFileName );
@@ -103,6 +138,13 @@ public:
 
     MODULE*     GetModule() const { return m_module.get(); }
     void        UpdateModificationTime() { m_mod_time = m_file_name.GetModificationTime(); }
+
+    /// Take ownership of \a aModule, freshly parsed from the footprint file.
+    void        SetModule( MODULE* aModule )
+    {
+        m_module.reset( aModule );
+        UpdateModificationTime();
+    }
 };
 
 
@@ -160,22 +202,38 @@ public:
     /// save the entire legacy library to m_lib_name;
     void Save();
 
+    /**
+     * Function Load
+     * reads the list of footprint files in the library.  The files themselves are
+     * parsed on demand by GetModule().  Footprints already parsed by an earlier call
+     * are kept if their files are still in the library.
+     */
     void Load();
 
+    /**
+     * Function GetModule
+     * returns the footprint \a aFootprintName, parsing its file if this was not done
+     * yet or if the file changed since it was parsed.
+     *
+     * @return MODULE* - the cached footprint, or NULL if the library has no such footprint.
+     */
+    MODULE* GetModule( const wxString& aFootprintName );
+
     void Remove( const wxString& aFootprintName );
 
     wxDateTime GetLibModificationTime() const;
 
     /**
      * Function IsModified
-     * check if the footprint cache has been modified relative to \a aLibPath
-     * and \a aFootprintName.
+     * check if the list of footprint files needs to be read again for \a aLibPath
+     * and \a aFootprintName.  Changes to the content of a footprint file are picked
+     * up by GetModule() instead, one file at a time.
      *
      * @param aLibPath is a path to test the current cache library path against.
      * @param aFootprintName is the footprint name in the cache to test.  If the footprint
-     *                       name is empty, the all the footprint files in the library are
-     *                       checked to see if they have been modified.
-     * @return true if the cache has been modified.
+     *                       name is not empty and is not in the cache, it may have been
+     *                       added to the library.
+     * @return true if the library path changed or files were added to or removed from it.
      */
     bool IsModified( const wxString& aLibPath,
                      const wxString& aFootprintName = wxEmptyString ) const;
@@ -227,6 +285,10 @@ void FP_CACHE::Save()
     {
         wxFileName fn = it->second->GetFileName();
 
+        // A footprint never parsed was not changed either.
+        if( !it->second->GetModule() )
+            continue;
+
         if( fn.FileExists() && !it->second->IsModified() )
             continue;
 
@@ -285,8 +347,9 @@ void FP_CACHE::Load()
         THROW_IO_ERROR( msg );
     }
 
-    wxString fpFileName;
-    wxString wildcard = wxT( "*." ) + KiCadFootprintFileExtension;
+    wxString    fpFileName;
+    wxString    wildcard = wxT( "*." ) + KiCadFootprintFileExtension;
+    MODULE_MAP  modules;
 
     if( dir.GetFirst( &fpFileName, wildcard, wxDIR_FILES ) )
     {
@@ -295,24 +358,57 @@ void FP_CACHE::Load()
             // prepend the libpath into fullPath
             wxFileName fullPath( m_lib_path.GetPath(), fpFileName );
 
-            FILE_LINE_READER    reader( fullPath.GetFullPath() );
-
-            m_owner->m_parser->SetLineReader( &reader );
-
+            // The footprint name is the file name without the extension.
             std::string name = TO_UTF8( fullPath.GetName() );
-            MODULE*     footprint = (MODULE*) m_owner->m_parser->Parse();
+            MODULE_ITER it   = m_modules.find( name );
 
-            // The footprint name is the file name without the extension.
-            footprint->SetFPID( FPID( fullPath.GetName() ) );
-            m_modules.insert( name, new FP_CACHE_ITEM( footprint, fullPath ) );
+            if( it != m_modules.end() )
+                modules.transfer( it, m_modules );
+            else
+                modules.insert( name, new FP_CACHE_ITEM( NULL, fullPath ) );
 
         } while( dir.GetNext( &fpFileName ) );
-
-        // Remember the file modification time of library file when the
-        // cache snapshot was made, so that in a networked environment we will
-        // reload the cache as needed.
-        m_mod_time = GetLibModificationTime();
     }
+
+    // Footprints whose files are gone are deleted with the old map.
+    m_modules.swap( modules );
+
+    // Remember the file modification time of library file when the
+    // cache snapshot was made, so that in a networked environment we will
+    // reload the cache as needed.
+    m_mod_time = GetLibModificationTime();
+}
+
+
+MODULE* FP_CACHE::GetModule( const wxString& aFootprintName )
+{
+    MODULE_ITER it = m_modules.find( TO_UTF8( aFootprintName ) );
+
+    if( it == m_modules.end() )
+        return NULL;
+
+    FP_CACHE_ITEM*  item = it->second;
+    wxFileName      fn = item->GetFileName();
+
+    if( item->GetModule() && !item->IsModified() )
+        return item->GetModule();
+
+    if( !fn.FileExists() )
+        return item->GetModule();
+
+    wxLogTrace( traceFootprintLibrary, wxT( "Parsing footprint file '%s'." ),
+                GetChars( fn.GetFullPath() ) );
+
+    MMAP_LINE_READER    reader( fn.GetFullPath() );
+
+    m_owner->m_parser->SetLineReader( &reader );
+
+    MODULE* footprint = (MODULE*) m_owner->m_parser->Parse();
+
+    footprint->SetFPID( FPID( fn.GetName() ) );
+    item->SetModule( footprint );
+
+    return footprint;
 }
 
 
@@ -336,6 +432,8 @@ void FP_CACHE::Remove( const wxString& aFootprintName )
     wxString fullPath = it->second->GetFileName().GetFullPath();
     m_modules.erase( footprintName );
     wxRemoveFile( fullPath );
+
+    m_mod_time = GetLibModificationTime();
 }
 
 
@@ -355,47 +453,33 @@ bool FP_CACHE::IsModified( const wxString& aLibPath, const wxString& aFootprintN
     if( !m_lib_path.DirExists() || !IsPath( aLibPath ) )
         return true;
 
-    // If no footprint was specified, check every file modification time against the time
-    // it was loaded.
-    if( aFootprintName.IsEmpty() )
+    // Adding, removing or renaming a footprint file changes the modification time of
+    // the library directory.  Editing a file does not, GetModule() checks the files.
+    if( GetLibModificationTime() != m_mod_time )
     {
-        for( MODULE_CITER it = m_modules.begin();  it != m_modules.end();  ++it )
-        {
-            wxFileName fn = m_lib_path;
-
-            fn.SetName( it->second->GetFileName().GetName() );
-            fn.SetExt( KiCadFootprintFileExtension );
-
-            if( !fn.FileExists() )
-            {
-                wxLogTrace( traceFootprintLibrary,
-                            wxT( "Footprint cache file '%s' does not exist." ),
-                            fn.GetFullPath().GetData() );
-                return true;
-            }
-
-            if( it->second->IsModified() )
-            {
-                wxLogTrace( traceFootprintLibrary,
-                            wxT( "Footprint cache file '%s' has been modified." ),
-                            fn.GetFullPath().GetData() );
-                return true;
-            }
-        }
+        wxLogTrace( traceFootprintLibrary,
+                    wxT( "Footprint library '%s' file list has been modified." ),
+                    GetChars( m_lib_path.GetPath() ) );
+        return true;
     }
-    else
-    {
-        MODULE_CITER it = m_modules.find( TO_UTF8( aFootprintName ) );
 
-        if( it == m_modules.end() || it->second->IsModified() )
-            return true;
-    }
+    if( !aFootprintName.IsEmpty() && m_modules.find( TO_UTF8( aFootprintName ) ) == m_modules.end() )
+        return true;
 
     return false;
 }
 
 
 void PCB_IO::Save( const wxString& aFileName, BOARD* aBoard, const PROPERTIES* aProperties )
+{
+    FILE_OUTPUTFORMATTER    formatter( aFileName );
+
+    FormatBoard( aBoard, &formatter, aProperties );
+}
+
+
+void PCB_IO::FormatBoard( BOARD* aBoard, OUTPUTFORMATTER* aFormatter,
+                          const PROPERTIES* aProperties )
 {
     LOCALE_IO   toggle;     // toggles on, then off, the C locale.
 
@@ -406,12 +490,10 @@ void PCB_IO::Save( const wxString& aFileName, BOARD* aBoard, const PROPERTIES* a
     // Prepare net mapping that assures that net codes saved in a file are consecutive integers
     m_mapping->SetBoard( aBoard );
 
-    FILE_OUTPUTFORMATTER    formatter( aFileName );
-
-    m_out = &formatter;     // no ownership
+    m_out = aFormatter;     // no ownership
 
     m_out->Print( 0, "(kicad_pcb (version %d) (host pcbnew %s)\n", SEXPR_BOARD_FILE_VERSION,
-                  formatter.Quotew( GetBuildVersion() ).c_str() );
+                  m_out->Quotew( GetBuildVersion() ).c_str() );
 
     Format( aBoard, 1 );
 
@@ -729,11 +811,15 @@ void PCB_IO::format( BOARD* aBoard, int aNestLevel ) const
         netclass.Format( m_out, aNestLevel, m_ctl );
     }
 
+    std::vector<BOARD_ITEM*> items;
+
     // Save the modules.
-    for( MODULE* module = aBoard->m_Modules;  module;  module = module->Next() )
+    if( !( m_ctl & CTL_OMIT_MODULES ) )
     {
-        Format( module, aNestLevel );
-        m_out->Print( 0, "\n" );
+        for( MODULE* module = aBoard->m_Modules;  module;  module = module->Next() )
+            items.push_back( module );
+
+        formatItems( items, aNestLevel, "\n" );
     }
 
     // Save the graphical items on the board (not owned by a module)
@@ -746,18 +832,129 @@ void PCB_IO::format( BOARD* aBoard, int aNestLevel ) const
     // Do not save MARKER_PCBs, they can be regenerated easily.
 
     // Save the tracks and vias.
-    for( TRACK* track = aBoard->m_Track;  track; track = track->Next() )
-        Format( track, aNestLevel );
+    if( !( m_ctl & CTL_OMIT_TRACKS ) )
+    {
+        items.clear();
 
-    if( aBoard->m_Track.GetCount() )
-        m_out->Print( 0, "\n" );
+        for( TRACK* track = aBoard->m_Track;  track; track = track->Next() )
+            items.push_back( track );
+
+        formatItems( items, aNestLevel, NULL );
+
+        if( aBoard->m_Track.GetCount() )
+            m_out->Print( 0, "\n" );
+    }
 
     /// @todo Add warning here that the old segment filed zones are no longer supported and
     ///       will not be saved.
 
     // Save the polygon (which are the newer technology) zones.
+    items.clear();
+
     for( int i = 0; i < aBoard->GetAreaCount();  ++i )
-        Format( aBoard->GetArea( i ), aNestLevel );
+        items.push_back( aBoard->GetArea( i ) );
+
+    formatItems( items, aNestLevel, NULL );
+}
+
+
+void PCB_IO::formatItems( const std::vector<BOARD_ITEM*>& aItems, int aNestLevel,
+                          const char* aSeparator ) const
+    throw( IO_ERROR )
+{
+    int itemCount   = aItems.size();
+    int threadCount = saveThreadCount();
+
+    if( threadCount < 2 || itemCount < PARALLEL_SAVE_MIN_ITEMS )
+    {
+        for( int ii = 0; ii < itemCount; ++ii )
+        {
+            Format( aItems[ii], aNestLevel );
+
+            if( aSeparator )
+                m_out->Write( aSeparator, strlen( aSeparator ) );
+        }
+
+        return;
+    }
+
+    // The worker formatters know the board and the net code mapping, and write to
+    // their own string
+    boost::ptr_vector<PCB_IO> workers;
+
+    for( int ii = 0; ii < threadCount; ++ii )
+    {
+        PCB_IO* worker = new PCB_IO( m_ctl );
+
+        worker->m_board    = m_board;
+        worker->m_props    = m_props;
+        *worker->m_mapping = *m_mapping;
+
+        workers.push_back( worker );
+    }
+
+    std::vector<std::string>    texts( PARALLEL_SAVE_BLOCK_ITEMS );
+    std::vector<IO_ERROR>       errors( PARALLEL_SAVE_BLOCK_ITEMS );
+    std::vector<char>           failed( PARALLEL_SAVE_BLOCK_ITEMS );
+
+    for( int first = 0; first < itemCount; first += PARALLEL_SAVE_BLOCK_ITEMS )
+    {
+        int blockCount = std::min( PARALLEL_SAVE_BLOCK_ITEMS, itemCount - first );
+
+        std::fill( failed.begin(), failed.end(), 0 );
+
+#ifdef USE_OPENMP
+        #pragma omp parallel for schedule(dynamic, 16)
+#endif
+        for( int ii = 0; ii < blockCount; ++ii )
+        {
+            PCB_IO& worker = workers[saveThreadNum()];
+
+            // No exception may leave the parallel loop: each one is kept with its item
+            // and thrown by the main thread
+            try
+            {
+                worker.Format( aItems[first + ii], aNestLevel );
+
+                if( aSeparator )
+                    worker.m_out->Write( aSeparator, strlen( aSeparator ) );
+
+                texts[ii] = worker.GetStringOutput( true );
+            }
+            catch( const IO_ERROR& ioe )
+            {
+                errors[ii] = ioe;
+                failed[ii] = 1;
+            }
+            catch( const std::exception& e )
+            {
+                errors[ii] = IO_ERROR( __FILE__, __LOC__,
+                                       wxString::Format( _( "Error saving board: %s" ),
+                                                         wxString::FromUTF8( e.what() ) ) );
+                failed[ii] = 1;
+            }
+            catch( ... )
+            {
+                errors[ii] = IO_ERROR( __FILE__, __LOC__, _( "Unknown error saving board" ) );
+                failed[ii] = 1;
+            }
+
+            // Drop the partial output of a failed item
+            if( failed[ii] )
+                worker.m_sf.Clear();
+        }
+
+        // Write the text in the list order.  An error is reported after writing the
+        // items which precede it, as when the items are formatted sequentially.
+        for( int ii = 0; ii < blockCount; ++ii )
+        {
+            if( failed[ii] )
+                throw errors[ii];
+
+            m_out->Write( texts[ii].data(), texts[ii].size() );
+            texts[ii].clear();
+        }
+    }
 }
 
 
@@ -1625,6 +1822,12 @@ void PCB_IO::format( ZONE_CONTAINER* aZone, int aNestLevel ) const
         m_out->Print( aNestLevel+1, ")\n" );
     }
 
+    if( m_ctl & CTL_OMIT_ZONE_FILLS )
+    {
+        m_out->Print( aNestLevel, ")\n" );
+        return;
+    }
+
     // Save the PolysList
     const SHAPE_POLY_SET& fv = aZone->GetFilledPolysList();
     newLine = 0;
@@ -1715,7 +1918,10 @@ PCB_IO::~PCB_IO()
 
 BOARD* PCB_IO::Load( const wxString& aFileName, BOARD* aAppendToMe, const PROPERTIES* aProperties )
 {
-    FILE_LINE_READER    reader( aFileName );
+    // A large board is mapped: saving it from another program while it is loaded
+    // truncates it under the reader (see MMAP_LINE_READER).  The board lock file
+    // keeps two instances of pcbnew from doing that.
+    MMAP_LINE_READER    reader( aFileName );
 
     init( aProperties );
 
@@ -1744,13 +1950,18 @@ void PCB_IO::init( const PROPERTIES* aProperties )
 
 void PCB_IO::cacheLib( const wxString& aLibraryPath, const wxString& aFootprintName )
 {
-    if( !m_cache || m_cache->IsModified( aLibraryPath, aFootprintName ) )
+    if( !m_cache || !m_cache->IsPath( aLibraryPath ) )
     {
         // a spectacular episode in memory management:
         delete m_cache;
         m_cache = new FP_CACHE( this, aLibraryPath );
         m_cache->Load();
     }
+    else if( m_cache->IsModified( aLibraryPath, aFootprintName ) )
+    {
+        // Only the file list is read again, the footprints parsed so far are kept.
+        m_cache->Load();
+    }
 }
 
 
@@ -1769,29 +1980,15 @@ wxArrayString PCB_IO::FootprintEnumerate( const wxString&   aLibraryPath,
 
     init( aProperties );
 
-#if 1                         // Set to 0 to only read directory contents, not load cache.
+    // Only reads the directory contents, the footprints are parsed by FootprintLoad().
     cacheLib( aLibraryPath );
 
     const MODULE_MAP& mods = m_cache->GetModules();
 
-
     for( MODULE_CITER it = mods.begin();  it != mods.end();  ++it )
     {
         ret.Add( FROM_UTF8( it->first.c_str() ) );
     }
-#else
-    wxString fpFileName;
-    wxString wildcard = wxT( "*." ) + KiCadFootprintFileExtension;
-
-    if( dir.GetFirst( &fpFileName, wildcard, wxDIR_FILES ) )
-    {
-        do
-        {
-            wxFileName fn( aLibraryPath, fpFileName );
-            ret.Add( fn.GetName() );
-        } while( dir.GetNext( &fpFileName ) );
-    }
-#endif
 
     return ret;
 }
@@ -1806,17 +2003,15 @@ MODULE* PCB_IO::FootprintLoad( const wxString& aLibraryPath, const wxString& aFo
 
     cacheLib( aLibraryPath, aFootprintName );
 
-    const MODULE_MAP& mods = m_cache->GetModules();
-
-    MODULE_CITER it = mods.find( TO_UTF8( aFootprintName ) );
+    const MODULE* footprint = m_cache->GetModule( aFootprintName );
 
-    if( it == mods.end() )
+    if( !footprint )
     {
         return NULL;
     }
 
     // copy constructor to clone the already loaded MODULE
-    return new MODULE( *it->second->GetModule() );
+    return new MODULE( *footprint );
 }
 
 
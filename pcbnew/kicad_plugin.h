@@ -26,6 +26,7 @@
 
 #include <io_mgr.h>
 #include <string>
+#include <vector>
 #include <layers_id_colors_and_visibility.h>
 
 class BOARD;
@@ -48,6 +49,10 @@ class NETINFO_MAPPING;
 #define CTL_OMIT_PATH               (1 << 4)    ///< Omit component sheet time stamp (useless in library)
 #define CTL_OMIT_AT                 (1 << 5)    ///< Omit position and rotation
                                                 // (always saved with potion 0,0 and rotation = 0 in library)
+#define CTL_OMIT_TRACKS             (1 << 6)    ///< Omit tracks and vias (saved apart in board snapshots)
+#define CTL_OMIT_ZONE_FILLS         (1 << 7)    ///< Omit zone filled polygons and fill segments
+                                                // (saved apart in board snapshots)
+#define CTL_OMIT_MODULES            (1 << 8)    ///< Omit footprints (saved apart in board snapshots)
 
 
 // common combinations of the above:
@@ -141,6 +146,18 @@ public:
     void Format( BOARD_ITEM* aItem, int aNestLevel = 0 ) const
         throw( IO_ERROR );
 
+    /**
+     * Function FormatBoard
+     * outputs \a aBoard to \a aFormatter as a complete kicad_pcb file, as Save() does.
+     *
+     * @param aBoard is the board to output.
+     * @param aFormatter is where to output the board to.
+     * @param aProperties is passed as in Save().
+     * @throw IO_ERROR on write error.
+     */
+    void FormatBoard( BOARD* aBoard, OUTPUTFORMATTER* aFormatter,
+                      const PROPERTIES* aProperties = NULL );
+
     std::string GetStringOutput( bool doClear )
     {
         std::string ret = m_sf.GetString();
@@ -185,6 +202,20 @@ private:
     void format( BOARD* aBoard, int aNestLevel = 0 ) const
         throw( IO_ERROR );
 
+    /**
+     * Function formatItems
+     * outputs the board items \a aItems in list order, each one followed by
+     * \a aSeparator if it is not NULL.
+     *
+     * Long lists are formatted by worker threads into one string per item, a block of
+     * items at a time.  The strings of a block are written to m_out in list order
+     * before the next block is formatted, so the output is the same as when the items
+     * are formatted one after the other, and only one block is held in memory.
+     */
+    void formatItems( const std::vector<BOARD_ITEM*>& aItems, int aNestLevel,
+                      const char* aSeparator ) const
+        throw( IO_ERROR );
+
     void format( DIMENSION* aDimension, int aNestLevel = 0 ) const
         throw( IO_ERROR );
 
@@ -351,6 +351,7 @@ void PCB_EDIT_FRAME::Change_Side_Module( MODULE* Module, wxDC* DC )
 void PCB_BASE_FRAME::PlaceModule( MODULE* aModule, wxDC* aDC, bool aDoNotRecreateRatsnest )
 {
     wxPoint newpos;
+    wxPoint moveVector;
 
     if( aModule == 0 )
         return;
@@ -358,10 +359,20 @@ void PCB_BASE_FRAME::PlaceModule( MODULE* aModule, wxDC* aDC, bool aDoNotRecreat
     OnModify();
     GetBoard()->m_Status_Pcb &= ~( LISTE_RATSNEST_ITEM_OK | CONNEXION_OK);
 
+    newpos = GetCrossHairPosition();
+
     if( aModule->IsNew() )
     {
         SaveCopyInUndoList( aModule, UR_NEW );
     }
+    else if( aModule->IsMoving() && s_ModuleInitialCopy
+             && s_ModuleInitialCopy->GetOrientation() == aModule->GetOrientation()
+             && s_ModuleInitialCopy->GetLayer() == aModule->GetLayer() )
+    {
+        // The module was only moved: keep the move vector instead of a copy of the module
+        moveVector = newpos - s_ModuleInitialCopy->GetPosition();
+        s_PickedList.PushItem( ITEM_PICKER( aModule, UR_MOVED ) );
+    }
     else if( aModule->IsMoving() )
     {
         ITEM_PICKER picker( aModule, UR_CHANGED );
@@ -372,7 +383,7 @@ void PCB_BASE_FRAME::PlaceModule( MODULE* aModule, wxDC* aDC, bool aDoNotRecreat
 
     if( s_PickedList.GetCount() )
     {
-        SaveCopyInUndoList( s_PickedList, UR_UNSPECIFIED );
+        SaveCopyInUndoList( s_PickedList, UR_UNSPECIFIED, moveVector );
 
         // Clear list, but DO NOT delete items, because they are owned by the saved undo
         // list and they therefore in use
@@ -384,7 +395,6 @@ void PCB_BASE_FRAME::PlaceModule( MODULE* aModule, wxDC* aDC, bool aDoNotRecreat
     if( displ_opts->m_Show_Module_Ratsnest && ( GetBoard()->m_Status_Pcb & LISTE_PAD_OK ) && aDC )
         TraceModuleRatsNest( aDC );
 
-    newpos = GetCrossHairPosition();
     aModule->SetPosition( newpos );
     aModule->ClearFlags();
 
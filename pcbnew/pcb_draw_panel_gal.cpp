@@ -106,6 +106,10 @@ EDA_DRAW_PANEL_GAL( aParentWindow, aWindowId, aPosition, aSize, aGalType )
     setDefaultLayerOrder();
     setDefaultLayerDeps();
 
+    // Board items may be tessellated concurrently, each of them by a single thread. The data
+    // cached on demand in the items is computed beforehand by PCB_PAINTER::PrepareDraw().
+    m_view->SetParallelCaching( true );
+
     // Load display options (such as filled/outline display of items).
     // Can be made only if the parent window is an EDA_DRAW_FRAME (or a derived class)
     // which is not always the case (namely when it is used from a wxDialog like the pad editor)
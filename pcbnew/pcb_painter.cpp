@@ -212,6 +212,47 @@ PCB_PAINTER::PCB_PAINTER( GAL* aGal ) :
 }
 
 
+PAINTER* PCB_PAINTER::Clone( GAL* aGal ) const
+{
+    PCB_PAINTER* painter = new PCB_PAINTER( aGal );
+    painter->m_pcbSettings = m_pcbSettings;
+
+    return painter;
+}
+
+
+bool PCB_PAINTER::PrepareDraw( const VIEW_ITEM* aItem ) const
+{
+    const EDA_ITEM* item = static_cast<const EDA_ITEM*>( aItem );
+
+    switch( item->Type() )
+    {
+    case PCB_PAD_T:
+        // The bounding radius is computed on demand, also by the pad hit tests
+        static_cast<const D_PAD*>( item )->GetBoundingRadius();
+        return true;
+
+    case PCB_ZONE_T:
+    case PCB_TRACE_T:
+    case PCB_VIA_T:
+    case PCB_LINE_T:
+    case PCB_MODULE_EDGE_T:
+    case PCB_TEXT_T:
+    case PCB_MODULE_TEXT_T:
+    case PCB_MODULE_T:
+    case PCB_ZONE_AREA_T:
+    case PCB_DIMENSION_T:
+    case PCB_TARGET_T:
+    case PCB_MARKER_T:
+        return true;
+
+    default:
+        // Drawn by VIEW_ITEM::ViewDraw(), which may not be safe to call from several threads
+        return false;
+    }
+}
+
+
 bool PCB_PAINTER::Draw( const VIEW_ITEM* aItem, int aLayer )
 {
     const EDA_ITEM* item = static_cast<const EDA_ITEM*>( aItem );
@@ -193,6 +193,12 @@ public:
         return &m_pcbSettings;
     }
 
+    /// @copydoc PAINTER::Clone()
+    virtual PAINTER* Clone( GAL* aGal ) const;
+
+    /// @copydoc PAINTER::PrepareDraw()
+    virtual bool PrepareDraw( const VIEW_ITEM* aItem ) const;
+
     /// @copydoc PAINTER::Draw()
     virtual bool Draw( const VIEW_ITEM* aItem, int aLayer );
 
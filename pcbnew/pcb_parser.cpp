@@ -54,10 +54,34 @@
 #include <pcb_parser.h>
 
 #include <memory>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
 
 using namespace PCB_KEYS_T;
 
 
+/// Boards whose item list is smaller than this (in bytes) are parsed sequentially
+static const size_t PARALLEL_LOAD_MIN_SIZE = 256 * 1024;
+
+/// No. of chunks of board items per worker thread, to balance the thread loads
+static const int    PARALLEL_LOAD_CHUNKS_PER_THREAD = 8;
+
+
+/* Returns the number of threads used to parse the board items
+ */
+static int loadThreadCount()
+{
+#ifdef USE_OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+
 void PCB_PARSER::init()
 {
     m_layerIndices.clear();
@@ -415,89 +439,509 @@ BOARD* PCB_PARSER::parseBOARD() throw( IO_ERROR, PARSE_ERROR )
 {
     T token;
 
+    // The text of the board items parsed in parallel, and the reader of what follows them
+    std::string                 itemsText;
+    std::auto_ptr<LINE_READER>  tailReader;
+
     parseHeader();
 
-    for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
+    try
     {
-        if( token != T_LEFT )
-            Expecting( T_LEFT );
+        for( token = NextTok();  token != T_RIGHT;  token = NextTok() )
+        {
+            if( token != T_LEFT )
+                Expecting( T_LEFT );
 
-        token = NextTok();
+            token = NextTok();
 
-        switch( token )
+            // The header, layers and nets come first, so when the first board item
+            // is met, the items which follow can be parsed on worker threads.
+            if( isBoardItem( token ) && !tailReader.get() && canParseItemsInParallel() )
+            {
+                tailReader.reset( parseBoardItems( itemsText ) );
+                PushReader( tailReader.get() );
+                continue;
+            }
+
+            switch( token )
+            {
+            case T_general:
+                parseGeneralSection();
+                break;
+
+            case T_page:
+                parsePAGE_INFO();
+                break;
+
+            case T_title_block:
+                parseTITLE_BLOCK();
+                break;
+
+            case T_layers:
+                parseLayers();
+                break;
+
+            case T_setup:
+                parseSetup();
+                break;
+
+            case T_net:
+                parseNETINFO_ITEM();
+                break;
+
+            case T_net_class:
+                parseNETCLASS();
+                break;
+
+            default:
+                m_board->Add( parseBoardItem( token ), ADD_APPEND );
+            }
+        }
+    }
+    catch( ... )
+    {
+        if( tailReader.get() )
+            PopReader();
+
+        throw;
+    }
+
+    if( tailReader.get() )
+        PopReader();
+
+    return m_board;
+}
+
+
+BOARD_ITEM* PCB_PARSER::parseBoardItem( T aToken ) throw( IO_ERROR, PARSE_ERROR )
+{
+    switch( aToken )
+    {
+    case T_gr_arc:
+    case T_gr_circle:
+    case T_gr_curve:
+    case T_gr_line:
+    case T_gr_poly:
+        return parseDRAWSEGMENT();
+
+    case T_gr_text:
+        return parseTEXTE_PCB();
+
+    case T_dimension:
+        return parseDIMENSION();
+
+    case T_module:
+        return parseMODULE();
+
+    case T_segment:
+        return parseTRACK();
+
+    case T_via:
+        return parseVIA();
+
+    case T_zone:
+        return parseZONE_CONTAINER();
+
+    case T_target:
+        return parsePCB_TARGET();
+
+    default:
+        wxString err;
+        err.Printf( _( "unknown token \"%s\"" ), GetChars( FromUTF8() ) );
+        THROW_PARSE_ERROR( err, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
+    }
+
+    return NULL;
+}
+
+
+bool PCB_PARSER::isBoardItem( T aToken )
+{
+    switch( aToken )
+    {
+    case T_gr_arc:
+    case T_gr_circle:
+    case T_gr_curve:
+    case T_gr_line:
+    case T_gr_poly:
+    case T_gr_text:
+    case T_dimension:
+    case T_module:
+    case T_segment:
+    case T_via:
+    case T_zone:
+    case T_target:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+
+/**
+ * Class ITEM_SCANNER
+ * finds the boundaries of the s-expressions of a text without parsing them, following
+ * the DSNLEXER rules for quoted strings and comment lines.  Lines are counted from zero.
+ */
+class ITEM_SCANNER
+{
+    const char* m_text;
+    size_t      m_size;
+    size_t      m_pos;          ///< offset of the current char
+    unsigned    m_line;         ///< line of the current char
+    size_t      m_lineBegin;    ///< offset of the beginning of this line
+
+    static bool isBlank( char cc )
+    {
+        return cc == ' ' || cc == '\t' || cc == '\r' || cc == '\n' || cc == '\0';
+    }
+
+    static bool isSep( char cc )
+    {
+        return isBlank( cc ) || cc == '(' || cc == ')';
+    }
+
+    void skipString()
+    {
+        // A string cannot span lines: the lexer reports the error of an unterminated string
+        for( ++m_pos;  m_pos < m_size && m_text[m_pos] != '\n';  ++m_pos )
         {
-        case T_general:
-            parseGeneralSection();
-            break;
+            if( m_text[m_pos] == '"' )
+            {
+                ++m_pos;
+                return;
+            }
 
-        case T_page:
-            parsePAGE_INFO();
-            break;
+            if( m_text[m_pos] == '\\' && m_pos + 1 < m_size && m_text[m_pos + 1] != '\n' )
+                ++m_pos;
+        }
+    }
 
-        case T_title_block:
-            parseTITLE_BLOCK();
-            break;
+    void skipSymbol()
+    {
+        while( m_pos < m_size && !isSep( m_text[m_pos] ) )
+            ++m_pos;
+    }
 
-        case T_layers:
-            parseLayers();
-            break;
+public:
+    ITEM_SCANNER( const std::string& aText ) :
+        m_text( aText.data() ),
+        m_size( aText.size() ),
+        m_pos( 0 ),
+        m_line( 0 ),
+        m_lineBegin( 0 )
+    {
+    }
 
-        case T_setup:
-            parseSetup();
-            break;
+    size_t Pos() const          { return m_pos; }
+    unsigned Line() const       { return m_line; }
+    size_t LineBegin() const    { return m_lineBegin; }
 
-        case T_net:
-            parseNETINFO_ITEM();
-            break;
+    /**
+     * Function StartsLine
+     * @return true if the current char is the first non blank char of its line.
+     */
+    bool StartsLine() const
+    {
+        for( size_t ii = m_lineBegin;  ii < m_pos;  ++ii )
+        {
+            if( !isBlank( m_text[ii] ) )
+                return false;
+        }
 
-        case T_net_class:
-            parseNETCLASS();
-            break;
+        return true;
+    }
 
-        case T_gr_arc:
-        case T_gr_circle:
-        case T_gr_curve:
-        case T_gr_line:
-        case T_gr_poly:
-            m_board->Add( parseDRAWSEGMENT(), ADD_APPEND );
-            break;
+    /**
+     * Function NextToken
+     * skips the blanks and the comment lines.
+     * @return char - the first char of the next token, or 0 at the end of the text.
+     */
+    char NextToken()
+    {
+        while( m_pos < m_size )
+        {
+            char cc = m_text[m_pos];
 
-        case T_gr_text:
-            m_board->Add( parseTEXTE_PCB(), ADD_APPEND );
-            break;
+            if( cc == '\n' )
+            {
+                m_lineBegin = ++m_pos;
+                ++m_line;
+            }
+            else if( isBlank( cc ) )
+                ++m_pos;
+            else if( cc == '#' && StartsLine() )
+            {
+                while( m_pos < m_size && m_text[m_pos] != '\n' )
+                    ++m_pos;
+            }
+            else
+                return cc;
+        }
 
-        case T_dimension:
-            m_board->Add( parseDIMENSION(), ADD_APPEND );
-            break;
+        return 0;
+    }
 
-        case T_module:
-            m_board->Add( parseMODULE(), ADD_APPEND );
-            break;
+    /**
+     * Function Keyword
+     * @return std::string - the keyword following the current '(' on the same line,
+     * or an empty string.
+     */
+    std::string Keyword() const
+    {
+        size_t begin = m_pos + 1;
 
-        case T_segment:
-            m_board->Add( parseTRACK(), ADD_APPEND );
-            break;
+        while( begin < m_size && isBlank( m_text[begin] ) && m_text[begin] != '\n' )
+            ++begin;
 
-        case T_via:
-            m_board->Add( parseVIA(), ADD_APPEND );
-            break;
+        size_t end = begin;
 
-        case T_zone:
-            m_board->Add( parseZONE_CONTAINER(), ADD_APPEND );
-            break;
+        while( end < m_size && !isSep( m_text[end] ) && m_text[end] != '"' )
+            ++end;
 
-        case T_target:
-            m_board->Add( parsePCB_TARGET(), ADD_APPEND );
-            break;
+        return std::string( m_text + begin, end - begin );
+    }
 
-        default:
-            wxString err;
-            err.Printf( _( "unknown token \"%s\"" ), GetChars( FromUTF8() ) );
-            THROW_PARSE_ERROR( err, CurSource(), CurLine(), CurLineNumber(), CurOffset() );
+    /**
+     * Function SkipExpression
+     * moves after the end of the expression which starts at the current '('.
+     * @return bool - false if the text ends before the expression.
+     */
+    bool SkipExpression()
+    {
+        int depth = 0;
+
+        for( char cc = NextToken();  cc;  cc = NextToken() )
+        {
+            if( cc == '(' )
+            {
+                ++depth;
+                ++m_pos;
+            }
+            else if( cc == ')' )
+            {
+                ++m_pos;
+
+                if( --depth == 0 )
+                    return true;
+            }
+            else if( cc == '"' )
+                skipString();
+            else
+                skipSymbol();
         }
+
+        return false;
     }
+};
 
-    return m_board;
+
+struct PCB_PARSER::ITEM_CHUNK
+{
+    size_t                      m_begin;        ///< offset in the text of the chunk
+    size_t                      m_end;          ///< offset of the end of the last item
+    unsigned                    m_lineNumber;   ///< line number before the chunk first line
+
+    std::vector<BOARD_ITEM*>    m_items;        ///< the items, until added to the board
+    std::vector<ZONE_NET>       m_newNetZones;  ///< see PCB_PARSER::m_deferNewNets
+    IO_ERROR*                   m_error;        ///< the error which stopped the parsing, or NULL
+    bool                        m_isParseError; ///< true if m_error is a PARSE_ERROR
+
+    ITEM_CHUNK( size_t aBegin, unsigned aLineNumber ) :
+        m_begin( aBegin ),
+        m_end( aBegin ),
+        m_lineNumber( aLineNumber ),
+        m_error( NULL ),
+        m_isParseError( false )
+    {
+    }
+
+    ~ITEM_CHUNK()
+    {
+        for( unsigned ii = 0; ii < m_items.size(); ++ii )
+            delete m_items[ii];
+
+        delete m_error;
+    }
+};
+
+
+bool PCB_PARSER::canParseItemsInParallel()
+{
+    if( loadThreadCount() < 2 )
+        return false;
+
+    // Small boards are parsed sequentially, without copying the rest of the file
+    long remaining = reader->RemainingLength();
+
+    if( remaining < 0 || (size_t) remaining + ( limit - start ) < PARALLEL_LOAD_MIN_SIZE )
+        return false;
+
+    // The items are split at line boundaries, so the current item must start its line:
+    // only blanks may precede the '(' before the current keyword.
+    const char* cur = start + curOffset;
+
+    while( cur > start && ( cur[-1] == ' ' || cur[-1] == '\t' ) )
+        --cur;
+
+    if( cur == start || *--cur != '(' )
+        return false;
+
+    while( cur > start )
+    {
+        --cur;
+
+        if( *cur != ' ' && *cur != '\t' )
+            return false;
+    }
+
+    return true;
+}
+
+
+LINE_READER* PCB_PARSER::parseBoardItems( std::string& aText ) throw( IO_ERROR, PARSE_ERROR )
+{
+    wxString    source = CurSource();
+
+    // The text starts with the line of the current item, and ends with the file
+    unsigned    firstLineNumber = CurLineNumber() - 1;
+
+    aText.assign( start, limit );
+
+    while( const char* line = reader->ReadLineView() )
+        aText.append( line, reader->Length() );
+
+    // Split the items into chunks, stopping at the end of the board or at the first
+    // expression which is not an item.  Each chunk is parsed by a worker thread.
+    boost::ptr_vector<ITEM_CHUNK> chunks;
+    size_t      tail = 0;           // offset of the text left to the caller
+    unsigned    tailLine = 0;
+
+    if( aText.size() >= PARALLEL_LOAD_MIN_SIZE )
+    {
+        size_t       chunkSize = aText.size() /
+                                 ( loadThreadCount() * PARALLEL_LOAD_CHUNKS_PER_THREAD );
+        ITEM_SCANNER scanner( aText );
+
+        for( char cc = scanner.NextToken();  cc == '(';  cc = scanner.NextToken() )
+        {
+            if( !isBoardItem( (T) findToken( scanner.Keyword() ) ) )
+                break;
+
+            bool     startsLine = scanner.StartsLine();
+            size_t   lineBegin  = scanner.LineBegin();
+            unsigned line       = scanner.Line();
+
+            // A truncated item is left to the caller, which reports the error
+            if( !scanner.SkipExpression() )
+                break;
+
+            if( startsLine && ( chunks.empty() || lineBegin - chunks.back().m_begin >= chunkSize ) )
+                chunks.push_back( new ITEM_CHUNK( lineBegin, firstLineNumber + line ) );
+            else if( chunks.empty() )
+                break;
+
+            chunks.back().m_end = scanner.Pos();
+
+            tail     = scanner.Pos();
+            tailLine = scanner.Line();
+        }
+    }
+
+    int chunkCount = chunks.size();
+
+#ifdef USE_OPENMP
+    #pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for( int ii = 0; ii < chunkCount; ++ii )
+        parseItemChunk( chunks[ii], aText, source );
+
+    // Add the items to the board in the file order.  An error is reported after
+    // adding the items which precede it, as when the items are parsed sequentially.
+    for( int ii = 0; ii < chunkCount; ++ii )
+    {
+        ITEM_CHUNK& chunk = chunks[ii];
+        unsigned    newNetZone = 0;
+
+        for( unsigned jj = 0; jj < chunk.m_items.size(); ++jj )
+        {
+            BOARD_ITEM* item = chunk.m_items[jj];
+
+            if( newNetZone < chunk.m_newNetZones.size()
+                && chunk.m_newNetZones[newNetZone].first == item )
+            {
+                setZoneNewNet( (ZONE_CONTAINER*) item, chunk.m_newNetZones[newNetZone].second );
+                ++newNetZone;
+            }
+
+            m_board->Add( item, ADD_APPEND );
+        }
+
+        chunk.m_items.clear();
+
+        if( chunk.m_error )
+        {
+            if( chunk.m_isParseError )
+                throw PARSE_ERROR( *static_cast<PARSE_ERROR*>( chunk.m_error ) );
+
+            throw IO_ERROR( *chunk.m_error );
+        }
+    }
+
+    return new MEMORY_LINE_READER( aText.data() + tail, aText.size() - tail, source,
+                                   firstLineNumber + tailLine );
+}
+
+
+void PCB_PARSER::parseItemChunk( ITEM_CHUNK& aChunk, const std::string& aText,
+                                 const wxString& aSource )
+{
+    MEMORY_LINE_READER reader( aText.data() + aChunk.m_begin, aChunk.m_end - aChunk.m_begin,
+                               aSource, aChunk.m_lineNumber );
+
+    // The worker parser knows the board layers and nets, but leaves the board unchanged
+    PCB_PARSER parser( &reader );
+
+    parser.m_board        = m_board;
+    parser.m_layerIndices = m_layerIndices;
+    parser.m_layerMasks   = m_layerMasks;
+    parser.m_netCodes     = m_netCodes;
+    parser.m_deferNewNets = true;
+
+    try
+    {
+        for( T token = parser.NextTok();  token != T_EOF;  token = parser.NextTok() )
+        {
+            if( token != T_LEFT )
+                parser.Expecting( T_LEFT );
+
+            aChunk.m_items.push_back( parser.parseBoardItem( parser.NextTok() ) );
+        }
+    }
+    catch( const PARSE_ERROR& pe )
+    {
+        aChunk.m_error = new PARSE_ERROR( pe );
+        aChunk.m_isParseError = true;
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        aChunk.m_error = new IO_ERROR( ioe );
+    }
+    // No exception may leave a worker thread: other errors are reported on the main thread
+    catch( const std::exception& e )
+    {
+        aChunk.m_error = new IO_ERROR( __FILE__, __LOC__,
+                                       wxString::Format( _( "Error loading board: %s" ),
+                                                         wxString::FromUTF8( e.what() ) ) );
+    }
+    catch( ... )
+    {
+        aChunk.m_error = new IO_ERROR( __FILE__, __LOC__,
+                                       _( "Unknown error loading board" ) );
+    }
+
+    aChunk.m_newNetZones.swap( parser.m_newNetZones );
 }
 
 
@@ -2875,28 +3319,43 @@ ZONE_CONTAINER* PCB_PARSER::parseZONE_CONTAINER() throw( IO_ERROR, PARSE_ERROR )
 
         if( net )   // An existing net has the same net name. use it for the zone
             zone->SetNetCode( net->GetNet() );
+        else if( m_deferNewNets )   // The net is created when the zone is added to the board
+            m_newNetZones.push_back( ZONE_NET( zone.get(), netnameFromfile ) );
         else    // Not existing net: add a new net to keep trace of the zone netname
-        {
-            int newnetcode = m_board->GetNetCount();
-            net = new NETINFO_ITEM( m_board, netnameFromfile, newnetcode );
-            m_board->AppendNet( net );
+            setZoneNewNet( zone.get(), netnameFromfile );
+    }
 
-            // Store the new code mapping
-            pushValueIntoMap( newnetcode, net->GetNet() );
-            // and update the zone netcode
-            zone->SetNetCode( net->GetNet() );
+    return zone.release();
+}
 
-            // Prompt the user
-            wxString msg;
-            msg.Printf( _( "There is a zone that belongs to a not existing net\n"
-                           "\"%s\"\n"
-                           "you should verify and edit it (run DRC test)." ),
-                           GetChars( netnameFromfile ) );
-            DisplayError( NULL, msg );
-        }
+
+void PCB_PARSER::setZoneNewNet( ZONE_CONTAINER* aZone, const wxString& aNetName )
+{
+    // When zones are parsed in parallel, the net may have been created for a previous zone
+    NETINFO_ITEM* net = m_board->FindNet( aNetName );
+
+    if( net )
+    {
+        aZone->SetNetCode( net->GetNet() );
+        return;
     }
 
-    return zone.release();
+    int newnetcode = m_board->GetNetCount();
+    net = new NETINFO_ITEM( m_board, aNetName, newnetcode );
+    m_board->AppendNet( net );
+
+    // Store the new code mapping
+    pushValueIntoMap( newnetcode, net->GetNet() );
+    // and update the zone netcode
+    aZone->SetNetCode( net->GetNet() );
+
+    // Prompt the user
+    wxString msg;
+    msg.Printf( _( "There is a zone that belongs to a not existing net\n"
+                   "\"%s\"\n"
+                   "you should verify and edit it (run DRC test)." ),
+                   GetChars( aNetName ) );
+    DisplayError( NULL, msg );
 }
 
 
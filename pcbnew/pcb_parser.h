@@ -64,11 +64,20 @@ class PCB_PARSER : public PCB_LEXER
     typedef std::unordered_map< std::string, LAYER_ID >   LAYER_ID_MAP;
     typedef std::unordered_map< std::string, LSET >       LSET_MAP;
 
+    /// A zone and the name of its net, when the name is not a net of the board
+    typedef std::pair< ZONE_CONTAINER*, wxString >        ZONE_NET;
+
+    /// A part of the board item list parsed by a worker thread, see parseBoardItems()
+    struct ITEM_CHUNK;
+
     BOARD*              m_board;
     LAYER_ID_MAP        m_layerIndices;     ///< map layer name to it's index
     LSET_MAP            m_layerMasks;       ///< map layer names to their masks
     std::vector<int>    m_netCodes;         ///< net codes mapping for boards being loaded
 
+    bool                m_deferNewNets;     ///< true when the board must not be modified
+    std::vector<ZONE_NET> m_newNetZones;    ///< zones with an unknown net, when m_deferNewNets
+
     ///> Converts net code using the mapping table if available,
     ///> otherwise returns unchanged net code if < 0 or if is is out of range
     inline int getNetCode( int aNetCode )
@@ -128,6 +137,59 @@ class PCB_PARSER : public PCB_LEXER
     PCB_TARGET*     parsePCB_TARGET() throw( IO_ERROR, PARSE_ERROR );
     BOARD*          parseBOARD() throw( IO_ERROR, PARSE_ERROR );
 
+    /**
+     * Function parseBoardItem
+     * parses the board item (drawing, text, dimension, module, track, via, zone or target)
+     * whose keyword is the current token.
+     * @return BOARD_ITEM* - the item, not added to the board.
+     */
+    BOARD_ITEM*     parseBoardItem( PCB_KEYS_T::T aToken ) throw( IO_ERROR, PARSE_ERROR );
+
+    /**
+     * Function isBoardItem
+     * @return true if @a aToken is the keyword of an item parsed by parseBoardItem().
+     */
+    static bool isBoardItem( PCB_KEYS_T::T aToken );
+
+    /**
+     * Function setZoneNewNet
+     * sets the net of @a aZone to the net named @a aNetName, which is created if
+     * the board does not have it yet.
+     */
+    void setZoneNewNet( ZONE_CONTAINER* aZone, const wxString& aNetName );
+
+    /**
+     * Function parseBoardItems
+     * parses the board items which follow, starting with the current item keyword, on
+     * worker threads, and adds them to the board in the file order.  Items are parsed
+     * up to the end of the board, or up to the first expression which is not a board
+     * item (e.g. a net declared after the items), whose parsing is left to the caller.
+     *
+     * @param aText receives the text following the current item, and must stay valid
+     *  while the returned reader is used.
+     * @return LINE_READER* - the reader of the text left to parse, which belongs to
+     *  the caller.
+     */
+    LINE_READER*    parseBoardItems( std::string& aText ) throw( IO_ERROR, PARSE_ERROR );
+
+    /**
+     * Function parseItemChunk
+     * parses the items of @a aChunk in @a aText, and stores them or the error
+     * into the chunk.  The board is only read, so chunks can be parsed by worker threads.
+     * No exception leaves this function: any error is stored as an IO_ERROR or a PARSE_ERROR,
+     * which parseBoardItems() throws on the main thread.
+     */
+    void            parseItemChunk( ITEM_CHUNK& aChunk, const std::string& aText,
+                                    const wxString& aSource );
+
+    /**
+     * Function canParseItemsInParallel
+     * @return true if the board items starting at the current keyword can be parsed
+     * by parseBoardItems(): worker threads are available, the rest of the input is large
+     * enough to be split, and the item starts a line.
+     */
+    bool            canParseItemsInParallel();
+
 
     /**
      * Function lookUpLayer
@@ -257,7 +319,8 @@ public:
 
     PCB_PARSER( LINE_READER* aReader = NULL ) :
         PCB_LEXER( aReader ),
-        m_board( 0 )
+        m_board( 0 ),
+        m_deferNewNets( false )
     {
         init();
     }
@@ -98,6 +98,7 @@ BEGIN_EVENT_TABLE( PCB_EDIT_FRAME, PCB_BASE_FRAME )
 
     EVT_CLOSE( PCB_EDIT_FRAME::OnCloseWindow )
     EVT_SIZE( PCB_EDIT_FRAME::OnSize )
+    EVT_IDLE( PCB_EDIT_FRAME::OnIdle )
 
     EVT_TOOL( ID_LOAD_FILE, PCB_EDIT_FRAME::Files_io )
     EVT_TOOL( ID_MENU_READ_BOARD_BACKUP_FILE, PCB_EDIT_FRAME::Files_io )
@@ -327,6 +328,7 @@ PCB_EDIT_FRAME::PCB_EDIT_FRAME( KIWAY* aKiway, wxWindow* aParent ) :
     m_hasAutoSave = true;
     m_RecordingMacros = -1;
     m_microWaveToolBar = NULL;
+    m_drc = NULL;
 
     m_rotationAngle = 900;
 
@@ -364,6 +366,7 @@ PCB_EDIT_FRAME::PCB_EDIT_FRAME( KIWAY* aKiway, wxWindow* aParent ) :
 
     SetScreen( new PCB_SCREEN( GetPageSettings().GetSizeIU() ) );
     GetScreen()->SetMaxUndoItems( m_UndoRedoCountMax );
+    GetScreen()->SetMaxUndoSize( DEFAULT_MAX_UNDO_SIZE );
 
     // PCB drawings start in the upper left corner.
     GetScreen()->m_Center = false;
@@ -486,6 +489,10 @@ void PCB_EDIT_FRAME::SetBoard( BOARD* aBoard )
 {
     PCB_BASE_EDIT_FRAME::SetBoard( aBoard );
 
+    // The markers and changed items known by the incremental DRC belong to the old board
+    if( m_drc )
+        m_drc->ClearIncrementalData();
+
     if( IsGalCanvasActive() )
     {
         aBoard->GetRatsnest()->Recalculate();
@@ -961,6 +968,32 @@ void PCB_EDIT_FRAME::OnModify( )
 }
 
 
+void PCB_EDIT_FRAME::OnIdle( wxIdleEvent& aEvent )
+{
+    aEvent.Skip();
+
+    if( !m_drc || !m_drc->NeedsIncrementalTests() )
+        return;
+
+    // Wait for the end of the current edit: the routers and the GAL move tool
+    // block undo/redo, the legacy tools flag the item being moved or created.
+    if( UndoRedoBlocked() )
+        return;
+
+    BOARD_ITEM* curItem = GetScreen()->GetCurItem();
+
+    if( curItem && curItem->GetFlags() & ( IS_NEW | IS_MOVED | IS_DRAGGED | IS_RESIZED ) )
+        return;
+
+    m_drc->RunIncrementalTests();
+
+    if( IsGalCanvasActive() )
+        GetGalCanvas()->Refresh();
+    else
+        m_canvas->Refresh();
+}
+
+
 void PCB_EDIT_FRAME::SVG_Print( wxCommandEvent& event )
 {
     PCB_PLOT_PARAMS  tmp = GetPlotSettings();
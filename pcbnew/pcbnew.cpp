@@ -96,6 +96,7 @@ wxString    g_DocModulesFileName = wxT( "footprints_doc/footprints.pdf" );
 DLIST<TRACK> g_CurrentTrackList;
 
 bool g_DumpZonesWhenFilling = false;
+bool g_FillZonesInParallel = true;
 KIWAY* TheKiway = NULL;
 
 namespace PCB {
@@ -94,6 +94,7 @@ extern int      g_MagneticPadOption;
 extern int      g_MagneticTrackOption;
 
 extern bool     g_DumpZonesWhenFilling;
+extern bool     g_FillZonesInParallel;  // Fill_All_Zones() calculates zones on worker threads
 
 extern wxPoint  g_Offset_Module;         // Offset trace when moving footprint.
 
@@ -33,6 +33,10 @@
 
 #include <ratsnest_data.h>
 
+#include <ttl/halfedge/hetriang.h>
+#include <ttl/halfedge/hetraits.h>
+#include <disjoint_set.h>
+
 #include <class_board.h>
 #include <class_module.h>
 #include <class_pad.h>
@@ -46,52 +50,71 @@
 
 #include <cassert>
 #include <algorithm>
+#include <iterator>
 #include <limits>
+#include <memory>
 #include <tuple>
 
 #ifdef PROFILE
 #include <profile.h>
 #endif
 
-static uint64_t getDistance( const RN_NODE_PTR& aNode1, const RN_NODE_PTR& aNode2 )
+///> The ratsnest of a net is updated locally (without a new triangulation) if at most
+///> this number of nodes has changed since the last update...
+static const unsigned int DYNAMIC_MAX_CHANGED = 256;
+
+///> ...and if changed nodes make less than 1/DYNAMIC_MIN_RATIO of the net nodes (including
+///> the nodes changed by the previous local updates).
+static const unsigned int DYNAMIC_MIN_RATIO = 4;
+
+///> Number of the closest nodes a changed node is linked to by candidate edges.
+static const unsigned int DYNAMIC_NEIGHBOURS = 8;
+
+
+static uint64_t getDistance( const RN_NODE& aNode1, const RN_NODE& aNode2 )
 {
     // Drop the least significant bits to avoid overflow
-    int64_t x = ( aNode1->GetX() - aNode2->GetX() ) >> 16;
-    int64_t y = ( aNode1->GetY() - aNode2->GetY() ) >> 16;
+    int64_t x = ( (int64_t) aNode1.GetX() - aNode2.GetX() ) >> 16;
+    int64_t y = ( (int64_t) aNode1.GetY() - aNode2.GetY() ) >> 16;
 
     // We do not need sqrt() here, as the distance is computed only for comparison
     return ( x * x + y * y );
 }
 
 
-static bool sortDistance( const RN_NODE_PTR& aOrigin, const RN_NODE_PTR& aNode1,
-                   const RN_NODE_PTR& aNode2 )
+///> Orders candidate edges by weight, and then by nodes, so duplicates are adjacent.
+static bool sortCandidates( const RN_EDGE& aEdge1, const RN_EDGE& aEdge2 )
 {
-    return getDistance( aOrigin, aNode1 ) < getDistance( aOrigin, aNode2 );
-}
+    if( aEdge1.GetWeight() != aEdge2.GetWeight() )
+        return aEdge1.GetWeight() < aEdge2.GetWeight();
 
+    if( aEdge1.GetSourceNode() != aEdge2.GetSourceNode() )
+        return aEdge1.GetSourceNode() < aEdge2.GetSourceNode();
 
-static bool sortWeight( const RN_EDGE_PTR& aEdge1, const RN_EDGE_PTR& aEdge2 )
-{
-    return aEdge1->GetWeight() < aEdge2->GetWeight();
+    return aEdge1.GetTargetNode() < aEdge2.GetTargetNode();
 }
 
 
-bool sortArea( const RN_POLY& aP1, const RN_POLY& aP2 )
+static bool sameCandidate( const RN_EDGE& aEdge1, const RN_EDGE& aEdge2 )
 {
-    return aP1.m_bbox.GetArea() < aP2.m_bbox.GetArea();
+    return aEdge1.GetSourceNode() == aEdge2.GetSourceNode()
+        && aEdge1.GetTargetNode() == aEdge2.GetTargetNode();
 }
 
 
-bool operator==( const RN_NODE_PTR& aFirst, const RN_NODE_PTR& aSecond )
+///> Creates a candidate edge, its source is always the node with the lower handle.
+static RN_EDGE makeCandidate( RN_NODE_ID aNode1, RN_NODE_ID aNode2, uint64_t aDistance )
 {
-    return aFirst->GetX() == aSecond->GetX() && aFirst->GetY() == aSecond->GetY();
+    if( aNode2 < aNode1 )
+        std::swap( aNode1, aNode2 );
+
+    return RN_EDGE( aNode1, aNode2, aDistance );
 }
 
 
-bool operator!=( const RN_NODE_PTR& aFirst, const RN_NODE_PTR& aSecond )
+bool sortArea( const RN_POLY& aP1, const RN_POLY& aP2 )
 {
-    return aFirst->GetX() != aSecond->GetX() || aFirst->GetY() != aSecond->GetY();
+    return aP1.m_bbox.GetArea() < aP2.m_bbox.GetArea();
 }
 
 
@@ -107,280 +130,580 @@ RN_NODE_OR_FILTER operator||( const RN_NODE_FILTER& aFilter1, const RN_NODE_FILT
 }
 
 
-static bool isEdgeConnectingNode( const RN_EDGE_PTR& aEdge, const RN_NODE_PTR& aNode )
+void RN_NODE::RemoveParent( const BOARD_CONNECTED_ITEM* aParent )
 {
-    return aEdge->GetSourceNode() == aNode || aEdge->GetTargetNode() == aNode;
-}
+    std::vector<const BOARD_CONNECTED_ITEM*>::iterator it =
+            std::find( m_parents.begin(), m_parents.end(), aParent );
 
+    if( it != m_parents.end() )
+    {
+        *it = m_parents.back();
+        m_parents.pop_back();
+    }
 
-static std::vector<RN_EDGE_MST_PTR>* kruskalMST( RN_LINKS::RN_EDGE_LIST& aEdges,
-                                                 std::vector<RN_NODE_PTR>& aNodes )
-{
-    unsigned int nodeNumber = aNodes.size();
-    unsigned int mstExpectedSize = nodeNumber - 1;
-    unsigned int mstSize = 0;
-    bool ratsnestLines = false;
+    m_layers.reset();   // mark as needs updating
+}
 
-    // The output
-    std::vector<RN_EDGE_MST_PTR>* mst = new std::vector<RN_EDGE_MST_PTR>;
-    mst->reserve( mstExpectedSize );
 
-    // Set tags for marking cycles
-    std::unordered_map<RN_NODE_PTR, int> tags;
-    unsigned int tag = 0;
-    for( RN_NODE_PTR& node : aNodes )
+const LSET& RN_NODE::GetLayers() const
+{
+    if( m_layers.none() )
     {
-        node->SetTag( tag );
-        tags[node] = tag++;
+        for( const BOARD_CONNECTED_ITEM* item : m_parents )
+            m_layers |= item->GetLayerSet();
     }
 
-    // Lists of nodes connected together (subtrees) to detect cycles in the graph
-    std::vector<std::list<int> > cycles( nodeNumber );
-    for( unsigned int i = 0; i < nodeNumber; ++i )
-        cycles[i].push_back( i );
+    return m_layers;
+}
 
-    // Kruskal algorithm requires edges to be sorted by their weight
-    aEdges.sort( sortWeight );
 
-    while( mstSize < mstExpectedSize && !aEdges.empty() )
+/**
+ * Function kruskalMST()
+ * Computes the minimal spanning tree of aNodes, using the existing connections and the
+ * ratsnest candidates. Existing connections have zero weight and have to be placed first in
+ * aEdges, the rest of the edges has to be sorted by weight.
+ * Nodes connected with copper get the same tag.
+ * @param aMst is the output, i.e. the missing connections.
+ * @return the number of trees left, i.e. 1 if aEdges connect all the nodes.
+ */
+static unsigned int kruskalMST( const std::vector<RN_EDGE>& aEdges, RN_LINKS& aLinks,
+                        const std::vector<RN_NODE_ID>& aNodes, std::vector<RN_EDGE>& aMst )
+{
+    // Subtrees joined so far, used to detect cycles in the graph
+    DISJOINT_SET clusters( aLinks.GetNodes().size() );
+    unsigned int clusterCount = aNodes.size();
+    bool ratsnestLines = false;
+
+    for( const RN_EDGE& edge : aEdges )
     {
-        RN_EDGE_PTR& dt = aEdges.front();
+        if( clusterCount <= 1 )
+            break;
 
-        int srcTag = tags[dt->GetSourceNode()];
-        int trgTag = tags[dt->GetTargetNode()];
+        int srcCluster = clusters.Find( edge.GetSourceNode() );
+        int trgCluster = clusters.Find( edge.GetTargetNode() );
 
         // Check if by adding this edge we are going to join two different forests
-        if( srcTag != trgTag )
+        if( srcCluster == trgCluster )
+            continue;
+
+        // Because edges are sorted by their weight, first we always process connected
+        // items (weight == 0). Once we stumble upon an edge with non-zero weight,
+        // it means that the rest of the lines are ratsnest, and that the clusters
+        // made so far are the groups of nodes connected with copper.
+        if( !ratsnestLines && edge.GetWeight() != 0 )
         {
-            // Because edges are sorted by their weight, first we always process connected
-            // items (weight == 0). Once we stumble upon an edge with non-zero weight,
-            // it means that the rest of the lines are ratsnest.
-            if( !ratsnestLines && dt->GetWeight() != 0 )
-                ratsnestLines = true;
-
-            // Update tags
-            std::list<int>::iterator it, itEnd;
+            ratsnestLines = true;
 
-            if( ratsnestLines )
-            {
-                for( it = cycles[trgTag].begin(), itEnd = cycles[trgTag].end(); it != itEnd; ++it )
-                    tags[aNodes[*it]] = srcTag;
-            }
-            else
-            {
-                for( it = cycles[trgTag].begin(), itEnd = cycles[trgTag].end(); it != itEnd; ++it ) {
-                    tags[aNodes[*it]] = srcTag;
-                    aNodes[*it]->SetTag( srcTag );
-                }
-            }
+            for( RN_NODE_ID node : aNodes )
+                aLinks.GetNode( node ).SetTag( clusters.Find( node ) );
+        }
 
-            // Move nodes that were marked with old tag to the list marked with the new tag
-            cycles[srcTag].splice( cycles[srcTag].end(), cycles[trgTag] );
+        clusters.Union( srcCluster, trgCluster );
+        --clusterCount;
 
-            if( ratsnestLines )
-            {
-                // Do a copy of edge, but make it RN_EDGE_MST. In contrary to RN_EDGE,
-                // RN_EDGE_MST saves both source and target node and does not require any other
-                // edges to exist for getting source/target nodes
-                RN_EDGE_MST_PTR newEdge = std::make_shared<RN_EDGE_MST>( dt->GetSourceNode(),
-                                                                           dt->GetTargetNode(),
-                                                                           dt->GetWeight() );
-                mst->push_back( newEdge );
-                ++mstSize;
-            }
-            else
-            {
-                // Processing a connection, decrease the expected size of the ratsnest MST
-                --mstExpectedSize;
-            }
-        }
+        if( ratsnestLines )
+            aMst.push_back( edge );
+    }
 
-        // Remove the edge that was just processed
-        aEdges.erase( aEdges.begin() );
+    if( !ratsnestLines )
+    {
+        for( RN_NODE_ID node : aNodes )
+            aLinks.GetNode( node ).SetTag( clusters.Find( node ) );
     }
 
-    // Probably we have discarded some of edges, so reduce the size
-    mst->resize( mstSize );
+    return clusterCount;
+}
+
+
+RN_NODE_ID RN_NET::closestUnflaggedNode( RN_NODE_ID aNode, RN_NODE_ID aExcluded ) const
+{
+    const std::vector<RN_NODE>& nodes = m_links.GetNodes();
+    const RN_NODE& origin = nodes[aNode];
+
+    uint64_t minDistance = std::numeric_limits<uint64_t>::max();
+    RN_NODE_ID closest = RN_INVALID_ID;
+
+    for( unsigned int i = 0; i < nodes.size(); ++i )
+    {
+        const RN_NODE& node = nodes[i];
+
+        if( !node.IsUsed() || node.GetFlag() || (int) i == aNode || (int) i == aExcluded )
+            continue;
+
+        uint64_t distance = getDistance( origin, node );
+
+        if( distance < minDistance )
+        {
+            minDistance = distance;
+            closest = i;
+        }
+    }
 
-    return mst;
+    return closest;
 }
 
 
-void RN_NET::validateEdge( RN_EDGE_MST_PTR& aEdge )
+void RN_NET::validateEdge( RN_EDGE& aEdge )
 {
-    RN_NODE_PTR source = aEdge->GetSourceNode();
-    RN_NODE_PTR target = aEdge->GetTargetNode();
+    RN_NODE_ID source = aEdge.GetSourceNode();
+    RN_NODE_ID target = aEdge.GetTargetNode();
     bool valid = true;
 
     // If any of nodes belonging to the edge has the flag set,
     // change it to the closest node that has flag cleared
-    if( source->GetFlag() )
+    if( m_links.GetNode( source ).GetFlag() )
     {
         valid = false;
 
-        std::list<RN_NODE_PTR> closest = GetClosestNodes( source, WITHOUT_FLAG() );
-        for( RN_NODE_PTR& node : closest )
-        {
-            if( node && node != target )
-            {
-                source = node;
-                break;
-            }
-        }
+        RN_NODE_ID node = closestUnflaggedNode( source, target );
+
+        if( node != RN_INVALID_ID )
+            source = node;
     }
 
-    if( target->GetFlag() )
+    if( m_links.GetNode( target ).GetFlag() )
     {
         valid = false;
 
-        std::list<RN_NODE_PTR> closest = GetClosestNodes( target, WITHOUT_FLAG() );
-        for( RN_NODE_PTR& node : closest )
-        {
-            if( node && node != source )
-            {
-                target = node;
-                break;
-            }
-        }
+        RN_NODE_ID node = closestUnflaggedNode( target, source );
+
+        if( node != RN_INVALID_ID )
+            target = node;
     }
 
     // Replace an invalid edge with new, valid one
     if( !valid )
-        aEdge.reset( new RN_EDGE_MST( source, target ) );
+        aEdge = RN_EDGE( source, target, getDistance( m_links.GetNode( source ),
+                                                      m_links.GetNode( target ) ) );
 }
 
 
-void RN_NET::removeNode( RN_NODE_PTR& aNode, const BOARD_CONNECTED_ITEM* aParent )
+void RN_NET::releaseNode( RN_NODE_ID aNode )
 {
-    aNode->RemoveParent( aParent );
-
     if( m_links.RemoveNode( aNode ) )
     {
+        // The handle may be reused for another node, so forget everything about it
         clearNode( aNode );
-        m_dirty = true;
+        m_simpleNodes.erase( aNode );
+        m_blockedNodes.erase( aNode );
     }
+
+    m_dirty = true;
 }
 
 
-void RN_NET::removeEdge( RN_EDGE_MST_PTR& aEdge, const BOARD_CONNECTED_ITEM* aParent )
+void RN_NET::removeNode( RN_NODE_ID aNode, const BOARD_CONNECTED_ITEM* aParent )
 {
-    // Save nodes, so they can be cleared later
-    RN_NODE_PTR start = aEdge->GetSourceNode();
-    RN_NODE_PTR end = aEdge->GetTargetNode();
+    m_links.GetNode( aNode ).RemoveParent( aParent );
+    releaseNode( aNode );
+}
+
 
-    start->RemoveParent( aParent );
-    end->RemoveParent( aParent );
+void RN_NET::removeEdge( RN_EDGE_ID aEdge, const BOARD_CONNECTED_ITEM* aParent )
+{
+    // Save nodes, so they can be cleared later
+    RN_NODE_ID start = m_links.GetConnection( aEdge ).GetSourceNode();
+    RN_NODE_ID end = m_links.GetConnection( aEdge ).GetTargetNode();
 
-    // Connection has to be removed before running RemoveNode(),
-    // as RN_NODE influences the reference counter
     m_links.RemoveConnection( aEdge );
 
     // Remove nodes associated with the edge. It is done in a safe way, there is a check
-    // if nodes are not used by other edges.
-    if( m_links.RemoveNode( start ) )
-        clearNode( start );
+    // if nodes are not used by other items.
+    removeNode( start, aParent );
+    removeNode( end, aParent );
+}
 
-    if( m_links.RemoveNode( end ) )
-        clearNode( end );
 
-    m_dirty = true;
+void RN_NET::removeHelperEdges( std::vector<RN_EDGE_ID>& aEdges )
+{
+    // Helper connections do not own their nodes, so only the edges are removed
+    for( RN_EDGE_ID edge : aEdges )
+        m_links.RemoveConnection( edge );
+
+    aEdges.clear();
 }
 
 
-const RN_NODE_PTR& RN_LINKS::AddNode( int aX, int aY )
+RN_NODE_ID RN_LINKS::AddNode( int aX, int aY )
 {
-    RN_NODE_SET::iterator node;
+    uint64_t key = ( (uint64_t) (uint32_t) aX << 32 ) | (uint32_t) aY;
+    std::unordered_map<uint64_t, RN_NODE_ID>::iterator it;
     bool wasNewElement;
 
-    std::tie( node, wasNewElement ) = m_nodes.emplace( std::make_shared<RN_NODE>( aX, aY ) );
+    std::tie( it, wasNewElement ) = m_nodeIndex.emplace( key, RN_INVALID_ID );
+
+    if( !wasNewElement )
+        return it->second;
+
+    RN_NODE_ID node;
+
+    if( m_freeNodes.empty() )
+    {
+        node = m_nodes.size();
+        m_nodes.push_back( RN_NODE( aX, aY ) );
+    }
+    else
+    {
+        node = m_freeNodes.back();
+        m_freeNodes.pop_back();
+        m_nodes[node] = RN_NODE( aX, aY );
+    }
+
+    m_nodes[node].m_used = true;
+    it->second = node;
+    ++m_nodeCount;
+    m_changedNodes.insert( node );
 
-    return *node;
+    return node;
 }
 
 
-bool RN_LINKS::RemoveNode( const RN_NODE_PTR& aNode )
+bool RN_LINKS::RemoveNode( RN_NODE_ID aNode )
 {
-    if( aNode->GetRefCount() == 0 )
-    {
-        m_nodes.erase( aNode );
+    RN_NODE& node = m_nodes[aNode];
 
-        return true;
-    }
+    if( !node.m_used || node.GetRefCount() > 0 || node.m_polyRefCount > 0 )
+        return false;
+
+    m_nodeIndex.erase( ( (uint64_t) (uint32_t) node.m_x << 32 ) | (uint32_t) node.m_y );
+
+    node = RN_NODE();       // releases the parent list as well
+    m_freeNodes.push_back( aNode );
+    --m_nodeCount;
+    m_changedNodes.insert( aNode );
 
-    return false;
+    return true;
 }
 
 
-RN_EDGE_MST_PTR RN_LINKS::AddConnection( const RN_NODE_PTR& aNode1, const RN_NODE_PTR& aNode2,
-                                         unsigned int aDistance )
+RN_EDGE_ID RN_LINKS::AddConnection( RN_NODE_ID aNode1, RN_NODE_ID aNode2,
+                                    unsigned int aDistance )
 {
     assert( aNode1 != aNode2 );
-    RN_EDGE_MST_PTR edge = std::make_shared<RN_EDGE_MST>( aNode1, aNode2, aDistance );
-    m_edges.push_back( edge );
+    RN_EDGE_ID edge;
+
+    if( m_freeEdges.empty() )
+    {
+        edge = m_edges.size();
+        m_edges.push_back( RN_EDGE( aNode1, aNode2, aDistance ) );
+    }
+    else
+    {
+        edge = m_freeEdges.back();
+        m_freeEdges.pop_back();
+        m_edges[edge] = RN_EDGE( aNode1, aNode2, aDistance );
+    }
+
+    ++m_edgeCount;
 
     return edge;
 }
 
 
+void RN_LINKS::RemoveConnection( RN_EDGE_ID aEdge )
+{
+    if( !m_edges[aEdge].IsUsed() )
+        return;
+
+    m_edges[aEdge] = RN_EDGE();
+    m_freeEdges.push_back( aEdge );
+    --m_edgeCount;
+}
+
+
+void RN_NET::getUsedNodes( std::vector<RN_NODE_ID>& aNodes ) const
+{
+    const std::vector<RN_NODE>& nodes = m_links.GetNodes();
+
+    aNodes.clear();
+    aNodes.reserve( m_links.GetNodeCount() );
+
+    for( unsigned int i = 0; i < nodes.size(); ++i )
+    {
+        if( nodes[i].IsUsed() )
+            aNodes.push_back( i );
+    }
+}
+
+
 void RN_NET::compute()
 {
-    const RN_LINKS::RN_NODE_SET& boardNodes = m_links.GetNodes();
-    const RN_LINKS::RN_EDGE_LIST& boardEdges = m_links.GetConnections();
+    const std::vector<RN_NODE>& boardNodes = m_links.GetNodes();
+    std::vector<RN_NODE_ID> nodes;
+
+    getUsedNodes( nodes );
+    m_rnEdges.clear();
 
     // Special cases do not need complicated algorithms
-    if( boardNodes.size() <= 2 )
+    if( nodes.size() <= 2 )
     {
-        m_rnEdges.reset( new std::vector<RN_EDGE_MST_PTR>( 0 ) );
-
         // Check if the only possible connection exists
-        if( boardEdges.size() == 0 && boardNodes.size() == 2 )
+        if( m_links.GetConnectionCount() == 0 && nodes.size() == 2 )
         {
-            auto last = ++boardNodes.begin();
-
             // There can be only one possible connection, but it is missing
-            m_rnEdges->push_back( std::make_shared<RN_EDGE_MST>( *boardNodes.begin(), *last ) );
+            m_rnEdges.push_back( RN_EDGE( nodes[0], nodes[1],
+                                          getDistance( boardNodes[nodes[0]],
+                                                       boardNodes[nodes[1]] ) ) );
         }
 
         // Set tags to nodes as connected
-        for( RN_NODE_PTR node : boardNodes )
-            node->SetTag( 0 );
+        for( RN_NODE_ID node : nodes )
+            m_links.GetNode( node ).SetTag( 0 );
+
+        m_candidates.clear();
+        m_links.ClearChangedNodes();
 
         return;
     }
 
-    // Move and sort (sorting speeds up) all nodes to a vector for the Delaunay triangulation
-    std::vector<RN_NODE_PTR> nodes( boardNodes.size() );
-    std::partial_sort_copy( boardNodes.begin(), boardNodes.end(), nodes.begin(), nodes.end() );
+    // When a few nodes have moved (e.g. an item is being dragged), the candidate edges
+    // are updated around them only. The triangulation is done again once the local updates
+    // have changed a large part of the net.
+    unsigned int changed = m_links.GetChangedNodes().size();
+    bool dynamic = !m_candidates.empty() && changed <= DYNAMIC_MAX_CHANGED
+                   && ( m_changedSinceRebuild + changed ) * DYNAMIC_MIN_RATIO < (unsigned int) nodes.size();
+
+    if( dynamic )
+    {
+        updateCandidates();
+        m_changedSinceRebuild += changed;
+    }
+    else
+    {
+        triangulate( nodes );
+    }
+
+    // Local updates cannot guarantee that the candidate edges connect all the nodes,
+    // in such case fall back to the triangulation
+    if( !computeMST( nodes ) && dynamic )
+    {
+        triangulate( nodes );
+        computeMST( nodes );
+    }
 
-    TRIANGULATOR triangulator;
-    triangulator.CreateDelaunay( nodes.begin(), nodes.end() );
-    const std::unique_ptr<RN_LINKS::RN_EDGE_LIST> triangEdges( triangulator.GetEdges() );
+    m_links.ClearChangedNodes();
+}
+
+
+void RN_NET::triangulate( const std::vector<RN_NODE_ID>& aNodes )
+{
+    const std::vector<RN_NODE>& boardNodes = m_links.GetNodes();
+
+    // Sort nodes by their coordinates, so consecutive insertions in the triangulation
+    // are close to each other (it speeds up the triangulation)
+    std::vector<RN_NODE_ID> nodes( aNodes );
+
+    std::sort( nodes.begin(), nodes.end(), [&boardNodes]( RN_NODE_ID aA, RN_NODE_ID aB )
+    {
+        const RN_NODE& a = boardNodes[aA];
+        const RN_NODE& b = boardNodes[aB];
+
+        return a.GetX() < b.GetX() || ( a.GetX() == b.GetX() && a.GetY() < b.GetY() );
+    } );
+
+    // The Delaunay triangulation works on its own node objects, they are tagged with
+    // the handle of the node they stand for
+    hed::NODES_CONTAINER triangNodes;
+    triangNodes.reserve( nodes.size() );
+
+    for( RN_NODE_ID node : nodes )
+    {
+        triangNodes.push_back( std::make_shared<hed::NODE>( boardNodes[node].GetX(),
+                                                             boardNodes[node].GetY() ) );
+        triangNodes.back()->SetTag( node );
+    }
+
+    hed::TRIANGULATION triangulator;
+    triangulator.CreateDelaunay( triangNodes.begin(), triangNodes.end() );
+    const std::unique_ptr<std::list<hed::EDGE_PTR> > triangEdges( triangulator.GetEdges() );
 
     // Compute weight/distance for edges resulting from triangulation
-    RN_LINKS::RN_EDGE_LIST::iterator eit, eitEnd;
-    for( eit = (*triangEdges).begin(), eitEnd = (*triangEdges).end(); eit != eitEnd; ++eit )
-        (*eit)->SetWeight( getDistance( (*eit)->GetSourceNode(), (*eit)->GetTargetNode() ) );
+    m_candidates.clear();
+    m_candidates.reserve( triangEdges->size() );
 
-    // Add the currently existing connections list to the results of triangulation
-    std::copy( boardEdges.begin(), boardEdges.end(), std::front_inserter( *triangEdges ) );
+    for( const hed::EDGE_PTR& edge : *triangEdges )
+    {
+        RN_NODE_ID source = edge->GetSourceNode()->GetTag();
+        RN_NODE_ID target = edge->GetTargetNode()->GetTag();
 
-    // Get the minimal spanning tree
-    m_rnEdges.reset( kruskalMST( *triangEdges, nodes ) );
+        m_candidates.push_back( makeCandidate( source, target,
+                                               getDistance( boardNodes[source],
+                                                            boardNodes[target] ) ) );
+    }
+
+    // Kruskal algorithm requires edges to be sorted by their weight
+    std::sort( m_candidates.begin(), m_candidates.end(), sortCandidates );
+    m_candidates.erase( std::unique( m_candidates.begin(), m_candidates.end(), sameCandidate ),
+                        m_candidates.end() );
+
+    m_changedSinceRebuild = 0;
 }
 
 
-void RN_NET::clearNode( const RN_NODE_PTR& aNode )
+///> Compares the x coordinate of a node with a value, for binary searches.
+struct RN_NODE_X_LESS
 {
-    if( !m_rnEdges )
-        return;
+    RN_NODE_X_LESS( const std::vector<RN_NODE>& aNodes ) : m_nodes( aNodes ) {}
+
+    bool operator()( RN_NODE_ID aNode, int aX ) const
+    {
+        return m_nodes[aNode].GetX() < aX;
+    }
 
-    std::vector<RN_EDGE_MST_PTR>::iterator newEnd;
+    const std::vector<RN_NODE>& m_nodes;
+};
 
-    // Remove all ratsnest edges for associated with the node
-    newEnd = std::remove_if( m_rnEdges->begin(), m_rnEdges->end(),
-                             std::bind( isEdgeConnectingNode, std::placeholders::_1, std::cref( aNode ) ) );
 
-    m_rnEdges->resize( std::distance( m_rnEdges->begin(), newEnd ) );
+/**
+ * Function findClosestNodes()
+ * Finds the aCount nodes closest to aNode.
+ * @param aSorted are all the nodes in use, sorted by their x coordinate.
+ * @param aClosest is the output, pairs of distance and node handle.
+ */
+static void findClosestNodes( const std::vector<RN_NODE>& aNodes,
+                              const std::vector<RN_NODE_ID>& aSorted, RN_NODE_ID aNode,
+                              unsigned int aCount,
+                              std::vector<std::pair<uint64_t, RN_NODE_ID> >& aClosest )
+{
+    const RN_NODE& origin = aNodes[aNode];
+    std::vector<RN_NODE_ID>::const_iterator start =
+            std::lower_bound( aSorted.begin(), aSorted.end(), origin.GetX(),
+                              RN_NODE_X_LESS( aNodes ) );
+
+    // aClosest is kept as a max-heap, so the farthest of the closest nodes is on top
+    aClosest.clear();
+
+    // Scan to the right, then to the left, until nodes are farther along the x axis
+    // than the farthest of the closest nodes found so far
+    for( int direction = 0; direction < 2; ++direction )
+    {
+        std::vector<RN_NODE_ID>::const_iterator it = start;
+
+        while( direction == 0 ? it != aSorted.end() : it != aSorted.begin() )
+        {
+            if( direction == 1 )
+                --it;
+
+            RN_NODE_ID other = *it;
+
+            if( direction == 0 )
+                ++it;
+
+            int64_t dx = ( (int64_t) origin.GetX() - aNodes[other].GetX() ) >> 16;
+
+            if( aClosest.size() == aCount && (uint64_t) ( dx * dx ) > aClosest.front().first )
+                break;
+
+            if( other == aNode )
+                continue;
+
+            uint64_t distance = getDistance( origin, aNodes[other] );
+
+            if( aClosest.size() < aCount )
+            {
+                aClosest.push_back( std::make_pair( distance, other ) );
+                std::push_heap( aClosest.begin(), aClosest.end() );
+            }
+            else if( distance < aClosest.front().first )
+            {
+                std::pop_heap( aClosest.begin(), aClosest.end() );
+                aClosest.back() = std::make_pair( distance, other );
+                std::push_heap( aClosest.begin(), aClosest.end() );
+            }
+        }
+    }
+}
+
+
+void RN_NET::updateCandidates()
+{
+    const std::vector<RN_NODE>& boardNodes = m_links.GetNodes();
+    const std::unordered_set<RN_NODE_ID>& changed = m_links.GetChangedNodes();
+
+    // Nodes that need new candidate edges: the changed ones, and the ones that were linked
+    // to a removed node (they have to be linked to something else)
+    std::unordered_set<RN_NODE_ID> affected;
+    std::vector<RN_EDGE> kept;
+    kept.reserve( m_candidates.size() );
+
+    for( const RN_EDGE& edge : m_candidates )
+    {
+        bool sourceChanged = changed.count( edge.GetSourceNode() );
+        bool targetChanged = changed.count( edge.GetTargetNode() );
+
+        if( !sourceChanged && !targetChanged )
+        {
+            kept.push_back( edge );
+            continue;
+        }
+
+        if( !sourceChanged )
+            affected.insert( edge.GetSourceNode() );
+
+        if( !targetChanged )
+            affected.insert( edge.GetTargetNode() );
+    }
+
+    for( RN_NODE_ID node : changed )
+    {
+        if( boardNodes[node].IsUsed() )
+            affected.insert( node );
+    }
+
+    // Link the affected nodes to their closest neighbours
+    std::vector<RN_NODE_ID> sorted;
+    std::vector<std::pair<uint64_t, RN_NODE_ID> > closest;
+    std::vector<RN_EDGE> added;
+
+    getNodesSortedByX( sorted );
+
+    for( RN_NODE_ID node : affected )
+    {
+        findClosestNodes( boardNodes, sorted, node, DYNAMIC_NEIGHBOURS, closest );
+
+        for( const std::pair<uint64_t, RN_NODE_ID>& neighbour : closest )
+            added.push_back( makeCandidate( node, neighbour.second, neighbour.first ) );
+    }
+
+    std::sort( added.begin(), added.end(), sortCandidates );
+
+    m_candidates.clear();
+    std::merge( kept.begin(), kept.end(), added.begin(), added.end(),
+                std::back_inserter( m_candidates ), sortCandidates );
+    m_candidates.erase( std::unique( m_candidates.begin(), m_candidates.end(), sameCandidate ),
+                        m_candidates.end() );
+}
+
+
+bool RN_NET::computeMST( const std::vector<RN_NODE_ID>& aNodes )
+{
+    // The currently existing connections go first, as they make the clusters of nodes
+    // connected with copper
+    std::vector<RN_EDGE> edges;
+    edges.reserve( m_links.GetConnectionCount() + m_candidates.size() );
+
+    for( const RN_EDGE& edge : m_links.GetConnections() )
+    {
+        if( edge.IsUsed() )
+            edges.push_back( edge );
+    }
+
+    edges.insert( edges.end(), m_candidates.begin(), m_candidates.end() );
+
+    // Get the minimal spanning tree
+    m_rnEdges.clear();
+
+    return kruskalMST( edges, m_links, aNodes, m_rnEdges ) <= 1;
+}
+
+
+void RN_NET::clearNode( RN_NODE_ID aNode )
+{
+    // Remove all ratsnest edges for associated with the node
+    m_rnEdges.erase( std::remove_if( m_rnEdges.begin(), m_rnEdges.end(),
+                                     std::bind( &RN_EDGE::IsConnecting, std::placeholders::_1,
+                                                aNode ) ),
+                     m_rnEdges.end() );
 }
 
 
@@ -395,15 +718,18 @@ RN_POLY::RN_POLY( const SHAPE_POLY_SET* aParent,
 
     m_node = aConnections.AddNode( p.x, p.y );
 
+    RN_NODE& node = aConnections.GetNode( m_node );
+    node.AddPolyRef();
+
     // Mark it as not appropriate as a destination of ratsnest edges
     // (edges coming out from a polygon vertex look weird)
-    m_node->SetFlag( true );
+    node.SetFlag( true );
 }
 
 
-bool RN_POLY::HitTest( const RN_NODE_PTR& aNode ) const
+bool RN_POLY::HitTest( const RN_NODE& aNode ) const
 {
-    VECTOR2I p( aNode->GetX(), aNode->GetY() );
+    VECTOR2I p( aNode.GetX(), aNode.GetY() );
 
     return m_parentPolyset->Contains( p, m_subpolygonIndex );
 }
@@ -417,7 +743,7 @@ void RN_NET::Update()
 
     compute();
 
-    for( RN_EDGE_MST_PTR& edge : *m_rnEdges )
+    for( RN_EDGE& edge : m_rnEdges )
         validateEdge( edge );
 
     m_dirty = false;
@@ -430,8 +756,8 @@ void RN_NET::AddItem( const D_PAD* aPad )
     if( ( aPad->GetLayerSet() & LSET::AllCuMask() ).none() )
         return;
 
-    RN_NODE_PTR node = m_links.AddNode( aPad->GetPosition().x, aPad->GetPosition().y );
-    node->AddParent( aPad );
+    RN_NODE_ID node = m_links.AddNode( aPad->GetPosition().x, aPad->GetPosition().y );
+    m_links.GetNode( node ).AddParent( aPad );
     m_pads[aPad].m_Node = node;
 
     m_dirty = true;
@@ -440,8 +766,8 @@ void RN_NET::AddItem( const D_PAD* aPad )
 
 void RN_NET::AddItem( const VIA* aVia )
 {
-    RN_NODE_PTR node = m_links.AddNode( aVia->GetPosition().x, aVia->GetPosition().y );
-    node->AddParent( aVia );
+    RN_NODE_ID node = m_links.AddNode( aVia->GetPosition().x, aVia->GetPosition().y );
+    m_links.GetNode( node ).AddParent( aVia );
     m_vias[aVia] = node;
 
     m_dirty = true;
@@ -453,11 +779,11 @@ void RN_NET::AddItem( const TRACK* aTrack )
     if( aTrack->GetStart() == aTrack->GetEnd() )
         return;
 
-    RN_NODE_PTR start = m_links.AddNode( aTrack->GetStart().x, aTrack->GetStart().y );
-    RN_NODE_PTR end = m_links.AddNode( aTrack->GetEnd().x, aTrack->GetEnd().y );
+    RN_NODE_ID start = m_links.AddNode( aTrack->GetStart().x, aTrack->GetStart().y );
+    RN_NODE_ID end = m_links.AddNode( aTrack->GetEnd().x, aTrack->GetEnd().y );
 
-    start->AddParent( aTrack );
-    end->AddParent( aTrack );
+    m_links.GetNode( start ).AddParent( aTrack );
+    m_links.GetNode( end ).AddParent( aTrack );
     m_tracks[aTrack] = m_links.AddConnection( start, end );
 
     m_dirty = true;
@@ -489,12 +815,10 @@ void RN_NET::RemoveItem( const D_PAD* aPad )
         return;
 
     RN_PAD_DATA& pad_data = it->second;
+    removeHelperEdges( pad_data.m_Edges );
     removeNode( pad_data.m_Node, aPad );
 
-    for( RN_EDGE_MST_PTR& edge : pad_data.m_Edges )
-        removeEdge( edge, aPad );
-
-    m_pads.erase( aPad );
+    m_pads.erase( it );
 }
 
 
@@ -531,74 +855,50 @@ void RN_NET::RemoveItem( const ZONE_CONTAINER* aZone )
 
     RN_ZONE_DATA& zoneData = it->second;
 
+    // Remove all connections added by the zone
+    removeHelperEdges( zoneData.m_Edges );
+
     // Remove all subpolygons that make the zone
     std::deque<RN_POLY>& polygons = zoneData.m_Polygons;
     for( RN_POLY& polygon : polygons )
-        removeNode( polygon.GetNode(), aZone );
+    {
+        m_links.GetNode( polygon.GetNode() ).RemovePolyRef();
+        releaseNode( polygon.GetNode() );
+    }
     polygons.clear();
 
-    // Remove all connections added by the zone
-    std::deque<RN_EDGE_MST_PTR>& edges = zoneData.m_Edges;
-    for( RN_EDGE_MST_PTR edge : edges )
-        removeEdge( edge, aZone );
-    edges.clear();
-
     m_zones.erase( it );
 }
 
 
-const RN_NODE_PTR RN_NET::GetClosestNode( const RN_NODE_PTR& aNode ) const
+RN_NODE_ID RN_NET::GetClosestNode( RN_NODE_ID aNode ) const
 {
-    const RN_LINKS::RN_NODE_SET& nodes = m_links.GetNodes();
-    RN_LINKS::RN_NODE_SET::const_iterator it, itEnd;
-
-    unsigned int minDistance = std::numeric_limits<unsigned int>::max();
-    RN_NODE_PTR closest;
-
-    for( it = nodes.begin(), itEnd = nodes.end(); it != itEnd; ++it )
-    {
-        RN_NODE_PTR node = *it;
-
-        // Obviously the distance between node and itself is the shortest,
-        // that's why we have to skip it
-        if( node != aNode )
-        {
-            unsigned int distance = getDistance( node, aNode );
-            if( distance < minDistance )
-            {
-                minDistance = distance;
-                closest = node;
-            }
-        }
-    }
-
-    return closest;
+    return GetClosestNode( aNode, RN_NODE_FILTER() );
 }
 
 
-const RN_NODE_PTR RN_NET::GetClosestNode( const RN_NODE_PTR& aNode,
-                                          const RN_NODE_FILTER& aFilter ) const
+RN_NODE_ID RN_NET::GetClosestNode( RN_NODE_ID aNode, const RN_NODE_FILTER& aFilter ) const
 {
-    const RN_LINKS::RN_NODE_SET& nodes = m_links.GetNodes();
-    RN_LINKS::RN_NODE_SET::const_iterator it, itEnd;
+    const std::vector<RN_NODE>& nodes = m_links.GetNodes();
+    const RN_NODE& origin = nodes[aNode];
 
-    unsigned int minDistance = std::numeric_limits<unsigned int>::max();
-    RN_NODE_PTR closest;
+    uint64_t minDistance = std::numeric_limits<uint64_t>::max();
+    RN_NODE_ID closest = RN_INVALID_ID;
 
-    for( it = nodes.begin(), itEnd = nodes.end(); it != itEnd; ++it )
+    for( unsigned int i = 0; i < nodes.size(); ++i )
     {
-        RN_NODE_PTR node = *it;
+        const RN_NODE& node = nodes[i];
 
         // Obviously the distance between node and itself is the shortest,
         // that's why we have to skip it
-        if( node != aNode && aFilter( node ) )
+        if( node.IsUsed() && (int) i != aNode && aFilter( node ) )
         {
-            unsigned int distance = getDistance( node, aNode );
+            uint64_t distance = getDistance( node, origin );
 
             if( distance < minDistance )
             {
                 minDistance = distance;
-                closest = node;
+                closest = i;
             }
         }
     }
@@ -607,51 +907,43 @@ const RN_NODE_PTR RN_NET::GetClosestNode( const RN_NODE_PTR& aNode,
 }
 
 
-std::list<RN_NODE_PTR> RN_NET::GetClosestNodes( const RN_NODE_PTR& aNode, int aNumber ) const
+std::vector<RN_NODE_ID> RN_NET::GetClosestNodes( RN_NODE_ID aNode, int aNumber ) const
 {
-    std::list<RN_NODE_PTR> closest;
-    const RN_LINKS::RN_NODE_SET& nodes = m_links.GetNodes();
-
-    // Copy nodes
-    for( const RN_NODE_PTR& node : nodes )
-        closest.push_back( node );
-
-    // Sort by the distance from aNode
-    closest.sort( std::bind( sortDistance, std::cref( aNode ), std::placeholders::_1, std::placeholders::_2 ) );
-
-    // aNode should not be returned in the results
-    closest.remove( aNode );
-
-    // Trim the result to the asked size
-    if( aNumber > 0 )
-        closest.resize( std::min( (size_t)aNumber, nodes.size() ) );
-
-    return closest;
+    return GetClosestNodes( aNode, RN_NODE_FILTER(), aNumber );
 }
 
 
-std::list<RN_NODE_PTR> RN_NET::GetClosestNodes( const RN_NODE_PTR& aNode,
-                                                const RN_NODE_FILTER& aFilter, int aNumber ) const
+std::vector<RN_NODE_ID> RN_NET::GetClosestNodes( RN_NODE_ID aNode,
+                                                 const RN_NODE_FILTER& aFilter,
+                                                 int aNumber ) const
 {
-    std::list<RN_NODE_PTR> closest;
-    const RN_LINKS::RN_NODE_SET& nodes = m_links.GetNodes();
-
-    // Copy nodes
-    for( const RN_NODE_PTR& node : nodes )
-        closest.push_back( node );
-
-    // Sort by the distance from aNode
-    closest.sort( std::bind( sortDistance, std::cref( aNode ), std::placeholders::_1, std::placeholders::_2 ) );
+    const std::vector<RN_NODE>& nodes = m_links.GetNodes();
+    const RN_NODE& origin = nodes[aNode];
+    std::vector<std::pair<uint64_t, RN_NODE_ID> > candidates;
 
     // aNode should not be returned in the results
-    closest.remove( aNode );
+    for( unsigned int i = 0; i < nodes.size(); ++i )
+    {
+        if( nodes[i].IsUsed() && (int) i != aNode && aFilter( nodes[i] ) )
+            candidates.push_back( std::make_pair( getDistance( origin, nodes[i] ), i ) );
+    }
 
-    // Filter out by condition
-    std::remove_if( closest.begin(), closest.end(), aFilter );
+    // Sort by the distance from aNode, trimming the result to the asked size
+    if( aNumber > 0 && aNumber < (int) candidates.size() )
+    {
+        std::partial_sort( candidates.begin(), candidates.begin() + aNumber, candidates.end() );
+        candidates.resize( aNumber );
+    }
+    else
+    {
+        std::sort( candidates.begin(), candidates.end() );
+    }
 
-    // Trim the result to the asked size
-    if( aNumber > 0 )
-        closest.resize( std::min( static_cast<size_t>( aNumber ), nodes.size() ) );
+    std::vector<RN_NODE_ID> closest;
+    closest.reserve( candidates.size() );
+
+    for( const std::pair<uint64_t, RN_NODE_ID>& candidate : candidates )
+        closest.push_back( candidate.second );
 
     return closest;
 }
@@ -659,21 +951,21 @@ std::list<RN_NODE_PTR> RN_NET::GetClosestNodes( const RN_NODE_PTR& aNode,
 
 void RN_NET::AddSimple( const BOARD_CONNECTED_ITEM* aItem )
 {
-    for( RN_NODE_PTR node : GetNodes( aItem ) )
+    for( RN_NODE_ID node : GetNodes( aItem ) )
     {
         // Block all nodes, so they do not become targets for dynamic ratsnest lines
         AddBlockedNode( node );
 
         // Filter out junctions
-        if( node->GetRefCount() == 1 )
+        if( m_links.GetNode( node ).GetRefCount() == 1 )
             m_simpleNodes.insert( node );
     }
 }
 
 
-std::list<RN_NODE_PTR> RN_NET::GetNodes( const BOARD_CONNECTED_ITEM* aItem ) const
+std::vector<RN_NODE_ID> RN_NET::GetNodes( const BOARD_CONNECTED_ITEM* aItem ) const
 {
-    std::list<RN_NODE_PTR> nodes;
+    std::vector<RN_NODE_ID> nodes;
 
     switch( aItem->Type() )
     {
@@ -701,8 +993,9 @@ std::list<RN_NODE_PTR> RN_NET::GetNodes( const BOARD_CONNECTED_ITEM* aItem ) con
 
         if( it != m_tracks.end() )
         {
-            nodes.push_back( it->second->GetSourceNode() );
-            nodes.push_back( it->second->GetTargetNode() );
+            const RN_EDGE& edge = m_links.GetConnection( it->second );
+            nodes.push_back( edge.GetSourceNode() );
+            nodes.push_back( edge.GetTargetNode() );
         }
     }
     break;
@@ -758,8 +1051,8 @@ void RN_NET::GetAllItems( std::list<BOARD_CONNECTED_ITEM*>& aOutput, RN_ITEM_TYP
 
 void RN_NET::ClearSimple()
 {
-    for( const RN_NODE_PTR& node : m_blockedNodes )
-        node->SetFlag( false );
+    for( RN_NODE_ID node : m_blockedNodes )
+        m_links.GetNode( node ).SetFlag( false );
 
     m_blockedNodes.clear();
     m_simpleNodes.clear();
@@ -770,17 +1063,17 @@ void RN_NET::GetConnectedItems( const BOARD_CONNECTED_ITEM* aItem,
                                 std::list<BOARD_CONNECTED_ITEM*>& aOutput,
                                 RN_ITEM_TYPE aTypes ) const
 {
-    std::list<RN_NODE_PTR> nodes = GetNodes( aItem );
+    std::vector<RN_NODE_ID> nodes = GetNodes( aItem );
     assert( !nodes.empty() );
 
-    int tag = nodes.front()->GetTag();
+    int tag = m_links.GetNode( nodes.front() ).GetTag();
     assert( tag >= 0 );
 
     if( aTypes & RN_PADS )
     {
         for( PAD_NODE_MAP::const_iterator it = m_pads.begin(); it != m_pads.end(); ++it )
         {
-            if( it->second.m_Node->GetTag() == tag )
+            if( m_links.GetNode( it->second.m_Node ).GetTag() == tag )
                 aOutput.push_back( const_cast<D_PAD*>( it->first ) );
         }
     }
@@ -789,7 +1082,7 @@ void RN_NET::GetConnectedItems( const BOARD_CONNECTED_ITEM* aItem,
     {
         for( VIA_NODE_MAP::const_iterator it = m_vias.begin(); it != m_vias.end(); ++it )
         {
-            if( it->second->GetTag() == tag )
+            if( m_links.GetNode( it->second ).GetTag() == tag )
                 aOutput.push_back( const_cast<VIA*>( it->first ) );
         }
     }
@@ -798,7 +1091,7 @@ void RN_NET::GetConnectedItems( const BOARD_CONNECTED_ITEM* aItem,
     {
         for( TRACK_EDGE_MAP::const_iterator it = m_tracks.begin(); it != m_tracks.end(); ++it )
         {
-            if( it->second->GetTag() == tag )
+            if( m_links.GetNode( m_links.GetConnection( it->second ).GetSourceNode() ).GetTag() == tag )
                 aOutput.push_back( const_cast<TRACK*>( it->first ) );
         }
     }
@@ -807,9 +1100,15 @@ void RN_NET::GetConnectedItems( const BOARD_CONNECTED_ITEM* aItem,
     {
         for( ZONE_DATA_MAP::const_iterator it = m_zones.begin(); it != m_zones.end(); ++it )
         {
-            for( const RN_EDGE_MST_PTR& edge : it->second.m_Edges )
+            for( RN_EDGE_ID edgeId : it->second.m_Edges )
             {
-                if( edge->GetTag() == tag )
+                const RN_EDGE& edge = m_links.GetConnection( edgeId );
+                int edgeTag = m_links.GetNode( edge.GetSourceNode() ).GetTag();
+
+                if( edgeTag < 0 )
+                    edgeTag = m_links.GetNode( edge.GetTargetNode() ).GetTag();
+
+                if( edgeTag == tag )
                 {
                     aOutput.push_back( const_cast<ZONE_CONTAINER*>( it->first ) );
                     break;
@@ -861,7 +1160,7 @@ void RN_DATA::AddBlocked( const BOARD_ITEM* aItem )
             return;
 
         // Block all nodes belonging to the item
-        for( RN_NODE_PTR node : m_nets[net].GetNodes( item ) )
+        for( RN_NODE_ID node : m_nets[net].GetNodes( item ) )
             m_nets[net].AddBlockedNode( node );
     }
     else if( aItem->Type() == PCB_MODULE_T )
@@ -916,12 +1215,13 @@ bool RN_DATA::AreConnected( const BOARD_CONNECTED_ITEM* aItem, const BOARD_CONNE
     assert( net1 < (int) m_nets.size() && net2 < (int) m_nets.size() );
 
     // net1 == net2
-    std::list<RN_NODE_PTR> items1 = m_nets[net1].GetNodes( aItem );
-    std::list<RN_NODE_PTR> items2 = m_nets[net1].GetNodes( aOther );
+    const RN_NET& net = m_nets[net1];
+    std::vector<RN_NODE_ID> items1 = net.GetNodes( aItem );
+    std::vector<RN_NODE_ID> items2 = net.GetNodes( aOther );
 
     assert( !items1.empty() && !items2.empty() );
 
-    return ( items1.front()->GetTag() == items2.front()->GetTag() );
+    return ( net.GetNode( items1.front() ).GetTag() == net.GetNode( items2.front() ).GetTag() );
 }
 
 
@@ -931,7 +1231,7 @@ int RN_DATA::GetUnconnectedCount() const
 
     for( unsigned i = 0; i < m_nets.size(); ++i )
     {
-        const std::vector<RN_EDGE_MST_PTR>* unconnected = m_nets[i].GetUnconnected();
+        const std::vector<RN_EDGE>* unconnected = m_nets[i].GetUnconnected();
 
         if( unconnected )
             count += unconnected->size();
@@ -941,23 +1241,41 @@ int RN_DATA::GetUnconnectedCount() const
 }
 
 
+void RN_NET::getNodesSortedByX( std::vector<RN_NODE_ID>& aNodes ) const
+{
+    const std::vector<RN_NODE>& nodes = m_links.GetNodes();
+
+    getUsedNodes( aNodes );
+    std::sort( aNodes.begin(), aNodes.end(), [&nodes]( RN_NODE_ID aA, RN_NODE_ID aB )
+    {
+        return nodes[aA].GetX() < nodes[aB].GetX();
+    } );
+}
+
+
 void RN_NET::processZones()
 {
+    const std::vector<RN_NODE>& nodes = m_links.GetNodes();
+    std::vector<RN_NODE_ID> candidates;
+    std::vector<bool> taken;
+
+    // Candidates are sorted by x, so the nodes inside a polygon bounding box
+    // are found with a binary search
+    if( !m_zones.empty() )
+        getNodesSortedByX( candidates );
+
     for( ZONE_DATA_MAP::iterator it = m_zones.begin(); it != m_zones.end(); ++it )
     {
         const ZONE_CONTAINER* zone = it->first;
         RN_ZONE_DATA& zoneData = it->second;
 
         // Reset existing connections
-        for( RN_EDGE_MST_PTR edge : zoneData.m_Edges )
-            m_links.RemoveConnection( edge );
+        removeHelperEdges( zoneData.m_Edges );
 
-        zoneData.m_Edges.clear();
         LSET layers = zone->GetLayerSet();
 
         // Compute new connections
-        RN_LINKS::RN_NODE_SET candidates = m_links.GetNodes();
-        RN_LINKS::RN_NODE_SET::iterator point, pointEnd;
+        taken.assign( candidates.size(), false );
 
         // Sorting by area should speed up the processing, as smaller polygons are computed
         // faster and may reduce the number of points for further checks
@@ -966,28 +1284,30 @@ void RN_NET::processZones()
         for( std::deque<RN_POLY>::iterator poly = zoneData.m_Polygons.begin(),
                 polyEnd = zoneData.m_Polygons.end(); poly != polyEnd; ++poly )
         {
-            const RN_NODE_PTR& node = poly->GetNode();
+            RN_NODE_ID node = poly->GetNode();
+            const BOX2I& bbox = poly->BBox();
 
-            point = candidates.begin();
-            pointEnd = candidates.end();
+            unsigned int i = std::lower_bound( candidates.begin(), candidates.end(),
+                                               bbox.GetLeft(), RN_NODE_X_LESS( nodes ) )
+                             - candidates.begin();
 
-            while( point != pointEnd )
+            for( ; i < candidates.size() && nodes[candidates[i]].GetX() <= bbox.GetRight(); ++i )
             {
-                if( *point != node && ( (*point)->GetLayers() & layers ).any()
-                        && poly->HitTest( *point ) )
-                {
-                    //(*point)->AddParent( zone );  // do not assign parent for helper links
+                RN_NODE_ID point = candidates[i];
+                const RN_NODE& pointNode = nodes[point];
 
-                    RN_EDGE_MST_PTR connection = m_links.AddConnection( node, *point );
-                    zoneData.m_Edges.push_back( connection );
+                if( taken[i] || pointNode.GetY() < bbox.GetTop()
+                        || pointNode.GetY() > bbox.GetBottom() )
+                    continue;
 
-                    // This point already belongs to a polygon, we do not need to check it anymore
-                    point = candidates.erase( point );
-                    pointEnd = candidates.end();
-                }
-                else
+                if( point != node && ( pointNode.GetLayers() & layers ).any()
+                        && poly->HitTest( pointNode ) )
                 {
-                    ++point;
+                    // do not assign parent for helper links
+                    zoneData.m_Edges.push_back( m_links.AddConnection( node, point ) );
+
+                    // This point already belongs to a polygon, we do not need to check it anymore
+                    taken[i] = true;
                 }
             }
         }
@@ -997,35 +1317,43 @@ void RN_NET::processZones()
 
 void RN_NET::processPads()
 {
+    const std::vector<RN_NODE>& nodes = m_links.GetNodes();
+    std::vector<RN_NODE_ID> candidates;
+
+    // Candidates are sorted by x, so the nodes inside a pad bounding box
+    // are found with a binary search
+    getNodesSortedByX( candidates );
+
     for( PAD_NODE_MAP::iterator it = m_pads.begin(); it != m_pads.end(); ++it )
     {
         const D_PAD* pad = it->first;
-        RN_NODE_PTR node = it->second.m_Node;
-        std::deque<RN_EDGE_MST_PTR>& edges = it->second.m_Edges;
+        RN_NODE_ID node = it->second.m_Node;
+        std::vector<RN_EDGE_ID>& edges = it->second.m_Edges;
 
         // Reset existing connections
-        for( RN_EDGE_MST_PTR edge : edges )
-            m_links.RemoveConnection( edge );
+        removeHelperEdges( edges );
 
         LSET layers = pad->GetLayerSet();
-        const RN_LINKS::RN_NODE_SET& candidates = m_links.GetNodes();
-        RN_LINKS::RN_NODE_SET::const_iterator point, pointEnd;
+        EDA_RECT bbox = pad->GetBoundingBox();
+        bbox.Normalize();
 
-        point = candidates.cbegin();
-        pointEnd = candidates.cend();
+        std::vector<RN_NODE_ID>::const_iterator point =
+                std::lower_bound( candidates.begin(), candidates.end(), bbox.GetX(),
+                                  RN_NODE_X_LESS( nodes ) );
 
-        while( point != pointEnd )
+        for( ; point != candidates.end() && nodes[*point].GetX() <= bbox.GetRight(); ++point )
         {
-            if( *point != node && ( (*point)->GetLayers() & layers ).any() &&
-                    pad->HitTest( wxPoint( (*point)->GetX(), (*point)->GetY() ) ) )
-            {
-                //(*point)->AddParent( pad );   // do not assign parent for helper links
+            const RN_NODE& pointNode = nodes[*point];
 
-                RN_EDGE_MST_PTR connection = m_links.AddConnection( node, *point );
-                edges.push_back( connection );
-            }
+            if( pointNode.GetY() < bbox.GetY() || pointNode.GetY() > bbox.GetBottom() )
+                continue;
 
-            ++point;
+            if( *point != node && ( pointNode.GetLayers() & layers ).any() &&
+                    pad->HitTest( wxPoint( pointNode.GetX(), pointNode.GetY() ) ) )
+            {
+                // do not assign parent for helper links
+                edges.push_back( m_links.AddConnection( node, *point ) );
+            }
         }
     }
 }
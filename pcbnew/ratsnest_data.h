@@ -30,12 +30,14 @@
 #ifndef RATSNEST_DATA_H
 #define RATSNEST_DATA_H
 
+#include <cassert>
+#include <cstdint>
 #include <deque>
-#include <memory>
-
-#include <ttl/halfedge/hetriang.h>
-#include <ttl/halfedge/hetraits.h>
+#include <functional>
+#include <list>
+#include <vector>
 
+#include <layers_id_colors_and_visibility.h>
 #include <math/box2.h>
 
 #include <unordered_set>
@@ -61,27 +63,182 @@ enum RN_ITEM_TYPE
     RN_ALL     = 0xFF
 };
 
-// Preserve KiCad coding style policy
-typedef hed::NODE           RN_NODE;
-typedef hed::NODE_PTR       RN_NODE_PTR;
-typedef hed::EDGE           RN_EDGE;
-typedef hed::EDGE_PTR       RN_EDGE_PTR;
-typedef hed::EDGE_MST       RN_EDGE_MST;
-typedef hed::TRIANGULATION  TRIANGULATOR;
-typedef std::shared_ptr<hed::EDGE_MST> RN_EDGE_MST_PTR;
+///> Handles of nodes and edges, i.e. their indices in the arrays stored by RN_LINKS.
+typedef int RN_NODE_ID;
+typedef int RN_EDGE_ID;
+
+///> Handle value that does not refer to any node or edge.
+const int RN_INVALID_ID = -1;
+
+
+/**
+ * Class RN_NODE
+ * Describes a point that is expected to be connected to other points of its net (pad, via,
+ * track end or zone subpolygon). Nodes are stored by value in RN_LINKS and are referred
+ * to by their RN_NODE_ID.
+ */
+class RN_NODE
+{
+public:
+    RN_NODE( int aX = 0, int aY = 0 ) :
+        m_x( aX ), m_y( aY ), m_tag( TAG_UNCONNECTED ), m_polyRefCount( 0 ),
+        m_flag( false ), m_used( false )
+    {
+        m_layers.reset();
+    }
+
+    inline int GetX() const
+    {
+        return m_x;
+    }
+
+    inline int GetY() const
+    {
+        return m_y;
+    }
+
+    ///> Returns tag, common identifier for connected nodes.
+    inline int GetTag() const
+    {
+        return m_tag;
+    }
+
+    ///> Sets tag, common identifier for connected nodes.
+    inline void SetTag( int aTag )
+    {
+        m_tag = aTag;
+    }
+
+    inline void SetFlag( bool aFlag )
+    {
+        m_flag = aFlag;
+    }
+
+    inline bool GetFlag() const
+    {
+        return m_flag;
+    }
+
+    ///> Returns true if the node is in use, false for a free slot of the node array.
+    inline bool IsUsed() const
+    {
+        return m_used;
+    }
+
+    ///> Returns the number of board items that share this node.
+    inline unsigned int GetRefCount() const
+    {
+        return m_parents.size();
+    }
+
+    void AddParent( const BOARD_CONNECTED_ITEM* aParent )
+    {
+        m_parents.push_back( aParent );
+        m_layers.reset();   // mark as needs updating
+    }
+
+    void RemoveParent( const BOARD_CONNECTED_ITEM* aParent );
+
+    ///> Zone subpolygons are represented by nodes without parents,
+    ///> they are counted separately to keep the node in use.
+    inline void AddPolyRef()
+    {
+        ++m_polyRefCount;
+    }
+
+    inline void RemovePolyRef()
+    {
+        assert( m_polyRefCount > 0 );
+        --m_polyRefCount;
+    }
+
+    ///> Returns the layers that are occupied by this node.
+    const LSET& GetLayers() const;
+
+    // Tag used for unconnected items.
+    static const int TAG_UNCONNECTED = -1;
+
+private:
+    friend class RN_LINKS;
+
+    /// Node coordinates
+    int m_x, m_y;
+
+    /// Tag for quick connection resolution
+    int m_tag;
+
+    /// Number of zone subpolygons represented by this node
+    int m_polyRefCount;
+
+    /// Marks nodes that should not be used as ratsnest targets
+    bool m_flag;
+
+    /// False for free slots
+    bool m_used;
+
+    /// Board items that share this node
+    std::vector<const BOARD_CONNECTED_ITEM*> m_parents;
+
+    /// Layers that are occupied by this node, computed on demand
+    mutable LSET m_layers;
+};
+
+
+/**
+ * Class RN_EDGE
+ * Describes a connection between two nodes: either an existing one (track, or helper
+ * connection made by a zone or a pad), or a missing one (ratsnest line).
+ */
+class RN_EDGE
+{
+public:
+    RN_EDGE( RN_NODE_ID aSource = RN_INVALID_ID, RN_NODE_ID aTarget = RN_INVALID_ID,
+             unsigned int aWeight = 0 ) :
+        m_source( aSource ), m_target( aTarget ), m_weight( aWeight )
+    {}
+
+    inline RN_NODE_ID GetSourceNode() const
+    {
+        return m_source;
+    }
+
+    inline RN_NODE_ID GetTargetNode() const
+    {
+        return m_target;
+    }
+
+    inline unsigned int GetWeight() const
+    {
+        return m_weight;
+    }
+
+    ///> Returns true if the edge is in use, false for a free slot of the edge array.
+    inline bool IsUsed() const
+    {
+        return m_source != RN_INVALID_ID;
+    }
+
+    inline bool IsConnecting( RN_NODE_ID aNode ) const
+    {
+        return m_source == aNode || m_target == aNode;
+    }
+
+private:
+    RN_NODE_ID   m_source;
+    RN_NODE_ID   m_target;
+    unsigned int m_weight;
+};
 
-bool operator==( const RN_NODE_PTR& aFirst, const RN_NODE_PTR& aSecond );
-bool operator!=( const RN_NODE_PTR& aFirst, const RN_NODE_PTR& aSecond );
 
 struct RN_NODE_OR_FILTER;
 struct RN_NODE_AND_FILTER;
 
 ///> General interface for filtering out nodes in search functions.
-struct RN_NODE_FILTER : public std::unary_function<const RN_NODE_PTR&, bool>
+struct RN_NODE_FILTER : public std::unary_function<const RN_NODE&, bool>
 {
     virtual ~RN_NODE_FILTER() {}
 
-    virtual bool operator()( const RN_NODE_PTR& aNode ) const
+    virtual bool operator()( const RN_NODE& aNode ) const
     {
         return true;        // By default everything passes
     }
@@ -96,9 +253,9 @@ RN_NODE_OR_FILTER operator||( const RN_NODE_FILTER& aFilter1, const RN_NODE_FILT
 ///> Filters out nodes that have the flag set.
 struct WITHOUT_FLAG : public RN_NODE_FILTER
 {
-    bool operator()( const RN_NODE_PTR& aNode ) const
+    bool operator()( const RN_NODE& aNode ) const
     {
-        return !aNode->GetFlag();
+        return !aNode.GetFlag();
     }
 };
 
@@ -109,9 +266,9 @@ struct DIFFERENT_TAG : public RN_NODE_FILTER
         m_tag( aTag )
     {}
 
-    bool operator()( const RN_NODE_PTR& aNode ) const
+    bool operator()( const RN_NODE& aNode ) const
     {
-        return aNode->GetTag() != m_tag;
+        return aNode.GetTag() != m_tag;
     }
 
     private:
@@ -124,7 +281,7 @@ struct RN_NODE_AND_FILTER : public RN_NODE_FILTER
         m_filter1( aFilter1 ), m_filter2( aFilter2 )
     {}
 
-    bool operator()( const RN_NODE_PTR& aNode ) const
+    bool operator()( const RN_NODE& aNode ) const
     {
         return m_filter1( aNode ) && m_filter2( aNode );
     }
@@ -140,7 +297,7 @@ struct RN_NODE_OR_FILTER : public RN_NODE_FILTER
         m_filter1( aFilter1 ), m_filter2( aFilter2 )
     {}
 
-    bool operator()( const RN_NODE_PTR& aNode ) const
+    bool operator()( const RN_NODE& aNode ) const
     {
         return m_filter1( aNode ) || m_filter2( aNode );
     }
@@ -151,72 +308,64 @@ struct RN_NODE_OR_FILTER : public RN_NODE_FILTER
 };
 
 
-///> Functor comparing if two nodes are equal by their coordinates. It is required to make set of
-///> shared pointers work properly.
-struct RN_NODE_COMPARE : std::binary_function<RN_NODE_PTR, RN_NODE_PTR, bool>
-{
-    bool operator()( const RN_NODE_PTR& aNode1, const RN_NODE_PTR& aNode2 ) const
-    {
-        return aNode1 == aNode2;
-    }
-};
-
-///> Functor calculating hash for a given node. It is required to make set of shared pointers
-///> work properly.
-struct RN_NODE_HASH : std::unary_function<RN_NODE_PTR, std::size_t>
-{
-    std::size_t operator()( const RN_NODE_PTR& aNode ) const
-    {
-        std::size_t hash = 2166136261u;
-
-        hash ^= aNode->GetX();
-        hash *= 16777619;
-        hash ^= aNode->GetY();
-
-        return hash;
-    }
-};
-
-
 /**
  * Class RN_LINKS
  * Manages data describing nodes and connections for a given net.
+ *
+ * Nodes and edges are stored in contiguous arrays and referred to by their index. Slots
+ * of removed nodes and edges are kept on free lists and reused, so handles stay valid
+ * until the node or edge they refer to is removed.
  */
 class RN_LINKS
 {
 public:
-    // Helper typedefs
-    typedef std::unordered_set<RN_NODE_PTR, RN_NODE_HASH, RN_NODE_COMPARE> RN_NODE_SET;
-    typedef std::list<RN_EDGE_PTR> RN_EDGE_LIST;
+    RN_LINKS() : m_nodeCount( 0 ), m_edgeCount( 0 )
+    {}
 
     /**
      * Function AddNode()
-     * Adds a node with given coordinates and returns pointer to the newly added node. If the node
-     * existed before, only appropriate pointer is returned.
+     * Adds a node with given coordinates and returns its handle. If the node
+     * existed before, only its handle is returned.
      * @param aX is the x coordinate of a node.
      * @param aY is the y coordinate of a node.
-     * @return Pointer to the node with given coordinates.
+     * @return Handle of the node with given coordinates.
      */
-    const RN_NODE_PTR& AddNode( int aX, int aY );
+    RN_NODE_ID AddNode( int aX, int aY );
 
     /**
      * Function RemoveNode()
-     * Removes a node described by a given node pointer.
-     * @param aNode is a pointer to node to be removed.
+     * Removes a node if it is not referenced anymore (no parents and no subpolygons).
+     * @param aNode is the handle of the node to be removed.
      * @return True if node was removed, false if there were other references, so it was kept.
      */
-    bool RemoveNode( const RN_NODE_PTR& aNode );
+    bool RemoveNode( RN_NODE_ID aNode );
+
+    inline RN_NODE& GetNode( RN_NODE_ID aNode )
+    {
+        return m_nodes[aNode];
+    }
+
+    inline const RN_NODE& GetNode( RN_NODE_ID aNode ) const
+    {
+        return m_nodes[aNode];
+    }
 
     /**
      * Function GetNodes()
-     * Returns the set of currently used nodes.
-     * @return The set of currently used nodes.
+     * Returns the node array. It contains free slots, check RN_NODE::IsUsed().
+     * @return The node array.
      */
-    const RN_NODE_SET& GetNodes() const
+    const std::vector<RN_NODE>& GetNodes() const
     {
         return m_nodes;
     }
 
+    ///> Returns the number of nodes in use.
+    int GetNodeCount() const
+    {
+        return m_nodeCount;
+    }
+
     /**
      * Function AddConnection()
      * Adds a connection between two nodes and of given distance. Edges with distance equal 0 are
@@ -226,36 +375,74 @@ public:
      * @param aNode2 is the end node of a new connection.
      * @param aDistance is the distance of the connection (0 means that nodes are actually
      * connected, >0 means a missing connection).
+     * @return Handle of the new connection.
      */
-    RN_EDGE_MST_PTR AddConnection( const RN_NODE_PTR& aNode1, const RN_NODE_PTR& aNode2,
-                                    unsigned int aDistance = 0 );
+    RN_EDGE_ID AddConnection( RN_NODE_ID aNode1, RN_NODE_ID aNode2, unsigned int aDistance = 0 );
 
     /**
      * Function RemoveConnection()
-     * Removes a connection described by a given edge pointer.
-     * @param aEdge is a pointer to edge to be removed.
+     * Removes a connection described by a given handle.
+     * @param aEdge is the handle of the edge to be removed.
      */
-    void RemoveConnection( const RN_EDGE_PTR& aEdge )
+    void RemoveConnection( RN_EDGE_ID aEdge );
+
+    inline const RN_EDGE& GetConnection( RN_EDGE_ID aEdge ) const
     {
-        m_edges.remove( aEdge );
+        return m_edges[aEdge];
     }
 
     /**
      * Function GetConnections()
-     * Returns the list of edges that currently connect nodes.
-     * @return the list of edges that currently connect nodes.
+     * Returns the array of edges that currently connect nodes. It contains free slots,
+     * check RN_EDGE::IsUsed().
+     * @return the array of edges that currently connect nodes.
      */
-    const RN_EDGE_LIST& GetConnections() const
+    const std::vector<RN_EDGE>& GetConnections() const
     {
         return m_edges;
     }
 
+    ///> Returns the number of connections in use.
+    int GetConnectionCount() const
+    {
+        return m_edgeCount;
+    }
+
+    /**
+     * Function GetChangedNodes()
+     * Returns the nodes that have been added or removed since the last call to
+     * ClearChangedNodes(). Handles of removed nodes may already be reused.
+     */
+    const std::unordered_set<RN_NODE_ID>& GetChangedNodes() const
+    {
+        return m_changedNodes;
+    }
+
+    void ClearChangedNodes()
+    {
+        m_changedNodes.clear();
+    }
+
 protected:
-    ///> Set of nodes that are expected to be connected together (vias, tracks, pads).
-    RN_NODE_SET m_nodes;
+    ///> Nodes that are expected to be connected together (vias, tracks, pads).
+    std::vector<RN_NODE> m_nodes;
 
-    ///> List of edges that currently connect nodes.
-    RN_EDGE_LIST m_edges;
+    ///> Edges that currently connect nodes.
+    std::vector<RN_EDGE> m_edges;
+
+    ///> Free slots in the node and edge arrays.
+    std::vector<RN_NODE_ID> m_freeNodes;
+    std::vector<RN_EDGE_ID> m_freeEdges;
+
+    ///> Finds nodes by their coordinates.
+    std::unordered_map<uint64_t, RN_NODE_ID> m_nodeIndex;
+
+    ///> Nodes added or removed since the last ClearChangedNodes() call.
+    std::unordered_set<RN_NODE_ID> m_changedNodes;
+
+    ///> Number of nodes and edges in use.
+    int m_nodeCount;
+    int m_edgeCount;
 };
 
 
@@ -276,12 +463,7 @@ public:
      * Returns node representing a polygon (it has the same coordinates as the first point of its
      * bounding polyline.
      */
-    inline const RN_NODE_PTR& GetNode() const
-    {
-        return m_node;
-    }
-
-    inline RN_NODE_PTR& GetNode()
+    inline RN_NODE_ID GetNode() const
     {
         return m_node;
     }
@@ -292,7 +474,12 @@ public:
      * @param aNode is a node to be checked.
      * @return True is the node is located within polygon boundaries.
      */
-    bool HitTest( const RN_NODE_PTR& aNode ) const;
+    bool HitTest( const RN_NODE& aNode ) const;
+
+    inline const BOX2I& BBox() const
+    {
+        return m_bbox;
+    }
 
 private:
 
@@ -307,7 +494,7 @@ private:
 
     ///> Node representing a polygon (it has the same coordinates as the first point of its
     ///> bounding polyline.
-    RN_NODE_PTR m_node;
+    RN_NODE_ID m_node;
 
     friend bool sortArea( const RN_POLY& aP1, const RN_POLY& aP2 );
 };
@@ -321,9 +508,19 @@ class RN_NET
 {
 public:
     ///> Default constructor.
-    RN_NET() : m_dirty( true ), m_visible( true )
+    RN_NET() : m_changedSinceRebuild( 0 ), m_dirty( true ), m_visible( true )
     {}
 
+    /**
+     * Function GetNode()
+     * Returns a node of the net.
+     * @param aNode is the node handle.
+     */
+    inline const RN_NODE& GetNode( RN_NODE_ID aNode ) const
+    {
+        return m_links.GetNode( aNode );
+    }
+
     /**
      * Function SetVisible()
      * Sets state of the visibility flag.
@@ -370,9 +567,9 @@ public:
      * Returns pointer to a vector of edges that makes ratsnest for a given net.
      * @return Pointer to a vector of edges that makes ratsnest for a given net.
      */
-    const std::vector<RN_EDGE_MST_PTR>* GetUnconnected() const
+    const std::vector<RN_EDGE>* GetUnconnected() const
     {
-        return m_rnEdges.get();
+        return &m_rnEdges;
     }
 
     /**
@@ -451,7 +648,7 @@ public:
      * @param aItem is an item for which the list is generated.
      * @return List of associated nodes.
      */
-    std::list<RN_NODE_PTR> GetNodes( const BOARD_CONNECTED_ITEM* aItem ) const;
+    std::vector<RN_NODE_ID> GetNodes( const BOARD_CONNECTED_ITEM* aItem ) const;
 
     /**
      * Function GetAllItems()
@@ -465,8 +662,9 @@ public:
      * Function GetClosestNode()
      * Returns a single node that lies in the shortest distance from a specific node.
      * @param aNode is the node for which the closest node is searched.
+     * @return The closest node or RN_INVALID_ID if there is none.
      */
-    const RN_NODE_PTR GetClosestNode( const RN_NODE_PTR& aNode ) const;
+    RN_NODE_ID GetClosestNode( RN_NODE_ID aNode ) const;
 
     /**
      * Function GetClosestNode()
@@ -474,9 +672,9 @@ public:
      * selected filter criterion..
      * @param aNode is the node for which the closest node is searched.
      * @param aFilter is a functor that filters nodes.
+     * @return The closest node or RN_INVALID_ID if there is none.
      */
-    const RN_NODE_PTR GetClosestNode( const RN_NODE_PTR& aNode,
-                                      const RN_NODE_FILTER& aFilter ) const;
+    RN_NODE_ID GetClosestNode( RN_NODE_ID aNode, const RN_NODE_FILTER& aFilter ) const;
 
     /**
      * Function GetClosestNodes()
@@ -486,7 +684,7 @@ public:
      * belong to the same net are returned. If asked number is greater than number of possible
      * nodes then the size of list is limited to number of possible nodes.
      */
-    std::list<RN_NODE_PTR> GetClosestNodes( const RN_NODE_PTR& aNode, int aNumber = -1 ) const;
+    std::vector<RN_NODE_ID> GetClosestNodes( RN_NODE_ID aNode, int aNumber = -1 ) const;
 
     /**
      * Function GetClosestNodes()
@@ -497,8 +695,8 @@ public:
      * belong to the same net are returned. If asked number is greater than number of possible
      * nodes then the size of list is limited to number of possible nodes.
      */
-    std::list<RN_NODE_PTR> GetClosestNodes( const RN_NODE_PTR& aNode,
-                                            const RN_NODE_FILTER& aFilter, int aNumber = -1 ) const;
+    std::vector<RN_NODE_ID> GetClosestNodes( RN_NODE_ID aNode, const RN_NODE_FILTER& aFilter,
+                                             int aNumber = -1 ) const;
 
     /**
      * Function AddSimple()
@@ -513,10 +711,10 @@ public:
      * target the node). The status is cleared after calling ClearSimple().
      * @param aNode is the node that is not going to be used as a ratsnest line target.
      */
-    inline void AddBlockedNode( RN_NODE_PTR& aNode )
+    inline void AddBlockedNode( RN_NODE_ID aNode )
     {
         m_blockedNodes.insert( aNode );
-        aNode->SetFlag( true );
+        m_links.GetNode( aNode ).SetFlag( true );
     }
 
     /**
@@ -525,7 +723,7 @@ public:
      * ratsnest line per node).
      * @return list of nodes for which ratsnest is drawn in simple mode.
      */
-    inline const std::unordered_set<RN_NODE_PTR>& GetSimpleNodes() const
+    inline const std::unordered_set<RN_NODE_ID>& GetSimpleNodes() const
     {
         return m_simpleNodes;
     }
@@ -550,18 +748,33 @@ public:
 protected:
     ///> Validates edge, i.e. modifies source and target nodes for an edge
     ///> to make sure that they are not ones with the flag set.
-    void validateEdge( RN_EDGE_MST_PTR& aEdge );
+    void validateEdge( RN_EDGE& aEdge );
+
+    ///> Returns the closest node without the flag set, other than aNode and aExcluded.
+    RN_NODE_ID closestUnflaggedNode( RN_NODE_ID aNode, RN_NODE_ID aExcluded ) const;
 
     ///> Removes a link between a node and a parent,
     ///> and clears linked edges if it was the last parent.
-    void removeNode( RN_NODE_PTR& aNode, const BOARD_CONNECTED_ITEM* aParent );
+    void removeNode( RN_NODE_ID aNode, const BOARD_CONNECTED_ITEM* aParent );
 
     ///> Removes a link between an edge and a parent,
     ///> and clears its node data if it was the last parent.
-    void removeEdge( RN_EDGE_MST_PTR& aEdge, const BOARD_CONNECTED_ITEM* aParent );
+    void removeEdge( RN_EDGE_ID aEdge, const BOARD_CONNECTED_ITEM* aParent );
+
+    ///> Removes helper connections (made by zones or pads) from the links.
+    void removeHelperEdges( std::vector<RN_EDGE_ID>& aEdges );
+
+    ///> Frees a node if it is not referenced anymore, together with its ratsnest edges.
+    void releaseNode( RN_NODE_ID aNode );
 
     ///> Removes all ratsnest edges for a given node.
-    void clearNode( const RN_NODE_PTR& aNode );
+    void clearNode( RN_NODE_ID aNode );
+
+    ///> Returns handles of all nodes in use.
+    void getUsedNodes( std::vector<RN_NODE_ID>& aNodes ) const;
+
+    ///> Returns handles of all nodes in use, sorted by their x coordinate.
+    void getNodesSortedByX( std::vector<RN_NODE_ID>& aNodes ) const;
 
     ///> Adds appropriate edges for nodes that are connected by zones.
     void processZones();
@@ -569,20 +782,37 @@ protected:
     ///> Adds additional edges to account for connections made by items located in pads areas.
     void processPads();
 
-    ///> Recomputes ratsnset from scratch.
+    ///> Recomputes ratsnset, locally if only a few nodes have changed since the last run.
     void compute();
 
+    ///> Rebuilds the ratsnest candidate edges from the Delaunay triangulation of aNodes.
+    void triangulate( const std::vector<RN_NODE_ID>& aNodes );
+
+    ///> Updates the candidate edges around the nodes changed since the last run.
+    void updateCandidates();
+
+    ///> Computes the minimal spanning tree out of the connections and the candidate edges.
+    ///> @return false if the candidate edges do not connect all the nodes.
+    bool computeMST( const std::vector<RN_NODE_ID>& aNodes );
+
     ////> Stores information about connections for a given net.
     RN_LINKS m_links;
 
     ///> Vector of edges that makes ratsnest for a given net.
-    std::shared_ptr< std::vector<RN_EDGE_MST_PTR> > m_rnEdges;
+    std::vector<RN_EDGE> m_rnEdges;
+
+    ///> Edges that may become ratsnest lines (initially the Delaunay triangulation of the nodes),
+    ///> sorted by weight. They are updated locally when only a few nodes change.
+    std::vector<RN_EDGE> m_candidates;
+
+    ///> Number of nodes changed by local updates since the last triangulation.
+    unsigned int m_changedSinceRebuild;
 
     ///> List of nodes which will not be used as ratsnest target nodes.
-    std::unordered_set<RN_NODE_PTR> m_blockedNodes;
+    std::unordered_set<RN_NODE_ID> m_blockedNodes;
 
     ///> Nodes to be displayed using the simplified ratsnest algorithm.
-    std::unordered_set<RN_NODE_PTR> m_simpleNodes;
+    std::unordered_set<RN_NODE_ID> m_simpleNodes;
 
     ///> Flag indicating necessity of recalculation of ratsnest for a net.
     bool m_dirty;
@@ -594,23 +824,23 @@ protected:
         std::deque<RN_POLY> m_Polygons;
 
         ///> Connections to other nodes
-        std::deque<RN_EDGE_MST_PTR> m_Edges;
+        std::vector<RN_EDGE_ID> m_Edges;
     } RN_ZONE_DATA;
 
     ///> Structureo to hold ratsnest data for D_PAD objects.
     typedef struct
     {
         ///> Node representing the pad.
-        RN_NODE_PTR m_Node;
+        RN_NODE_ID m_Node;
 
         ///> Helper nodes that make for connections to items located in the pad area.
-        std::deque<RN_EDGE_MST_PTR> m_Edges;
+        std::vector<RN_EDGE_ID> m_Edges;
     } RN_PAD_DATA;
 
     ///> Helper typedefs
     typedef std::unordered_map<const D_PAD*, RN_PAD_DATA> PAD_NODE_MAP;
-    typedef std::unordered_map<const VIA*, RN_NODE_PTR> VIA_NODE_MAP;
-    typedef std::unordered_map<const TRACK*, RN_EDGE_MST_PTR> TRACK_EDGE_MAP;
+    typedef std::unordered_map<const VIA*, RN_NODE_ID> VIA_NODE_MAP;
+    typedef std::unordered_map<const TRACK*, RN_EDGE_ID> TRACK_EDGE_MAP;
     typedef std::unordered_map<const ZONE_CONTAINER*, RN_ZONE_DATA> ZONE_DATA_MAP;
 
     ///> Map that associates nodes in the ratsnest model to respective nodes.
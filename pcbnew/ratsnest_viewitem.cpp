@@ -72,18 +72,21 @@ void RATSNEST_VIEWITEM::ViewDraw( int aLayer, GAL* aGal ) const
         aGal->SetStrokeColor( color.Brightened( 0.8 ) );
 
         // Draw the "dynamic" ratsnest (i.e. for objects that may be currently being moved)
-        for( const RN_NODE_PTR& node : net.GetSimpleNodes() )
+        for( RN_NODE_ID nodeId : net.GetSimpleNodes() )
         {
+            const RN_NODE& node = net.GetNode( nodeId );
+
             // Skipping nodes with higher reference count avoids displaying redundant lines
-            if( node->GetRefCount() > 1 )
+            if( node.GetRefCount() > 1 )
                 continue;
 
-            RN_NODE_PTR dest = net.GetClosestNode( node, WITHOUT_FLAG() );
+            RN_NODE_ID destId = net.GetClosestNode( nodeId, WITHOUT_FLAG() );
 
-            if( dest )
+            if( destId != RN_INVALID_ID )
             {
-                VECTOR2D origin( node->GetX(), node->GetY() );
-                VECTOR2D end( dest->GetX(), dest->GetY() );
+                const RN_NODE& dest = net.GetNode( destId );
+                VECTOR2D origin( node.GetX(), node.GetY() );
+                VECTOR2D end( dest.GetX(), dest.GetY() );
 
                 aGal->DrawLine( origin, end );
             }
@@ -93,17 +96,17 @@ void RATSNEST_VIEWITEM::ViewDraw( int aLayer, GAL* aGal ) const
         if( i != highlightedNet )
             aGal->SetStrokeColor( color );  // using the default ratsnest color for not highlighted
 
-        const std::vector<RN_EDGE_MST_PTR>* edges = net.GetUnconnected();
+        const std::vector<RN_EDGE>* edges = net.GetUnconnected();
 
         if( edges == NULL )
             continue;
 
-        for( const RN_EDGE_MST_PTR& edge : *edges )
+        for( const RN_EDGE& edge : *edges )
         {
-            const RN_NODE_PTR& sourceNode = edge->GetSourceNode();
-            const RN_NODE_PTR& targetNode = edge->GetTargetNode();
-            VECTOR2D source( sourceNode->GetX(), sourceNode->GetY() );
-            VECTOR2D target( targetNode->GetX(), targetNode->GetY() );
+            const RN_NODE& sourceNode = net.GetNode( edge.GetSourceNode() );
+            const RN_NODE& targetNode = net.GetNode( edge.GetTargetNode() );
+            VECTOR2D source( sourceNode.GetX(), sourceNode.GetY() );
+            VECTOR2D target( targetNode.GetX(), targetNode.GetY() );
 
             aGal->DrawLine( source, target );
         }
@@ -0,0 +1,461 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
+#include <map>
+#include <set>
+#include <algorithm>
+
+#include <profile.h>
+#include <convert_to_biu.h>
+
+#include <class_board.h>
+#include <ratsnest_data.h>
+
+#include "pns_batch_router.h"
+#include "pns_router.h"
+#include "pns_node.h"
+#include "pns_placement_algo.h"
+#include "pns_sizes_settings.h"
+#include "pns_pool.h"
+
+// number of Move() calls made before giving up a connection the placer can't complete
+static const int MAX_MOVE_STEPS = 8;
+
+
+PNS_BATCH_ROUTER::PNS_BATCH_ROUTER( BOARD* aBoard ) :
+    m_board( aBoard )
+{
+    m_threadCount = 0;
+    m_regionMargin = Millimeter2iu( 2.0 );
+
+    m_failedCount = 0;
+    m_retriedNetCount = 0;
+    m_routingTime = 0.0;
+
+    m_settings.SetMode( RM_Walkaround );
+}
+
+
+PNS_BATCH_ROUTER::~PNS_BATCH_ROUTER()
+{
+    // the board items removed by Route() calls are owned by the undo buffer,
+    // unless someone took them with GetUndoBuffer()
+    m_undoBuffer.ClearListAndDeleteItems();
+}
+
+
+void PNS_BATCH_ROUTER::AddConnection( int aNet, const wxPoint& aStart, const wxPoint& aEnd,
+                                      int aLayer )
+{
+    CONNECTION conn;
+
+    conn.m_net = aNet;
+    conn.m_start = VECTOR2I( aStart.x, aStart.y );
+    conn.m_end = VECTOR2I( aEnd.x, aEnd.y );
+    conn.m_layer = aLayer;
+    conn.m_routed = false;
+
+    m_connections.push_back( conn );
+}
+
+
+int PNS_BATCH_ROUTER::AddRatsnestConnections( int aNet )
+{
+    RN_DATA* ratsnest = m_board->GetRatsnest();
+    int count = 0;
+
+    // boards loaded by scripts have no ratsnest yet
+    if( ratsnest->GetNetCount() == 0 )
+        ratsnest->ProcessBoard();
+    else
+        ratsnest->Recalculate();
+
+    for( int net = 1; net < ratsnest->GetNetCount(); net++ )
+    {
+        if( aNet >= 0 && net != aNet )
+            continue;
+
+        const RN_NET& rnNet = ratsnest->GetNet( net );
+
+        for( const RN_EDGE& edge : *rnNet.GetUnconnected() )
+        {
+            const RN_NODE& source = rnNet.GetNode( edge.GetSourceNode() );
+            const RN_NODE& target = rnNet.GetNode( edge.GetTargetNode() );
+            LSET common = source.GetLayers() & target.GetLayers();
+            int layer = -1;
+
+            for( int i = 0; i < MAX_CU_LAYERS; i++ )
+            {
+                if( common[i] )
+                {
+                    layer = i;
+                    break;
+                }
+            }
+
+            AddConnection( net, wxPoint( source.GetX(), source.GetY() ),
+                           wxPoint( target.GetX(), target.GetY() ), layer );
+            count++;
+        }
+    }
+
+    return count;
+}
+
+
+void PNS_BATCH_ROUTER::ClearConnections()
+{
+    m_connections.clear();
+}
+
+
+int PNS_BATCH_ROUTER::Route()
+{
+    prof_counter totalTime;
+    std::vector<NET_JOB> jobs;
+
+    prof_start( &totalTime );
+
+    buildJobs( jobs );
+
+    int threads = 1;
+
+#ifdef USE_OPENMP
+    threads = m_threadCount > 0 ? m_threadCount : omp_get_max_threads();
+#endif
+
+    std::vector<int> retry;
+
+    if( threads == 1 )
+    {
+        std::vector<int> all;
+
+        for( unsigned i = 0; i < jobs.size(); i++ )
+            all.push_back( i );
+
+        routeJobs( jobs, all, 1, false, retry );
+    }
+    else
+    {
+        // split the nets in waves, so that the regions of the nets of a wave never overlap
+        std::vector< std::vector<int> > waves;
+
+        for( unsigned i = 0; i < jobs.size(); i++ )
+        {
+            unsigned w;
+
+            for( w = 0; w < waves.size(); w++ )
+            {
+                bool overlaps = false;
+
+                for( int j : waves[w] )
+                {
+                    if( jobs[j].m_region.Intersects( jobs[i].m_region ) )
+                    {
+                        overlaps = true;
+                        break;
+                    }
+                }
+
+                if( !overlaps )
+                    break;
+            }
+
+            if( w == waves.size() )
+                waves.push_back( std::vector<int>() );
+
+            waves[w].push_back( i );
+        }
+
+        for( const std::vector<int>& wave : waves )
+            routeJobs( jobs, wave, threads, true, retry );
+    }
+
+    m_retriedNetCount = retry.size();
+
+    // nets whose tracks left their region: route them again, one after the other, on the
+    // board updated with all the other nets
+    if( !retry.empty() )
+    {
+        std::vector<int> unused;
+
+        std::sort( retry.begin(), retry.end() );
+        routeJobs( jobs, retry, 1, false, unused );
+    }
+
+    m_board->GetRatsnest()->Recalculate();
+
+    int routed = 0;
+
+    m_failedCount = 0;
+
+    for( const NET_JOB& job : jobs )
+    {
+        for( int c : job.m_connections )
+        {
+            if( m_connections[c].m_routed )
+                routed++;
+            else
+                m_failedCount++;
+        }
+    }
+
+    prof_end( &totalTime );
+    m_routingTime = totalTime.msecs();
+
+    return routed;
+}
+
+
+void PNS_BATCH_ROUTER::buildJobs( std::vector<NET_JOB>& aJobs ) const
+{
+    std::map<int, int> netJobs;
+
+    for( unsigned i = 0; i < m_connections.size(); i++ )
+    {
+        const CONNECTION& conn = m_connections[i];
+
+        if( conn.m_routed )
+            continue;
+
+        BOX2I bbox( conn.m_start, conn.m_end - conn.m_start );
+        std::map<int, int>::iterator it = netJobs.find( conn.m_net );
+
+        bbox.Normalize();
+
+        if( it == netJobs.end() )
+        {
+            NET_JOB job;
+
+            job.m_net = conn.m_net;
+            job.m_region = bbox;
+            netJobs[conn.m_net] = aJobs.size();
+            aJobs.push_back( job );
+            it = netJobs.find( conn.m_net );
+        }
+
+        NET_JOB& job = aJobs[it->second];
+
+        job.m_region.Merge( bbox );
+        job.m_connections.push_back( i );
+    }
+
+    for( NET_JOB& job : aJobs )
+        job.m_region.Inflate( m_regionMargin );
+}
+
+
+/**
+ * Function insideRegion()
+ * Checks if the items of net aNet added by the router (i.e. not on the board yet) keep
+ * at least aClearance away from the border of aRegion.
+ */
+static bool insideRegion( PNS_NODE* aWorld, int aNet, const BOX2I& aRegion, int aClearance )
+{
+    std::set<PNS_ITEM*> items;
+
+    aWorld->AllItemsInNet( aNet, items );
+
+    for( PNS_ITEM* item : items )
+    {
+        if( item->Parent() || !item->Shape() )
+            continue;
+
+        if( !aRegion.Contains( item->Shape()->BBox( aClearance ) ) )
+            return false;
+    }
+
+    return true;
+}
+
+
+void PNS_BATCH_ROUTER::routeJobs( const std::vector<NET_JOB>& aJobs,
+                                  const std::vector<int>& aIndices, int aThreads,
+                                  bool aCheckRegions, std::vector<int>& aRetry )
+{
+    int clearance = m_board->GetDesignSettings().GetBiggestClearanceValue();
+    std::vector<int> escaped( aIndices.size(), 0 );
+
+    aThreads = std::max( 1, std::min<int>( aThreads, aIndices.size() ) );
+
+#ifdef USE_OPENMP
+    #pragma omp parallel num_threads( aThreads )
+#endif
+    {
+#ifdef USE_OPENMP
+        int thread = omp_get_thread_num();
+        int threadCount = omp_get_num_threads();
+#else
+        int thread = 0;
+        int threadCount = 1;
+#endif
+
+        {
+            // every thread routes in its own world. The board is only read until all the
+            // threads are done, the routers keep their changes until then.
+            PNS_ROUTER router;
+
+            router.SetBoard( m_board );
+            router.SyncWorld();
+            router.LoadSettings( m_settings );
+            router.SetDeferredCommit( true );
+
+            for( unsigned i = thread; i < aIndices.size(); i += threadCount )
+            {
+                const NET_JOB& job = aJobs[aIndices[i]];
+                int firstCommit = router.PendingCommitCount();
+
+                for( int c : job.m_connections )
+                    m_connections[c].m_routed = routeConnection( router, m_connections[c] );
+
+                // the tracks may conflict with the ones of the nets routed by other threads
+                if( aCheckRegions &&
+                    !insideRegion( router.GetWorld(), job.m_net, job.m_region, clearance ) )
+                {
+                    router.DiscardCommits( firstCommit );
+                    escaped[i] = 1;
+
+                    for( int c : job.m_connections )
+                        m_connections[c].m_routed = false;
+                }
+            }
+
+#ifdef USE_OPENMP
+            #pragma omp barrier
+#endif
+
+            // write the changes to the board, one thread after the other
+            for( int t = 0; t < threadCount; t++ )
+            {
+                if( t == thread )
+                {
+                    router.FlushCommits();
+
+                    const PICKED_ITEMS_LIST& changes = router.GetUndoBuffer();
+
+                    for( unsigned i = 0; i < changes.GetCount(); i++ )
+                        m_undoBuffer.PushItem( changes.GetItemWrapper( i ) );
+
+                    router.ClearUndoBuffer();
+                }
+
+#ifdef USE_OPENMP
+                #pragma omp barrier
+#endif
+            }
+        }
+
+        // the thread's router is gone: give the memory it pooled back
+        PNS_POOL::ReleaseMemory();
+    }
+
+    for( unsigned i = 0; i < aIndices.size(); i++ )
+    {
+        if( escaped[i] )
+            aRetry.push_back( aIndices[i] );
+    }
+}
+
+
+PNS_ITEM* PNS_BATCH_ROUTER::pickItem( PNS_ROUTER& aRouter, const VECTOR2I& aWhere, int aNet,
+                                      int aLayer ) const
+{
+    PNS_ITEM* rv = NULL;
+    PNS_ITEMSET candidates = aRouter.QueryHoverItems( aWhere );
+
+    // pads and vias are preferred to tracks, as in the interactive router
+    for( PNS_ITEM* item : candidates.Items() )
+    {
+        if( item->Net() != aNet || !IsCopperLayer( item->Layers().Start() ) )
+            continue;
+
+        if( aLayer >= 0 && !item->Layers().Overlaps( aLayer ) )
+            continue;
+
+        if( item->OfKind( PNS_ITEM::VIA | PNS_ITEM::SOLID ) )
+            return item;
+
+        if( !rv )
+            rv = item;
+    }
+
+    return rv;
+}
+
+
+bool PNS_BATCH_ROUTER::routeConnection( PNS_ROUTER& aRouter, CONNECTION& aConn )
+{
+    int layer = aConn.m_layer;
+    PNS_ITEM* startItem = pickItem( aRouter, aConn.m_start, aConn.m_net, layer );
+    PNS_ITEM* endItem = pickItem( aRouter, aConn.m_end, aConn.m_net, layer );
+
+    if( !startItem || !endItem )
+        return false;
+
+    if( layer < 0 )
+    {
+        const PNS_LAYERSET& layers = startItem->Layers();
+
+        for( int i = layers.Start(); i <= layers.End(); i++ )
+        {
+            if( endItem->Layers().Overlaps( i ) )
+            {
+                layer = i;
+                break;
+            }
+        }
+
+        if( layer < 0 )
+            return false;
+    }
+
+    bool splitsSegment;
+    VECTOR2I start = aRouter.SnapToItem( startItem, aConn.m_start, splitsSegment );
+    VECTOR2I end = aRouter.SnapToItem( endItem, aConn.m_end, splitsSegment );
+
+    PNS_SIZES_SETTINGS sizes( aRouter.Sizes() );
+    sizes.Init( m_board, startItem, aConn.m_net );
+    aRouter.UpdateSizes( sizes );
+
+    if( !aRouter.StartRouting( start, startItem, layer ) )
+        return false;
+
+    // every move brings the head closer to the end point, until it gets there or is blocked
+    for( int i = 0; i < MAX_MOVE_STEPS; i++ )
+    {
+        VECTOR2I prevEnd = aRouter.Placer()->CurrentEnd();
+
+        aRouter.Move( end, endItem );
+
+        if( aRouter.Placer()->CurrentEnd() == end || aRouter.Placer()->CurrentEnd() == prevEnd )
+            break;
+    }
+
+    if( aRouter.Placer()->CurrentEnd() != end || !aRouter.FixRoute( end, endItem ) )
+    {
+        aRouter.StopRouting();
+        return false;
+    }
+
+    return true;
+}
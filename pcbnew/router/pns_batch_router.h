@@ -0,0 +1,199 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_BATCH_ROUTER_H
+#define __PNS_BATCH_ROUTER_H
+
+#include <vector>
+
+#include <math/vector2d.h>
+#include <math/box2.h>
+#include <class_undoredo_container.h>
+
+#include "pns_routing_settings.h"
+
+class BOARD;
+class PNS_ROUTER;
+class PNS_ITEM;
+
+/**
+ * Class PNS_BATCH_ROUTER
+ *
+ * Routes a list of connections of a board without any user interaction nor view, by
+ * driving the line placer of the router from the start to the end point of each
+ * connection. Used for scripted routing of repetitive channels and for benchmarking
+ * the router.
+ *
+ * Connections are grouped by net, and every net gets a region: the bounding box of its
+ * connections, inflated by a margin. Nets with disjoint regions are routed in parallel
+ * by routers working on their own world, the results are written to the board by
+ * a single thread. A net whose tracks leave its region is routed again after the
+ * parallel pass, on the updated board. With a given number of threads, the results
+ * don't depend on the thread scheduling.
+ */
+class PNS_BATCH_ROUTER
+{
+public:
+    PNS_BATCH_ROUTER( BOARD* aBoard );
+    ~PNS_BATCH_ROUTER();
+
+    /**
+     * Function AddConnection()
+     * Adds a connection to be routed.
+     * @param aNet is the net code of the connection.
+     * @param aStart is the start point, lying on an item of the net (pad, via or track).
+     * @param aEnd is the end point, lying on an item of the net.
+     * @param aLayer is the layer to route on, -1 to use the first layer common to
+     * the start and end items.
+     */
+    void AddConnection( int aNet, const wxPoint& aStart, const wxPoint& aEnd, int aLayer = -1 );
+
+    /**
+     * Function AddRatsnestConnections()
+     * Adds the missing connections of the board ratsnest.
+     * @param aNet is the net code of the connections to add, -1 for all nets.
+     * @return the number of added connections.
+     */
+    int AddRatsnestConnections( int aNet = -1 );
+
+    void ClearConnections();
+
+    int GetConnectionCount() const
+    {
+        return m_connections.size();
+    }
+
+    ///> Returns true if the aIndex-th connection has been routed
+    bool IsRouted( int aIndex ) const
+    {
+        return m_connections[aIndex].m_routed;
+    }
+
+    /**
+     * Function Route()
+     * Routes all connections which are not routed yet and writes the new tracks to the board.
+     * @return the number of routed connections.
+     */
+    int Route();
+
+    ///> Sets the number of worker threads, 0 to use all available processors
+    void SetThreadCount( int aThreads )
+    {
+        m_threadCount = aThreads;
+    }
+
+    int GetThreadCount() const
+    {
+        return m_threadCount;
+    }
+
+    ///> Sets the distance between the connections of a net and the border of its region
+    void SetRegionMargin( int aMargin )
+    {
+        m_regionMargin = aMargin;
+    }
+
+    int GetRegionMargin() const
+    {
+        return m_regionMargin;
+    }
+
+    ///> Returns the number of connections the last Route() call failed to route
+    int GetFailedCount() const
+    {
+        return m_failedCount;
+    }
+
+    ///> Returns the number of nets of the last Route() call that had to be routed again
+    ///> after the parallel pass
+    int GetRetriedNetCount() const
+    {
+        return m_retriedNetCount;
+    }
+
+    ///> Returns the duration of the last Route() call, in milliseconds
+    double GetRoutingTime() const
+    {
+        return m_routingTime;
+    }
+
+#ifndef SWIG
+    PNS_ROUTING_SETTINGS& Settings()
+    {
+        return m_settings;
+    }
+
+    /**
+     * Returns the changes made to the board by Route() calls, to be stored in the undo buffer.
+     * The board items removed by Route() are owned by this list and deleted with the batch
+     * router: call ClearUndoBuffer() after taking them.
+     */
+    const PICKED_ITEMS_LIST& GetUndoBuffer() const
+    {
+        return m_undoBuffer;
+    }
+
+    void ClearUndoBuffer()
+    {
+        m_undoBuffer.ClearItemsList();
+    }
+#endif
+
+private:
+    struct CONNECTION
+    {
+        int m_net;
+        VECTOR2I m_start;
+        VECTOR2I m_end;
+        int m_layer;
+        bool m_routed;
+    };
+
+    ///> Connections of a net, routed by a single router
+    struct NET_JOB
+    {
+        int m_net;
+        BOX2I m_region;
+        std::vector<int> m_connections;    ///< indices in m_connections
+    };
+
+    void buildJobs( std::vector<NET_JOB>& aJobs ) const;
+
+    void routeJobs( const std::vector<NET_JOB>& aJobs, const std::vector<int>& aIndices,
+                    int aThreads, bool aCheckRegions, std::vector<int>& aRetry );
+
+    bool routeConnection( PNS_ROUTER& aRouter, CONNECTION& aConn );
+
+    PNS_ITEM* pickItem( PNS_ROUTER& aRouter, const VECTOR2I& aWhere, int aNet, int aLayer ) const;
+
+    BOARD* m_board;
+    std::vector<CONNECTION> m_connections;
+    PNS_ROUTING_SETTINGS m_settings;
+    PICKED_ITEMS_LIST m_undoBuffer;
+
+    int m_threadCount;
+    int m_regionMargin;
+
+    ///> statistics of the last Route() call
+    int m_failedCount;
+    int m_retriedNetCount;
+    double m_routingTime;
+};
+
+#endif    // __PNS_BATCH_ROUTER_H
@@ -454,12 +454,14 @@ OPT_VECTOR2I PNS_DIFF_PAIR_PLACER::getDanglingAnchor( PNS_NODE* aNode, PNS_ITEM*
     {
         PNS_SEGMENT* s =static_cast<PNS_SEGMENT*>( aItem );
 
-        PNS_JOINT* jA = aNode->FindJoint( s->Seg().A, s );
-        PNS_JOINT* jB = aNode->FindJoint( s->Seg().B, s );
+        VECTOR2I ends[2] = { s->Seg().A, s->Seg().B };
+        PNS_JOINT* joints[2];
 
-        if( jA->LinkCount() == 1 )
+        aNode->FindJoints( ends, 2, s->Layers().Start(), s->Net(), joints );
+
+        if( joints[0]->LinkCount() == 1 )
             return s->Seg().A;
-        else if( jB->LinkCount() == 1 )
+        else if( joints[1]->LinkCount() == 1 )
             return s->Seg().B;
         else
             return OPT_VECTOR2I();
@@ -26,7 +26,8 @@
 
 #include <boost/range/adaptor/map.hpp>
 
-#include <list>
+#include <vector>
+#include <algorithm>
 #include <unordered_set>
 #include <geometry/shape_index.h>
 
@@ -42,7 +43,7 @@
 class PNS_INDEX
 {
 public:
-    typedef std::list<PNS_ITEM*>            NET_ITEMS_LIST;
+    typedef std::vector<PNS_ITEM*>          NET_ITEMS_LIST;
     typedef SHAPE_INDEX<PNS_ITEM*>          ITEM_SHAPE_INDEX;
     typedef std::unordered_set<PNS_ITEM*> ITEM_SET;
 
@@ -223,8 +224,23 @@ void PNS_INDEX::Remove( PNS_ITEM* aItem )
 
     int net = aItem->Net();
 
-    if( net >= 0 && m_netMap.find( net ) != m_netMap.end() )
-        m_netMap[net].remove( aItem );
+    if( net < 0 )
+        return;
+
+    std::map<int, NET_ITEMS_LIST>::iterator l = m_netMap.find( net );
+
+    if( l == m_netMap.end() )
+        return;
+
+    // the order of the items of a net does not matter: fill the gap with the last item
+    NET_ITEMS_LIST& items = l->second;
+    NET_ITEMS_LIST::iterator i = std::find( items.begin(), items.end(), aItem );
+
+    if( i != items.end() )
+    {
+        *i = items.back();
+        items.pop_back();
+    }
 }
 
 void PNS_INDEX::Replace( PNS_ITEM* aOldItem, PNS_ITEM* aNewItem )
@@ -306,10 +322,12 @@ PNS_INDEX::~PNS_INDEX()
 
 PNS_INDEX::NET_ITEMS_LIST* PNS_INDEX::GetItemsForNet( int aNet )
 {
-    if( m_netMap.find( aNet ) == m_netMap.end() )
+    std::map<int, NET_ITEMS_LIST>::iterator l = m_netMap.find( aNet );
+
+    if( l == m_netMap.end() )
         return NULL;
 
-    return &m_netMap[aNet];
+    return &l->second;
 }
 
 #endif
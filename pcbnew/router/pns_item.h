@@ -29,6 +29,7 @@
 #include "trace.h"
 
 #include "pns_layerset.h"
+#include "pns_pool.h"
 
 class BOARD_CONNECTED_ITEM;
 class PNS_NODE;
@@ -89,6 +90,9 @@ public:
 
     virtual ~PNS_ITEM();
 
+    ///> items are allocated from the router memory pool
+    PNS_POOLED_ALLOCATION
+
     /**
      * Function Clone()
      *
@@ -0,0 +1,198 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+
+#include "pns_joint_map.h"
+
+// slots allocated by the first insertion
+static const int INITIAL_SLOTS = 64;
+
+
+PNS_JOINT_MAP::PNS_JOINT_MAP() :
+    m_mask( 0 ),
+    m_count( 0 )
+{
+}
+
+
+int PNS_JOINT_MAP::findSlot( const TAG& aTag, uint32_t aHash, const PNS_LAYERSET* aLayers ) const
+{
+    if( m_slots.empty() )
+        return -1;
+
+    for( uint32_t i = aHash & m_mask; ; i = ( i + 1 ) & m_mask )
+    {
+        const SLOT& slot = m_slots[i];
+
+        if( slot.m_index < 0 )
+            return -1;
+
+        if( slot.m_hash != aHash )
+            continue;
+
+        const PNS_JOINT& jt = m_joints[slot.m_index];
+
+        if( jt.Tag() == aTag && ( !aLayers || jt.Layers().Overlaps( *aLayers ) ) )
+            return i;
+    }
+}
+
+
+int PNS_JOINT_MAP::FindAll( const TAG& aTag, uint32_t aHash, std::vector<PNS_JOINT*>& aJoints )
+{
+    int n = 0;
+
+    if( m_slots.empty() )
+        return 0;
+
+    for( uint32_t i = aHash & m_mask; m_slots[i].m_index >= 0; i = ( i + 1 ) & m_mask )
+    {
+        const SLOT& slot = m_slots[i];
+
+        if( slot.m_hash == aHash && m_joints[slot.m_index].Tag() == aTag )
+        {
+            aJoints.push_back( &m_joints[slot.m_index] );
+            n++;
+        }
+    }
+
+    return n;
+}
+
+
+void PNS_JOINT_MAP::grow()
+{
+    std::vector<SLOT> old;
+
+    old.swap( m_slots );
+
+    SLOT empty;
+    empty.m_hash = 0;
+    empty.m_index = -1;
+
+    m_slots.resize( old.empty() ? INITIAL_SLOTS : old.size() * 2, empty );
+    m_mask = m_slots.size() - 1;
+
+    for( unsigned i = 0; i < old.size(); i++ )
+    {
+        if( old[i].m_index < 0 )
+            continue;
+
+        uint32_t j = old[i].m_hash & m_mask;
+
+        while( m_slots[j].m_index >= 0 )
+            j = ( j + 1 ) & m_mask;
+
+        m_slots[j] = old[i];
+    }
+}
+
+
+PNS_JOINT& PNS_JOINT_MAP::Insert( const PNS_JOINT& aJoint )
+{
+    // keep the load factor under 1/2: probe sequences stay short even with
+    // several joints at the same position
+    if( ( m_count + 1 ) * 2 > (int) m_slots.size() )
+        grow();
+
+    int index;
+
+    if( m_freeJoints.empty() )
+    {
+        index = m_joints.size();
+        m_joints.push_back( aJoint );
+    }
+    else
+    {
+        index = m_freeJoints.back();
+        m_freeJoints.pop_back();
+        m_joints[index] = aJoint;
+    }
+
+    uint32_t hash = Hash( aJoint.Tag() );
+    uint32_t i = hash & m_mask;
+
+    while( m_slots[i].m_index >= 0 )
+        i = ( i + 1 ) & m_mask;
+
+    m_slots[i].m_hash = hash;
+    m_slots[i].m_index = index;
+    m_count++;
+
+    return m_joints[index];
+}
+
+
+void PNS_JOINT_MAP::Erase( PNS_JOINT* aJoint )
+{
+    uint32_t hash = Hash( aJoint->Tag() );
+    uint32_t i = hash & m_mask;
+
+    assert( !m_slots.empty() );
+
+    while( &m_joints[m_slots[i].m_index] != aJoint )
+    {
+        i = ( i + 1 ) & m_mask;
+        assert( m_slots[i].m_index >= 0 );
+    }
+
+    int index = m_slots[i].m_index;
+
+    // release the links, keep the entry for the next insertion
+    m_joints[index] = PNS_JOINT();
+    m_freeJoints.push_back( index );
+    m_count--;
+
+    // shift back the following slots of the cluster which can't be reached anymore
+    // from their home slot through the emptied slot
+    uint32_t j = i;
+
+    for( ;; )
+    {
+        j = ( j + 1 ) & m_mask;
+
+        if( m_slots[j].m_index < 0 )
+            break;
+
+        uint32_t home = m_slots[j].m_hash & m_mask;
+
+        // can the slot j stay where it is, i.e. is its home in the cyclic range (i, j] ?
+        bool stays = ( i <= j ) ? ( i < home && home <= j ) : ( i < home || home <= j );
+
+        if( !stays )
+        {
+            m_slots[i] = m_slots[j];
+            i = j;
+        }
+    }
+
+    m_slots[i].m_hash = 0;
+    m_slots[i].m_index = -1;
+}
+
+
+void PNS_JOINT_MAP::Clear()
+{
+    m_slots.clear();
+    m_mask = 0;
+    m_count = 0;
+    m_joints.clear();
+    m_freeJoints.clear();
+}
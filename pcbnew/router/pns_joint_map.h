@@ -0,0 +1,187 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_JOINT_MAP_H
+#define __PNS_JOINT_MAP_H
+
+#include <stdint.h>
+#include <vector>
+#include <deque>
+
+#include "pns_joint.h"
+
+/**
+ * Class PNS_JOINT_MAP
+ *
+ * Hash table of the joints of a PNS_NODE, keyed by position and net. Several joints
+ * (spanning different layers) may share the same key.
+ *
+ * The table uses open addressing with linear probing: a lookup reads a few adjacent
+ * slots, each holding the hash of the key and the index of the joint, and compares the
+ * layers of the joints with the same key in place. Joints themselves are stored in
+ * blocks that never move, so pointers to a joint stay valid until it is erased.
+ **/
+class PNS_JOINT_MAP
+{
+public:
+    typedef PNS_JOINT::HASH_TAG TAG;
+
+    PNS_JOINT_MAP();
+
+    ///> Returns the hash of a joint key, to be passed to the other methods
+    static uint32_t Hash( const TAG& aTag )
+    {
+        uint64_t h = (uint32_t) aTag.pos.x;
+
+        h = h * 0x9E3779B97F4A7C15ULL + (uint32_t) aTag.pos.y;
+        h = h * 0x9E3779B97F4A7C15ULL + (uint32_t) aTag.net;
+        h ^= h >> 29;
+        h *= 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 32;
+
+        return (uint32_t) h;
+    }
+
+    ///> Returns true if there is at least one joint with key aTag
+    bool Contains( const TAG& aTag, uint32_t aHash ) const
+    {
+        return findSlot( aTag, aHash, NULL ) >= 0;
+    }
+
+    ///> Returns the first joint with key aTag on layer aLayer, or NULL
+    PNS_JOINT* Find( const TAG& aTag, uint32_t aHash, int aLayer )
+    {
+        PNS_LAYERSET layers( aLayer );
+
+        int slot = findSlot( aTag, aHash, &layers );
+
+        return slot < 0 ? NULL : &m_joints[m_slots[slot].m_index];
+    }
+
+    ///> Returns the first joint with key aTag on any of aLayers, or NULL
+    PNS_JOINT* FindOverlapping( const TAG& aTag, uint32_t aHash, const PNS_LAYERSET& aLayers )
+    {
+        int slot = findSlot( aTag, aHash, &aLayers );
+
+        return slot < 0 ? NULL : &m_joints[m_slots[slot].m_index];
+    }
+
+    ///> Stores all the joints with key aTag in aJoints, returns their count
+    int FindAll( const TAG& aTag, uint32_t aHash, std::vector<PNS_JOINT*>& aJoints );
+
+    ///> Hints the processor the table slots of a key will be read soon
+    void Prefetch( uint32_t aHash ) const
+    {
+#ifdef __GNUC__
+        if( !m_slots.empty() )
+            __builtin_prefetch( &m_slots[aHash & m_mask] );
+#endif
+    }
+
+    ///> Adds a copy of aJoint, returns the stored joint
+    PNS_JOINT& Insert( const PNS_JOINT& aJoint );
+
+    ///> Removes a joint stored in this map
+    void Erase( PNS_JOINT* aJoint );
+
+    ///> Removes all joints
+    void Clear();
+
+    int Size() const
+    {
+        return m_count;
+    }
+
+    /**
+     * Class ITERATOR
+     * visits all the joints of the map, in no particular order. Must not be used
+     * while the map is modified.
+     */
+    class ITERATOR
+    {
+    public:
+        ITERATOR( PNS_JOINT_MAP* aMap, int aSlot ) :
+            m_map( aMap ), m_slot( aSlot )
+        {
+            skipEmpty();
+        }
+
+        PNS_JOINT& operator*() const
+        {
+            return m_map->m_joints[m_map->m_slots[m_slot].m_index];
+        }
+
+        PNS_JOINT* operator->() const
+        {
+            return &**this;
+        }
+
+        ITERATOR& operator++()
+        {
+            m_slot++;
+            skipEmpty();
+            return *this;
+        }
+
+        bool operator!=( const ITERATOR& aOther ) const
+        {
+            return m_slot != aOther.m_slot;
+        }
+
+    private:
+        void skipEmpty()
+        {
+            while( m_slot < (int) m_map->m_slots.size() && m_map->m_slots[m_slot].m_index < 0 )
+                m_slot++;
+        }
+
+        PNS_JOINT_MAP* m_map;
+        int m_slot;
+    };
+
+    ITERATOR begin() { return ITERATOR( this, 0 ); }
+    ITERATOR end() { return ITERATOR( this, m_slots.size() ); }
+
+private:
+    struct SLOT
+    {
+        uint32_t m_hash;
+        int32_t m_index;     ///< index of the joint in m_joints, -1 for an empty slot
+    };
+
+    /// maps are not copyable
+    PNS_JOINT_MAP( const PNS_JOINT_MAP& aB );
+    PNS_JOINT_MAP& operator=( const PNS_JOINT_MAP& aB );
+
+    ///> finds the slot of the first joint with key aTag (overlapping aLayers if not NULL).
+    ///> Returns -1 if not found.
+    int findSlot( const TAG& aTag, uint32_t aHash, const PNS_LAYERSET* aLayers ) const;
+
+    void grow();
+
+    std::vector<SLOT> m_slots;
+    uint32_t m_mask;
+    int m_count;
+
+    ///> joint storage (a deque, so that joints never move), and indices of the free entries
+    std::deque<PNS_JOINT> m_joints;
+    std::vector<int> m_freeJoints;
+};
+
+#endif    // __PNS_JOINT_MAP_H
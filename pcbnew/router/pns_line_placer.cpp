@@ -398,7 +398,12 @@ bool PNS_LINE_PLACER::rhWalkOnly( const VECTOR2I& aP, PNS_LINE& aNewHead )
         walkFull.AppendVia( makeVia( walkFull.CPoint( -1 ) ) );
     }
 
-    PNS_OPTIMIZER::Optimize( &walkFull, effort, m_currentNode );
+    PNS_OPTIMIZER optimizer( m_currentNode );
+
+    optimizer.SetEffortLevel( effort );
+    optimizer.SetCollisionMask( -1 );
+    optimizer.SetSpeculativeMerge( Settings().ParallelOptimizer() );
+    optimizer.Optimize( &walkFull );
 
     if( m_currentNode->CheckColliding( &walkFull ) )
     {
@@ -439,6 +444,7 @@ bool PNS_LINE_PLACER::rhShoveOnly( const VECTOR2I& aP, PNS_LINE& aNewHead )
 
     optimizer.SetEffortLevel( PNS_OPTIMIZER::MERGE_SEGMENTS );
     optimizer.SetCollisionMask ( PNS_ITEM::SOLID );
+    optimizer.SetSpeculativeMerge( Settings().ParallelOptimizer() );
     optimizer.Optimize( &walkSolids );
 
     if( stat_solids == PNS_WALKAROUND::DONE )
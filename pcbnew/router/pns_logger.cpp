@@ -18,6 +18,8 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <fstream>
+
 #include "pns_logger.h"
 #include "pns_item.h"
 #include "pns_via.h"
@@ -31,6 +33,25 @@
 #include <geometry/shape_circle.h>
 #include <geometry/shape_convex.h>
 
+PNS_LOGGER::EVENT::EVENT( EVENT_TYPE aType, const VECTOR2I& aP, const PNS_ITEM* aItem, int aArg ) :
+    m_type( aType ),
+    m_p( aP ),
+    m_arg( aArg ),
+    m_itemKind( 0 ),
+    m_itemNet( -1 ),
+    m_itemLayerStart( -1 ),
+    m_itemLayerEnd( -1 )
+{
+    if( aItem )
+    {
+        m_itemKind = aItem->Kind();
+        m_itemNet = aItem->Net();
+        m_itemLayerStart = aItem->Layers().Start();
+        m_itemLayerEnd = aItem->Layers().End();
+    }
+}
+
+
 PNS_LOGGER::PNS_LOGGER( )
 {
     m_groupOpened = false;
@@ -136,6 +157,154 @@ void PNS_LOGGER::Log( const VECTOR2I& aStart, const VECTOR2I& aEnd,
 }
 
 
+void PNS_LOGGER::LogBoard( const std::string& aBoardFile )
+{
+    m_theLog << "board " << aBoardFile << std::endl;
+}
+
+
+void PNS_LOGGER::LogEvent( const EVENT& aEvent )
+{
+    m_theLog << "event " << aEvent.m_type << " " << aEvent.m_p.x << " " << aEvent.m_p.y << " " <<
+                aEvent.m_arg << " " << aEvent.m_itemKind << " " << aEvent.m_itemNet << " " <<
+                aEvent.m_itemLayerStart << " " << aEvent.m_itemLayerEnd;
+
+    switch( aEvent.m_type )
+    {
+    case EVT_SETTINGS:
+    {
+        PNS_ROUTING_SETTINGS st = aEvent.m_settings;
+
+        m_theLog << " " << st.Mode() << " " << st.OptimizerEffort() << " " <<
+                    st.ShoveVias() << " " << st.RemoveLoops() << " " << st.SmartPads() << " " <<
+                    st.SuggestFinish() << " " << st.SmoothDraggedSegments() << " " <<
+                    st.JumpOverObstacles() << " " << st.CanViolateDRC() << " " <<
+                    st.GetFreeAngleMode() << " " << st.InlineDragEnabled() << " " <<
+                    st.ParallelOptimizer();
+        break;
+    }
+
+    case EVT_SIZES:
+    {
+        const PNS_SIZES_SETTINGS& sz = aEvent.m_sizes;
+
+        m_theLog << " " << sz.TrackWidth() << " " << sz.ViaDiameter() << " " << sz.ViaDrill() <<
+                    " " << sz.ViaType() << " " << sz.DiffPairWidth() << " " << sz.DiffPairGap() <<
+                    " " << sz.DiffPairViaGap() << " " << sz.DiffPairViaGapSameAsTraceGap() <<
+                    " " << sz.LayerPairs().size();
+
+        for( std::map<int, int>::const_iterator it = sz.LayerPairs().begin();
+             it != sz.LayerPairs().end(); ++it )
+            m_theLog << " " << it->first << " " << it->second;
+
+        break;
+    }
+
+    default:
+        break;
+    }
+
+    m_theLog << std::endl;
+}
+
+
+bool PNS_LOGGER::LoadSession( const std::string& aFilename, std::string& aBoardFile,
+                              std::vector<EVENT>& aEvents )
+{
+    std::ifstream f( aFilename.c_str() );
+
+    if( !f )
+        return false;
+
+    aBoardFile.clear();
+    aEvents.clear();
+
+    std::string line;
+
+    while( std::getline( f, line ) )
+    {
+        std::istringstream ss( line );
+        std::string cmd;
+
+        ss >> cmd;
+
+        if( cmd == "board" )
+        {
+            std::getline( ss >> std::ws, aBoardFile );
+        }
+        else if( cmd == "event" )
+        {
+            EVENT evt;
+            int type;
+
+            ss >> type >> evt.m_p.x >> evt.m_p.y >> evt.m_arg >> evt.m_itemKind >>
+                  evt.m_itemNet >> evt.m_itemLayerStart >> evt.m_itemLayerEnd;
+
+            evt.m_type = (EVENT_TYPE) type;
+
+            if( evt.m_type == EVT_SETTINGS )
+            {
+                int mode, effort;
+                bool shoveVias, removeLoops, smartPads, suggestFinish, smoothDragged;
+                bool jumpOver, canViolateDRC, freeAngle, inlineDrag, parallelOptimizer;
+
+                ss >> mode >> effort >> shoveVias >> removeLoops >> smartPads >> suggestFinish >>
+                      smoothDragged >> jumpOver >> canViolateDRC >> freeAngle >> inlineDrag >>
+                      parallelOptimizer;
+
+                PNS_ROUTING_SETTINGS& st = evt.m_settings;
+                st.SetMode( (PNS_MODE) mode );
+                st.SetOptimizerEffort( (PNS_OPTIMIZATION_EFFORT) effort );
+                st.SetShoveVias( shoveVias );
+                st.SetRemoveLoops( removeLoops );
+                st.SetSmartPads( smartPads );
+                st.SetSuggestFinish( suggestFinish );
+                st.SetSmoothDraggedSegments( smoothDragged );
+                st.SetJumpOverObstacles( jumpOver );
+                st.SetCanViolateDRC( canViolateDRC );
+                st.SetFreeAngleMode( freeAngle );
+                st.SetInlineDragEnabled( inlineDrag );
+                st.SetParallelOptimizer( parallelOptimizer );
+            }
+            else if( evt.m_type == EVT_SIZES )
+            {
+                int width, viaDiameter, viaDrill, viaType, dpWidth, dpGap, dpViaGap;
+                int pairCount;
+                bool sameGap;
+
+                ss >> width >> viaDiameter >> viaDrill >> viaType >> dpWidth >> dpGap >>
+                      dpViaGap >> sameGap >> pairCount;
+
+                PNS_SIZES_SETTINGS& sz = evt.m_sizes;
+                sz.SetTrackWidth( width );
+                sz.SetViaDiameter( viaDiameter );
+                sz.SetViaDrill( viaDrill );
+                sz.SetViaType( (VIATYPE_T) viaType );
+                sz.SetDiffPairWidth( dpWidth );
+                sz.SetDiffPairGap( dpGap );
+                sz.SetDiffPairViaGap( dpViaGap );
+                sz.SetDiffPairViaGapSameAsTraceGap( sameGap );
+
+                for( int i = 0; i < pairCount; i++ )
+                {
+                    int l1, l2;
+
+                    ss >> l1 >> l2;
+                    sz.AddLayerPair( l1, l2 );
+                }
+            }
+
+            if( !ss )
+                return false;
+
+            aEvents.push_back( evt );
+        }
+    }
+
+    return !aBoardFile.empty() || !aEvents.empty();
+}
+
+
 void PNS_LOGGER::dumpShape( const SHAPE* aSh )
 {
     switch( aSh->Type() )
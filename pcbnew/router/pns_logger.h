@@ -28,13 +28,59 @@
 
 #include <math/vector2d.h>
 
+#include "pns_routing_settings.h"
+#include "pns_sizes_settings.h"
+
 class PNS_ITEM;
 class SHAPE_LINE_CHAIN;
 class SHAPE;
 
+/**
+ * Class PNS_LOGGER
+ *
+ * Writes text logs of the router, for debugging. A log is made of groups of items (the
+ * steps of the shove algorithm) and/or of events: the calls of a routing session made
+ * to PNS_ROUTER, which can be read back with LoadSession() and replayed on a snapshot
+ * of the board taken at the start of the session.
+ */
 class PNS_LOGGER
 {
 public:
+    ///> Router calls stored in session logs
+    enum EVENT_TYPE
+    {
+        EVT_START_ROUTE = 0,    ///< StartRouting(), m_arg is the layer
+        EVT_START_DRAG,         ///< StartDragging()
+        EVT_MOVE,               ///< Move()
+        EVT_FIX,                ///< FixRoute()
+        EVT_STOP,               ///< StopRouting()
+        EVT_SWITCH_LAYER,       ///< SwitchLayer(), m_arg is the layer
+        EVT_TOGGLE_VIA,         ///< ToggleViaPlacement()
+        EVT_FLIP_POSTURE,       ///< FlipPosture()
+        EVT_ORTHO_MODE,         ///< SetOrthoMode(), m_arg is the new state
+        EVT_MODE,               ///< SetMode(), m_arg is the PNS_ROUTER_MODE
+        EVT_SETTINGS,           ///< LoadSettings(), stored in m_settings
+        EVT_SIZES               ///< UpdateSizes(), stored in m_sizes
+    };
+
+    ///> A router call of a session log. The item passed to the router, if any, is
+    ///> identified by its kind, net and layers, to be picked again by the replay.
+    struct EVENT
+    {
+        EVENT( EVENT_TYPE aType = EVT_STOP, const VECTOR2I& aP = VECTOR2I(),
+               const PNS_ITEM* aItem = NULL, int aArg = 0 );
+
+        EVENT_TYPE m_type;
+        VECTOR2I m_p;
+        int m_arg;
+        int m_itemKind;         ///< PNS_ITEM::PnsKind of the item, 0 if there is none
+        int m_itemNet;
+        int m_itemLayerStart;
+        int m_itemLayerEnd;
+        PNS_ROUTING_SETTINGS m_settings;
+        PNS_SIZES_SETTINGS m_sizes;
+    };
+
     PNS_LOGGER();
     ~PNS_LOGGER();
 
@@ -49,6 +95,22 @@ public:
     void Log( const VECTOR2I& aStart, const VECTOR2I& aEnd, int aKind = 0,
               const std::string aName = std::string() );
 
+    ///> Stores the name of the file holding the board the session log starts from
+    void LogBoard( const std::string& aBoardFile );
+
+    void LogEvent( const EVENT& aEvent );
+
+    /**
+     * Function LoadSession()
+     * Reads a session log saved by Save().
+     * @param aFilename is the log file.
+     * @param aBoardFile receives the file name stored by LogBoard(), empty if there is none.
+     * @param aEvents receives the events, in the order they were logged.
+     * @return false if the file can't be read or is not a session log.
+     */
+    static bool LoadSession( const std::string& aFilename, std::string& aBoardFile,
+                             std::vector<EVENT>& aEvents );
+
 private:
     void dumpShape( const SHAPE* aSh );
 
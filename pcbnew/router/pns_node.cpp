@@ -20,6 +20,7 @@
 
 #include <vector>
 #include <cassert>
+#include <algorithm>
 
 #include <math/vector2d.h>
 
@@ -39,21 +40,33 @@
 #include "pns_router.h"
 
 #ifdef DEBUG
+#include <ki_mutex.h>
+
+// nodes are created and destroyed by several threads (parallel optimizer, batch router)
 static std::unordered_set<PNS_NODE*> allocNodes;
+static MUTEX allocNodesLock;
 #endif
 
+// Maximum number of parent branches a branch reads through. A deeper branch takes a copy
+// of the contents of its parents instead, so that queries don't slow down in long
+// chains of branches (e.g. the shove springback stack).
+static const int MAX_OVERLAY_LENGTH = 16;
+
 PNS_NODE::PNS_NODE()
 {
     TRACE( 0, "PNS_NODE::create %p", this );
     m_depth = 0;
     m_root = this;
     m_parent = NULL;
+    m_overlay = NULL;
+    m_overlayLength = 0;
     m_maxClearance = 800000;    // fixme: depends on how thick traces are.
     m_clearanceFunctor = NULL;
     m_index = new PNS_INDEX;
     m_collisionFilter = NULL;
 
 #ifdef DEBUG
+    MUTLOCK lock( allocNodesLock );
     allocNodes.insert( this );
 #endif
 }
@@ -70,16 +83,20 @@ PNS_NODE::~PNS_NODE()
     }
 
 #ifdef DEBUG
-    if( allocNodes.find( this ) == allocNodes.end() )
     {
-        TRACEn( 0, "attempting to free an already-free'd node.\n" );
-        assert( false );
-    }
+        MUTLOCK lock( allocNodesLock );
 
-    allocNodes.erase( this );
+        if( allocNodes.find( this ) == allocNodes.end() )
+        {
+            TRACEn( 0, "attempting to free an already-free'd node.\n" );
+            assert( false );
+        }
+
+        allocNodes.erase( this );
+    }
 #endif
 
-    m_joints.clear();
+    m_joints.Clear();
 
     for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
     {
@@ -117,21 +134,19 @@ PNS_NODE* PNS_NODE::Branch()
     child->m_collisionFilter = m_collisionFilter;
 
     // immmediate offspring of the root branch needs not copy anything.
-    // For the rest, deep-copy joints, overridden item map and pointers
-    // to stored items.
+    // The rest reads the items and joints of this node through m_overlay and
+    // only inherits the overridden item map.
     if( !isRoot() )
     {
-        JOINT_MAP::iterator j;
-
-        for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-            child->m_index->Add( *i );
-
-        child->m_joints = m_joints;
+        child->m_overlay = this;
+        child->m_overlayLength = m_overlayLength + 1;
         child->m_override = m_override;
+
+        if( child->m_overlayLength > MAX_OVERLAY_LENGTH )
+            child->detach();
     }
 
-    TRACE( 2, "%d items, %d joints, %d overrides",
-            child->m_index->Size() % child->m_joints.size() % child->m_override.size() );
+    TRACE( 2, "%d overrides", child->m_override.size() );
 
     return child;
 }
@@ -146,6 +161,73 @@ void PNS_NODE::unlinkParent()
 }
 
 
+void PNS_NODE::detachChildren()
+{
+    // branches of the root always see its current contents
+    if( isRoot() )
+        return;
+
+    for( PNS_NODE* child : m_children )
+    {
+        if( child->m_overlay == this )
+            child->detach();
+    }
+}
+
+
+void PNS_NODE::detach()
+{
+    if( !m_overlay )
+        return;
+
+    // joints stored in this node, or erased by it, hide the joints of the parents
+    // at the same position. The same goes for each parent wrs to its own parents.
+    JOINT_TAGS hidden( m_erasedJoints );
+
+    for( PNS_JOINT_MAP::ITERATOR j = m_joints.begin(); j != m_joints.end(); ++j )
+        hidden.insert( j->Tag() );
+
+    for( PNS_NODE* node = m_overlay; node; node = node->m_overlay )
+    {
+        for( PNS_INDEX::ITEM_SET::iterator i = node->m_index->begin();
+             i != node->m_index->end(); ++i )
+        {
+            if( !overrides( *i, node->m_depth ) && !m_index->Contains( *i ) )
+                m_index->Add( *i );
+        }
+
+        for( PNS_JOINT_MAP::ITERATOR j = node->m_joints.begin(); j != node->m_joints.end(); ++j )
+        {
+            if( hidden.find( j->Tag() ) == hidden.end() )
+                m_joints.Insert( *j );
+        }
+
+        for( PNS_JOINT_MAP::ITERATOR j = node->m_joints.begin(); j != node->m_joints.end(); ++j )
+            hidden.insert( j->Tag() );
+
+        hidden.insert( node->m_erasedJoints.begin(), node->m_erasedJoints.end() );
+    }
+
+    m_overlay = NULL;
+    m_overlayLength = 0;
+}
+
+
+template <class Visitor>
+void PNS_NODE::visitBranchItems( Visitor& aVisitor )
+{
+    for( PNS_NODE* node = this; node; node = node->m_overlay )
+    {
+        for( PNS_INDEX::ITEM_SET::iterator i = node->m_index->begin();
+             i != node->m_index->end(); ++i )
+        {
+            if( node == this || !overrides( *i, node->m_depth ) )
+                aVisitor( *i );
+        }
+    }
+}
+
+
 // function object that visits potential obstacles and performs
 // the actual collision refining
 struct PNS_NODE::OBSTACLE_VISITOR
@@ -156,6 +238,9 @@ struct PNS_NODE::OBSTACLE_VISITOR
     ///> node that overrides root entries
     PNS_NODE* m_override;
 
+    ///> depth of the node whose index is searched, if it is not m_override itself
+    int m_overrideDepth;
+
     ///> list of encountered obstacles
     OBSTACLES& m_tab;
 
@@ -181,6 +266,7 @@ struct PNS_NODE::OBSTACLE_VISITOR
     OBSTACLE_VISITOR( PNS_NODE::OBSTACLES& aTab, const PNS_ITEM* aItem, int aKindMask, bool aDifferentNetsOnly ) :
         m_node( NULL ),
         m_override( NULL ),
+        m_overrideDepth( 0 ),
         m_tab( aTab ),
         m_item( aItem ),
         m_kindMask( aKindMask ),
@@ -199,10 +285,11 @@ struct PNS_NODE::OBSTACLE_VISITOR
         m_limitCount = aLimit;
     }
 
-    void SetWorld( PNS_NODE* aNode, PNS_NODE* aOverride = NULL )
+    void SetWorld( PNS_NODE* aNode, PNS_NODE* aOverride = NULL, int aOverrideDepth = 0 )
     {
         m_node = aNode;
         m_override = aOverride;
+        m_overrideDepth = aOverrideDepth;
     }
 
     bool operator()( PNS_ITEM* aItem )
@@ -212,7 +299,7 @@ struct PNS_NODE::OBSTACLE_VISITOR
 
         // check if there is a more recent branch with a newer
         // (possibily modified) version of this item.
-        if( m_override && m_override->overrides( aItem ) )
+        if( m_override && m_override->overrides( aItem, m_overrideDepth ) )
             return true;
 
         int clearance = m_extraClearance + m_node->GetClearance( aItem, m_item );
@@ -251,7 +338,10 @@ int PNS_NODE::QueryColliding( const PNS_ITEM* aItem,
     OBSTACLE_VISITOR visitor( aObstacles, aItem, aKindMask, aDifferentNetsOnly );
 
 #ifdef DEBUG
-    assert( allocNodes.find( this ) != allocNodes.end() );
+    {
+        MUTLOCK lock( allocNodesLock );
+        assert( allocNodes.find( this ) != allocNodes.end() );
+    }
 #endif
 
     visitor.SetCountLimit( aLimitCount );
@@ -260,6 +350,16 @@ int PNS_NODE::QueryColliding( const PNS_ITEM* aItem,
     // first, look for colliding items in the local index
     m_index->Query( aItem, m_maxClearance, visitor );
 
+    // then in the parent branches this node reads through
+    for( PNS_NODE* node = m_overlay; node; node = node->m_overlay )
+    {
+        if( visitor.m_matchCount >= aLimitCount && aLimitCount >= 0 )
+            break;
+
+        visitor.SetWorld( this, this, node->m_depth );
+        node->m_index->Query( aItem, m_maxClearance, visitor );
+    }
+
     // if we haven't found enough items, look in the root branch as well.
     if( !isRoot() && ( visitor.m_matchCount < aLimitCount || aLimitCount < 0 ) )
     {
@@ -484,6 +584,19 @@ const PNS_ITEMSET PNS_NODE::HitTest( const VECTOR2I& aPoint ) const
 
     m_index->Query( &s, m_maxClearance, visitor );
 
+    for( PNS_NODE* node = m_overlay; node; node = node->m_overlay )
+    {
+        PNS_ITEMSET items_parent;
+        HIT_VISITOR visitor_parent( items_parent, aPoint, node );
+        node->m_index->Query( &s, m_maxClearance, visitor_parent );
+
+        for( PNS_ITEM* item : items_parent.Items() )
+        {
+            if( !overrides( item, node->m_depth ) )
+                items.Add( item );
+        }
+    }
+
     if( !isRoot() )    // fixme: could be made cleaner
     {
         PNS_ITEMSET items_root;
@@ -575,6 +688,8 @@ void PNS_NODE::addSegment( PNS_SEGMENT* aSeg, bool aAllowRedundant )
 
 void PNS_NODE::Add( PNS_ITEM* aItem, bool aAllowRedundant )
 {
+    detachChildren();
+
     aItem->SetOwner( this );
 
     switch( aItem->Kind() )
@@ -603,16 +718,15 @@ void PNS_NODE::Add( PNS_ITEM* aItem, bool aAllowRedundant )
 
 void PNS_NODE::doRemove( PNS_ITEM* aItem )
 {
-    // case 1: removing an item that is stored in the root node from any branch:
-    // mark it as overridden, but do not remove
-    if( aItem->BelongsTo( m_root ) && !isRoot() )
-        m_override.insert( aItem );
-
-    // case 2: the item belongs to this branch or a parent, non-root branch,
-    // or the root itself and we are the root: remove from the index
-    else if( !aItem->BelongsTo( m_root ) || isRoot() )
+    // case 1: the item is stored in this branch (or we are the root): remove from the index
+    if( isRoot() || m_index->Contains( aItem ) )
         m_index->Remove( aItem );
 
+    // case 2: removing an item that is stored in the root node or in a parent branch:
+    // mark it as overridden, but do not remove
+    else
+        m_override[aItem] = m_depth;
+
     // the item belongs to this particular branch: un-reference it
     if( aItem->BelongsTo( this ) )
     {
@@ -660,27 +774,30 @@ void PNS_NODE::removeVia( PNS_VIA* aVia )
     tag.net = net;
     tag.pos = p;
 
-    bool split;
-    do
+    uint32_t hash = PNS_JOINT_MAP::Hash( tag );
+
+    // the joints are modified in this node: take a copy of the ones stored in the parents
+    if( !isRoot() && !m_joints.Contains( tag, hash ) )
     {
-        split = false;
-        std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range = m_joints.equal_range( tag );
+        PNS_JOINT_MAP* joints = branchJoints( tag, hash );
 
-        if( range.first == m_joints.end() )
-            break;
+        if( joints )
+        {
+            std::vector<PNS_JOINT*> copied;
 
-        // find and remove all joints containing the via to be removed
+            joints->FindAll( tag, hash, copied );
 
-        for( JOINT_MAP::iterator f = range.first; f != range.second; ++f )
-        {
-            if( aVia->LayersOverlap ( &f->second ) )
-            {
-                m_joints.erase( f );
-                split = true;
-                break;
-            }
+            for( PNS_JOINT* j : copied )
+                m_joints.Insert( *j );
         }
-    } while( split );
+    }
+
+    // find and remove all joints containing the via to be removed
+    while( PNS_JOINT* f = m_joints.FindOverlapping( tag, hash, vLayers ) )
+        m_joints.Erase( f );
+
+    if( !isRoot() && !m_joints.Contains( tag, hash ) )
+        m_erasedJoints.insert( tag );
 
     // and re-link them, using the former via's link list
     for(PNS_ITEM* item : links)
@@ -702,6 +819,8 @@ void PNS_NODE::Replace( PNS_ITEM* aOldItem, PNS_ITEM* aNewItem )
 
 void PNS_NODE::Remove( PNS_ITEM* aItem )
 {
+    detachChildren();
+
     switch( aItem->Kind() )
     {
     case PNS_ITEM::SOLID:
@@ -729,6 +848,7 @@ void PNS_NODE::Remove( PNS_ITEM* aItem )
 
 void PNS_NODE::Remove( PNS_LINE& aLine )
 {
+    detachChildren();
     removeLine( &aLine );
 }
 
@@ -830,8 +950,13 @@ const PNS_LINE PNS_NODE::AssembleLine( PNS_SEGMENT* aSeg, int* aOriginSegmentInd
 
 void PNS_NODE::FindLineEnds( const PNS_LINE& aLine, PNS_JOINT& aA, PNS_JOINT& aB )
 {
-    aA = *FindJoint( aLine.CPoint( 0 ), &aLine );
-    aB = *FindJoint( aLine.CPoint( -1 ), &aLine );
+    VECTOR2I ends[2] = { aLine.CPoint( 0 ), aLine.CPoint( -1 ) };
+    PNS_JOINT* joints[2];
+
+    FindJoints( ends, 2, aLine.Layers().Start(), aLine.Net(), joints );
+
+    aA = *joints[0];
+    aB = *joints[1];
 }
 
 
@@ -876,36 +1001,76 @@ PNS_JOINT* PNS_NODE::FindJoint( const VECTOR2I& aPos, int aLayer, int aNet )
     tag.net = aNet;
     tag.pos = aPos;
 
-    JOINT_MAP::iterator f = m_joints.find( tag ), end = m_joints.end();
+    return findJoint( tag, PNS_JOINT_MAP::Hash( tag ), aLayer );
+}
 
-    if( f == end && !isRoot() )
-    {
-        end = m_root->m_joints.end();
-        f = m_root->m_joints.find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
-    }
 
-    if( f == end )
-        return NULL;
+void PNS_NODE::FindJoints( const VECTOR2I* aPos, int aCount, int aLayer, int aNet,
+                           PNS_JOINT** aJoints )
+{
+    const int batchSize = 8;
+
+    PNS_JOINT::HASH_TAG tags[batchSize];
+    uint32_t hashes[batchSize];
 
-    while( f != end )
+    for( int base = 0; base < aCount; base += batchSize )
     {
-        if( f->second.Layers().Overlaps( aLayer ) )
-            return &f->second;
+        int n = std::min( batchSize, aCount - base );
+
+        // most joints are found in this node or in the root: issue all the loads of the
+        // batch first, so that the cache misses overlap instead of adding up
+        for( int i = 0; i < n; i++ )
+        {
+            tags[i].net = aNet;
+            tags[i].pos = aPos[base + i];
+            hashes[i] = PNS_JOINT_MAP::Hash( tags[i] );
+
+            m_joints.Prefetch( hashes[i] );
+            m_root->m_joints.Prefetch( hashes[i] );
+        }
 
-        ++f;
+        for( int i = 0; i < n; i++ )
+            aJoints[base + i] = findJoint( tags[i], hashes[i], aLayer );
     }
+}
 
-    return NULL;
+
+PNS_JOINT* PNS_NODE::findJoint( const PNS_JOINT::HASH_TAG& aTag, uint32_t aHash, int aLayer )
+{
+    PNS_JOINT_MAP* joints = branchJoints( aTag, aHash );
+
+    if( !joints )
+        joints = &m_root->m_joints;
+
+    return joints->Find( aTag, aHash, aLayer );
 }
 
 
 void PNS_NODE::LockJoint( const VECTOR2I& aPos, const PNS_ITEM* aItem, bool aLock )
 {
+    detachChildren();
+
     PNS_JOINT& jt = touchJoint( aPos, aItem->Layers(), aItem->Net() );
     jt.Lock( aLock );
 }
 
 
+PNS_JOINT_MAP* PNS_NODE::branchJoints( const PNS_JOINT::HASH_TAG& aTag, uint32_t aHash )
+{
+    for( PNS_NODE* node = this; node; node = node->m_overlay )
+    {
+        if( node->m_joints.Contains( aTag, aHash ) )
+            return &node->m_joints;
+
+        // the joints of the parents at this position have been removed
+        if( node->m_erasedJoints.find( aTag ) != node->m_erasedJoints.end() )
+            break;
+    }
+
+    return NULL;
+}
+
+
 PNS_JOINT& PNS_NODE::touchJoint( const VECTOR2I& aPos, const PNS_LAYERSET& aLayers, int aNet )
 {
     PNS_JOINT::HASH_TAG tag;
@@ -913,47 +1078,35 @@ PNS_JOINT& PNS_NODE::touchJoint( const VECTOR2I& aPos, const PNS_LAYERSET& aLaye
     tag.pos = aPos;
     tag.net = aNet;
 
-    // try to find the joint in this node.
-    JOINT_MAP::iterator f = m_joints.find( tag );
-
-    std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range;
+    uint32_t hash = PNS_JOINT_MAP::Hash( tag );
 
-    // not found and we are not root? find in the root and copy results here.
-    if( f == m_joints.end() && !isRoot() )
+    // not found in this node and we are not root? find in the parents or in the root
+    // and copy results here.
+    if( !isRoot() && !m_joints.Contains( tag, hash ) )
     {
-        range = m_root->m_joints.equal_range( tag );
+        PNS_JOINT_MAP* joints = branchJoints( tag, hash );
+
+        if( !joints )
+            joints = &m_root->m_joints;
+
+        std::vector<PNS_JOINT*> copied;
 
-        for( f = range.first; f != range.second; ++f )
-            m_joints.insert( *f );
+        joints->FindAll( tag, hash, copied );
+
+        for( PNS_JOINT* j : copied )
+            m_joints.Insert( *j );
     }
 
     // now insert and combine overlapping joints
     PNS_JOINT jt( aPos, aLayers, aNet );
 
-    bool merged;
-
-    do
+    while( PNS_JOINT* f = m_joints.FindOverlapping( tag, hash, aLayers ) )
     {
-        merged  = false;
-        range   = m_joints.equal_range( tag );
-
-        if( range.first == m_joints.end() )
-            break;
-
-        for( f = range.first; f != range.second; ++f )
-        {
-            if( aLayers.Overlaps( f->second.Layers() ) )
-            {
-                jt.Merge( f->second );
-                m_joints.erase( f );
-                merged = true;
-                break;
-            }
-        }
+        jt.Merge( *f );
+        m_joints.Erase( f );
     }
-    while( merged );
 
-    return m_joints.insert( TagJointPair( tag, jt ) )->second;
+    return m_joints.Insert( jt );
 }
 
 
@@ -1004,16 +1157,16 @@ void PNS_NODE::Dump( bool aLong )
         }
     }
 
-    JOINT_MAP::iterator j;
+    PNS_JOINT_MAP::ITERATOR j = m_joints.begin();
 
     if( aLong )
-        for( j = m_joints.begin(); j != m_joints.end(); ++j )
+        for( ; j != m_joints.end(); ++j )
         {
             printf( "joint : %s, links : %d\n",
-                    j->second.GetPos().Format().c_str(), j->second.LinkCount() );
+                    j->GetPos().Format().c_str(), j->LinkCount() );
             PNS_JOINT::LINKED_ITEMS::const_iterator k;
 
-            for( k = j->second.GetLinkList().begin(); k != j->second.GetLinkList().end(); ++k )
+            for( k = j->GetLinkList().begin(); k != j->GetLinkList().end(); ++k )
             {
                 const PNS_ITEM* m_item = *k;
 
@@ -1059,11 +1212,29 @@ void PNS_NODE::Dump( bool aLong )
         lines_count++;
     }
 
-    printf( "Local joints: %d, lines : %d \n", m_joints.size(), lines_count );
+    printf( "Local joints: %d, lines : %d \n", m_joints.Size(), lines_count );
 #endif
 }
 
 
+// function object collecting the items of a branch, optionally only the marked ones
+struct ITEM_COLLECTOR
+{
+    PNS_NODE::ITEM_VECTOR& m_items;
+    int m_marker;
+
+    ITEM_COLLECTOR( PNS_NODE::ITEM_VECTOR& aItems, int aMarker = 0 ) :
+        m_items( aItems ), m_marker( aMarker )
+    {}
+
+    void operator()( PNS_ITEM* aItem )
+    {
+        if( !m_marker || ( aItem->Marker() & m_marker ) )
+            m_items.push_back( aItem );
+    }
+};
+
+
 void PNS_NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
 {
     aRemoved.reserve( m_override.size() );
@@ -1072,11 +1243,15 @@ void PNS_NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
     if( isRoot() )
         return;
 
-    for( PNS_ITEM* item : m_override )
-        aRemoved.push_back( item );
+    // the overridden items stored in the parent branches are not part of the root
+    for( OVERRIDE_MAP::iterator i = m_override.begin(); i != m_override.end(); ++i )
+    {
+        if( m_root->m_index->Contains( i->first ) )
+            aRemoved.push_back( i->first );
+    }
 
-    for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-        aAdded.push_back( *i );
+    ITEM_COLLECTOR collector( aAdded );
+    visitBranchItems( collector );
 }
 
 void PNS_NODE::releaseChildren()
@@ -1112,17 +1287,20 @@ void PNS_NODE::Commit( PNS_NODE* aNode )
     if( aNode->isRoot() )
         return;
 
-    for( PNS_ITEM* item : aNode->m_override )
+    ITEM_VECTOR removed, added;
+
+    aNode->GetUpdatedItems( removed, added );
+
+    for( PNS_ITEM* item : removed )
     {
         Remove( item );
     }
 
-    for( PNS_INDEX::ITEM_SET::iterator i = aNode->m_index->begin();
-         i != aNode->m_index->end(); ++i )
+    for( PNS_ITEM* item : added )
     {
-        (*i)->SetRank( -1 );
-        (*i)->Unmark();
-        Add( *i );
+        item->SetRank( -1 );
+        item->Unmark();
+        Add( item );
     }
 
     releaseChildren();
@@ -1147,6 +1325,18 @@ void PNS_NODE::AllItemsInNet( int aNet, std::set<PNS_ITEM*>& aItems )
             aItems.insert( item );
     }
 
+    for( PNS_NODE* node = m_overlay; node; node = node->m_overlay )
+    {
+        PNS_INDEX::NET_ITEMS_LIST* l_parent = node->m_index->GetItemsForNet( aNet );
+
+        if( l_parent )
+        {
+            for( PNS_ITEM* item : *l_parent )
+                if( !overrides( item, node->m_depth ) )
+                    aItems.insert( item );
+        }
+    }
+
     if( !isRoot() )
     {
         PNS_INDEX::NET_ITEMS_LIST* l_root = m_root->m_index->GetItemsForNet( aNet );
@@ -1159,23 +1349,40 @@ void PNS_NODE::AllItemsInNet( int aNet, std::set<PNS_ITEM*>& aItems )
 }
 
 
-void PNS_NODE::ClearRanks( int aMarkerMask )
+// function object resetting the rank and markers of the items of a branch
+struct RANK_CLEARER
 {
-    for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
+    int m_markerMask;
+
+    RANK_CLEARER( int aMarkerMask ) :
+        m_markerMask( aMarkerMask )
+    {}
+
+    void operator()( PNS_ITEM* aItem )
     {
-        (*i)->SetRank( -1 );
-        (*i)->Mark( (*i)->Marker() & (~aMarkerMask) );
+        aItem->SetRank( -1 );
+        aItem->Mark( aItem->Marker() & (~m_markerMask) );
     }
+};
+
+
+void PNS_NODE::ClearRanks( int aMarkerMask )
+{
+    RANK_CLEARER clearer( aMarkerMask );
+
+    visitBranchItems( clearer );
 }
 
 
 int PNS_NODE::FindByMarker( int aMarker, PNS_ITEMSET& aItems )
 {
-    for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-    {
-        if( (*i)->Marker() & aMarker )
-            aItems.Add( *i );
-    }
+    ITEM_VECTOR marked;
+    ITEM_COLLECTOR collector( marked, aMarker );
+
+    visitBranchItems( collector );
+
+    for( PNS_ITEM* item : marked )
+        aItems.Add( item );
 
     return 0;
 }
@@ -1183,19 +1390,14 @@ int PNS_NODE::FindByMarker( int aMarker, PNS_ITEMSET& aItems )
 
 int PNS_NODE::RemoveByMarker( int aMarker )
 {
-    std::list<PNS_ITEM*> garbage;
+    ITEM_VECTOR garbage;
+    ITEM_COLLECTOR collector( garbage, aMarker );
 
-    for( PNS_INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
-    {
-        if ( (*i)->Marker() & aMarker )
-        {
-            garbage.push_back( *i );
-        }
-    }
+    visitBranchItems( collector );
 
-    for( std::list<PNS_ITEM*>::const_iterator i = garbage.begin(), end = garbage.end(); i != end; ++i )
+    for( PNS_ITEM* item : garbage )
     {
-        Remove( *i );
+        Remove( item );
     }
 
     return 0;
@@ -1239,11 +1441,17 @@ void PNS_NODE::SetCollisionFilter( PNS_COLLISION_FILTER* aFilter )
 
 PNS_ITEM *PNS_NODE::FindItemByParent( const BOARD_CONNECTED_ITEM* aParent )
 {
-    PNS_INDEX::NET_ITEMS_LIST* l_cur = m_index->GetItemsForNet( aParent->GetNetCode() );
+    for( PNS_NODE* node = this; node; node = node->m_overlay )
+    {
+        PNS_INDEX::NET_ITEMS_LIST* l_cur = node->m_index->GetItemsForNet( aParent->GetNetCode() );
+
+        if( !l_cur )
+            continue;
 
-    for( PNS_ITEM*item : *l_cur )
-        if( item->Parent() == aParent )
-            return item;
+        for( PNS_ITEM*item : *l_cur )
+            if( item->Parent() == aParent && ( node == this || !overrides( item, node->m_depth ) ) )
+                return item;
+    }
 
     return NULL;
 }
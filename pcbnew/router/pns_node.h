@@ -25,7 +25,9 @@
 #include <list>
 
 #include <unordered_set>
+#include <unordered_map>
 #include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
 #include <boost/optional.hpp>
 
 #include <geometry/shape.h>
@@ -34,7 +36,9 @@
 
 #include "pns_item.h"
 #include "pns_joint.h"
+#include "pns_joint_map.h"
 #include "pns_itemset.h"
+#include "pns_pool.h"
 
 class PNS_SEGMENT;
 class PNS_LINE;
@@ -130,6 +134,12 @@ struct PNS_COLLISION_FILTER {
  * - assembly of lines connecting joints, finding loops and unique paths
  * - lightweight cloning/branching (for recursive optimization and shove
  * springback)
+ *
+ * A branch stores only its changes: the items and joints it has added or modified, and
+ * the set of items it hides. Everything else is looked up in the parent branches, then
+ * in the root, so branching does not copy the contents of the parent. If a branch
+ * that has children is modified, the children take a private copy of what they see
+ * of it first.
  **/
 class PNS_NODE
 {
@@ -141,6 +151,9 @@ public:
     PNS_NODE();
     ~PNS_NODE();
 
+    ///> nodes are allocated from the router memory pool
+    PNS_POOLED_ALLOCATION
+
     ///> Returns the expected clearance between items a and b.
     int GetClearance( const PNS_ITEM* aA, const PNS_ITEM* aB ) const;
 
@@ -162,10 +175,10 @@ public:
         m_clearanceFunctor = aFunc;
     }
 
-    ///> Returns the number of joints
+    ///> Returns the number of joints stored in this node
     int JointCount() const
     {
-        return m_joints.size();
+        return m_joints.Size();
     }
 
     ///> Returns the number of nodes in the inheritance chain (wrs to the root node)
@@ -355,6 +368,16 @@ public:
         return FindJoint( aPos, aItem->Layers().Start(), aItem->Net() );
     }
 
+    /**
+     * Function FindJoints()
+     *
+     * Batch version of FindJoint(): looks up the joints at aCount positions on the same
+     * layer and net, storing them (or NULL) in aJoints. The table slots of all positions are
+     * requested from memory before the first one is examined.
+     */
+    void FindJoints( const VECTOR2I* aPos, int aCount, int aLayer, int aNet,
+                     PNS_JOINT** aJoints );
+
     ///> finds all lines between a pair of joints. Used by the loop removal procedure.
     int FindLinesBetweenJoints( PNS_JOINT&                  aA,
                                 PNS_JOINT&                  aB,
@@ -383,13 +406,24 @@ public:
 
 private:
     struct OBSTACLE_VISITOR;
-    typedef boost::unordered_multimap<PNS_JOINT::HASH_TAG, PNS_JOINT> JOINT_MAP;
-    typedef JOINT_MAP::value_type TagJointPair;
+    typedef boost::unordered_set<PNS_JOINT::HASH_TAG> JOINT_TAGS;
+
+    ///> hidden items, with the depth of the node which has removed them
+    typedef std::unordered_map<PNS_ITEM*, int, std::hash<PNS_ITEM*>, std::equal_to<PNS_ITEM*>,
+                               PNS_POOL_ALLOCATOR<std::pair<PNS_ITEM* const, int> > >
+                                OVERRIDE_MAP;
 
     /// nodes are not copyable
     PNS_NODE( const PNS_NODE& aB );
     PNS_NODE& operator=( const PNS_NODE& aB );
 
+    ///> returns the joints of the nearest node of the branch (this node, then the parent
+    ///> branches it reads through) storing joints at aTag, or NULL if there are none.
+    PNS_JOINT_MAP* branchJoints( const PNS_JOINT::HASH_TAG& aTag, uint32_t aHash );
+
+    ///> looks up a joint of the branch or of the root, aHash being the hash of aTag
+    PNS_JOINT* findJoint( const PNS_JOINT::HASH_TAG& aTag, uint32_t aHash, int aLayer );
+
     ///> tries to find matching joint and creates a new one if not found
     PNS_JOINT& touchJoint( const VECTOR2I&      aPos,
                            const PNS_LAYERSET&  aLayers,
@@ -418,16 +452,29 @@ private:
     void releaseChildren();
     void releaseGarbage();
 
+    ///> gives a private copy of the contents of this node to the children reading through it.
+    ///> Called before this node is modified.
+    void detachChildren();
+
+    ///> copies the items and joints of the parent branches this node reads through
+    void detach();
+
+    ///> calls aVisitor for each item of the branch (added or modified wrs to the root)
+    template <class Visitor>
+    void visitBranchItems( Visitor& aVisitor );
+
     bool isRoot() const
     {
         return m_parent == NULL;
     }
 
     ///> checks if this branch contains an updated version of the m_item
-    ///> from the root branch.
-    bool overrides( PNS_ITEM* aItem ) const
+    ///> stored in the node of depth aDepth (by default, the root branch).
+    bool overrides( PNS_ITEM* aItem, int aDepth = 0 ) const
     {
-        return m_override.find( aItem ) != m_override.end();
+        OVERRIDE_MAP::const_iterator f = m_override.find( aItem );
+
+        return f != m_override.end() && f->second > aDepth;
     }
 
     PNS_SEGMENT* findRedundantSegment( PNS_SEGMENT* aSeg );
@@ -443,20 +490,31 @@ private:
                      bool            aStopAtLockedJoints );
 
     ///> hash table with the joints, linking the items. Joints are hashed by
-    ///> their position, layer set and net.
-    JOINT_MAP m_joints;
+    ///> their position and net.
+    PNS_JOINT_MAP m_joints;
+
+    ///> positions where this node has removed all the joints seen from its parents
+    JOINT_TAGS m_erasedJoints;
 
     ///> node this node was branched from
     PNS_NODE* m_parent;
 
+    ///> nearest non-root parent whose items and joints are shared by this node
+    ///> (NULL for the root, its children and detached nodes)
+    PNS_NODE* m_overlay;
+
+    ///> number of nodes in the m_overlay chain
+    int m_overlayLength;
+
     ///> root node of the whole hierarchy
     PNS_NODE* m_root;
 
     ///> list of nodes branched from this one
     std::set<PNS_NODE*> m_children;
 
-    ///> hash of root's items that have been changed in this node
-    std::unordered_set<PNS_ITEM*> m_override;
+    ///> hash of the root's and parents' items that have been changed in this node
+    ///> or in its parents
+    OVERRIDE_MAP m_override;
 
     ///> worst case item-item clearance
     int m_maxClearance;
@@ -18,10 +18,16 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cassert>
+
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_rect.h>
 #include <geometry/shape_convex.h>
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
 #include "pns_line.h"
 #include "pns_diff_pair.h"
 #include "pns_node.h"
@@ -29,6 +35,7 @@
 #include "pns_optimizer.h"
 #include "pns_utils.h"
 #include "pns_router.h"
+#include "pns_perf.h"
 
 /**
  *  Cost Estimator Methods
@@ -123,6 +130,7 @@ PNS_OPTIMIZER::PNS_OPTIMIZER( PNS_NODE* aWorld ) :
     m_collisionKindMask( PNS_ITEM::ANY ),
     m_effortLevel( MERGE_SEGMENTS ),
     m_keepPostures( false ),
+    m_speculativeMerge( false ),
     m_restrictAreaActive( false )
 {
 }
@@ -233,7 +241,7 @@ class LINE_RESTRICTIONS
         ~LINE_RESTRICTIONS() {};
 
         void Build( PNS_NODE* aWorld, PNS_LINE* aOriginLine, const SHAPE_LINE_CHAIN& aLine, const BOX2I& aRestrictedArea, bool aRestrictedAreaEnable );
-        bool Check ( int aVertex1, int aVertex2, const SHAPE_LINE_CHAIN& aReplacement );
+        bool Check ( int aVertex1, int aVertex2, const SHAPE_LINE_CHAIN& aReplacement ) const;
         void Dump();
 
     private:
@@ -353,7 +361,7 @@ void LINE_RESTRICTIONS::Dump()
 }
 
 
-bool LINE_RESTRICTIONS::Check( int aVertex1, int aVertex2, const SHAPE_LINE_CHAIN& aReplacement )
+bool LINE_RESTRICTIONS::Check( int aVertex1, int aVertex2, const SHAPE_LINE_CHAIN& aReplacement ) const
 {
     if( m_rs.empty( ) )
         return true;
@@ -378,10 +386,39 @@ bool LINE_RESTRICTIONS::Check( int aVertex1, int aVertex2, const SHAPE_LINE_CHAI
 }
 
 
+static void mergeArea( OPT_BOX2I& aArea, const BOX2I& aOther )
+{
+    if( aArea )
+        aArea->Merge( aOther );
+    else
+        aArea = aOther;
+}
+
+
+BOX2I PNS_OPTIMIZER::ItemArea( const PNS_ITEM* aItem )
+{
+    if( aItem->Kind() != PNS_ITEM::LINE )
+    {
+        assert( aItem->Shape() );
+        return aItem->Shape()->BBox();
+    }
+
+    const PNS_LINE* line = static_cast<const PNS_LINE*>( aItem );
+    BOX2I area = line->CLine().BBox( line->Width() );
+
+    if( line->EndsWithVia() )
+        area.Merge( line->Via().Shape()->BBox() );
+
+    return area;
+}
+
+
 bool PNS_OPTIMIZER::checkColliding( PNS_ITEM* aItem, bool aUpdateCache )
 {
     CACHE_VISITOR v( aItem, m_world, m_collisionKindMask );
 
+    mergeArea( m_queryArea, ItemArea( aItem ) );
+
     return static_cast<bool>( m_world->CheckColliding( aItem ) );
 
     // something is wrong with the cache, need to investigate.
@@ -547,6 +584,8 @@ bool PNS_OPTIMIZER::mergeFull( PNS_LINE* aLine )
 
 bool PNS_OPTIMIZER::Optimize( PNS_LINE* aLine, PNS_LINE* aResult )
 {
+    PNS_PERF::SCOPE perf( PNS_PERF::OPTIMIZER_PASS );
+
     if( !aResult )
         aResult = aLine;
     else
@@ -554,6 +593,9 @@ bool PNS_OPTIMIZER::Optimize( PNS_LINE* aLine, PNS_LINE* aResult )
 
     m_keepPostures = false;
 
+    // the joints at the vertices of the line are read as well
+    mergeArea( m_queryArea, ItemArea( aLine ) );
+
     bool rv = false;
 
     if( m_effortLevel & MERGE_SEGMENTS )
@@ -572,70 +614,141 @@ bool PNS_OPTIMIZER::Optimize( PNS_LINE* aLine, PNS_LINE* aResult )
 }
 
 
-bool PNS_OPTIMIZER::mergeStep( PNS_LINE* aLine, SHAPE_LINE_CHAIN& aCurrentPath, int step )
+// data shared by the evaluations of the candidates of a merge step
+struct PNS_OPTIMIZER::MERGE_STEP
 {
-    int n = 0;
-    int n_segs = aCurrentPath.SegmentCount();
+    PNS_LINE*               m_line;
+    const SHAPE_LINE_CHAIN* m_path;
+    int                     m_step;
+    int                     m_costOrig;
+    DIRECTION_45            m_origStart;
+    DIRECTION_45            m_origEnd;
+    LINE_RESTRICTIONS       m_restrictions;
+};
+
+
+// result of the evaluation of the bypass of the segments n to n + step of a path
+struct PNS_OPTIMIZER::MERGE_CANDIDATE
+{
+    ///> the path with the best bypass, if it lowers the cost of the path
+    SHAPE_LINE_CHAIN    m_path;
+
+    ///> area of the bypasses checked for collisions
+    OPT_BOX2I           m_queryArea;
+};
 
-    int cost_orig = PNS_COST_ESTIMATOR::CornerCost( aCurrentPath );
 
-    LINE_RESTRICTIONS restr;
+bool PNS_OPTIMIZER::mergeStep( PNS_LINE* aLine, SHAPE_LINE_CHAIN& aCurrentPath, int step )
+{
+    int n_segs = aCurrentPath.SegmentCount();
 
     if( aLine->SegmentCount() < 4 )
         return false;
 
-    DIRECTION_45 orig_start( aLine->CSegment( 0 ) );
-    DIRECTION_45 orig_end( aLine->CSegment( -1 ) );
+    MERGE_STEP ms;
 
-    restr.Build( m_world, aLine, aCurrentPath, m_restrictArea, m_restrictAreaActive );
+    ms.m_line = aLine;
+    ms.m_path = &aCurrentPath;
+    ms.m_step = step;
+    ms.m_costOrig = PNS_COST_ESTIMATOR::CornerCost( aCurrentPath );
+    ms.m_origStart = DIRECTION_45( aLine->CSegment( 0 ) );
+    ms.m_origEnd = DIRECTION_45( aLine->CSegment( -1 ) );
+    ms.m_restrictions.Build( m_world, aLine, aCurrentPath, m_restrictArea, m_restrictAreaActive );
 
-    while( n < n_segs - step )
-    {
-        const SEG s1    = aCurrentPath.CSegment( n );
-        const SEG s2    = aCurrentPath.CSegment( n + step );
+    int n_candidates = n_segs - step;
+    int batch = 1;
 
-        SHAPE_LINE_CHAIN path[2];
-        SHAPE_LINE_CHAIN* picked = NULL;
-        int cost[2];
+#ifdef USE_OPENMP
+    // one candidate per thread: the candidates following the picked one are wasted work
+    if( m_speculativeMerge && !omp_in_parallel() )
+        batch = omp_get_max_threads();
+#endif
 
-        for( int i = 0; i < 2; i++ )
-        {
-            bool postureMatch = true;
-            SHAPE_LINE_CHAIN bypass = DIRECTION_45().BuildInitialTrace( s1.A, s2.B, i );
-            cost[i] = INT_MAX;
+    std::vector<MERGE_CANDIDATE> candidates( batch );
+    std::vector<char> improves( batch );
 
-            bool restrictionsOK = restr.Check ( n, n + step + 1, bypass );
+    for( int first = 0; first < n_candidates; first += batch )
+    {
+        int count = std::min( batch, n_candidates - first );
 
-            if( n == 0 && orig_start != DIRECTION_45( bypass.CSegment( 0 ) ) )
-                postureMatch = false;
-            else if( n == n_segs - step && orig_end != DIRECTION_45( bypass.CSegment( -1 ) ) )
-                postureMatch = false;
+#ifdef USE_OPENMP
+        #pragma omp parallel for schedule(dynamic, 1) if( count > 1 )
+#endif
+        for( int i = 0; i < count; i++ )
+            improves[i] = mergeCandidate( ms, first + i, candidates[i] );
 
-            if( restrictionsOK && (postureMatch || !m_keepPostures) && !checkColliding( aLine, bypass ) )
+        // pick the first improving candidate, as a serial evaluation does
+        for( int i = 0; i < count; i++ )
+        {
+            if( candidates[i].m_queryArea )
+                mergeArea( m_queryArea, *candidates[i].m_queryArea );
+
+            if( improves[i] )
             {
-                path[i] = aCurrentPath;
-                path[i].Replace( s1.Index(), s2.Index(), bypass );
-                path[i].Simplify();
-                cost[i] = PNS_COST_ESTIMATOR::CornerCost( path[i] );
+                aCurrentPath = candidates[i].m_path;
+                return true;
             }
         }
+    }
+
+    return false;
+}
+
+
+bool PNS_OPTIMIZER::mergeCandidate( const MERGE_STEP& aStep, int aN,
+                                    MERGE_CANDIDATE& aResult ) const
+{
+    const SHAPE_LINE_CHAIN& currentPath = *aStep.m_path;
+    int n_segs = currentPath.SegmentCount();
+
+    const SEG s1    = currentPath.CSegment( aN );
+    const SEG s2    = currentPath.CSegment( aN + aStep.m_step );
+
+    SHAPE_LINE_CHAIN path[2];
+    int cost[2];
+
+    aResult.m_queryArea = OPT_BOX2I();
+
+    for( int i = 0; i < 2; i++ )
+    {
+        bool postureMatch = true;
+        SHAPE_LINE_CHAIN bypass = DIRECTION_45().BuildInitialTrace( s1.A, s2.B, i );
+        cost[i] = INT_MAX;
+
+        bool restrictionsOK = aStep.m_restrictions.Check( aN, aN + aStep.m_step + 1, bypass );
+
+        if( aN == 0 && aStep.m_origStart != DIRECTION_45( bypass.CSegment( 0 ) ) )
+            postureMatch = false;
+        else if( aN == n_segs - aStep.m_step &&
+                 aStep.m_origEnd != DIRECTION_45( bypass.CSegment( -1 ) ) )
+            postureMatch = false;
+
+        if( !restrictionsOK || !( postureMatch || !m_keepPostures ) )
+            continue;
+
+        // candidates may be evaluated concurrently: query the world directly instead
+        // of going through checkColliding(), which updates the optimizer state
+        PNS_LINE tmp( *aStep.m_line, bypass );
 
-        if( cost[0] < cost_orig && cost[0] < cost[1] )
-            picked = &path[0];
-        else if( cost[1] < cost_orig )
-            picked = &path[1];
+        mergeArea( aResult.m_queryArea, ItemArea( &tmp ) );
 
-        if( picked )
+        if( !m_world->CheckColliding( &tmp ) )
         {
-            n_segs = aCurrentPath.SegmentCount();
-            aCurrentPath = *picked;
-            return true;
+            path[i] = currentPath;
+            path[i].Replace( s1.Index(), s2.Index(), bypass );
+            path[i].Simplify();
+            cost[i] = PNS_COST_ESTIMATOR::CornerCost( path[i] );
         }
-
-        n++;
     }
 
-    return false;
+    if( cost[0] < aStep.m_costOrig && cost[0] < cost[1] )
+        aResult.m_path = path[0];
+    else if( cost[1] < aStep.m_costOrig )
+        aResult.m_path = path[1];
+    else
+        return false;
+
+    return true;
 }
 
 
@@ -801,14 +914,12 @@ PNS_OPTIMIZER::BREAKOUT_LIST PNS_OPTIMIZER::computeBreakouts( int aWidth,
 }
 
 
-PNS_ITEM* PNS_OPTIMIZER::findPadOrVia( int aLayer, int aNet, const VECTOR2I& aP ) const
+static PNS_ITEM* findPadOrVia( PNS_JOINT* aJoint )
 {
-    PNS_JOINT* jt = m_world->FindJoint( aP, aLayer, aNet );
-
-    if( !jt )
+    if( !aJoint )
         return NULL;
 
-    for( PNS_ITEM* item : jt->LinkList() )
+    for( PNS_ITEM* item : aJoint->LinkList() )
     {
         if( item->OfKind( PNS_ITEM::VIA | PNS_ITEM::SOLID ) )
             return item;
@@ -818,6 +929,19 @@ PNS_ITEM* PNS_OPTIMIZER::findPadOrVia( int aLayer, int aNet, const VECTOR2I& aP
 }
 
 
+void PNS_OPTIMIZER::findPadsOrVias( const PNS_LINE* aLine, PNS_ITEM*& aStartPad,
+                                    PNS_ITEM*& aEndPad ) const
+{
+    VECTOR2I ends[2] = { aLine->CPoint( 0 ), aLine->CPoint( -1 ) };
+    PNS_JOINT* joints[2];
+
+    m_world->FindJoints( ends, 2, aLine->Layer(), aLine->Net(), joints );
+
+    aStartPad = findPadOrVia( joints[0] );
+    aEndPad = findPadOrVia( joints[1] );
+}
+
+
 int PNS_OPTIMIZER::smartPadsSingle( PNS_LINE* aLine, PNS_ITEM* aPad, bool aEnd, int aEndVertex )
 {
     int min_cost = INT_MAX; // PNS_COST_ESTIMATOR::CornerCost( line );
@@ -932,10 +1056,10 @@ bool PNS_OPTIMIZER::runSmartPads( PNS_LINE* aLine )
     if( line.PointCount() < 3 )
         return false;
 
-    VECTOR2I p_start = line.CPoint( 0 ), p_end = line.CPoint( -1 );
+    PNS_ITEM* startPad;
+    PNS_ITEM* endPad;
 
-    PNS_ITEM* startPad = findPadOrVia( aLine->Layer(), aLine->Net(), p_start );
-    PNS_ITEM* endPad = findPadOrVia( aLine->Layer(), aLine->Net(), p_end );
+    findPadsOrVias( aLine, startPad, endPad );
 
     int vtx = -1;
 
@@ -969,8 +1093,10 @@ bool PNS_OPTIMIZER::fanoutCleanup( PNS_LINE* aLine )
 
     VECTOR2I p_start = aLine->CPoint( 0 ), p_end = aLine->CPoint( -1 );
 
-    PNS_ITEM* startPad = findPadOrVia( aLine->Layer(), aLine->Net(), p_start );
-    PNS_ITEM* endPad = findPadOrVia( aLine->Layer(), aLine->Net(), p_end );
+    PNS_ITEM* startPad;
+    PNS_ITEM* endPad;
+
+    findPadsOrVias( aLine, startPad, endPad );
 
     int thr = aLine->Width() * 10;
     int len = aLine->CLine().Length();
@@ -998,7 +1124,7 @@ bool PNS_OPTIMIZER::fanoutCleanup( PNS_LINE* aLine )
             PNS_LINE repl;
             repl = PNS_LINE( *aLine, l2 );
 
-            if( !m_world->CheckColliding( &repl ) )
+            if( !checkColliding( &repl ) )
             {
                 aLine->SetShape( repl.CLine() );
                 return true;
@@ -32,6 +32,7 @@ class PNS_NODE;
 class PNS_ROUTER;
 class PNS_LINE;
 class PNS_DIFF_PAIR;
+class PNS_ITEM;
 
 /**
  * Class PNS_COST_ESTIMATOR
@@ -126,12 +127,42 @@ public:
         m_restrictAreaActive = true;
     }
 
+    /**
+     * Function SetSpeculativeMerge()
+     *
+     * Enables the speculative evaluation of the segment merging candidates: all the
+     * candidates of a merge step are checked for collisions in parallel (if the router is
+     * built with OpenMP support), the first improving one being picked as in a serial
+     * evaluation. The results do not depend on the number of threads.
+     */
+    void SetSpeculativeMerge( bool aEnable )
+    {
+        m_speculativeMerge = aEnable;
+    }
+
+    /**
+     * Function QueryArea()
+     *
+     * Returns the area of the world read by the optimizations done so far: the lines
+     * being optimized and all the candidate paths checked for collisions. Items changing
+     * outside of this area can't change the results of these optimizations.
+     */
+    const OPT_BOX2I& QueryArea() const
+    {
+        return m_queryArea;
+    }
+
+    ///> Returns the area the collision checks of aItem cover (aItem with its width and via)
+    static BOX2I ItemArea( const PNS_ITEM* aItem );
+
 private:
     static const int MaxCachedItems = 256;
 
     typedef std::vector<SHAPE_LINE_CHAIN> BREAKOUT_LIST;
 
     struct CACHE_VISITOR;
+    struct MERGE_STEP;
+    struct MERGE_CANDIDATE;
 
     struct CACHED_ITEM
     {
@@ -144,6 +175,7 @@ private:
     bool removeUglyCorners( PNS_LINE* aLine );
     bool runSmartPads( PNS_LINE* aLine );
     bool mergeStep( PNS_LINE* aLine, SHAPE_LINE_CHAIN& aCurrentLine, int step );
+    bool mergeCandidate( const MERGE_STEP& aStep, int aN, MERGE_CANDIDATE& aResult ) const;
     bool fanoutCleanup( PNS_LINE * aLine );
     bool mergeDpSegments( PNS_DIFF_PAIR *aPair );
     bool mergeDpStep( PNS_DIFF_PAIR *aPair, bool aTryP, int step );
@@ -162,7 +194,8 @@ private:
 
     int smartPadsSingle( PNS_LINE* aLine, PNS_ITEM* aPad, bool aEnd, int aEndVertex );
 
-    PNS_ITEM* findPadOrVia( int aLayer, int aNet, const VECTOR2I& aP ) const;
+    ///> finds the pads or vias at both ends of aLine (NULL if none)
+    void findPadsOrVias( const PNS_LINE* aLine, PNS_ITEM*& aStartPad, PNS_ITEM*& aEndPad ) const;
 
     SHAPE_INDEX_LIST<PNS_ITEM*> m_cache;
 
@@ -172,6 +205,10 @@ private:
     int m_collisionKindMask;
     int m_effortLevel;
     bool m_keepPostures;
+    bool m_speculativeMerge;
+
+    ///> area read by the optimizations, see QueryArea()
+    OPT_BOX2I m_queryArea;
 
     BOX2I m_restrictArea;
     bool m_restrictAreaActive;
@@ -0,0 +1,128 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_PERF_H
+#define __PNS_PERF_H
+
+#include <atomic>
+#include <stdint.h>
+
+#include <profile.h>
+
+/**
+ * Class PNS_PERF
+ *
+ * Counts the calls of the inner loops of the router and the time spent in them, for
+ * the replay benchmark. Counting is disabled by default and then costs a single test
+ * per call. The counters are shared by all threads.
+ */
+class PNS_PERF
+{
+public:
+    enum COUNTER
+    {
+        SHOVE_ITERATION = 0,    ///< PNS_SHOVE::shoveIteration()
+        OPTIMIZER_PASS,         ///< PNS_OPTIMIZER::Optimize() of a single line
+        COUNTER_COUNT
+    };
+
+    static void Enable( bool aEnable )
+    {
+        enabled() = aEnable;
+    }
+
+    static bool Enabled()
+    {
+        return enabled().load( std::memory_order_relaxed );
+    }
+
+    ///> Clears all counters
+    static void Reset()
+    {
+        for( int i = 0; i < COUNTER_COUNT; i++ )
+        {
+            counters()[i].m_calls = 0;
+            counters()[i].m_usecs = 0;
+        }
+    }
+
+    ///> Returns the number of calls counted since the last Reset()
+    static int Calls( COUNTER aCounter )
+    {
+        return counters()[aCounter].m_calls;
+    }
+
+    ///> Returns the time spent in the counted calls since the last Reset(), in microseconds
+    static uint64_t Usecs( COUNTER aCounter )
+    {
+        return counters()[aCounter].m_usecs;
+    }
+
+    /**
+     * Class SCOPE
+     * Counts the enclosing block as a call of a counter.
+     */
+    class SCOPE
+    {
+    public:
+        SCOPE( COUNTER aCounter ) :
+            m_counter( aCounter ),
+            m_start( Enabled() ? get_tics() : 0 )
+        {
+        }
+
+        ~SCOPE()
+        {
+            if( !m_start )
+                return;
+
+            STAT& stat = counters()[m_counter];
+
+            stat.m_calls++;
+            stat.m_usecs += get_tics() - m_start;
+        }
+
+    private:
+        COUNTER m_counter;
+        uint64_t m_start;
+    };
+
+private:
+    struct STAT
+    {
+        std::atomic<int> m_calls;
+        std::atomic<uint64_t> m_usecs;
+    };
+
+    static std::atomic<bool>& enabled()
+    {
+        static std::atomic<bool> flag( false );
+
+        return flag;
+    }
+
+    static STAT* counters()
+    {
+        static STAT stats[COUNTER_COUNT];
+
+        return stats;
+    }
+};
+
+#endif    // __PNS_PERF_H
@@ -0,0 +1,282 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_POOL_H
+#define __PNS_POOL_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
+/**
+ * Class PNS_POOL
+ *
+ * Recycles the small memory blocks the router allocates and frees at a very high rate
+ * (items, nodes, joint and override hash entries): freed blocks are kept in free lists,
+ * one per size class, and are reused by the next allocations of the same size class.
+ * Branching and discarding nodes therefore does not go through the system allocator
+ * once the pool is warmed up.
+ *
+ * Free lists are per thread, so the pool needs no locking. A block may be freed
+ * by a thread other than the one which allocated it. Each thread keeps at most
+ * MaxFreeBytes of free blocks.
+ */
+class PNS_POOL
+{
+public:
+    static void* Alloc( size_t aSize )
+    {
+        if( aSize > MaxBlockSize )
+            return ::operator new( aSize );
+
+        FREE_LISTS& lists = freeLists();
+        int         sc = sizeClass( aSize );
+        BLOCK*      block = lists.m_head[sc];
+
+        if( !block )
+            return ::operator new( blockSize( sc ) );
+
+        lists.m_head[sc] = block->m_next;
+        lists.m_bytes -= blockSize( sc );
+
+        return block;
+    }
+
+    static void Free( void* aPtr, size_t aSize )
+    {
+        if( !aPtr )
+            return;
+
+        if( aSize > MaxBlockSize )
+        {
+            ::operator delete( aPtr );
+            return;
+        }
+
+        FREE_LISTS& lists = freeLists();
+        int         sc = sizeClass( aSize );
+
+        // don't keep an unbounded amount of memory after a large operation
+        if( lists.m_bytes + blockSize( sc ) > MaxFreeBytes )
+        {
+            ::operator delete( aPtr );
+            return;
+        }
+
+        BLOCK* block = static_cast<BLOCK*>( aPtr );
+
+        block->m_next = lists.m_head[sc];
+        lists.m_head[sc] = block;
+        lists.m_bytes += blockSize( sc );
+    }
+
+    /**
+     * Function ReleaseMemory()
+     *
+     * Returns the free blocks of the calling thread to the system.
+     */
+    static void ReleaseMemory()
+    {
+        freeLists().Clear();
+    }
+
+    /**
+     * Function ReleaseWorkerMemory()
+     *
+     * Returns the free blocks of the calling thread and of the OpenMP worker threads
+     * (e.g. the ones of the parallel shove and optimizer loops) to the system. Called at
+     * the end of a routing session. Does nothing in a parallel region: its threads release
+     * their memory when they are done (see PNS_BATCH_ROUTER).
+     */
+    static void ReleaseWorkerMemory()
+    {
+#ifdef USE_OPENMP
+        if( omp_in_parallel() )
+            return;
+
+        #pragma omp parallel
+        freeLists().Clear();
+#endif /* USE_OPENMP */
+
+        freeLists().Clear();
+    }
+
+private:
+    static const size_t Granularity     = 16;
+    static const size_t MaxBlockSize    = 512;
+    static const int    SizeClasses     = MaxBlockSize / Granularity;
+    static const size_t MaxFreeBytes    = 4 * 1024 * 1024;
+
+    struct BLOCK
+    {
+        BLOCK* m_next;
+    };
+
+    struct FREE_LISTS
+    {
+        FREE_LISTS()
+        {
+            for( int i = 0; i < SizeClasses; i++ )
+                m_head[i] = NULL;
+
+            m_bytes = 0;
+        }
+
+        ~FREE_LISTS()
+        {
+            Clear();
+        }
+
+        void Clear()
+        {
+            for( int i = 0; i < SizeClasses; i++ )
+            {
+                while( m_head[i] )
+                {
+                    BLOCK* next = m_head[i]->m_next;
+                    ::operator delete( m_head[i] );
+                    m_head[i] = next;
+                }
+            }
+
+            m_bytes = 0;
+        }
+
+        BLOCK*  m_head[SizeClasses];
+        size_t  m_bytes;            ///< size of the free blocks
+    };
+
+    static int sizeClass( size_t aSize )
+    {
+        return aSize ? ( aSize - 1 ) / Granularity : 0;
+    }
+
+    static size_t blockSize( int aSizeClass )
+    {
+        return ( aSizeClass + 1 ) * Granularity;
+    }
+
+    static FREE_LISTS& freeLists()
+    {
+        static thread_local FREE_LISTS lists;
+
+        return lists;
+    }
+};
+
+
+/**
+ * Class PNS_POOL_ALLOCATOR
+ *
+ * Standard allocator drawing single elements (e.g. hash table nodes) from PNS_POOL.
+ * Arrays (e.g. hash bucket tables) go to the system allocator.
+ */
+template <class T>
+class PNS_POOL_ALLOCATOR
+{
+public:
+    typedef T               value_type;
+    typedef T*              pointer;
+    typedef const T*        const_pointer;
+    typedef T&              reference;
+    typedef const T&        const_reference;
+    typedef size_t          size_type;
+    typedef ptrdiff_t       difference_type;
+
+    template <class U>
+    struct rebind
+    {
+        typedef PNS_POOL_ALLOCATOR<U> other;
+    };
+
+    PNS_POOL_ALLOCATOR() {}
+
+    template <class U>
+    PNS_POOL_ALLOCATOR( const PNS_POOL_ALLOCATOR<U>& ) {}
+
+    pointer allocate( size_type aCount, const void* = 0 )
+    {
+        if( aCount == 1 )
+            return static_cast<pointer>( PNS_POOL::Alloc( sizeof( T ) ) );
+
+        return static_cast<pointer>( ::operator new( aCount * sizeof( T ) ) );
+    }
+
+    void deallocate( pointer aPtr, size_type aCount )
+    {
+        if( aCount == 1 )
+            PNS_POOL::Free( aPtr, sizeof( T ) );
+        else
+            ::operator delete( aPtr );
+    }
+
+    size_type max_size() const
+    {
+        return size_type( -1 ) / sizeof( T );
+    }
+
+    template <class U, class... ARGS>
+    void construct( U* aPtr, ARGS&&... aArgs )
+    {
+        ::new( (void*) aPtr ) U( std::forward<ARGS>( aArgs )... );
+    }
+
+    template <class U>
+    void destroy( U* aPtr )
+    {
+        aPtr->~U();
+    }
+
+    pointer address( reference aRef ) const { return &aRef; }
+    const_pointer address( const_reference aRef ) const { return &aRef; }
+};
+
+
+template <class T, class U>
+inline bool operator==( const PNS_POOL_ALLOCATOR<T>&, const PNS_POOL_ALLOCATOR<U>& )
+{
+    return true;
+}
+
+
+template <class T, class U>
+inline bool operator!=( const PNS_POOL_ALLOCATOR<T>&, const PNS_POOL_ALLOCATOR<U>& )
+{
+    return false;
+}
+
+
+///> Declares class-specific operator new/delete allocating the objects of the class (and
+///> of the derived classes) from PNS_POOL. The class must have a virtual destructor if
+///> objects of derived classes are deleted through a pointer to it.
+#define PNS_POOLED_ALLOCATION                                       \
+    static void* operator new( size_t aSize )                       \
+    {                                                               \
+        return PNS_POOL::Alloc( aSize );                            \
+    }                                                               \
+    static void operator delete( void* aPtr, size_t aSize )         \
+    {                                                               \
+        PNS_POOL::Free( aPtr, aSize );                              \
+    }
+
+#endif    // __PNS_POOL_H
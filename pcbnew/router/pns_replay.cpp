@@ -0,0 +1,272 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <algorithm>
+
+#include <wx/filename.h>
+
+#include <profile.h>
+#include <class_board.h>
+#include <io_mgr.h>
+
+#include "trace.h"
+#include "pns_replay.h"
+#include "pns_router.h"
+#include "pns_perf.h"
+
+static const char* eventNames[] =
+{
+    "start", "drag", "move", "fix", "stop", "layer", "via", "posture", "ortho", "mode",
+    "settings", "sizes"
+};
+
+
+PNS_REPLAY::PNS_REPLAY() :
+    m_board( NULL )
+{
+}
+
+
+PNS_REPLAY::~PNS_REPLAY()
+{
+    delete m_board;
+}
+
+
+bool PNS_REPLAY::Load( const std::string& aLogFile )
+{
+    std::string boardName;
+
+    if( !PNS_LOGGER::LoadSession( aLogFile, boardName, m_events ) || boardName.empty() )
+        return false;
+
+    // the board snapshot is saved next to the log
+    wxFileName boardFile( wxString::FromUTF8( boardName.c_str() ) );
+    boardFile.MakeAbsolute( wxFileName( wxString::FromUTF8( aLogFile.c_str() ) ).GetPath() );
+
+    delete m_board;
+    m_board = NULL;
+
+    try
+    {
+        m_board = IO_MGR::Load( IO_MGR::KICAD, boardFile.GetFullPath() );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        TRACE( 0, "can't load the board snapshot: %s", (const char*) ioe.errorText.mb_str() );
+        return false;
+    }
+
+    return m_board != NULL;
+}
+
+
+double PNS_REPLAY::Run()
+{
+    double total = 0.0;
+    bool perfEnabled = PNS_PERF::Enabled();
+
+    m_calls.clear();
+
+    if( !m_board )
+        return total;
+
+    PNS_ROUTER router;
+
+    router.SetBoard( m_board );
+    router.SyncWorld();
+
+    // keep the routed tracks in the world: the board stays as loaded
+    router.SetDeferredCommit( true );
+
+    PNS_PERF::Enable( true );
+
+    for( const PNS_LOGGER::EVENT& evt : m_events )
+    {
+        // settings are applied before the calls which use them, they are not measured
+        if( evt.m_type == PNS_LOGGER::EVT_SETTINGS || evt.m_type == PNS_LOGGER::EVT_MODE )
+        {
+            replayEvent( router, evt );
+            continue;
+        }
+
+        CALL call;
+        prof_counter cnt;
+
+        PNS_PERF::Reset();
+
+        prof_start( &cnt );
+        replayEvent( router, evt );
+        prof_end( &cnt );
+
+        call.m_type = evt.m_type;
+        call.m_time = cnt.msecs();
+        call.m_shoveIterations = PNS_PERF::Calls( PNS_PERF::SHOVE_ITERATION );
+        call.m_shoveTime = PNS_PERF::Usecs( PNS_PERF::SHOVE_ITERATION ) / 1000.0;
+        call.m_optimizerPasses = PNS_PERF::Calls( PNS_PERF::OPTIMIZER_PASS );
+        call.m_optimizerTime = PNS_PERF::Usecs( PNS_PERF::OPTIMIZER_PASS ) / 1000.0;
+
+        m_calls.push_back( call );
+        total += call.m_time;
+    }
+
+    router.StopRouting();
+    router.DiscardCommits();
+
+    PNS_PERF::Enable( perfEnabled );
+
+    return total;
+}
+
+
+void PNS_REPLAY::replayEvent( PNS_ROUTER& aRouter, const PNS_LOGGER::EVENT& aEvent )
+{
+    switch( aEvent.m_type )
+    {
+    case PNS_LOGGER::EVT_START_ROUTE:
+        aRouter.StartRouting( aEvent.m_p, pickItem( aRouter, aEvent ), aEvent.m_arg );
+        break;
+
+    case PNS_LOGGER::EVT_START_DRAG:
+        aRouter.StartDragging( aEvent.m_p, pickItem( aRouter, aEvent ) );
+        break;
+
+    case PNS_LOGGER::EVT_MOVE:
+        aRouter.Move( aEvent.m_p, pickItem( aRouter, aEvent ) );
+        break;
+
+    case PNS_LOGGER::EVT_FIX:
+        aRouter.FixRoute( aEvent.m_p, pickItem( aRouter, aEvent ) );
+        break;
+
+    case PNS_LOGGER::EVT_STOP:
+        aRouter.StopRouting();
+        break;
+
+    case PNS_LOGGER::EVT_SWITCH_LAYER:
+        aRouter.SwitchLayer( aEvent.m_arg );
+        break;
+
+    case PNS_LOGGER::EVT_TOGGLE_VIA:
+        aRouter.ToggleViaPlacement();
+        break;
+
+    case PNS_LOGGER::EVT_FLIP_POSTURE:
+        aRouter.FlipPosture();
+        break;
+
+    case PNS_LOGGER::EVT_ORTHO_MODE:
+        aRouter.SetOrthoMode( aEvent.m_arg );
+        break;
+
+    case PNS_LOGGER::EVT_MODE:
+        aRouter.SetMode( (PNS_ROUTER_MODE) aEvent.m_arg );
+        break;
+
+    case PNS_LOGGER::EVT_SETTINGS:
+        aRouter.LoadSettings( aEvent.m_settings );
+        break;
+
+    case PNS_LOGGER::EVT_SIZES:
+        aRouter.UpdateSizes( aEvent.m_sizes );
+        break;
+    }
+}
+
+
+PNS_ITEM* PNS_REPLAY::pickItem( PNS_ROUTER& aRouter, const PNS_LOGGER::EVENT& aEvent ) const
+{
+    if( !aEvent.m_itemKind )
+        return NULL;
+
+    // the dragger doesn't look for items under the cursor
+    if( aRouter.RoutingInProgress() && !aRouter.Placer() )
+        return NULL;
+
+    PNS_ITEMSET candidates = aRouter.QueryHoverItems( aEvent.m_p );
+
+    for( PNS_ITEM* item : candidates.Items() )
+    {
+        if( item->Kind() == aEvent.m_itemKind && item->Net() == aEvent.m_itemNet &&
+            item->Layers().Start() == aEvent.m_itemLayerStart &&
+            item->Layers().End() == aEvent.m_itemLayerEnd )
+            return item;
+    }
+
+    return NULL;
+}
+
+
+std::string PNS_REPLAY::Report() const
+{
+    const int typeCount = sizeof( eventNames ) / sizeof( eventNames[0] );
+
+    std::vector<CALL> sums( typeCount );
+    std::vector<int> counts( typeCount, 0 );
+    std::vector<double> maxTimes( typeCount, 0.0 );
+
+    for( int i = 0; i < typeCount; i++ )
+    {
+        sums[i].m_type = i;
+        sums[i].m_time = 0.0;
+        sums[i].m_shoveIterations = 0;
+        sums[i].m_shoveTime = 0.0;
+        sums[i].m_optimizerPasses = 0;
+        sums[i].m_optimizerTime = 0.0;
+    }
+
+    for( const CALL& call : m_calls )
+    {
+        CALL& sum = sums[call.m_type];
+
+        sum.m_time += call.m_time;
+        sum.m_shoveIterations += call.m_shoveIterations;
+        sum.m_shoveTime += call.m_shoveTime;
+        sum.m_optimizerPasses += call.m_optimizerPasses;
+        sum.m_optimizerTime += call.m_optimizerTime;
+        counts[call.m_type]++;
+        maxTimes[call.m_type] = std::max( maxTimes[call.m_type], call.m_time );
+    }
+
+    std::string report;
+    char line[256];
+
+    snprintf( line, sizeof( line ), "%-10s %8s %12s %10s %10s %10s %12s %10s %12s\n",
+              "call", "count", "total [ms]", "avg [ms]", "max [ms]", "shove it.",
+              "shove [ms]", "opt. pass", "opt. [ms]" );
+    report += line;
+
+    for( int i = 0; i < typeCount; i++ )
+    {
+        const CALL& sum = sums[i];
+
+        if( !counts[i] )
+            continue;
+
+        snprintf( line, sizeof( line ),
+                  "%-10s %8d %12.3f %10.3f %10.3f %10d %12.3f %10d %12.3f\n",
+                  eventNames[i], counts[i], sum.m_time, sum.m_time / counts[i], maxTimes[i],
+                  sum.m_shoveIterations, sum.m_shoveTime, sum.m_optimizerPasses,
+                  sum.m_optimizerTime );
+        report += line;
+    }
+
+    return report;
+}
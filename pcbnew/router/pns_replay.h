@@ -0,0 +1,135 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __PNS_REPLAY_H
+#define __PNS_REPLAY_H
+
+#include <string>
+#include <vector>
+
+#include "pns_logger.h"
+
+class BOARD;
+class PNS_ROUTER;
+class PNS_ITEM;
+
+/**
+ * Class PNS_REPLAY
+ *
+ * Replays a routing session recorded by PNS_ROUTER::StartRecording() on the board
+ * snapshot of the session, without any view, and measures each router call: its
+ * duration, and the iterations of the shove algorithm and the optimizer passes it made.
+ * The changes made by the session are kept in the world of the router only, so the
+ * board is left untouched and the session can be replayed several times.
+ */
+class PNS_REPLAY
+{
+public:
+    PNS_REPLAY();
+    ~PNS_REPLAY();
+
+    /**
+     * Function Load()
+     * Reads a session log and loads the board snapshot it refers to.
+     * @param aLogFile is the log file (see PNS_ROUTER::StartRecording()).
+     * @return false if the log or the board can't be read.
+     */
+    bool Load( const std::string& aLogFile );
+
+    BOARD* GetBoard() const
+    {
+        return m_board;
+    }
+
+    int GetEventCount() const
+    {
+        return m_events.size();
+    }
+
+    /**
+     * Function Run()
+     * Replays the whole session.
+     * @return the time spent in the router calls, in milliseconds.
+     */
+    double Run();
+
+    ///> Returns the number of router calls measured by the last Run()
+    int GetCallCount() const
+    {
+        return m_calls.size();
+    }
+
+    ///> Returns the PNS_LOGGER::EVENT_TYPE of the aIndex-th call
+    int GetCallType( int aIndex ) const
+    {
+        return m_calls[aIndex].m_type;
+    }
+
+    ///> Returns the duration of the aIndex-th call, in milliseconds
+    double GetCallTime( int aIndex ) const
+    {
+        return m_calls[aIndex].m_time;
+    }
+
+    int GetShoveIterations( int aIndex ) const
+    {
+        return m_calls[aIndex].m_shoveIterations;
+    }
+
+    ///> Returns the time spent in shove iterations by the aIndex-th call, in milliseconds
+    double GetShoveTime( int aIndex ) const
+    {
+        return m_calls[aIndex].m_shoveTime;
+    }
+
+    int GetOptimizerPasses( int aIndex ) const
+    {
+        return m_calls[aIndex].m_optimizerPasses;
+    }
+
+    ///> Returns the time spent in optimizer passes by the aIndex-th call, in milliseconds
+    double GetOptimizerTime( int aIndex ) const
+    {
+        return m_calls[aIndex].m_optimizerTime;
+    }
+
+    ///> Returns a table of the calls of the last Run(), summed up by call type
+    std::string Report() const;
+
+private:
+    struct CALL
+    {
+        int m_type;
+        double m_time;
+        int m_shoveIterations;
+        double m_shoveTime;
+        int m_optimizerPasses;
+        double m_optimizerTime;
+    };
+
+    void replayEvent( PNS_ROUTER& aRouter, const PNS_LOGGER::EVENT& aEvent );
+
+    PNS_ITEM* pickItem( PNS_ROUTER& aRouter, const PNS_LOGGER::EVENT& aEvent ) const;
+
+    BOARD* m_board;
+    std::vector<PNS_LOGGER::EVENT> m_events;
+    std::vector<CALL> m_calls;
+};
+
+#endif    // __PNS_REPLAY_H
@@ -0,0 +1,95 @@
+/*
+ * KiRouter - a push-and-(sometimes-)shove PCB router
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replays a routing session recorded by the interactive router (DEBUG builds: press '9'
+ * in the router tool to start and stop the recording) and prints the time spent in each
+ * kind of router call.  The standalone version of scripting/examples/replaySession.py.
+ *
+ * usage: pns_replay session.log [runs] [-v]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <wx/init.h>
+
+#include "pns_replay.h"
+
+
+int main( int argc, char** argv )
+{
+    wxInitializer initializer;
+
+    if( !initializer )
+    {
+        fprintf( stderr, "can't initialize wxWidgets\n" );
+        return 1;
+    }
+
+    if( argc < 2 )
+    {
+        fprintf( stderr, "usage: %s session.log [runs] [-v]\n", argv[0] );
+        return 1;
+    }
+
+    int runs = 1;
+    bool verbose = false;
+
+    for( int i = 2; i < argc; i++ )
+    {
+        if( !strcmp( argv[i], "-v" ) )
+            verbose = true;
+        else
+            runs = atoi( argv[i] );
+    }
+
+    PNS_REPLAY replay;
+
+    if( !replay.Load( argv[1] ) )
+    {
+        fprintf( stderr, "can't load the session %s\n", argv[1] );
+        return 1;
+    }
+
+    for( int run = 0; run < runs; run++ )
+    {
+        double total = replay.Run();
+        printf( "run %d: %d calls in %.3f ms\n", run, replay.GetCallCount(), total );
+    }
+
+    if( verbose )
+    {
+        printf( "%6s %6s %10s %6s %10s %6s %10s\n",
+                "call", "type", "time", "shove", "shove t.", "opt.", "opt. t." );
+
+        for( int i = 0; i < replay.GetCallCount(); i++ )
+        {
+            printf( "%6d %6d %10.3f %6d %10.3f %6d %10.3f\n",
+                    i, replay.GetCallType( i ), replay.GetCallTime( i ),
+                    replay.GetShoveIterations( i ), replay.GetShoveTime( i ),
+                    replay.GetOptimizerPasses( i ), replay.GetOptimizerTime( i ) );
+        }
+    }
+
+    printf( "%s", replay.Report().c_str() );
+
+    return 0;
+}
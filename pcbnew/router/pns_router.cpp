@@ -20,6 +20,9 @@
 
 #include <cstdio>
 #include <vector>
+#include <algorithm>
+
+#include <wx/filename.h>
 
 #include <view/view.h>
 #include <view/view_item.h>
@@ -49,6 +52,7 @@
 #include "pns_meander_placer.h"
 #include "pns_meander_skew_placer.h"
 #include "pns_dp_meander_placer.h"
+#include "pns_pool.h"
 
 #include <router/router_preview_item.h>
 
@@ -56,14 +60,16 @@
 #include <class_board_connected_item.h>
 #include <class_module.h>
 #include <class_track.h>
+#include <io_mgr.h>
 #include <ratsnest_data.h>
 #include <layers_id_colors_and_visibility.h>
 #include <geometry/convex_hull.h>
 
 
 // an ugly singleton for drawing debug items within the router context.
-// To be fixed sometime in the future.
-static PNS_ROUTER* theRouter;
+// To be fixed sometime in the future. Kept per thread, so that routers working
+// on different threads (batch routing) don't step on each other.
+static thread_local PNS_ROUTER* theRouter;
 
 
 PNS_PCBNEW_CLEARANCE_FUNC::PNS_PCBNEW_CLEARANCE_FUNC( PNS_ROUTER* aRouter ) :
@@ -480,6 +486,7 @@ void PNS_ROUTER::SyncWorld()
 
 PNS_ROUTER::PNS_ROUTER()
 {
+    m_prevInstance = theRouter;
     theRouter = this;
 
     m_clearanceFunc = NULL;
@@ -502,7 +509,8 @@ PNS_ROUTER::PNS_ROUTER()
     m_snappingEnabled  = false;
     m_violation = false;
     m_gridHelper = NULL;
-
+    m_deferredCommit = false;
+    m_sessionLog = NULL;
 }
 
 
@@ -530,8 +538,11 @@ PNS_ROUTER* PNS_ROUTER::GetInstance()
 
 PNS_ROUTER::~PNS_ROUTER()
 {
+    StopRecording();
     ClearWorld();
-    theRouter = NULL;
+
+    if( theRouter == this )
+        theRouter = m_prevInstance;
 
     if( m_previewItems )
         delete m_previewItems;
@@ -555,6 +566,9 @@ void PNS_ROUTER::ClearWorld()
     if( m_previewItems )
         delete m_previewItems;
 
+    // queued commits refer to the items of the world
+    m_pendingCommits.clear();
+
     m_clearanceFunc = NULL;
     m_world = NULL;
     m_placer = NULL;
@@ -613,6 +627,11 @@ const VECTOR2I PNS_ROUTER::SnapToItem( PNS_ITEM* aItem, VECTOR2I aP, bool& aSpli
             anchor = s.A;
         else if( ( aP - s.B ).EuclideanNorm() < w / 2 )
             anchor = s.B;
+        else if( !m_gridHelper )
+        {
+            anchor = s.NearestPoint( aP );
+            aSplitsSegment = ( anchor != s.A && anchor != s.B );
+        }
         else
         {
             anchor = m_gridHelper->AlignToSegment ( aP, s );
@@ -632,6 +651,13 @@ const VECTOR2I PNS_ROUTER::SnapToItem( PNS_ITEM* aItem, VECTOR2I aP, bool& aSpli
 
 bool PNS_ROUTER::StartDragging( const VECTOR2I& aP, PNS_ITEM* aStartItem )
 {
+    if( m_sessionLog )
+    {
+        logEvent( PNS_LOGGER::EVT_SETTINGS );
+        logEvent( PNS_LOGGER::EVT_SIZES );
+        logEvent( PNS_LOGGER::EVT_START_DRAG, aP, aStartItem );
+    }
+
     if( !aStartItem || aStartItem->OfKind( PNS_ITEM::SOLID ) )
         return false;
 
@@ -652,6 +678,14 @@ bool PNS_ROUTER::StartDragging( const VECTOR2I& aP, PNS_ITEM* aStartItem )
 
 bool PNS_ROUTER::StartRouting( const VECTOR2I& aP, PNS_ITEM* aStartItem, int aLayer )
 {
+    if( m_sessionLog )
+    {
+        logEvent( PNS_LOGGER::EVT_MODE, VECTOR2I(), NULL, m_mode );
+        logEvent( PNS_LOGGER::EVT_SETTINGS );
+        logEvent( PNS_LOGGER::EVT_SIZES );
+        logEvent( PNS_LOGGER::EVT_START_ROUTE, aP, aStartItem, aLayer );
+    }
+
     m_clearanceFunc->UseDpGap( false );
 
     switch( m_mode )
@@ -716,6 +750,9 @@ void PNS_ROUTER::eraseView()
 
 void PNS_ROUTER::DisplayItem( const PNS_ITEM* aItem, int aColor, int aClearance )
 {
+    if( !m_previewItems )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( aItem, m_previewItems );
 
     if( aColor >= 0 )
@@ -740,6 +777,9 @@ void PNS_ROUTER::DisplayItems( const PNS_ITEMSET& aItems )
 
 void PNS_ROUTER::DisplayDebugLine( const SHAPE_LINE_CHAIN& aLine, int aType, int aWidth )
 {
+    if( !m_previewItems )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( NULL, m_previewItems );
 
     pitem->Line( aLine, aWidth, aType );
@@ -749,8 +789,74 @@ void PNS_ROUTER::DisplayDebugLine( const SHAPE_LINE_CHAIN& aLine, int aType, int
 }
 
 
+// The debug drawing helpers of pns_utils.h are defined here, so the geometry helpers
+// of pns_utils.cpp do not depend on the router instance.
+void DrawDebugPoint( VECTOR2I aP, int aColor )
+{
+    SHAPE_LINE_CHAIN l;
+
+    l.Append( aP - VECTOR2I( -50000, -50000 ) );
+    l.Append( aP + VECTOR2I( -50000, -50000 ) );
+
+    PNS_ROUTER::GetInstance()->DisplayDebugLine ( l, aColor, 10000 );
+
+    l.Clear();
+    l.Append( aP - VECTOR2I( 50000, -50000 ) );
+    l.Append( aP + VECTOR2I( 50000, -50000 ) );
+
+    PNS_ROUTER::GetInstance()->DisplayDebugLine( l, aColor, 10000 );
+}
+
+
+void DrawDebugBox( BOX2I aB, int aColor )
+{
+    SHAPE_LINE_CHAIN l;
+
+    VECTOR2I o = aB.GetOrigin();
+    VECTOR2I s = aB.GetSize();
+
+    l.Append( o );
+    l.Append( o.x + s.x, o.y );
+    l.Append( o.x + s.x, o.y + s.y );
+    l.Append( o.x, o.y + s.y );
+    l.Append( o );
+
+    PNS_ROUTER::GetInstance()->DisplayDebugLine( l, aColor, 10000 );
+}
+
+
+void DrawDebugSeg( SEG aS, int aColor )
+{
+    SHAPE_LINE_CHAIN l;
+
+    l.Append( aS.A );
+    l.Append( aS.B );
+
+    PNS_ROUTER::GetInstance()->DisplayDebugLine( l, aColor, 10000 );
+}
+
+
+void DrawDebugDirs( VECTOR2D aP, int aMask, int aColor )
+{
+    BOX2I b( aP - VECTOR2I( 10000, 10000 ), VECTOR2I( 20000, 20000 ) );
+
+    DrawDebugBox( b, aColor );
+    for( int i = 0; i < 8; i++ )
+    {
+        if( ( 1 << i ) & aMask )
+        {
+            VECTOR2I v = DIRECTION_45( ( DIRECTION_45::Directions ) i ).ToVector() * 100000;
+            DrawDebugSeg( SEG( aP, aP + v ), aColor );
+        }
+    }
+}
+
+
 void PNS_ROUTER::DisplayDebugPoint( const VECTOR2I aPos, int aType )
 {
+    if( !m_previewItems )
+        return;
+
     ROUTER_PREVIEW_ITEM* pitem = new ROUTER_PREVIEW_ITEM( NULL, m_previewItems );
 
     pitem->Point( aPos, aType );
@@ -762,6 +868,9 @@ void PNS_ROUTER::DisplayDebugPoint( const VECTOR2I aPos, int aType )
 
 void PNS_ROUTER::Move( const VECTOR2I& aP, PNS_ITEM* endItem )
 {
+    if( m_sessionLog )
+        logEvent( PNS_LOGGER::EVT_MOVE, aP, endItem );
+
     m_currentEnd = aP;
 
     switch( m_state )
@@ -828,7 +937,7 @@ void PNS_ROUTER::updateView( PNS_NODE* aNode, PNS_ITEMSET& aCurrent )
     PNS_NODE::ITEM_VECTOR removed, added;
     PNS_NODE::OBSTACLES obstacles;
 
-    if( !aNode )
+    if( !aNode || !m_view )
         return;
 
     if( Settings().Mode() == RM_MarkObstacles )
@@ -861,6 +970,9 @@ void PNS_ROUTER::UpdateSizes ( const PNS_SIZES_SETTINGS& aSizes )
 {
     m_sizes = aSizes;
 
+    if( m_sessionLog )
+        logEvent( PNS_LOGGER::EVT_SIZES );
+
     // Change track/via size settings
     if( m_state == ROUTE_TRACK)
     {
@@ -897,22 +1009,101 @@ void PNS_ROUTER::movePlacing( const VECTOR2I& aP, PNS_ITEM* aEndItem )
 void PNS_ROUTER::CommitRouting( PNS_NODE* aNode )
 {
     PNS_NODE::ITEM_VECTOR removed, added;
+    std::vector<BOARD_CONNECTED_ITEM*> removedParents;
 
     aNode->GetUpdatedItems( removed, added );
 
-    for( unsigned int i = 0; i < removed.size(); i++ )
+    for( PNS_ITEM* item : removed )
+    {
+        if( item->Parent() )
+        {
+            removedParents.push_back( item->Parent() );
+        }
+        else
+        {
+            // an item added by a commit which is still queued: it never reaches the board
+            for( PENDING_COMMIT& commit : m_pendingCommits )
+            {
+                PNS_NODE::ITEM_VECTOR::iterator i =
+                    std::find( commit.m_added.begin(), commit.m_added.end(), item );
+
+                if( i != commit.m_added.end() )
+                    commit.m_added.erase( i );
+            }
+        }
+    }
+
+    if( m_deferredCommit )
     {
-        BOARD_CONNECTED_ITEM* parent = removed[i]->Parent();
+        PENDING_COMMIT commit;
 
-        if( parent )
+        commit.m_removed = removedParents;
+        commit.m_added = added;
+        m_pendingCommits.push_back( commit );
+    }
+    else
+    {
+        commitToBoard( removedParents, added );
+        m_board->GetRatsnest()->Recalculate();
+    }
+
+    m_world->Commit( aNode );
+}
+
+
+void PNS_ROUTER::DiscardCommits( int aFirst )
+{
+    // take the changes of the dropped commits back from the world, the last one first.
+    // The items they added are still alive: the ones removed by a later commit were
+    // erased from m_added by CommitRouting().
+    for( int i = (int) m_pendingCommits.size() - 1; i >= aFirst; i-- )
+    {
+        const PENDING_COMMIT& commit = m_pendingCommits[i];
+
+        for( PNS_ITEM* item : commit.m_added )
+            m_world->Remove( item );
+
+        // the board is untouched in deferred commit mode: the removed items are still there
+        for( BOARD_CONNECTED_ITEM* parent : commit.m_removed )
         {
-            m_view->Remove( parent );
-            m_board->Remove( parent );
-            m_undoBuffer.PushItem( ITEM_PICKER( parent, UR_DELETED ) );
+            PNS_ITEM* item = NULL;
+
+            if( parent->Type() == PCB_TRACE_T )
+                item = syncTrack( static_cast<TRACK*>( parent ) );
+            else if( parent->Type() == PCB_VIA_T )
+                item = syncVia( static_cast<VIA*>( parent ) );
+
+            if( item )
+                m_world->Add( item );
         }
     }
 
-    for( PNS_ITEM* item : added )
+    m_pendingCommits.resize( aFirst );
+}
+
+
+void PNS_ROUTER::FlushCommits()
+{
+    for( const PENDING_COMMIT& commit : m_pendingCommits )
+        commitToBoard( commit.m_removed, commit.m_added );
+
+    m_pendingCommits.clear();
+}
+
+
+void PNS_ROUTER::commitToBoard( const std::vector<BOARD_CONNECTED_ITEM*>& aRemoved,
+                                const PNS_NODE::ITEM_VECTOR& aAdded )
+{
+    for( BOARD_CONNECTED_ITEM* parent : aRemoved )
+    {
+        if( m_view )
+            m_view->Remove( parent );
+
+        m_board->Remove( parent );
+        m_undoBuffer.PushItem( ITEM_PICKER( parent, UR_DELETED ) );
+    }
+
+    for( PNS_ITEM* item : aAdded )
     {
         BOARD_CONNECTED_ITEM* newBI = NULL;
 
@@ -956,15 +1147,15 @@ void PNS_ROUTER::CommitRouting( PNS_NODE* aNode )
         {
             item->SetParent( newBI );
             newBI->ClearFlags();
-            m_view->Add( newBI );
+
+            if( m_view )
+                m_view->Add( newBI );
+
             m_board->Add( newBI );
             m_undoBuffer.PushItem( ITEM_PICKER( newBI, UR_NEW ) );
             newBI->ViewUpdate( KIGFX::VIEW_ITEM::GEOMETRY );
         }
     }
-
-    m_board->GetRatsnest()->Recalculate();
-    m_world->Commit( aNode );
 }
 
 
@@ -972,6 +1163,9 @@ bool PNS_ROUTER::FixRoute( const VECTOR2I& aP, PNS_ITEM* aEndItem )
 {
     bool rv = false;
 
+    if( m_sessionLog )
+        logEvent( PNS_LOGGER::EVT_FIX, aP, aEndItem );
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -995,9 +1189,12 @@ bool PNS_ROUTER::FixRoute( const VECTOR2I& aP, PNS_ITEM* aEndItem )
 
 void PNS_ROUTER::StopRouting()
 {
-    // Update the ratsnest with new changes
+    if( m_sessionLog )
+        logEvent( PNS_LOGGER::EVT_STOP );
 
-    if( m_placer )
+    // Update the ratsnest with new changes
+    // (in deferred commit mode, the board is not modified yet)
+    if( m_placer && !m_deferredCommit )
     {
         std::vector<int> nets;
         m_placer->GetModifiedNets( nets );
@@ -1026,11 +1223,17 @@ void PNS_ROUTER::StopRouting()
     m_state = IDLE;
     m_world->KillChildren();
     m_world->ClearRanks();
+
+    // the branches of the routing session are gone: give their memory back
+    PNS_POOL::ReleaseWorkerMemory();
 }
 
 
 void PNS_ROUTER::FlipPosture()
 {
+    if( m_sessionLog )
+        logEvent( PNS_LOGGER::EVT_FLIP_POSTURE );
+
     if( m_state == ROUTE_TRACK )
     {
         m_placer->FlipPosture();
@@ -1040,6 +1243,9 @@ void PNS_ROUTER::FlipPosture()
 
 void PNS_ROUTER::SwitchLayer( int aLayer )
 {
+    if( m_sessionLog )
+        logEvent( PNS_LOGGER::EVT_SWITCH_LAYER, VECTOR2I(), NULL, aLayer );
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -1053,6 +1259,9 @@ void PNS_ROUTER::SwitchLayer( int aLayer )
 
 void PNS_ROUTER::ToggleViaPlacement()
 {
+    if( m_sessionLog )
+        logEvent( PNS_LOGGER::EVT_TOGGLE_VIA );
+
     if( m_state == ROUTE_TRACK )
     {
         bool toggle = !m_placer->IsPlacingVia();
@@ -1101,6 +1310,56 @@ void PNS_ROUTER::DumpLog()
 }
 
 
+bool PNS_ROUTER::StartRecording( const std::string& aBaseName )
+{
+    StopRecording();
+
+    wxFileName boardFile( wxString::FromUTF8( aBaseName.c_str() ) + wxT( ".kicad_pcb" ) );
+
+    try
+    {
+        IO_MGR::Save( IO_MGR::KICAD, boardFile.GetFullPath(), m_board );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        TRACE( 0, "can't save the board snapshot: %s", (const char*) ioe.errorText.mb_str() );
+        return false;
+    }
+
+    m_sessionLog = new PNS_LOGGER;
+    m_sessionLogFile = aBaseName + ".log";
+
+    // the snapshot is looked for next to the log
+    m_sessionLog->LogBoard( (const char*) boardFile.GetFullName().utf8_str() );
+
+    return true;
+}
+
+
+void PNS_ROUTER::StopRecording()
+{
+    if( !m_sessionLog )
+        return;
+
+    m_sessionLog->Save( m_sessionLogFile );
+
+    delete m_sessionLog;
+    m_sessionLog = NULL;
+}
+
+
+void PNS_ROUTER::logEvent( PNS_LOGGER::EVENT_TYPE aType, const VECTOR2I& aP,
+                           const PNS_ITEM* aItem, int aArg )
+{
+    PNS_LOGGER::EVENT evt( aType, aP, aItem, aArg );
+
+    evt.m_settings = m_settings;
+    evt.m_sizes = m_sizes;
+
+    m_sessionLog->LogEvent( evt );
+}
+
+
 bool PNS_ROUTER::IsPlacingVia() const
 {
     if( !m_placer )
@@ -1112,6 +1371,9 @@ bool PNS_ROUTER::IsPlacingVia() const
 
 void PNS_ROUTER::SetOrthoMode( bool aEnable )
 {
+    if( m_sessionLog )
+        logEvent( PNS_LOGGER::EVT_ORTHO_MODE, VECTOR2I(), NULL, aEnable );
+
     if( !m_placer )
         return;
 
@@ -34,6 +34,7 @@
 #include "pns_item.h"
 #include "pns_itemset.h"
 #include "pns_node.h"
+#include "pns_logger.h"
 
 class BOARD;
 class BOARD_ITEM;
@@ -92,6 +93,7 @@ public:
     void SetMode ( PNS_ROUTER_MODE aMode );
     PNS_ROUTER_MODE Mode() const { return m_mode; }
 
+    ///> Returns the router most recently created by the calling thread
     static PNS_ROUTER* GetInstance();
 
     void ClearWorld();
@@ -133,6 +135,21 @@ public:
 
     void DumpLog();
 
+    /**
+     * Function StartRecording()
+     * Starts recording a session log: the calls made to the router, to be replayed by
+     * the pns_replay benchmark. The board is saved at once to aBaseName.kicad_pcb, the log
+     * is written to aBaseName.log by StopRecording().
+     * @return false if the board could not be saved.
+     */
+    bool StartRecording( const std::string& aBaseName );
+    void StopRecording();
+
+    bool IsRecording() const
+    {
+        return m_sessionLog != NULL;
+    }
+
     PNS_CLEARANCE_FUNC* GetClearanceFunc() const
     {
         return m_clearanceFunc;
@@ -160,6 +177,44 @@ public:
 
     void CommitRouting( PNS_NODE* aNode );
 
+    /**
+     * Function SetDeferredCommit()
+     * In deferred commit mode, CommitRouting() applies the changes to the world only and
+     * queues them instead of modifying the board, so that a router working on a worker
+     * thread leaves the board untouched. The queue is written by FlushCommits().
+     */
+    void SetDeferredCommit( bool aEnabled )
+    {
+        m_deferredCommit = aEnabled;
+    }
+
+    bool DeferredCommit() const
+    {
+        return m_deferredCommit;
+    }
+
+    ///> Returns the number of commits queued in deferred commit mode
+    int PendingCommitCount() const
+    {
+        return m_pendingCommits.size();
+    }
+
+    /**
+     * Function DiscardCommits()
+     * Drops the queued commits, from the aFirst-th one onwards, and takes their changes
+     * back from the world: the items they added are removed, the board items they removed
+     * are synced again.  The dropped commits must not have removed items added by the
+     * kept ones, which holds when they route other nets.
+     */
+    void DiscardCommits( int aFirst = 0 );
+
+    /**
+     * Function FlushCommits()
+     * Writes the commits queued in deferred commit mode to the board. Must be called by the
+     * thread owning the board, before the world is cleared.
+     */
+    void FlushCommits();
+
     /**
      * Returns the last changes introduced by the router (since the last time ClearLastChanges()
      * was called or a new track has been started).
@@ -245,8 +300,21 @@ private:
 
     void highlightCurrent( bool enabled );
 
+    void logEvent( PNS_LOGGER::EVENT_TYPE aType, const VECTOR2I& aP = VECTOR2I(),
+                   const PNS_ITEM* aItem = NULL, int aArg = 0 );
+
     void markViolations( PNS_NODE* aNode, PNS_ITEMSET& aCurrent, PNS_NODE::ITEM_VECTOR& aRemoved );
 
+    void commitToBoard( const std::vector<BOARD_CONNECTED_ITEM*>& aRemoved,
+                        const PNS_NODE::ITEM_VECTOR& aAdded );
+
+    ///> Changes made by a CommitRouting() call in deferred commit mode
+    struct PENDING_COMMIT
+    {
+        std::vector<BOARD_CONNECTED_ITEM*> m_removed;
+        PNS_NODE::ITEM_VECTOR m_added;      ///< items of the world, not on the board yet
+    };
+
     VECTOR2I m_currentEnd;
     RouterState m_state;
 
@@ -280,6 +348,16 @@ private:
     wxString m_failureReason;
 
     GRID_HELPER *m_gridHelper;
+
+    bool m_deferredCommit;
+    std::vector<PENDING_COMMIT> m_pendingCommits;
+
+    ///> router returned by GetInstance() on this thread before this one was created
+    PNS_ROUTER* m_prevInstance;
+
+    ///> session log being recorded, NULL if there is none
+    PNS_LOGGER* m_sessionLog;
+    std::string m_sessionLogFile;
 };
 
 #endif
@@ -41,6 +41,7 @@ PNS_ROUTING_SETTINGS::PNS_ROUTING_SETTINGS()
     m_canViolateDRC = false;
     m_freeAngleMode = false;
     m_inlineDragEnabled = false;
+    m_parallelOptimizer = true;
 }
 
 
@@ -61,6 +62,7 @@ void PNS_ROUTING_SETTINGS::Save( TOOL_SETTINGS& aSettings ) const
     aSettings.Set( "SuggestFinish", m_suggestFinish );
     aSettings.Set( "FreeAngleMode", m_freeAngleMode );
     aSettings.Set( "InlineDragEnabled", m_inlineDragEnabled );
+    aSettings.Set( "ParallelOptimizer", m_parallelOptimizer );
 }
 
 
@@ -81,6 +83,7 @@ void PNS_ROUTING_SETTINGS::Load( const TOOL_SETTINGS& aSettings )
     m_suggestFinish = aSettings.Get( "SuggestFinish", false );
     m_freeAngleMode = aSettings.Get( "FreeAngleMode", false );
     m_inlineDragEnabled = aSettings.Get( "InlineDragEnabled", false );
+    m_parallelOptimizer = aSettings.Get( "ParallelOptimizer", true );
 }
 
 
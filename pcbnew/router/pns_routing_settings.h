@@ -71,6 +71,12 @@ public:
     ///> Sets the optimizer effort. Bigger means cleaner traces, but slower routing.
     void SetOptimizerEffort( PNS_OPTIMIZATION_EFFORT aEffort ) { m_optimizerEffort = aEffort; }
 
+    ///> Returns true if the optimizer evaluates its candidate paths on several threads.
+    bool ParallelOptimizer() const { return m_parallelOptimizer; }
+
+    ///> Enables/disables the evaluation of the optimizer candidate paths on several threads.
+    void SetParallelOptimizer( bool aEnable ) { m_parallelOptimizer = aEnable; }
+
     ///> Returns true if shoving vias is enbled.
     bool ShoveVias() const { return m_shoveVias; }
 
@@ -145,6 +151,7 @@ private:
     bool m_canViolateDRC;
     bool m_freeAngleMode;
     bool m_inlineDragEnabled;
+    bool m_parallelOptimizer;
 
     PNS_MODE m_routingMode;
     PNS_OPTIMIZATION_EFFORT m_optimizerEffort;
@@ -40,6 +40,7 @@
 #include "pns_topology.h"
 
 #include "time_limit.h"
+#include "pns_perf.h"
 
 #include <profile.h>
 
@@ -898,6 +899,8 @@ void PNS_SHOVE::popLine( )
 
 PNS_SHOVE::SHOVE_STATUS PNS_SHOVE::shoveIteration( int aIter )
 {
+    PNS_PERF::SCOPE perf( PNS_PERF::SHOVE_ITERATION );
+
     PNS_LINE currentLine = m_lineStack.back();
     PNS_NODE::OPT_OBSTACLE nearest;
     SHOVE_STATUS st = SH_NULL;
@@ -1277,12 +1280,12 @@ PNS_SHOVE::SHOVE_STATUS PNS_SHOVE::ShoveDraggingVia( PNS_VIA* aVia, const VECTOR
 
 void PNS_SHOVE::runOptimizer( PNS_NODE* aNode )
 {
-    PNS_OPTIMIZER optimizer( aNode );
     int optFlags = 0, n_passes = 0;
 
     PNS_OPTIMIZATION_EFFORT effort = Settings().OptimizerEffort();
 
     OPT_BOX2I area = totalAffectedArea();
+    OPT_BOX2I restrictArea;
 
     int maxWidth = 0;
 
@@ -1306,10 +1309,7 @@ void PNS_SHOVE::runOptimizer( PNS_NODE* aNode )
 
     case OE_MEDIUM:
         optFlags = PNS_OPTIMIZER::MERGE_SEGMENTS;
-
-        if( area )
-            optimizer.SetRestrictArea( *area );
-
+        restrictArea = area;
         n_passes = 2;
         break;
 
@@ -1325,29 +1325,98 @@ void PNS_SHOVE::runOptimizer( PNS_NODE* aNode )
     if( Settings().SmartPads() )
         optFlags |= PNS_OPTIMIZER::SMART_PADS;
 
-    optimizer.SetEffortLevel( optFlags );
-    optimizer.SetCollisionMask( PNS_ITEM::ANY );
-
     for( int pass = 0; pass < n_passes; pass++ )
     {
         std::reverse( m_optimizerQueue.begin(), m_optimizerQueue.end() );
 
-        for( std::vector<PNS_LINE>::iterator i = m_optimizerQueue.begin();
-             i != m_optimizerQueue.end(); ++i )
+        optimizeLines( aNode, optFlags, restrictArea );
+    }
+}
+
+
+static void setupOptimizer( PNS_OPTIMIZER& aOptimizer, int aFlags, const OPT_BOX2I& aRestrictArea )
+{
+    aOptimizer.SetEffortLevel( aFlags );
+    aOptimizer.SetCollisionMask( PNS_ITEM::ANY );
+
+    if( aRestrictArea )
+        aOptimizer.SetRestrictArea( *aRestrictArea );
+}
+
+
+void PNS_SHOVE::optimizeLines( PNS_NODE* aNode, int aFlags, const OPT_BOX2I& aRestrictArea )
+{
+    int n = m_optimizerQueue.size();
+    bool speculative = false;
+
+#ifdef USE_OPENMP
+    speculative = Settings().ParallelOptimizer() && n > 1;
+#endif
+
+    std::vector<PNS_LINE> optimized( n );
+    std::vector<char> changed( n, 0 );
+    std::vector<char> valid( n, 0 );
+    std::vector<OPT_BOX2I> readAreas( n );
+
+    if( speculative )
+    {
+        // optimize all the lines at once, against the node as it is before the pass.
+        // The node is only read here.
+#ifdef USE_OPENMP
+        #pragma omp parallel for schedule(dynamic, 1)
+#endif
+        for( int i = 0; i < n; i++ )
         {
-            PNS_LINE& line = *i;
+            if( m_optimizerQueue[i].Marker() & MK_HEAD )
+                continue;
 
-            if( !( line.Marker() & MK_HEAD ) )
-            {
-                PNS_LINE optimized;
-
-                if( optimizer.Optimize( &line, &optimized ) )
-                {
-                    aNode->Remove( &line );
-                    line.SetShape( optimized.CLine() );
-                    aNode->Add( &line );
-                }
-            }
+            PNS_OPTIMIZER optimizer( aNode );
+
+            setupOptimizer( optimizer, aFlags, aRestrictArea );
+            changed[i] = optimizer.Optimize( &m_optimizerQueue[i], &optimized[i] );
+            readAreas[i] = optimizer.QueryArea();
+            valid[i] = true;
+        }
+    }
+
+    PNS_OPTIMIZER optimizer( aNode );
+
+    setupOptimizer( optimizer, aFlags, aRestrictArea );
+    optimizer.SetSpeculativeMerge( Settings().ParallelOptimizer() );
+
+    // areas changed by the lines updated so far in this pass
+    std::vector<BOX2I> modified;
+    int clearance = aNode->GetMaxClearance();
+
+    for( int i = 0; i < n; i++ )
+    {
+        PNS_LINE& line = m_optimizerQueue[i];
+
+        if( line.Marker() & MK_HEAD )
+            continue;
+
+        // the result computed in advance is the one of a serial pass if none of the lines
+        // updated before has changed in the area read by the optimization of this line
+        for( unsigned j = 0; j < modified.size() && valid[i]; j++ )
+        {
+            if( !readAreas[i] || modified[j].Intersects( *readAreas[i] ) )
+                valid[i] = false;
+        }
+
+        if( !valid[i] )
+            changed[i] = optimizer.Optimize( &line, &optimized[i] );
+
+        if( changed[i] )
+        {
+            BOX2I area = PNS_OPTIMIZER::ItemArea( &line );
+
+            area.Merge( PNS_OPTIMIZER::ItemArea( &optimized[i] ) );
+            area.Inflate( clearance );
+            modified.push_back( area );
+
+            aNode->Remove( &line );
+            line.SetShape( optimized[i].CLine() );
+            aNode->Add( &line );
         }
     }
 }
@@ -122,6 +122,7 @@ private:
     void unwindStack( PNS_ITEM* aItem );
 
     void runOptimizer( PNS_NODE* aNode );
+    void optimizeLines( PNS_NODE* aNode, int aFlags, const OPT_BOX2I& aRestrictArea );
 
     bool pushLine( const PNS_LINE& aL, bool aKeepCurrentOnTop = false );
     void popLine();
@@ -73,9 +73,12 @@ const PNS_TOPOLOGY::JOINT_SET PNS_TOPOLOGY::ConnectedJoints( PNS_JOINT* aStart )
             if( item->OfKind( PNS_ITEM::SEGMENT ) )
             {
                 PNS_SEGMENT* seg = static_cast<PNS_SEGMENT*>( item );
-                PNS_JOINT* a = m_world->FindJoint( seg->Seg().A, seg );
-                PNS_JOINT* b = m_world->FindJoint( seg->Seg().B, seg );
-                PNS_JOINT* next = ( *a == *current ) ? b : a;
+                VECTOR2I ends[2] = { seg->Seg().A, seg->Seg().B };
+                PNS_JOINT* joints[2];
+
+                m_world->FindJoints( ends, 2, seg->Layers().Start(), seg->Net(), joints );
+
+                PNS_JOINT* next = ( *joints[0] == *current ) ? joints[1] : joints[0];
 
                 if( processed.find( next ) == processed.end() )
                 {
@@ -52,6 +52,7 @@ const SHAPE_LINE_CHAIN ConvexHull( const SHAPE_CONVEX& convex, int aClearance );
 
 SHAPE_RECT ApproximateSegmentAsRect( const SHAPE_SEGMENT& aSeg );
 
+// Debug drawing through the router instance, defined in pns_router.cpp
 void DrawDebugPoint( VECTOR2I aP, int aColor );
 void DrawDebugBox( BOX2I aB, int aColor );
 void DrawDebugSeg( SEG aS, int aColor );
@@ -19,6 +19,8 @@
  */
 
 #include <wx/numdlg.h>
+#include <wx/filedlg.h>
+#include <wx/filename.h>
 
 #include <boost/optional.hpp>
 #include <functional>
@@ -298,6 +300,30 @@ void ROUTER_TOOL::handleCommonEvents( const TOOL_EVENT& aEvent )
             TRACEn( 2, "saving drag/route log...\n" );
             m_router->DumpLog();
             break;
+
+        case '9':
+            if( m_router->IsRecording() )
+            {
+                TRACEn( 2, "saving routing session...\n" );
+                m_router->StopRecording();
+            }
+            else
+            {
+                // the log and the board snapshot are saved side by side, under the chosen name
+                wxFileDialog dlg( m_frame, _( "Record Routing Session" ), GetKicadConfigPath(),
+                                  wxT( "pns_session.log" ), wxT( "*.log" ),
+                                  wxFD_SAVE | wxFD_OVERWRITE_PROMPT );
+
+                if( dlg.ShowModal() != wxID_OK )
+                    break;
+
+                wxFileName baseName( dlg.GetPath() );
+                baseName.ClearExt();
+
+                TRACEn( 2, "recording routing session...\n" );
+                m_router->StartRecording( (const char*) baseName.GetFullPath().utf8_str() );
+            }
+            break;
         }
     }
     else
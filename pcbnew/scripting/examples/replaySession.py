@@ -0,0 +1,38 @@
+#!/usr/bin/env python
+#
+# Replays a routing session recorded by the interactive router (DEBUG builds:
+# press '9' in the router tool to choose the session file and start the
+# recording, and again to stop it; the board snapshot is saved next to the log)
+# and prints the time spent in each kind of router call.
+# The pns_replay target of pcbnew builds the same replay as a standalone program.
+#
+# usage: replaySession.py session.log [runs] [-v]
+#
+import sys
+from pcbnew import *
+
+filename = sys.argv[1]
+runs = int(sys.argv[2]) if len(sys.argv) > 2 and sys.argv[2] != "-v" else 1
+verbose = "-v" in sys.argv
+
+replay = PNS_REPLAY()
+
+if not replay.Load(filename):
+    print "can't load the session %s" % filename
+    sys.exit(1)
+
+for run in range(runs):
+    total = replay.Run()
+    print "run %d: %d calls in %.3f ms" % (run, replay.GetCallCount(), total)
+
+if verbose:
+    print "%6s %6s %10s %6s %10s %6s %10s" % \
+        ("call", "type", "time", "shove", "shove t.", "opt.", "opt. t.")
+
+    for i in range(replay.GetCallCount()):
+        print "%6d %6d %10.3f %6d %10.3f %6d %10.3f" % \
+            (i, replay.GetCallType(i), replay.GetCallTime(i),
+             replay.GetShoveIterations(i), replay.GetShoveTime(i),
+             replay.GetOptimizerPasses(i), replay.GetOptimizerTime(i))
+
+print replay.Report()
@@ -0,0 +1,27 @@
+#!/usr/bin/env python
+#
+# Routes the missing connections of a board with the interactive router's
+# walkaround algorithm, without any user interaction, and saves the result.
+#
+# usage: routeRatsnest.py board.kicad_pcb [threads]
+#
+import os
+import sys
+from pcbnew import *
+
+filename = sys.argv[1]
+threads = int(sys.argv[2]) if len(sys.argv) > 2 else 0
+
+pcb = LoadBoard(filename)
+
+router = PNS_BATCH_ROUTER(pcb)
+router.SetThreadCount(threads)
+
+count = router.AddRatsnestConnections()
+routed = router.Route()
+
+print "routed %d of %d connections in %.1f ms (%d nets routed again)" % \
+    (routed, count, router.GetRoutingTime(), router.GetRetriedNetCount())
+
+dirname, basename = os.path.split(filename)
+pcb.Save(os.path.join(dirname, "routed_" + basename))
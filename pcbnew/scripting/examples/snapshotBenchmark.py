@@ -0,0 +1,67 @@
+#!/usr/bin/env python
+#
+# Compares the save and load times of a board as a kicad_pcb file and as a
+# binary snapshot, and checks that the snapshot gives back the same board.
+#
+# usage: snapshotBenchmark.py board.kicad_pcb [runs]
+#
+import os
+import sys
+import tempfile
+import time
+from pcbnew import *
+
+filename = sys.argv[1]
+runs = int(sys.argv[2]) if len(sys.argv) > 2 else 5
+
+pcb = LoadBoard(filename)
+tmpdir = tempfile.mkdtemp()
+
+
+def best_time(function):
+    best = None
+
+    for i in range(runs):
+        start = time.time()
+        function()
+        elapsed = (time.time() - start) * 1000.0
+
+        if best is None or elapsed < best:
+            best = elapsed
+
+    return best
+
+
+def format_board(board):
+    io = PCB_IO()
+    io.Format(board)
+    return io.GetStringOutput(True)
+
+
+results = {}
+
+for name, filetype in (("kicad_pcb", IO_MGR.KICAD), ("kicad_snap", IO_MGR.KICAD_SNAPSHOT)):
+    path = os.path.join(tmpdir, "board." + name)
+
+    save = best_time(lambda: IO_MGR.Save(filetype, path, pcb))
+    load = best_time(lambda: IO_MGR.Load(filetype, path))
+
+    results[name] = (save, load, os.path.getsize(path))
+
+    print "%-10s save %8.1f ms  load %8.1f ms  %10d bytes" % \
+        (name, save, load, os.path.getsize(path))
+
+    os.remove(path)
+
+text, snap = results["kicad_pcb"], results["kicad_snap"]
+
+print "snapshot speedup: save %.1fx  load %.1fx" % \
+    (text[0] / snap[0], text[1] / snap[1])
+
+path = os.path.join(tmpdir, "board.kicad_snap")
+IO_MGR.Save(IO_MGR.KICAD_SNAPSHOT, path, pcb)
+same = format_board(IO_MGR.Load(IO_MGR.KICAD_SNAPSHOT, path)) == format_board(pcb)
+os.remove(path)
+os.rmdir(tmpdir)
+
+print "round trip: %s" % ("same board" if same else "BOARD DIFFERS")
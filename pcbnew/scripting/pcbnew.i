@@ -83,6 +83,7 @@
 
 %{
   #include <wx_python_helpers.h>
+  #include <class_undoredo_container.h>
   #include <class_board_item.h>
   #include <class_board_connected_item.h>
   #include <class_board_design_settings.h>
@@ -112,6 +113,8 @@
   #include <pcb_plot_params.h>
   #include <exporters/gendrill_Excellon_writer.h>
   #include <colors.h>
+  #include <router/pns_batch_router.h>
+  #include <router/pns_replay.h>
 
   BOARD *GetBoard(); /* get current editor board */
 %}
@@ -122,6 +125,7 @@
   #include <kicad_plugin.h>
 %}
 
+%include <class_undoredo_container.h>
 %include <class_board_item.h>
 %include <class_board_connected_item.h>
 %include <class_board_design_settings.h>
@@ -151,6 +155,8 @@
 %include <plot_common.h>
 %include <exporters/gendrill_Excellon_writer.h>
 %include <colors.h>
+%include <router/pns_batch_router.h>
+%include <router/pns_replay.h>
 
 %include "board_item.i"
 
@@ -36,6 +36,8 @@
 #include <class_board.h>
 #include <kicad_string.h>
 #include <io_mgr.h>
+#include <fp_lib_table.h>
+#include <footprint_info.h>
 #include <macros.h>
 #include <stdlib.h>
 
@@ -92,3 +94,30 @@ bool SaveBoard( wxString& aFileName, BOARD* aBoard,
 
     return true;
 }
+
+
+wxArrayString ReadFootprintInfo( wxString& aLibPath, bool aErrors )
+{
+    FP_LIB_TABLE    table;
+    FOOTPRINT_LIST  list;
+    wxString        nickname = wxT( "scripting" );
+    wxArrayString   result;
+
+    table.InsertRow( FP_LIB_TABLE::ROW( nickname, aLibPath,
+                                        IO_MGR::ShowType( IO_MGR::KICAD ), wxEmptyString ) );
+
+    list.ReadFootprintFiles( &table, &nickname );
+
+    if( aErrors )
+    {
+        for( unsigned ii = 0; ii < list.GetErrorCount(); ii++ )
+            result.Add( list.GetError( ii )->errorText );
+    }
+    else
+    {
+        for( unsigned ii = 0; ii < list.GetCount(); ii++ )
+            result.Add( list.GetItem( ii ).GetFootprintName() );
+    }
+
+    return result;
+}
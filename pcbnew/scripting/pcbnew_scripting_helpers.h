@@ -43,5 +43,14 @@ BOARD*  LoadBoard( wxString& aFileName );
 bool    SaveBoard( wxString& aFileName, BOARD* aBoard, IO_MGR::PCB_FILE_T aFormat );
 bool    SaveBoard( wxString& aFileName, BOARD* aBoard );
 
+/**
+ * Function ReadFootprintInfo
+ * reads the footprint info of the KiCad footprint library aLibPath the way the
+ * footprint choosers do, with FOOTPRINT_LIST::ReadFootprintFiles().
+ * @return the names of the footprints listed, or if aErrors is true, the messages of
+ * the errors found while reading them.
+ */
+wxArrayString ReadFootprintInfo( wxString& aLibPath, bool aErrors = false );
+
 
 #endif
@@ -0,0 +1,1118 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file snapshot_plugin.cpp
+ * @brief Binary board snapshot file plugin implementation file.
+ */
+
+#include <fctsys.h>
+#include <common.h>
+#include <macros.h>
+#include <richio.h>
+
+#include <3d_struct.h>
+#include <class_board.h>
+#include <class_edge_mod.h>
+#include <class_module.h>
+#include <class_netinfo.h>
+#include <class_pad.h>
+#include <class_text_mod.h>
+#include <class_track.h>
+#include <class_zone.h>
+#include <kicad_plugin.h>
+#include <pcb_parser.h>
+#include <snapshot_plugin.h>
+#include <trigo.h>
+
+#include <climits>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <vector>
+
+
+/// The first bytes of every board snapshot file.
+static const char snapshotMagic[8] = { 'K', 'I', 'C', 'A', 'D', 'S', 'N', 'P' };
+
+/// Kinds of track records.
+enum SNAPSHOT_TRACK_T
+{
+    SNAPSHOT_SEGMENT,
+    SNAPSHOT_VIA_THROUGH,
+    SNAPSHOT_VIA_BLIND_BURIED,
+    SNAPSHOT_VIA_MICROVIA
+};
+
+/// Kinds of footprint graphic item records.
+enum SNAPSHOT_GRAPHIC_T
+{
+    SNAPSHOT_EDGE,
+    SNAPSHOT_TEXT
+};
+
+
+/**
+ * Class SNAPSHOT_BUFFER
+ * collects one section of a snapshot file.  Unsigned numbers are written as LEB128
+ * variable length integers, and signed numbers are zigzag encoded first, so small
+ * values of either sign take a single byte.
+ */
+class SNAPSHOT_BUFFER
+{
+    std::string m_bytes;
+
+public:
+    void Unsigned( unsigned long long aValue )
+    {
+        while( aValue >= 0x80 )
+        {
+            m_bytes += char( ( aValue & 0x7F ) | 0x80 );
+            aValue >>= 7;
+        }
+
+        m_bytes += char( aValue );
+    }
+
+    void Signed( long long aValue )
+    {
+        Unsigned( ( (unsigned long long) aValue << 1 ) ^ (unsigned long long) ( aValue >> 63 ) );
+    }
+
+    /// Writes \a aPoint relative to \a aPrevious, then makes it the previous point.
+    void Point( const wxPoint& aPoint, wxPoint& aPrevious )
+    {
+        Signed( (long long) aPoint.x - aPrevious.x );
+        Signed( (long long) aPoint.y - aPrevious.y );
+        aPrevious = aPoint;
+    }
+
+    /// Writes \a aPoint as it is, for coordinates relative to a footprint.
+    void Point( const wxPoint& aPoint )
+    {
+        Signed( aPoint.x );
+        Signed( aPoint.y );
+    }
+
+    void Size( const wxSize& aSize )
+    {
+        Signed( aSize.x );
+        Signed( aSize.y );
+    }
+
+    /// Writes the bytes of \a aValue, in the byte order of the machine.
+    void Double( double aValue )
+    {
+        Bytes( (const char*) &aValue, sizeof( aValue ) );
+    }
+
+    void String( const wxString& aString )
+    {
+        std::string utf8 = TO_UTF8( aString );
+
+        Unsigned( utf8.size() );
+        Bytes( utf8.data(), utf8.size() );
+    }
+
+    void Bytes( const char* aData, size_t aCount )
+    {
+        m_bytes.append( aData, aCount );
+    }
+
+    /// Writes \a aSection, prefixed with its size.
+    void Section( const SNAPSHOT_BUFFER& aSection )
+    {
+        Unsigned( aSection.m_bytes.size() );
+        m_bytes += aSection.m_bytes;
+    }
+
+    const std::string& GetBytes() const { return m_bytes; }
+};
+
+
+/**
+ * Class SNAPSHOT_READER
+ * reads back what SNAPSHOT_BUFFER wrote, from memory owned by the caller.
+ *
+ * @throw IO_ERROR when reading past the end of the data.
+ */
+class SNAPSHOT_READER
+{
+    const char* m_pos;
+    const char* m_end;
+    wxString    m_source;      ///< the file name, for error reporting
+
+public:
+    SNAPSHOT_READER( const char* aData, size_t aCount, const wxString& aSource ) :
+        m_pos( aData ),
+        m_end( aData + aCount ),
+        m_source( aSource )
+    {
+    }
+
+    void Damaged() const
+    {
+        THROW_IO_ERROR( wxString::Format( _( "Board snapshot file '%s' is damaged" ),
+                                          GetChars( m_source ) ) );
+    }
+
+    unsigned long long Unsigned()
+    {
+        unsigned long long  value = 0;
+        int                 shift = 0;
+
+        for( ;; )
+        {
+            if( m_pos == m_end || shift > 63 )
+                Damaged();
+
+            unsigned char byte = *m_pos++;
+
+            value |= (unsigned long long) ( byte & 0x7F ) << shift;
+
+            if( !( byte & 0x80 ) )
+                return value;
+
+            shift += 7;
+        }
+    }
+
+    long long Signed()
+    {
+        unsigned long long value = Unsigned();
+
+        return (long long) ( value >> 1 ) ^ -(long long) ( value & 1 );
+    }
+
+    /// Reads a count of items, which cannot be more than there are bytes left.
+    size_t Count()
+    {
+        unsigned long long count = Unsigned();
+
+        if( count > Left() )
+            Damaged();
+
+        return count;
+    }
+
+    int Int()
+    {
+        long long value = Signed();
+
+        if( value < INT_MIN || value > INT_MAX )
+            Damaged();
+
+        return value;
+    }
+
+    /// Reads a point written relative to \a aPrevious, which becomes the point.
+    void Point( wxPoint& aPrevious )
+    {
+        long long x = aPrevious.x + Signed();
+        long long y = aPrevious.y + Signed();
+
+        if( x < INT_MIN || x > INT_MAX || y < INT_MIN || y > INT_MAX )
+            Damaged();
+
+        aPrevious = wxPoint( x, y );
+    }
+
+    wxPoint Point()
+    {
+        int x = Int();
+
+        return wxPoint( x, Int() );
+    }
+
+    wxSize Size()
+    {
+        int x = Int();
+
+        return wxSize( x, Int() );
+    }
+
+    double Double()
+    {
+        double value;
+
+        memcpy( &value, Bytes( sizeof( value ) ), sizeof( value ) );
+        return value;
+    }
+
+    wxString String()
+    {
+        size_t len = Count();
+
+        return wxString::FromUTF8( Bytes( len ), len );
+    }
+
+    LAYER_ID Layer()
+    {
+        unsigned long long layer = Unsigned();
+
+        if( layer >= LAYER_ID_COUNT )
+            Damaged();
+
+        return LAYER_ID( layer );
+    }
+
+    const char* Bytes( size_t aCount )
+    {
+        if( aCount > Left() )
+            Damaged();
+
+        const char* bytes = m_pos;
+
+        m_pos += aCount;
+        return bytes;
+    }
+
+    /// Reads a section written by SNAPSHOT_BUFFER::Section().
+    SNAPSHOT_READER Section()
+    {
+        size_t count = Count();
+
+        return SNAPSHOT_READER( Bytes( count ), count, m_source );
+    }
+
+    const char* Pos() const     { return m_pos; }
+    size_t      Left() const    { return m_end - m_pos; }
+};
+
+
+/**
+ * Class SNAPSHOT_FORMATTER
+ * is an OUTPUTFORMATTER which writes to a binary file, so the binary sections and
+ * the board text go to the same file.
+ */
+class SNAPSHOT_FORMATTER : public OUTPUTFORMATTER
+{
+    FILE*       m_fp;
+    wxString    m_filename;
+
+public:
+    SNAPSHOT_FORMATTER( const wxString& aFileName ) throw( IO_ERROR ) :
+        m_filename( aFileName )
+    {
+        m_fp = wxFopen( aFileName, wxT( "wb" ) );
+
+        if( !m_fp )
+        {
+            THROW_IO_ERROR( wxString::Format( _( "cannot open or save file '%s'" ),
+                                              GetChars( aFileName ) ) );
+        }
+    }
+
+    ~SNAPSHOT_FORMATTER()
+    {
+        fclose( m_fp );
+    }
+
+    void Write( const std::string& aBytes ) throw( IO_ERROR )
+    {
+        write( aBytes.data(), aBytes.size() );
+    }
+
+protected:
+    void write( const char* aOutBuf, int aCount ) throw( IO_ERROR )
+    {
+        if( fwrite( aOutBuf, 1, aCount, m_fp ) != (size_t) aCount )
+        {
+            THROW_IO_ERROR( wxString::Format( _( "error writing to file '%s'" ),
+                                              GetChars( m_filename ) ) );
+        }
+    }
+};
+
+
+/**
+ * Class SNAPSHOT_FILE
+ * maps a snapshot file into memory, or reads it at once where mmap() is missing.
+ */
+class SNAPSHOT_FILE : public MMAP_LINE_READER
+{
+public:
+    SNAPSHOT_FILE( const wxString& aFileName ) throw( IO_ERROR ) :
+        MMAP_LINE_READER( aFileName )
+    {
+    }
+
+    const char* Data() const    { return buf; }
+    size_t      Size() const    { return bufLen; }
+};
+
+
+/// Returns the index of \a aString in the string table \a aTable, adding it if needed.
+static unsigned stringIndex( std::map<wxString, unsigned>& aTable, const wxString& aString )
+{
+    std::map<wxString, unsigned>::iterator it = aTable.find( aString );
+
+    if( it == aTable.end() )
+        it = aTable.insert( std::make_pair( aString, (unsigned) aTable.size() ) ).first;
+
+    return it->second;
+}
+
+
+/**
+ * Function saveText
+ * writes the footprint text \a aText to \a aBuffer, with its position and orientation
+ * relative to the footprint.
+ */
+static void saveText( SNAPSHOT_BUFFER& aBuffer, const TEXTE_MODULE* aText )
+{
+    aBuffer.Unsigned( aText->GetType() );
+    aBuffer.String( aText->GetText() );
+    aBuffer.Point( aText->GetPos0() );
+    aBuffer.Double( aText->GetOrientation() );
+    aBuffer.Unsigned( aText->GetLayer() );
+    aBuffer.Unsigned( aText->IsVisible() );
+    aBuffer.Unsigned( aText->GetAttributes() );
+    aBuffer.Size( aText->GetSize() );
+    aBuffer.Signed( aText->GetThickness() );
+    aBuffer.Unsigned( aText->IsBold() );
+    aBuffer.Unsigned( aText->IsItalic() );
+    aBuffer.Unsigned( aText->IsMirrored() );
+    aBuffer.Signed( aText->GetHorizJustify() );
+    aBuffer.Signed( aText->GetVertJustify() );
+}
+
+
+/**
+ * Function saveModule
+ * writes \a aModule to \a aBuffer, with what PCB_IO would write of it.  The pads refer
+ * to their nets by index in the string table \a aStrings.
+ */
+static void saveModule( SNAPSHOT_BUFFER& aBuffer, std::map<wxString, unsigned>& aStrings,
+                        MODULE* aModule, wxPoint& aPrevious )
+{
+    std::string fpid = aModule->GetFPID().Format();
+
+    aBuffer.Unsigned( fpid.size() );
+    aBuffer.Bytes( fpid.data(), fpid.size() );
+    aBuffer.Unsigned( aModule->IsLocked() );
+    aBuffer.Unsigned( aModule->IsPlaced() );
+    aBuffer.Unsigned( aModule->GetLayer() );
+    aBuffer.Unsigned( (unsigned long) aModule->GetLastEditTime() );
+    aBuffer.Unsigned( (unsigned long) aModule->GetTimeStamp() );
+    aBuffer.Point( aModule->GetPosition(), aPrevious );
+    aBuffer.Double( aModule->GetOrientation() );
+    aBuffer.String( aModule->GetDescription() );
+    aBuffer.String( aModule->GetKeywords() );
+    aBuffer.String( aModule->GetPath() );
+    aBuffer.Signed( aModule->GetPlacementCost90() );
+    aBuffer.Signed( aModule->GetPlacementCost180() );
+    aBuffer.Signed( aModule->GetLocalSolderMaskMargin() );
+    aBuffer.Signed( aModule->GetLocalSolderPasteMargin() );
+    aBuffer.Double( aModule->GetLocalSolderPasteMarginRatio() );
+    aBuffer.Signed( aModule->GetLocalClearance() );
+    aBuffer.Signed( aModule->GetZoneConnection() );
+    aBuffer.Signed( aModule->GetThermalWidth() );
+    aBuffer.Signed( aModule->GetThermalGap() );
+    aBuffer.Unsigned( aModule->GetAttributes() );
+
+    saveText( aBuffer, &aModule->Reference() );
+    saveText( aBuffer, &aModule->Value() );
+
+    aBuffer.Unsigned( aModule->GraphicalItems().GetCount() );
+
+    for( BOARD_ITEM* item = aModule->GraphicalItems();  item;  item = item->Next() )
+    {
+        if( item->Type() == PCB_MODULE_TEXT_T )
+        {
+            aBuffer.Unsigned( SNAPSHOT_TEXT );
+            saveText( aBuffer, static_cast<TEXTE_MODULE*>( item ) );
+            continue;
+        }
+
+        const EDGE_MODULE* edge = static_cast<EDGE_MODULE*>( item );
+
+        aBuffer.Unsigned( SNAPSHOT_EDGE );
+        aBuffer.Unsigned( edge->GetShape() );
+        aBuffer.Unsigned( edge->GetLayer() );
+        aBuffer.Signed( edge->GetWidth() );
+        aBuffer.Point( edge->GetStart0() );
+        aBuffer.Point( edge->GetEnd0() );
+
+        switch( edge->GetShape() )
+        {
+        case S_ARC:
+            aBuffer.Double( edge->GetAngle() );
+            break;
+
+        case S_CURVE:
+            aBuffer.Point( edge->GetBezControl1() );
+            aBuffer.Point( edge->GetBezControl2() );
+            break;
+
+        case S_POLYGON:
+            aBuffer.Unsigned( edge->GetPolyPoints().size() );
+
+            for( unsigned i = 0;  i < edge->GetPolyPoints().size();  ++i )
+                aBuffer.Point( edge->GetPolyPoints()[i] );
+
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    aBuffer.Unsigned( aModule->Pads().GetCount() );
+
+    for( D_PAD* pad = aModule->Pads();  pad;  pad = pad->Next() )
+    {
+        LSEQ layers = pad->GetLayerSet().Seq();
+
+        aBuffer.String( pad->GetPadName() );
+        aBuffer.Unsigned( pad->GetShape() );
+        aBuffer.Unsigned( pad->GetAttribute() );
+        aBuffer.Point( pad->GetPos0() );
+        aBuffer.Double( pad->GetOrientation() );
+        aBuffer.Size( pad->GetSize() );
+        aBuffer.Size( pad->GetDelta() );
+        aBuffer.Size( pad->GetDrillSize() );
+        aBuffer.Unsigned( pad->GetDrillShape() );
+        aBuffer.Point( pad->GetOffset() );
+        aBuffer.Double( pad->GetRoundRectRadiusRatio() );
+        aBuffer.Unsigned( layers.size() );
+
+        for( unsigned i = 0;  i < layers.size();  ++i )
+            aBuffer.Unsigned( layers[i] );
+
+        aBuffer.Unsigned( stringIndex( aStrings, pad->GetNetname() ) );
+        aBuffer.Signed( pad->GetPadToDieLength() );
+        aBuffer.Signed( pad->GetLocalSolderMaskMargin() );
+        aBuffer.Signed( pad->GetLocalSolderPasteMargin() );
+        aBuffer.Double( pad->GetLocalSolderPasteMarginRatio() );
+        aBuffer.Signed( pad->GetLocalClearance() );
+
+        // The inherited values are written like PCB_IO does, resolved from the footprint.
+        aBuffer.Signed( pad->GetZoneConnection() );
+        aBuffer.Signed( pad->GetThermalWidth() );
+        aBuffer.Signed( pad->GetThermalGap() );
+    }
+
+    // Models without a file name are not saved, like PCB_IO does.
+    std::vector<S3D_MASTER*> models;
+
+    for( S3D_MASTER* model = aModule->Models();  model;  model = model->Next() )
+    {
+        if( !model->GetShape3DName().IsEmpty() )
+            models.push_back( model );
+    }
+
+    aBuffer.Unsigned( models.size() );
+
+    for( unsigned i = 0;  i < models.size();  ++i )
+    {
+        aBuffer.String( models[i]->GetShape3DName() );
+        aBuffer.Double( models[i]->m_MatPosition.x );
+        aBuffer.Double( models[i]->m_MatPosition.y );
+        aBuffer.Double( models[i]->m_MatPosition.z );
+        aBuffer.Double( models[i]->m_MatScale.x );
+        aBuffer.Double( models[i]->m_MatScale.y );
+        aBuffer.Double( models[i]->m_MatScale.z );
+        aBuffer.Double( models[i]->m_MatRotation.x );
+        aBuffer.Double( models[i]->m_MatRotation.y );
+        aBuffer.Double( models[i]->m_MatRotation.z );
+    }
+}
+
+
+void SNAPSHOT_PLUGIN::Save( const wxString& aFileName, BOARD* aBoard,
+                            const PROPERTIES* aProperties )
+{
+    std::map<wxString, unsigned>    strings;
+    SNAPSHOT_BUFFER                 tracks;
+    SNAPSHOT_BUFFER                 zones;
+    SNAPSHOT_BUFFER                 modules;
+    wxPoint                         prev;
+
+    tracks.Unsigned( aBoard->m_Track.GetCount() );
+
+    for( TRACK* track = aBoard->m_Track;  track;  track = track->Next() )
+    {
+        if( track->Type() == PCB_VIA_T )
+        {
+            const VIA*  via = static_cast<const VIA*>( track );
+            LAYER_ID    layer1, layer2;
+
+            switch( via->GetViaType() )
+            {
+            case VIA_THROUGH:       tracks.Unsigned( SNAPSHOT_VIA_THROUGH );        break;
+            case VIA_BLIND_BURIED:  tracks.Unsigned( SNAPSHOT_VIA_BLIND_BURIED );   break;
+            case VIA_MICROVIA:      tracks.Unsigned( SNAPSHOT_VIA_MICROVIA );       break;
+
+            default:
+                THROW_IO_ERROR( wxString::Format( _( "unknown via type %d" ), via->GetViaType() ) );
+            }
+
+            via->LayerPair( &layer1, &layer2 );
+
+            tracks.Point( via->GetStart(), prev );
+            tracks.Signed( via->GetWidth() );
+            tracks.Signed( via->GetDrill() );
+            tracks.Unsigned( layer1 );
+            tracks.Unsigned( layer2 );
+        }
+        else
+        {
+            tracks.Unsigned( SNAPSHOT_SEGMENT );
+            tracks.Point( track->GetStart(), prev );
+            tracks.Point( track->GetEnd(), prev );
+            tracks.Signed( track->GetWidth() );
+            tracks.Unsigned( track->GetLayer() );
+        }
+
+        tracks.Unsigned( stringIndex( strings, track->GetNetname() ) );
+        tracks.Unsigned( track->GetTimeStamp() );
+        tracks.Unsigned( track->GetStatus() );
+    }
+
+    // Filled polygons are fractured, so only their outlines are saved, like PCB_IO does.
+    zones.Unsigned( aBoard->GetAreaCount() );
+
+    for( int i = 0;  i < aBoard->GetAreaCount();  ++i )
+    {
+        const ZONE_CONTAINER*   zone = aBoard->GetArea( i );
+        const SHAPE_POLY_SET&   fill = zone->GetFilledPolysList();
+
+        zones.Unsigned( fill.OutlineCount() );
+
+        for( int ii = 0;  ii < fill.OutlineCount();  ++ii )
+        {
+            const SHAPE_LINE_CHAIN& outline = fill.COutline( ii );
+
+            zones.Unsigned( outline.PointCount() );
+
+            for( int jj = 0;  jj < outline.PointCount();  ++jj )
+            {
+                const VECTOR2I& pt = outline.CPoint( jj );
+
+                zones.Point( wxPoint( pt.x, pt.y ), prev );
+            }
+        }
+
+        const std::vector<SEGMENT>& segs = zone->FillSegments();
+
+        zones.Unsigned( segs.size() );
+
+        for( unsigned ii = 0;  ii < segs.size();  ++ii )
+        {
+            zones.Point( segs[ii].m_Start, prev );
+            zones.Point( segs[ii].m_End, prev );
+        }
+    }
+
+    modules.Unsigned( aBoard->m_Modules.GetCount() );
+
+    for( MODULE* module = aBoard->m_Modules;  module;  module = module->Next() )
+        saveModule( modules, strings, module, prev );
+
+    std::vector<const wxString*> byIndex( strings.size() );
+
+    for( std::map<wxString, unsigned>::const_iterator it = strings.begin();  it != strings.end();  ++it )
+        byIndex[it->second] = &it->first;
+
+    SNAPSHOT_BUFFER table;
+
+    table.Unsigned( byIndex.size() );
+
+    for( unsigned i = 0;  i < byIndex.size();  ++i )
+        table.String( *byIndex[i] );
+
+    SNAPSHOT_BUFFER header;
+
+    header.Bytes( snapshotMagic, sizeof( snapshotMagic ) );
+    header.Unsigned( SNAPSHOT_FILE_VERSION );
+    header.Section( table );
+
+    SNAPSHOT_FORMATTER formatter( aFileName );
+
+    formatter.Write( header.GetBytes() );
+
+    // The sections are written one after the other rather than copied into one buffer.
+    header = SNAPSHOT_BUFFER();
+    header.Unsigned( tracks.GetBytes().size() );
+    formatter.Write( header.GetBytes() );
+    formatter.Write( tracks.GetBytes() );
+
+    header = SNAPSHOT_BUFFER();
+    header.Unsigned( zones.GetBytes().size() );
+    formatter.Write( header.GetBytes() );
+    formatter.Write( zones.GetBytes() );
+
+    header = SNAPSHOT_BUFFER();
+    header.Unsigned( modules.GetBytes().size() );
+    formatter.Write( header.GetBytes() );
+    formatter.Write( modules.GetBytes() );
+
+    // The rest of the board goes straight to the file, up to its end.
+    PCB_IO  io( CTL_FOR_BOARD | CTL_OMIT_TRACKS | CTL_OMIT_ZONE_FILLS | CTL_OMIT_MODULES );
+
+    io.FormatBoard( aBoard, &formatter, aProperties );
+}
+
+
+/**
+ * Function readNetCode
+ * reads a net name index of \a aReader and returns the code of the net of \a aBoard
+ * with this name.
+ *
+ * @param aStrings is the string table of the snapshot.
+ * @param aNetCodes caches the net codes by string index, -1 when not looked up yet.
+ */
+static int readNetCode( SNAPSHOT_READER& aReader, const std::vector<wxString>& aStrings,
+                        std::vector<int>& aNetCodes, BOARD* aBoard )
+{
+    unsigned long long net = aReader.Unsigned();
+
+    if( net >= aStrings.size() )
+        aReader.Damaged();
+
+    // Net names are looked up once, the nets were created by the board text.
+    if( aNetCodes[net] < 0 )
+    {
+        if( aStrings[net].IsEmpty() )
+        {
+            aNetCodes[net] = NETINFO_LIST::UNCONNECTED;
+        }
+        else
+        {
+            NETINFO_ITEM* netinfo = aBoard->FindNet( aStrings[net] );
+
+            if( !netinfo )
+                aReader.Damaged();
+
+            aNetCodes[net] = netinfo->GetNet();
+        }
+    }
+
+    return aNetCodes[net];
+}
+
+
+/**
+ * Function loadTracks
+ * adds the tracks and vias of the track section \a aReader to \a aBoard.
+ *
+ * @param aStrings is the string table of the snapshot.
+ * @param aNetCodes caches the net codes by string index.
+ */
+static void loadTracks( SNAPSHOT_READER& aReader, const std::vector<wxString>& aStrings,
+                        std::vector<int>& aNetCodes, BOARD* aBoard )
+{
+    wxPoint             prev;
+    size_t              count = aReader.Count();
+
+    for( size_t i = 0;  i < count;  ++i )
+    {
+        std::auto_ptr<TRACK>    track;
+        unsigned long long      kind = aReader.Unsigned();
+
+        if( kind == SNAPSHOT_SEGMENT )
+        {
+            track.reset( new TRACK( aBoard ) );
+
+            aReader.Point( prev );
+            track->SetStart( prev );
+            aReader.Point( prev );
+            track->SetEnd( prev );
+            track->SetWidth( aReader.Int() );
+            track->SetLayer( aReader.Layer() );
+        }
+        else if( kind <= SNAPSHOT_VIA_MICROVIA )
+        {
+            VIA* via = new VIA( aBoard );
+
+            track.reset( via );
+
+            if( kind == SNAPSHOT_VIA_BLIND_BURIED )
+                via->SetViaType( VIA_BLIND_BURIED );
+            else if( kind == SNAPSHOT_VIA_MICROVIA )
+                via->SetViaType( VIA_MICROVIA );
+
+            aReader.Point( prev );
+            via->SetStart( prev );
+            via->SetEnd( prev );
+            via->SetWidth( aReader.Int() );
+            via->SetDrill( aReader.Int() );
+
+            LAYER_ID layer1 = aReader.Layer();
+
+            via->SetLayerPair( layer1, aReader.Layer() );
+        }
+        else
+        {
+            aReader.Damaged();
+        }
+
+        track->SetNetCode( readNetCode( aReader, aStrings, aNetCodes, aBoard ),
+                           /* aNoAssert */ true );
+        track->SetTimeStamp( aReader.Unsigned() );
+        track->SetStatus( static_cast<STATUS_FLAGS>( aReader.Unsigned() ) );
+
+        aBoard->Add( track.release(), ADD_APPEND );
+    }
+}
+
+
+/**
+ * Function loadZoneFills
+ * gives the filled polygons and fill segments of the zone section \a aReader to the
+ * zones of \a aBoard, starting with zone \a aFirstZone.
+ */
+static void loadZoneFills( SNAPSHOT_READER& aReader, BOARD* aBoard, int aFirstZone )
+{
+    wxPoint prev;
+    size_t  count = aReader.Count();
+
+    if( aFirstZone + count != (size_t) aBoard->GetAreaCount() )
+        aReader.Damaged();
+
+    for( size_t i = 0;  i < count;  ++i )
+    {
+        ZONE_CONTAINER* zone = aBoard->GetArea( aFirstZone + i );
+        SHAPE_POLY_SET  fill;
+        size_t          outlineCount = aReader.Count();
+
+        for( size_t ii = 0;  ii < outlineCount;  ++ii )
+        {
+            size_t pointCount = aReader.Count();
+
+            fill.NewOutline();
+
+            for( size_t jj = 0;  jj < pointCount;  ++jj )
+            {
+                aReader.Point( prev );
+                fill.Append( prev.x, prev.y );
+            }
+        }
+
+        if( !fill.IsEmpty() )
+            zone->AddFilledPolysList( fill );
+
+        std::vector<SEGMENT>    segs( aReader.Count() );
+
+        for( size_t ii = 0;  ii < segs.size();  ++ii )
+        {
+            aReader.Point( prev );
+            segs[ii].m_Start = prev;
+            aReader.Point( prev );
+            segs[ii].m_End = prev;
+        }
+
+        if( segs.size() )
+            zone->AddFillSegments( segs );
+    }
+}
+
+
+/**
+ * Function loadText
+ * reads a footprint text written by saveText() into \a aText, whose parent footprint
+ * is already placed.
+ */
+static void loadText( SNAPSHOT_READER& aReader, TEXTE_MODULE* aText )
+{
+    unsigned long long type = aReader.Unsigned();
+
+    if( type > TEXTE_MODULE::TEXT_is_DIVERS )
+        aReader.Damaged();
+
+    aText->SetType( TEXTE_MODULE::TEXT_TYPE( type ) );
+    aText->SetText( aReader.String() );
+    aText->SetPos0( aReader.Point() );
+    aText->SetOrientation( aReader.Double() );
+    aText->SetLayer( aReader.Layer() );
+    aText->SetVisible( aReader.Unsigned() );
+    aText->SetAttributes( aReader.Unsigned() );
+    aText->SetSize( aReader.Size() );
+    aText->SetThickness( aReader.Int() );
+    aText->SetBold( aReader.Unsigned() );
+    aText->SetItalic( aReader.Unsigned() );
+    aText->SetMirrored( aReader.Unsigned() );
+    aText->SetHorizJustify( EDA_TEXT_HJUSTIFY_T( aReader.Int() ) );
+    aText->SetVertJustify( EDA_TEXT_VJUSTIFY_T( aReader.Int() ) );
+    aText->SetDrawCoord();
+}
+
+
+/**
+ * Function loadModules
+ * adds the footprints of the footprint section \a aReader to \a aBoard.  They are
+ * built the way PCB_PARSER builds them, placing the items from their coordinates
+ * relative to the footprint.
+ *
+ * @param aStrings is the string table of the snapshot.
+ * @param aNetCodes caches the net codes by string index.
+ */
+static void loadModules( SNAPSHOT_READER& aReader, const std::vector<wxString>& aStrings,
+                         std::vector<int>& aNetCodes, BOARD* aBoard )
+{
+    wxPoint prev;
+    size_t  count = aReader.Count();
+
+    for( size_t i = 0;  i < count;  ++i )
+    {
+        std::auto_ptr<MODULE>   module( new MODULE( aBoard ) );
+        FPID                    fpid;
+        size_t                  len = aReader.Count();
+
+        if( fpid.Parse( std::string( aReader.Bytes( len ), len ) ) >= 0 )
+            aReader.Damaged();
+
+        module->SetFPID( fpid );
+        module->SetLocked( aReader.Unsigned() );
+        module->SetIsPlaced( aReader.Unsigned() );
+        module->SetLayer( aReader.Layer() );
+        module->SetLastEditTime( (time_t) aReader.Unsigned() );
+        module->SetTimeStamp( (time_t) aReader.Unsigned() );
+
+        // Placed while empty, the items are placed from the footprint afterwards.
+        aReader.Point( prev );
+        module->SetPosition( prev );
+        module->SetOrientation( aReader.Double() );
+
+        module->SetDescription( aReader.String() );
+        module->SetKeywords( aReader.String() );
+        module->SetPath( aReader.String() );
+        module->SetPlacementCost90( aReader.Int() );
+        module->SetPlacementCost180( aReader.Int() );
+        module->SetLocalSolderMaskMargin( aReader.Int() );
+        module->SetLocalSolderPasteMargin( aReader.Int() );
+        module->SetLocalSolderPasteMarginRatio( aReader.Double() );
+        module->SetLocalClearance( aReader.Int() );
+        module->SetZoneConnection( ZoneConnection( aReader.Int() ) );
+        module->SetThermalWidth( aReader.Int() );
+        module->SetThermalGap( aReader.Int() );
+        module->SetAttributes( (int) aReader.Unsigned() );
+
+        loadText( aReader, &module->Reference() );
+        loadText( aReader, &module->Value() );
+
+        size_t graphicCount = aReader.Count();
+
+        for( size_t ii = 0;  ii < graphicCount;  ++ii )
+        {
+            unsigned long long kind = aReader.Unsigned();
+
+            if( kind == SNAPSHOT_TEXT )
+            {
+                TEXTE_MODULE* text = new TEXTE_MODULE( module.get() );
+
+                module->GraphicalItems().PushBack( text );
+                loadText( aReader, text );
+                continue;
+            }
+
+            if( kind != SNAPSHOT_EDGE )
+                aReader.Damaged();
+
+            EDGE_MODULE* edge = new EDGE_MODULE( module.get() );
+
+            module->GraphicalItems().PushBack( edge );
+
+            unsigned long long shape = aReader.Unsigned();
+
+            if( shape >= S_LAST )
+                aReader.Damaged();
+
+            edge->SetShape( STROKE_T( shape ) );
+            edge->SetLayer( aReader.Layer() );
+            edge->SetWidth( aReader.Int() );
+            edge->SetStart0( aReader.Point() );
+            edge->SetEnd0( aReader.Point() );
+
+            switch( edge->GetShape() )
+            {
+            case S_ARC:
+                edge->SetAngle( aReader.Double() );
+                break;
+
+            case S_CURVE:
+                edge->SetBezControl1( aReader.Point() );
+                edge->SetBezControl2( aReader.Point() );
+                break;
+
+            case S_POLYGON:
+                {
+                    std::vector<wxPoint> pts( aReader.Count() );
+
+                    for( size_t jj = 0;  jj < pts.size();  ++jj )
+                        pts[jj] = aReader.Point();
+
+                    edge->SetPolyPoints( pts );
+                }
+                break;
+
+            default:
+                break;
+            }
+
+            edge->SetDrawCoord();
+        }
+
+        size_t padCount = aReader.Count();
+
+        for( size_t ii = 0;  ii < padCount;  ++ii )
+        {
+            D_PAD* pad = new D_PAD( module.get() );
+
+            module->Add( pad );
+
+            pad->SetPadName( aReader.String() );
+
+            unsigned long long shape = aReader.Unsigned();
+            unsigned long long attribute = aReader.Unsigned();
+
+            if( shape > PAD_SHAPE_ROUNDRECT || attribute > PAD_ATTRIB_HOLE_NOT_PLATED )
+                aReader.Damaged();
+
+            pad->SetShape( PAD_SHAPE_T( shape ) );
+            pad->SetAttribute( PAD_ATTR_T( attribute ) );
+            pad->SetPos0( aReader.Point() );
+            pad->SetOrientation( aReader.Double() );
+            pad->SetSize( aReader.Size() );
+            pad->SetDelta( aReader.Size() );
+            pad->SetDrillSize( aReader.Size() );
+            pad->SetDrillShape( PAD_DRILL_SHAPE_T( aReader.Unsigned() ) );
+            pad->SetOffset( aReader.Point() );
+            pad->SetRoundRectRadiusRatio( aReader.Double() );
+
+            LSET    layers;
+            size_t  layerCount = aReader.Count();
+
+            for( size_t jj = 0;  jj < layerCount;  ++jj )
+                layers.set( aReader.Layer() );
+
+            pad->SetLayerSet( layers );
+            pad->SetNetCode( readNetCode( aReader, aStrings, aNetCodes, aBoard ),
+                             /* aNoAssert */ true );
+            pad->SetPadToDieLength( aReader.Int() );
+            pad->SetLocalSolderMaskMargin( aReader.Int() );
+            pad->SetLocalSolderPasteMargin( aReader.Int() );
+            pad->SetLocalSolderPasteMarginRatio( aReader.Double() );
+            pad->SetLocalClearance( aReader.Int() );
+            pad->SetZoneConnection( ZoneConnection( aReader.Int() ) );
+            pad->SetThermalWidth( aReader.Int() );
+            pad->SetThermalGap( aReader.Int() );
+
+            wxPoint pt = pad->GetPos0();
+
+            RotatePoint( &pt, module->GetOrientation() );
+            pad->SetPosition( pt + module->GetPosition() );
+        }
+
+        size_t modelCount = aReader.Count();
+
+        for( size_t ii = 0;  ii < modelCount;  ++ii )
+        {
+            S3D_MASTER* model = new S3D_MASTER( NULL );
+
+            module->Add3DModel( model );
+
+            model->SetShape3DName( aReader.String() );
+            model->m_MatPosition.x = aReader.Double();
+            model->m_MatPosition.y = aReader.Double();
+            model->m_MatPosition.z = aReader.Double();
+            model->m_MatScale.x = aReader.Double();
+            model->m_MatScale.y = aReader.Double();
+            model->m_MatScale.z = aReader.Double();
+            model->m_MatRotation.x = aReader.Double();
+            model->m_MatRotation.y = aReader.Double();
+            model->m_MatRotation.z = aReader.Double();
+        }
+
+        module->CalculateBoundingBox();
+        aBoard->Add( module.release(), ADD_APPEND );
+    }
+}
+
+
+BOARD* SNAPSHOT_PLUGIN::Load( const wxString& aFileName, BOARD* aAppendToMe,
+                              const PROPERTIES* aProperties )
+{
+    LOCALE_IO       toggle;     // toggles on, then off, the C locale.
+
+    SNAPSHOT_FILE   file( aFileName );
+    SNAPSHOT_READER reader( file.Data(), file.Size(), aFileName );
+
+    if( file.Size() < sizeof( snapshotMagic )
+        || memcmp( reader.Bytes( sizeof( snapshotMagic ) ), snapshotMagic, sizeof( snapshotMagic ) ) )
+    {
+        THROW_IO_ERROR( wxString::Format( _( "File '%s' is not a board snapshot file" ),
+                                          GetChars( aFileName ) ) );
+    }
+
+    unsigned long long version = reader.Unsigned();
+
+    if( version != SNAPSHOT_FILE_VERSION )
+    {
+        THROW_IO_ERROR( wxString::Format(
+                _( "Board snapshot file '%s' has format version %d, this Pcbnew reads version %d" ),
+                GetChars( aFileName ), (int) version, SNAPSHOT_FILE_VERSION ) );
+    }
+
+    SNAPSHOT_READER         table = reader.Section();
+    SNAPSHOT_READER         tracks = reader.Section();
+    SNAPSHOT_READER         zones = reader.Section();
+    SNAPSHOT_READER         modules = reader.Section();
+    std::vector<wxString>   strings( table.Count() );
+
+    for( unsigned i = 0;  i < strings.size();  ++i )
+        strings[i] = table.String();
+
+    int firstZone = aAppendToMe ? aAppendToMe->GetAreaCount() : 0;
+
+    // The rest of the file is the board text, without the tracks, zone fills and footprints.
+    MEMORY_LINE_READER  textReader( reader.Pos(), reader.Left(), aFileName );
+    PCB_PARSER          parser( &textReader );
+
+    parser.SetBoard( aAppendToMe );
+
+    BOARD* board = dyn_cast<BOARD*>( parser.Parse() );
+    wxASSERT( board );
+
+    try
+    {
+        std::vector<int> netCodes( strings.size(), -1 );
+
+        loadTracks( tracks, strings, netCodes, board );
+        loadZoneFills( zones, board, firstZone );
+        loadModules( modules, strings, netCodes, board );
+    }
+    catch( const IO_ERROR& )
+    {
+        if( !aAppendToMe )
+            delete board;
+
+        throw;
+    }
+
+    // Give the filename to the board if it's new
+    if( !aAppendToMe )
+        board->SetFileName( aFileName );
+
+    return board;
+}
@@ -0,0 +1,88 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file snapshot_plugin.h
+ * @brief Binary board snapshot file plugin definition file.
+ */
+
+#ifndef SNAPSHOT_PLUGIN_H_
+#define SNAPSHOT_PLUGIN_H_
+
+#include <io_mgr.h>
+
+
+/// Current board snapshot format version, bump it when the layout changes.
+#define SNAPSHOT_FILE_VERSION       2
+
+
+/**
+ * Class SNAPSHOT_PLUGIN
+ * is a PLUGIN derivation which saves and loads a BOARD as a binary snapshot, for
+ * autosave, crash recovery and scripted pipelines.  It is not meant for exchange,
+ * a snapshot is only read back by the same format version that wrote it.
+ * <p>
+ * The file holds, in this order:
+ * <ul>
+ * <li> a magic string and the snapshot format version,
+ * <li> a string table, holding the net names used by the tracks and pads,
+ * <li> the tracks and vias, coordinates delta encoded into variable length integers,
+ * <li> the filled polygons and fill segments of the zones, packed the same way,
+ * <li> the footprints, with their texts, graphic items, pads and 3D models,
+ * <li> the rest of the board, as kicad_pcb s-expression text up to the end of the file.
+ * </ul>
+ * The file is mapped into memory to load it.  Only the text part is read by PCB_PARSER:
+ * the setup, nets, net classes, board graphics and zone outlines, which are a small part
+ * of a routed and filled board.
+ *
+ * @note This class is not thread safe, but it is re-entrant multiple times in sequence.
+ */
+class SNAPSHOT_PLUGIN : public PLUGIN
+{
+public:
+
+    //-----<PLUGIN API>---------------------------------------------------------
+
+    const wxString PluginName() const
+    {
+        return wxT( "KiCad-Snapshot" );
+    }
+
+    const wxString GetFileExtension() const
+    {
+        return wxT( "kicad_snap" );
+    }
+
+    void Save( const wxString& aFileName, BOARD* aBoard,
+               const PROPERTIES* aProperties = NULL );          // overload
+
+    BOARD* Load( const wxString& aFileName, BOARD* aAppendToMe,
+                 const PROPERTIES* aProperties = NULL );        // overload
+
+    //-----</PLUGIN API>--------------------------------------------------------
+
+    SNAPSHOT_PLUGIN() {}
+
+    ~SNAPSHOT_PLUGIN() {}
+};
+
+#endif  // SNAPSHOT_PLUGIN_H_
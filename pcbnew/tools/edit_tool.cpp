@@ -56,7 +56,7 @@
 
 EDIT_TOOL::EDIT_TOOL() :
     TOOL_INTERACTIVE( "pcbnew.InteractiveEdit" ), m_selectionTool( NULL ),
-    m_dragging( false ), m_editModules( false ), m_undoInhibit( 0 ),
+    m_dragging( false ), m_dragUndo( NULL ), m_editModules( false ), m_undoInhibit( 0 ),
     m_updateFlag( KIGFX::VIEW_ITEM::NONE )
 {
 }
@@ -65,6 +65,7 @@ EDIT_TOOL::EDIT_TOOL() :
 void EDIT_TOOL::Reset( RESET_REASON aReason )
 {
     m_dragging = false;
+    m_dragUndo = NULL;
     m_updateFlag = KIGFX::VIEW_ITEM::NONE;
 }
 
@@ -215,11 +216,22 @@ int EDIT_TOOL::Main( const TOOL_EVENT& aEvent )
                     else if( lockFlags == SELECTION_LOCK_OVERRIDE )
                         lockOverride = true;
 
-                    // Save items, so changes can be undone
+                    // Save items, so changes can be undone. On boards, only the move vector
+                    // is stored, see finishDragUndo() and keepDragUndoCopies()
                     if( !isUndoInhibited() )
                     {
                         editFrame->OnModify();
-                        editFrame->SaveCopyInUndoList( selection.items, UR_CHANGED );
+
+                        if( m_editModules )
+                        {
+                            editFrame->SaveCopyInUndoList( selection.items, UR_CHANGED );
+                        }
+                        else
+                        {
+                            editFrame->SaveCopyInUndoList( selection.items, UR_MOVED );
+                            m_dragUndo = editFrame->GetScreen()->m_UndoList.m_CommandsList.back();
+                            m_dragOrigin = selection.Item<BOARD_ITEM>( 0 )->GetPosition();
+                        }
                     }
 
                     m_cursor = controls->GetCursorPosition();
@@ -246,6 +258,10 @@ int EDIT_TOOL::Main( const TOOL_EVENT& aEvent )
                     controls->SetAutoPan( true );
                     m_dragging = true;
                     incUndoInhibit();
+
+                    // Items are not in their final place until the drag ends:
+                    // no undo/redo, and no incremental DRC until then
+                    editFrame->UndoRedoBlock( true );
                 }
             }
 
@@ -269,6 +285,7 @@ int EDIT_TOOL::Main( const TOOL_EVENT& aEvent )
             }
             else if( evt->IsAction( &COMMON_ACTIONS::remove ) )
             {
+                finishDragUndo( selection );
                 Remove( aEvent );
 
                 break;       // exit the loop, as there is no further processing for removed items
@@ -315,7 +332,11 @@ int EDIT_TOOL::Main( const TOOL_EVENT& aEvent )
     } while( ( evt = Wait() ) ); //Should be assignment not equality test
 
     if( m_dragging )
+    {
+        finishDragUndo( selection );
         decUndoInhibit();
+        editFrame->UndoRedoBlock( false );
+    }
 
     m_dragging = false;
     m_offset.x = 0;
@@ -433,12 +454,16 @@ int EDIT_TOOL::Rotate( const TOOL_EVENT& aEvent )
 
     wxPoint rotatePoint = getModificationPoint( selection );
 
-    // If it is being dragged, then it is already saved with UR_CHANGED flag
+    // If it is being dragged, then it is already saved
     if( !isUndoInhibited() )
     {
         editFrame->OnModify();
         editFrame->SaveCopyInUndoList( selection.items, UR_ROTATED, rotatePoint );
     }
+    else
+    {
+        keepDragUndoCopies( selection );
+    }
 
     for( unsigned int i = 0; i < selection.items.GetCount(); ++i )
     {
@@ -483,11 +508,15 @@ int EDIT_TOOL::Flip( const TOOL_EVENT& aEvent )
 
     wxPoint flipPoint = getModificationPoint( selection );
 
-    if( !isUndoInhibited() )   // If it is being dragged, then it is already saved with UR_CHANGED flag
+    if( !isUndoInhibited() )   // If it is being dragged, then it is already saved
     {
         editFrame->OnModify();
         editFrame->SaveCopyInUndoList( selection.items, UR_FLIPPED, flipPoint );
     }
+    else
+    {
+        keepDragUndoCopies( selection );
+    }
 
     for( unsigned int i = 0; i < selection.items.GetCount(); ++i )
     {
@@ -962,6 +991,45 @@ bool EDIT_TOOL::hoverSelection( const SELECTION& aSelection, bool aSanitize )
     return !aSelection.Empty();
 }
 
+void EDIT_TOOL::finishDragUndo( const SELECTION& aSelection )
+{
+    if( m_dragUndo == NULL )
+        return;
+
+    // All the items were moved by the same vector
+    if( !aSelection.Empty() )
+        m_dragUndo->m_TransformPoint = aSelection.Item<BOARD_ITEM>( 0 )->GetPosition() -
+                                       m_dragOrigin;
+
+    m_dragUndo = NULL;
+}
+
+
+void EDIT_TOOL::keepDragUndoCopies( const SELECTION& aSelection )
+{
+    if( m_dragUndo == NULL || aSelection.Empty() )
+        return;
+
+    wxPoint movement = aSelection.Item<BOARD_ITEM>( 0 )->GetPosition() - m_dragOrigin;
+
+    // Items saved as changed (e.g. the parent module of a text) have their copy already
+    for( unsigned int i = 0; i < m_dragUndo->GetCount(); ++i )
+    {
+        if( m_dragUndo->GetPickedItemStatus( i ) != UR_MOVED )
+            continue;
+
+        BOARD_ITEM* item = static_cast<BOARD_ITEM*>( m_dragUndo->GetPickedItem( i ) );
+        BOARD_ITEM* copy = static_cast<BOARD_ITEM*>( item->Clone() );
+
+        copy->Move( -movement );
+        m_dragUndo->SetPickedItemLink( copy, i );
+        m_dragUndo->SetPickedItemStatus( UR_CHANGED, i );
+    }
+
+    m_dragUndo = NULL;
+}
+
+
 void EDIT_TOOL::processUndoBuffer( const PICKED_ITEMS_LIST* aLastChange )
 {
     PCB_BASE_EDIT_FRAME* editFrame = getEditFrame<PCB_BASE_EDIT_FRAME>();
@@ -999,6 +1067,9 @@ void EDIT_TOOL::processPickedList( const PICKED_ITEMS_LIST* aList )
         switch( operation )
         {
         case UR_CHANGED:
+        case UR_MOVED:
+        case UR_ZONE_OUTLINE:
+        case UR_ZONE_FILL:
             ratsnest->Update( updItem );
             // fall through
 
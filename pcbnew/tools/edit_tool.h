@@ -139,6 +139,12 @@ private:
     ///> Offset from the dragged item's center (anchor)
     wxPoint m_offset;
 
+    ///> Undo command of the current drag, as long as it only records the move vector
+    PICKED_ITEMS_LIST* m_dragUndo;
+
+    ///> Position of the first dragged item when the drag started
+    wxPoint m_dragOrigin;
+
     ///> Last cursor position (needed for getModificationPoint() to avoid changes
     ///> of edit reference point).
     VECTOR2I m_cursor;
@@ -185,6 +191,13 @@ private:
     ///> Updates items stored in the list.
     void processPickedList( const PICKED_ITEMS_LIST* aList );
 
+    ///> Stores the move vector of the current drag in its undo command, once the drag ends.
+    void finishDragUndo( const SELECTION& aSelection );
+
+    ///> Turns the undo command of the current drag into copies of the dragged items, as they
+    ///> were before the drag, when they are going to be changed by more than a move.
+    void keepDragUndoCopies( const SELECTION& aSelection );
+
     /**
      * Increments the undo inhibit counter. This will indicate that tools
      * should not create an undo point, as another tool is doing it already,
@@ -431,23 +431,45 @@ int PCB_EDITOR_CONTROL::PlaceTarget( const TOOL_EVENT& aEvent )
 
 
 // Zone actions
+/**
+ * Function saveZoneFill
+ * moves the filled areas of \a aZone to a copy of the zone without its outline data, which
+ * is added to \a aUndoList as the UR_ZONE_FILL copy of the zone.  The filled areas are not
+ * copied, \a aZone is left unfilled.
+ */
+static void saveZoneFill( PICKED_ITEMS_LIST& aUndoList, ZONE_CONTAINER* aZone )
+{
+    ZONE_CONTAINER* image = aZone->CloneWithoutFill();
+    image->SwapFill( aZone );
+
+    ITEM_PICKER picker( aZone, UR_ZONE_FILL );
+    picker.SetLink( image );
+    aUndoList.PushItem( picker );
+}
+
+
 int PCB_EDITOR_CONTROL::ZoneFill( const TOOL_EVENT& aEvent )
 {
     SELECTION_TOOL* selTool = m_toolMgr->GetTool<SELECTION_TOOL>();
     const SELECTION& selection = selTool->GetSelection();
     RN_DATA* ratsnest = getModel<BOARD>()->GetRatsnest();
+    PICKED_ITEMS_LIST undoList;
 
     for( int i = 0; i < selection.Size(); ++i )
     {
         assert( selection.Item<BOARD_ITEM>( i )->Type() == PCB_ZONE_AREA_T );
 
         ZONE_CONTAINER* zone = selection.Item<ZONE_CONTAINER>( i );
+        saveZoneFill( undoList, zone );
         m_frame->Fill_Zone( zone );
         zone->SetIsFilled( true );
         ratsnest->Update( zone );
         zone->ViewUpdate();
     }
 
+    if( undoList.GetCount() )
+        m_frame->SaveCopyInUndoList( undoList, UR_ZONE_FILL );
+
     ratsnest->Recalculate();
 
     return 0;
@@ -458,16 +480,21 @@ int PCB_EDITOR_CONTROL::ZoneFillAll( const TOOL_EVENT& aEvent )
 {
     BOARD* board = getModel<BOARD>();
     RN_DATA* ratsnest = board->GetRatsnest();
+    PICKED_ITEMS_LIST undoList;
 
     for( int i = 0; i < board->GetAreaCount(); ++i )
     {
         ZONE_CONTAINER* zone = board->GetArea( i );
+        saveZoneFill( undoList, zone );
         m_frame->Fill_Zone( zone );
         zone->SetIsFilled( true );
         ratsnest->Update( zone );
         zone->ViewUpdate();
     }
 
+    if( undoList.GetCount() )
+        m_frame->SaveCopyInUndoList( undoList, UR_ZONE_FILL );
+
     ratsnest->Recalculate();
 
     return 0;
@@ -479,18 +506,21 @@ int PCB_EDITOR_CONTROL::ZoneUnfill( const TOOL_EVENT& aEvent )
     SELECTION_TOOL* selTool = m_toolMgr->GetTool<SELECTION_TOOL>();
     const SELECTION& selection = selTool->GetSelection();
     RN_DATA* ratsnest = getModel<BOARD>()->GetRatsnest();
+    PICKED_ITEMS_LIST undoList;
 
     for( int i = 0; i < selection.Size(); ++i )
     {
         assert( selection.Item<BOARD_ITEM>( i )->Type() == PCB_ZONE_AREA_T );
 
         ZONE_CONTAINER* zone = selection.Item<ZONE_CONTAINER>( i );
-        zone->SetIsFilled( false );
-        zone->ClearFilledPolysList();
+        saveZoneFill( undoList, zone );     // leaves the zone unfilled
         ratsnest->Update( zone );
         zone->ViewUpdate();
     }
 
+    if( undoList.GetCount() )
+        m_frame->SaveCopyInUndoList( undoList, UR_ZONE_FILL );
+
     ratsnest->Recalculate();
 
     return 0;
@@ -501,16 +531,19 @@ int PCB_EDITOR_CONTROL::ZoneUnfillAll( const TOOL_EVENT& aEvent )
 {
     BOARD* board = getModel<BOARD>();
     RN_DATA* ratsnest = board->GetRatsnest();
+    PICKED_ITEMS_LIST undoList;
 
     for( int i = 0; i < board->GetAreaCount(); ++i )
     {
         ZONE_CONTAINER* zone = board->GetArea( i );
-        zone->SetIsFilled( false );
-        zone->ClearFilledPolysList();
+        saveZoneFill( undoList, zone );     // leaves the zone unfilled
         ratsnest->Update( zone );
         zone->ViewUpdate();
     }
 
+    if( undoList.GetCount() )
+        m_frame->SaveCopyInUndoList( undoList, UR_ZONE_FILL );
+
     ratsnest->Recalculate();
 
     return 0;
@@ -566,7 +599,8 @@ int PCB_EDITOR_CONTROL::ZoneMerge( const TOOL_EVENT& aEvent )
 
             if( b1.Intersects( b2 ) )
             {
-                EDA_ITEM* backup = curr_area->Clone();
+                // Merging does not change the filled areas, they are not saved
+                EDA_ITEM* backup = curr_area->CloneWithoutFill();
                 bool ret = board->TestAreaIntersection( curr_area, area2 );
 
                 if( ret && board->CombineAreas( &changes, curr_area, area2 ) )
@@ -574,7 +608,7 @@ int PCB_EDITOR_CONTROL::ZoneMerge( const TOOL_EVENT& aEvent )
                     mod_ia1 = true;
                     selection.items.RemovePicker( ia2 );
 
-                    ITEM_PICKER picker( curr_area, UR_CHANGED );
+                    ITEM_PICKER picker( curr_area, UR_ZONE_OUTLINE );
                     picker.SetLink( backup );
                     changes.PushItem( picker );
                 }
@@ -602,7 +636,7 @@ int PCB_EDITOR_CONTROL::ZoneMerge( const TOOL_EVENT& aEvent )
             view->Remove( item );
             ratsnest->Remove( item );
         }
-        else if( picker.GetStatus() == UR_CHANGED )
+        else if( picker.GetStatus() == UR_ZONE_OUTLINE )
         {
             item->ViewUpdate( KIGFX::VIEW_ITEM::ALL );
             m_toolMgr->RunAction( COMMON_ACTIONS::selectItem, true, item );
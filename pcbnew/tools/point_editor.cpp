@@ -722,8 +722,9 @@ void POINT_EDITOR::addCorner( const VECTOR2I& aBreakPoint )
 
     if( item->Type() == PCB_ZONE_AREA_T )
     {
+        // Adding a corner does not change the filled areas, they are not saved
         getEditFrame<PCB_BASE_FRAME>()->OnModify();
-        getEditFrame<PCB_BASE_FRAME>()->SaveCopyInUndoList( selection.items, UR_CHANGED );
+        getEditFrame<PCB_BASE_FRAME>()->SaveCopyInUndoList( selection.items, UR_ZONE_OUTLINE );
 
         ZONE_CONTAINER* zone = static_cast<ZONE_CONTAINER*>( item );
         CPolyLine* outline = zone->Outline();
@@ -835,7 +836,7 @@ void POINT_EDITOR::removeCorner( EDIT_POINT* aPoint )
             if( VECTOR2I( outline->GetPos( i ) ) == aPoint->GetPosition() )
             {
                 frame->OnModify();
-                frame->SaveCopyInUndoList( selection.items, UR_CHANGED );
+                frame->SaveCopyInUndoList( selection.items, UR_ZONE_OUTLINE );
                 outline->DeleteCorner( i );
                 setEditedPoint( NULL );
                 break;
@@ -28,6 +28,7 @@
 
 
 #include <algorithm> // sort
+#include <memory>
 
 #include <wx/wx.h>
 #include <trigo.h>
@@ -64,64 +65,87 @@ bool ZONE_CONTAINER::BuildFilledSolidAreasPolygons( BOARD* aPcb, SHAPE_POLY_SET*
     if( GetNumCorners() <= 2 )  // malformed zone. polygon calculations do not like it ...
         return 0;
 
-    // Make a smoothed polygon out of the user-drawn polygon if required
-    if( m_smoothedPoly )
+    // Only the outline is wanted: do not modify the zone, because outlines of other
+    // zones are used when filling a zone, and zones can be filled by several threads.
+    if( aOutlineBuffer )
     {
-        delete m_smoothedPoly;
-        m_smoothedPoly = NULL;
+        std::auto_ptr<CPolyLine> smoothedPoly( buildSmoothedPoly() );
+        aOutlineBuffer->Append( ConvertPolyListToPolySet( smoothedPoly->m_CornersList ) );
+        return true;
     }
 
-    switch( m_cornerSmoothingType )
-    {
-    case ZONE_SETTINGS::SMOOTHING_CHAMFER:
-        m_smoothedPoly = m_Poly->Chamfer( m_cornerRadius );
-        break;
+    if( !BuildFilledPolysList( aPcb ) )
+        return false;
 
-    case ZONE_SETTINGS::SMOOTHING_FILLET:
-        m_smoothedPoly = m_Poly->Fillet( m_cornerRadius, m_ArcToSegmentsCount );
-        break;
+    if( m_FillMode )   // if fill mode uses segments, create them:
+        FillZoneAreasWithSegments();
 
-    default:
-        // Acute angles between adjacent edges can create issues in calculations,
-        // in inflate/deflate outlines transforms, especially when the angle is very small.
-        // We can avoid issues by creating a very small chamfer which remove acute angles,
-        // or left it without chamfer and use only CPOLYGONS_LIST::InflateOutline to create
-        // clearance areas
-        m_smoothedPoly = m_Poly->Chamfer( Millimeter2iu( 0.0 ) );
-        break;
-    }
+    m_IsFilled = true;
 
-    if( aOutlineBuffer )
-        aOutlineBuffer->Append( ConvertPolyListToPolySet( m_smoothedPoly->m_CornersList ) );
+    return true;
+}
+
+
+bool ZONE_CONTAINER::BuildFilledPolysList( BOARD* aPcb )
+{
+    if( GetNumCorners() <= 2 )  // malformed zone. polygon calculations do not like it ...
+        return false;
+
+    // Make a smoothed polygon out of the user-drawn polygon if required
+    delete m_smoothedPoly;
+    m_smoothedPoly = buildSmoothedPoly();
 
     /* For copper layers, we now must add holes in the Polygon list.
      * holes are pads and tracks with their clearance area
      * for non copper layers just recalculate the m_FilledPolysList
      * with m_ZoneMinThickness taken in account
      */
+    m_FilledPolysList.RemoveAllContours();
+
+    if( IsOnCopperLayer() )
+    {
+        AddClearanceAreasPolygonsToPolysList_NG( aPcb );
+    }
     else
     {
-        m_FilledPolysList.RemoveAllContours();
+        int margin = m_ZoneMinThickness / 2;
+        m_FilledPolysList = ConvertPolyListToPolySet( m_smoothedPoly->m_CornersList );
+        m_FilledPolysList.Inflate( -margin, 16 );
+        m_FilledPolysList.Fracture( SHAPE_POLY_SET::PM_FAST );
+    }
 
-        if( IsOnCopperLayer() )
-        {
-            AddClearanceAreasPolygonsToPolysList_NG( aPcb );
-        }
-        else
-        {
-            int margin = m_ZoneMinThickness / 2;
-            m_FilledPolysList = ConvertPolyListToPolySet( m_smoothedPoly->m_CornersList );
-            m_FilledPolysList.Inflate( -margin, 16 );
-            m_FilledPolysList.Fracture( SHAPE_POLY_SET::PM_FAST );
-        }
+    return true;
+}
 
-        if( m_FillMode )   // if fill mode uses segments, create them:
-            FillZoneAreasWithSegments();
 
-        m_IsFilled = true;
+CPolyLine* ZONE_CONTAINER::buildSmoothedPoly() const
+{
+    switch( m_cornerSmoothingType )
+    {
+    case ZONE_SETTINGS::SMOOTHING_CHAMFER:
+        return m_Poly->Chamfer( m_cornerRadius );
+
+    case ZONE_SETTINGS::SMOOTHING_FILLET:
+        return m_Poly->Fillet( m_cornerRadius, m_ArcToSegmentsCount );
+
+    default:
+        // Acute angles between adjacent edges can create issues in calculations,
+        // in inflate/deflate outlines transforms, especially when the angle is very small.
+        // We can avoid issues by creating a very small chamfer which remove acute angles,
+        // or left it without chamfer and use only CPOLYGONS_LIST::InflateOutline to create
+        // clearance areas
+        return m_Poly->Chamfer( Millimeter2iu( 0.0 ) );
     }
+}
 
-    return true;
+
+void ZONE_CONTAINER::SwapFilledAreas( ZONE_CONTAINER& aZone )
+{
+    std::swap( m_smoothedPoly, aZone.m_smoothedPoly );
+    std::swap( m_FilledPolysList, aZone.m_FilledPolysList );
+    std::swap( m_FillSegmList, aZone.m_FillSegmList );
+    std::swap( m_IsFilled, aZone.m_IsFilled );
+    m_holeCache.Swap( aZone.m_holeCache );
 }
 
 
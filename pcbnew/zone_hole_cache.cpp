@@ -0,0 +1,145 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file zone_hole_cache.cpp
+ */
+
+#include <fctsys.h>
+
+#include <class_pad.h>
+#include <class_track.h>
+
+#include <zone_hole_cache.h>
+
+
+ZONE_HOLE_CACHE::SIGNATURE::SIGNATURE()
+{
+    std::fill( m_values, m_values + SIZE, 0.0 );
+}
+
+
+bool ZONE_HOLE_CACHE::SIGNATURE::operator==( const SIGNATURE& aOther ) const
+{
+    return std::equal( m_values, m_values + SIZE, aOther.m_values );
+}
+
+
+void ZONE_HOLE_CACHE::EndFill()
+{
+    for( CACHE_MAP::iterator it = m_cache.begin(); it != m_cache.end(); )
+    {
+        if( it->second.m_lastFill != m_fillCount )
+            m_cache.erase( it++ );
+        else
+            ++it;
+    }
+}
+
+
+ZONE_HOLE_CACHE::ENTRY& ZONE_HOLE_CACHE::findEntry( const BOARD_ITEM* aKey,
+                                                    const SIGNATURE& aSignature,
+                                                    bool& aUpToDate )
+{
+    ENTRY& entry = m_cache[aKey];
+
+    // A new entry has a null signature, which cannot match an item signature
+    // (its first value is the item type)
+    aUpToDate = entry.m_signature == aSignature;
+
+    if( !aUpToDate )
+    {
+        entry.m_signature = aSignature;
+        entry.m_polys.RemoveAllContours();
+    }
+
+    entry.m_lastFill = m_fillCount;
+
+    return entry;
+}
+
+
+const SHAPE_POLY_SET& ZONE_HOLE_CACHE::GetTrackPolygons( const TRACK* aTrack,
+                                                         int aClearanceValue,
+                                                         int aCircleToSegmentsCount,
+                                                         double aCorrectionFactor )
+{
+    SIGNATURE signature;
+    double*   values = signature.m_values;
+
+    values[0] = aTrack->Type();
+    values[1] = aTrack->GetStart().x;
+    values[2] = aTrack->GetStart().y;
+    values[3] = aTrack->GetEnd().x;
+    values[4] = aTrack->GetEnd().y;
+    values[5] = aTrack->GetWidth();
+    values[6] = aClearanceValue;
+    values[7] = aCircleToSegmentsCount;
+    values[8] = aCorrectionFactor;
+
+    bool   upToDate;
+    ENTRY& entry = findEntry( aTrack, signature, upToDate );
+
+    if( !upToDate )
+        aTrack->TransformShapeWithClearanceToPolygon( entry.m_polys, aClearanceValue,
+                                                      aCircleToSegmentsCount,
+                                                      aCorrectionFactor );
+
+    return entry.m_polys;
+}
+
+
+const SHAPE_POLY_SET& ZONE_HOLE_CACHE::GetPadPolygons( const BOARD_ITEM* aKey,
+                                                       const D_PAD* aPad,
+                                                       int aClearanceValue,
+                                                       int aCircleToSegmentsCount,
+                                                       double aCorrectionFactor )
+{
+    SIGNATURE signature;
+    double*   values = signature.m_values;
+    wxPoint   shapePos = aPad->ShapePos();
+
+    values[0] = aPad->Type();
+    values[1] = aPad->GetShape();
+    values[2] = shapePos.x;
+    values[3] = shapePos.y;
+    values[4] = aPad->GetSize().x;
+    values[5] = aPad->GetSize().y;
+    values[6] = aPad->GetDelta().x;
+    values[7] = aPad->GetDelta().y;
+    values[8] = aPad->GetOrientation();
+    values[9] = aPad->GetShape() == PAD_SHAPE_ROUNDRECT ? aPad->GetRoundRectCornerRadius() : 0;
+    values[10] = aClearanceValue;
+    values[11] = aCircleToSegmentsCount;
+    values[12] = aCorrectionFactor;
+
+    bool   upToDate;
+    ENTRY& entry = findEntry( aKey, signature, upToDate );
+
+    if( !upToDate )
+        aPad->TransformShapeWithClearanceToPolygon( entry.m_polys, aClearanceValue,
+                                                    aCircleToSegmentsCount,
+                                                    aCorrectionFactor );
+
+    return entry.m_polys;
+}
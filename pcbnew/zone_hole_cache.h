@@ -0,0 +1,139 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file zone_hole_cache.h
+ */
+
+#ifndef ZONE_HOLE_CACHE_H
+#define ZONE_HOLE_CACHE_H
+
+#include <algorithm>
+#include <map>
+
+#include <geometry/shape_poly_set.h>
+
+class BOARD_ITEM;
+class TRACK;
+class D_PAD;
+
+
+/**
+ * Class ZONE_HOLE_CACHE
+ * keeps the clearance polygons of the pads and tracks removed from a zone by the
+ * last fill, so the next fill only builds again the polygons of the items which
+ * have changed.
+ *
+ * Entries are keyed by item, and store all the parameters the polygons were built from
+ * (the item shape, position, size, and the clearance and arc approximation used).
+ * Cached polygons are used only when these parameters are unchanged, so they are always
+ * the same as the polygons built from scratch, even if the item has been edited without
+ * notice, or if the memory of a deleted item has been reused for a new item.
+ *
+ * A fill is done between BeginFill() and EndFill(): entries not used by the fill
+ * (items deleted, or moved away from the zone) are dropped by EndFill().
+ */
+class ZONE_HOLE_CACHE
+{
+public:
+    ZONE_HOLE_CACHE() : m_fillCount( 0 ) {}
+
+    /**
+     * Function BeginFill
+     * starts a new fill.
+     */
+    void BeginFill() { m_fillCount++; }
+
+    /**
+     * Function EndFill
+     * removes the entries not used since BeginFill().
+     */
+    void EndFill();
+
+    /**
+     * Function Clear
+     * removes all entries.
+     */
+    void Clear() { m_cache.clear(); }
+
+    void Swap( ZONE_HOLE_CACHE& aOther )
+    {
+        m_cache.swap( aOther.m_cache );
+        std::swap( m_fillCount, aOther.m_fillCount );
+    }
+
+    /**
+     * Function GetTrackPolygons
+     * @return the polygons built by TRACK::TransformShapeWithClearanceToPolygon()
+     * for aTrack and the given parameters.
+     */
+    const SHAPE_POLY_SET& GetTrackPolygons( const TRACK* aTrack, int aClearanceValue,
+                                            int aCircleToSegmentsCount,
+                                            double aCorrectionFactor );
+
+    /**
+     * Function GetPadPolygons
+     * @return the polygons built by D_PAD::TransformShapeWithClearanceToPolygon()
+     * for aPad and the given parameters.
+     * @param aKey is the item used as key: usually aPad, but this is the actual pad
+     * when aPad is a dummy pad which has the shape of its hole.
+     */
+    const SHAPE_POLY_SET& GetPadPolygons( const BOARD_ITEM* aKey, const D_PAD* aPad,
+                                          int aClearanceValue, int aCircleToSegmentsCount,
+                                          double aCorrectionFactor );
+
+private:
+    /// The parameters the polygons of an item are built from
+    struct SIGNATURE
+    {
+        enum { SIZE = 13 };
+
+        SIGNATURE();
+
+        bool operator==( const SIGNATURE& aOther ) const;
+
+        double m_values[SIZE];
+    };
+
+    struct ENTRY
+    {
+        SIGNATURE      m_signature;
+        SHAPE_POLY_SET m_polys;
+        unsigned       m_lastFill;      ///< the last fill which used this entry
+    };
+
+    typedef std::map<const BOARD_ITEM*, ENTRY> CACHE_MAP;
+
+    /**
+     * Function findEntry
+     * @return the entry of aKey, marked as used by the current fill.
+     * @param aUpToDate is set to true if the entry polygons were built from aSignature.
+     * Otherwise the signature is updated and the polygons are cleared.
+     */
+    ENTRY& findEntry( const BOARD_ITEM* aKey, const SIGNATURE& aSignature, bool& aUpToDate );
+
+    CACHE_MAP m_cache;
+    unsigned  m_fillCount;
+};
+
+#endif  // ZONE_HOLE_CACHE_H
@@ -956,7 +956,7 @@ void PCB_EDIT_FRAME::Delete_Zone_Contour( wxDC* DC, ZONE_CONTAINER* aZone )
 
     else
     {
-        SaveCopyInUndoList( aZone, UR_CHANGED );
+        SaveCopyInUndoList( aZone, UR_ZONE_OUTLINE );
         aZone->Outline()->RemoveContour( ncont );
     }
 
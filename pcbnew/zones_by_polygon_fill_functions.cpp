@@ -35,6 +35,7 @@
 #include <ratsnest_data.h>
 #include <wxPcbStruct.h>
 #include <macros.h>
+#include <confirm.h>
 
 #include <class_board.h>
 #include <class_track.h>
@@ -43,6 +44,13 @@
 #include <pcbnew.h>
 #include <zones.h>
 
+#include <algorithm>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif /* USE_OPENMP */
+
 #define FORMAT_STRING _( "Filling zone %d out of %d (net %s)..." )
 
 
@@ -124,6 +132,153 @@ int PCB_EDIT_FRAME::Fill_Zone( ZONE_CONTAINER* aZone )
 }
 
 
+/* Returns the number of zones filled at the same time:
+ * one per thread
+ */
+static int zoneFillThreadCount()
+{
+#ifdef USE_OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+
+// Sort function to fill zones in priority order, and in list order for a given priority
+static bool sortZonesByPriority( const std::pair<int, ZONE_CONTAINER*>& aRef,
+                                 const std::pair<int, ZONE_CONTAINER*>& aTst )
+{
+    if( aRef.second->GetPriority() != aTst.second->GetPriority() )
+        return aRef.second->GetPriority() > aTst.second->GetPriority();
+
+    return aRef.first < aTst.first;
+}
+
+
+int PCB_EDIT_FRAME::fillZonesInParallel( wxProgressDialog* aProgressDialog,
+                                         wxArrayString& aErrors )
+{
+    BOARD*   board = GetBoard();
+    int      areaCount = board->GetAreaCount();
+    wxString msg;
+
+    // Zones to fill, with their index in the board zone list
+    std::vector< std::pair<int, ZONE_CONTAINER*> > zones;
+
+    for( int ii = 0; ii < areaCount; ii++ )
+    {
+        ZONE_CONTAINER* zone = board->GetArea( ii );
+
+        if( !zone->GetIsKeepout() )
+            zones.push_back( std::make_pair( ii, zone ) );
+    }
+
+    std::sort( zones.begin(), zones.end(), sortZonesByPriority );
+
+    // Filling a zone does not depend on the filling of other zones (only on their outlines),
+    // so zones are filled in copies by worker threads, while the board and its zones
+    // are only read. Copies are created, and committed to the board in priority order,
+    // on this (the UI) thread, by blocks of one zone per thread, so the progress bar
+    // can be updated and the fill aborted between two blocks.
+    // A zone not yet committed when the fill is aborted keeps its previous filling.
+    int blockSize = zoneFillThreadCount();
+    int zoneCount = zones.size();
+    int committed = 0;
+
+    for( int blockStart = 0; blockStart < zoneCount; blockStart += blockSize )
+    {
+        int blockEnd = std::min( blockStart + blockSize, zoneCount );
+
+        boost::ptr_vector<ZONE_CONTAINER> copies;
+        std::vector<char> filled( blockEnd - blockStart, false );
+        std::vector<std::string> failures( blockEnd - blockStart );
+
+        for( int ii = blockStart; ii < blockEnd; ++ii )
+        {
+            // The old filled areas are not copied: the copy is filled again
+            copies.push_back( zones[ii].second->CloneWithoutFill() );
+
+            // The copy uses the hole cache of the zone (given back by SwapFilledAreas())
+            copies.back().GetHoleCache().Swap( zones[ii].second->GetHoleCache() );
+        }
+
+#ifdef USE_OPENMP
+        #pragma omp parallel for schedule(dynamic, 1)
+#endif
+        for( int ii = 0; ii < blockEnd - blockStart; ++ii )
+        {
+            // An exception cannot leave a worker thread: it is kept, and reported
+            // with the other errors on this thread, which creates the messages
+            try
+            {
+                filled[ii] = copies[ii].BuildFilledPolysList( board );
+            }
+            catch( const std::exception& e )
+            {
+                failures[ii] = e.what();
+            }
+            catch( ... )
+            {
+                // Reported without a reason, as a zone which cannot be filled
+            }
+        }
+
+        for( int ii = blockStart; ii < blockEnd; ++ii )
+        {
+            ZONE_CONTAINER* zone = zones[ii].second;
+
+            msg.Printf( FORMAT_STRING, committed + 1, zoneCount, GetChars( zone->GetNetname() ) );
+
+            if( aProgressDialog && !aProgressDialog->Update( committed + 1, msg ) )
+            {
+                // Aborted by user: give back the hole caches of zones not committed
+                for( int jj = ii; jj < blockEnd; ++jj )
+                {
+                    ZONE_HOLE_CACHE& cache = copies[jj - blockStart].GetHoleCache();
+                    zones[jj].second->GetHoleCache().Swap( cache );
+                }
+
+                return committed;
+            }
+
+            zone->UnFill();
+
+            if( !filled[ii - blockStart] )
+            {
+                wxString error;
+
+                error.Printf( _( "Zone %d (net %s) cannot be filled" ),
+                              zones[ii].first + 1, GetChars( zone->GetNetname() ) );
+
+                if( !failures[ii - blockStart].empty() )
+                    error << wxT( ": " ) << FROM_UTF8( failures[ii - blockStart].c_str() );
+
+                aErrors.Add( error );
+            }
+            else
+            {
+                zone->SwapFilledAreas( copies[ii - blockStart] );
+
+                // Fill segments are created here, because an error is shown in a message box
+                if( zone->GetFillMode() )
+                    zone->FillZoneAreasWithSegments();
+
+                zone->SetIsFilled( true );
+            }
+
+            zone->ViewUpdate( KIGFX::VIEW_ITEM::ALL );
+            board->GetRatsnest()->Update( zone );
+            OnModify();
+
+            committed++;
+        }
+    }
+
+    return committed;
+}
+
+
 int PCB_EDIT_FRAME::Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose )
 {
     int errorLevel = 0;
@@ -150,24 +305,43 @@ int PCB_EDIT_FRAME::Fill_All_Zones( wxWindow * aActiveWindow, bool aVerbose )
 
     int ii;
 
-    for( ii = 0; ii < areaCount; ii++ )
+    // The zone dump file cannot be written by several threads
+    if( g_FillZonesInParallel && !g_DumpZonesWhenFilling )
     {
-        ZONE_CONTAINER* zoneContainer = GetBoard()->GetArea( ii );
-        if( zoneContainer->GetIsKeepout() )
-            continue;
+        wxArrayString errors;
 
-        msg.Printf( FORMAT_STRING, ii + 1, areaCount, GetChars( zoneContainer->GetNetname() ) );
+        ii = fillZonesInParallel( progressDialog, errors );
 
-        if( progressDialog )
+        if( !errors.IsEmpty() )
         {
-            if( !progressDialog->Update( ii+1, msg ) )
-                break;  // Aborted by user
+            errorLevel = 1;
+
+            if( aVerbose )
+                DisplayError( aActiveWindow ? aActiveWindow : this,
+                              wxJoin( errors, '\n', '\0' ) );
         }
+    }
+    else
+    {
+        for( ii = 0; ii < areaCount; ii++ )
+        {
+            ZONE_CONTAINER* zoneContainer = GetBoard()->GetArea( ii );
+            if( zoneContainer->GetIsKeepout() )
+                continue;
 
-        errorLevel = Fill_Zone( zoneContainer );
+            msg.Printf( FORMAT_STRING, ii + 1, areaCount, GetChars( zoneContainer->GetNetname() ) );
 
-        if( errorLevel && !aVerbose )
-            break;
+            if( progressDialog )
+            {
+                if( !progressDialog->Update( ii+1, msg ) )
+                    break;  // Aborted by user
+            }
+
+            errorLevel = Fill_Zone( zoneContainer );
+
+            if( errorLevel && !aVerbose )
+                break;
+        }
     }
 
     if( progressDialog )
@@ -146,6 +146,10 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
     MODULE dummymodule( aPcb );    // Creates a dummy parent
     D_PAD dummypad( &dummymodule );
 
+    // Clearance polygons of pads and tracks are taken from the cache of the
+    // previous fill when these items are not changed
+    m_holeCache.BeginFill();
+
     for( MODULE* module = aPcb->m_Modules;  module;  module = module->Next() )
     {
         D_PAD* nextpad;
@@ -154,6 +158,7 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
         {
             nextpad = pad->Next();  // pad pointer can be modified by next code, so
                                     // calculate the next pad here
+            D_PAD* actualPad = pad; // the cache key, when pad is replaced by the dummy pad
 
             if( !pad->IsOnLayer( GetLayer() ) )
             {
@@ -186,10 +191,10 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
                 if( item_boundingbox.Intersects( zone_boundingbox ) )
                 {
                     int clearance = std::max( zone_clearance, item_clearance );
-                    pad->TransformShapeWithClearanceToPolygon( aFeatures,
-                                                               clearance,
-                                                               segsPerCircle,
-                                                               correctionFactor );
+                    aFeatures.Append( m_holeCache.GetPadPolygons( actualPad, pad,
+                                                                  clearance,
+                                                                  segsPerCircle,
+                                                                  correctionFactor ) );
                 }
 
                 continue;
@@ -206,10 +211,10 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
 
                 if( item_boundingbox.Intersects( zone_boundingbox ) )
                 {
-                    pad->TransformShapeWithClearanceToPolygon( aFeatures,
-                                                               gap,
-                                                               segsPerCircle,
-                                                               correctionFactor );
+                    aFeatures.Append( m_holeCache.GetPadPolygons( actualPad, pad,
+                                                                  gap,
+                                                                  segsPerCircle,
+                                                                  correctionFactor ) );
                 }
             }
         }
@@ -232,13 +237,16 @@ void ZONE_CONTAINER::buildFeatureHoleList( BOARD* aPcb, SHAPE_POLY_SET& aFeature
         if( item_boundingbox.Intersects( zone_boundingbox ) )
         {
             int clearance = std::max( zone_clearance, item_clearance );
-            track->TransformShapeWithClearanceToPolygon( aFeatures,
-                                                         clearance,
-                                                         segsPerCircle,
-                                                         correctionFactor );
+            aFeatures.Append( m_holeCache.GetTrackPolygons( track,
+                                                            clearance,
+                                                            segsPerCircle,
+                                                            correctionFactor ) );
         }
     }
 
+    // Entries of items no longer in the zone area are dropped
+    m_holeCache.EndFill();
+
     /* Add module edge items that are on copper layers
      * Pcbnew allows these items to be on copper layers in microwave applictions
      * This is a bad thing, but must be handled here, until a better way is found
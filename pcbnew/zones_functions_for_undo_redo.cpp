@@ -127,7 +127,8 @@ bool ZONE_CONTAINER::IsSame( const ZONE_CONTAINER& aZoneToCompare )
  * Function SaveCopyOfZones
  * creates a copy of zones having a given netcode on a given layer,
  * and fill a pick list with pickers to handle these copies
- * the UndoRedo status is set to UR_CHANGED for all items in list
+ * the UndoRedo status is set to UR_ZONE_OUTLINE for all items in list: the zone
+ * editions using these copies do not change the filled areas, which are not copied
  * Later, UpdateCopyOfZonesList will change and update these pickers after a zone edition
  * @param aPickList = the pick list
  * @param aPcb = the Board
@@ -152,9 +153,9 @@ int SaveCopyOfZones( PICKED_ITEMS_LIST& aPickList, BOARD* aPcb, int aNetCode, LA
         if( aLayer >= 0 && aLayer != zone->GetLayer() )
             continue;
 
-        ZONE_CONTAINER* zoneDup = new ZONE_CONTAINER( *zone );
+        ZONE_CONTAINER* zoneDup = zone->CloneWithoutFill();
         zoneDup->SetParent( aPcb );
-        ITEM_PICKER picker( zone, UR_CHANGED );
+        ITEM_PICKER picker( zone, UR_ZONE_OUTLINE );
         picker.SetLink( zoneDup );
         aPickList.PushItem( picker );
         copyCount++;
@@ -167,7 +168,7 @@ int SaveCopyOfZones( PICKED_ITEMS_LIST& aPickList, BOARD* aPcb, int aNetCode, LA
 /**
  * Function UpdateCopyOfZonesList
  * check a pick list to remove zones identical to their copies
- * and set the type of operation in picker (UR_DELETED, UR_CHANGED)
+ * and set the type of operation in picker (UR_DELETED, UR_ZONE_OUTLINE)
  * if an item is deleted, the initial values are retrievered,
  * because they can have changed in edition
  * @param aPickList = the main pick list
@@ -237,7 +238,8 @@ void UpdateCopyOfZonesList( PICKED_ITEMS_LIST& aPickList,
                     wxASSERT_MSG( zcopy != NULL,
                                   wxT( "UpdateCopyOfZonesList() error: link = NULL" ) );
 
-                    ref->Copy( zcopy );
+                    // The copy has no filled areas, the ones of the zone are kept
+                    ref->SwapOutline( zcopy );
 
                     // the copy was deleted; the link does not exists now.
                     aPickList.SetPickedItemLink( NULL, kk );
@@ -40,6 +40,7 @@
 #include <pcbnew.h>
 #include <zones.h>
 #include <polygon_test_point_inside.h>
+#include <disjoint_set.h>
 
 static bool CmpZoneSubnetValue( const BOARD_CONNECTED_ITEM* a, const BOARD_CONNECTED_ITEM* b );
 
@@ -345,9 +346,19 @@ void Merge_SubNets_Connected_By_CopperAreas( BOARD* aPcb, int aNetcode )
     }
 
     // Now, for each zone subnet, we search for 2 items with different subnets.
-    // if found, the 2 subnet are merged in the whole candidate list.
+    // if found, the 2 subnet are merged.
+    // Merges are stored in a union-find of subnet values, and applied in one pass
+    // to the whole candidate list.
+    int max_subnet = 0;
+
+    for( unsigned ii = 0; ii < Candidates.size(); ii++ )
+        max_subnet = std::max( max_subnet, Candidates[ii]->GetSubNet() );
+
+    DISJOINT_SET subnets( max_subnet + 1 );
     int old_subnet      = 0;
     int old_zone_subnet = 0;
+    bool merged         = false;
+
     for( unsigned ii = 0; ii < Candidates.size(); ii++ )
     {
         BOARD_CONNECTED_ITEM* item = Candidates[ii];
@@ -369,19 +380,22 @@ void Merge_SubNets_Connected_By_CopperAreas( BOARD* aPcb, int aNetcode )
         if( subnet == old_subnet )
             continue;
 
-        // Here we have 2 items connected by the same area have 2 differents subnets: merge subnets
-        if( (subnet > old_subnet) || ( subnet <= 0) )
-            std::swap( subnet, old_subnet );
+        // Here we have 2 items connected by the same area have 2 differents subnets:
+        // merge subnets (the smallest subnet value is kept)
+        subnets.Union( subnet, old_subnet );
+        merged = true;
+        old_subnet = subnet;
+    }
 
-        for( unsigned jj = 0; jj < Candidates.size(); jj++ )
-        {
-            BOARD_CONNECTED_ITEM * item_to_merge = Candidates[jj];
+    if( !merged )
+        return;
 
-            if( item_to_merge->GetSubNet() == old_subnet )
-                item_to_merge->SetSubNet( subnet );
-        }
+    for( unsigned jj = 0; jj < Candidates.size(); jj++ )
+    {
+        BOARD_CONNECTED_ITEM* item = Candidates[jj];
 
-        old_subnet = subnet;
+        if( item->GetSubNet() > 0 )
+            item->SetSubNet( subnets.Find( item->GetSubNet() ) );
     }
 }
 
@@ -781,8 +781,8 @@ void CPolyLine::Hatch()
     #define MAXPTS 200      // Usually we store only few values per one hatch line
                             // depending on the compexity of the zone outline
 
-    static std::vector <wxPoint> pointbuffer;
-    pointbuffer.clear();
+    // Not static: hatching is also done when zones are loaded by worker threads
+    std::vector <wxPoint> pointbuffer;
     pointbuffer.reserve( MAXPTS + 2 );
 
     for( int a = min_a; a < max_a; a += spacing )
@@ -0,0 +1,69 @@
+import os
+import shutil
+import tempfile
+import unittest
+import pcbnew
+
+
+GOOD_FOOTPRINT = """(module good (layer F.Cu) (tedit 0)
+  (descr "a good footprint")
+  (pad 1 smd rect (at 0 0) (size 1 1) (layers F.Cu))
+  (pad 2 smd rect (at 2 0) (size 1 1) (layers F.Cu))
+)
+"""
+
+BROKEN_FOOTPRINT = """(module broken (layer F.Cu) (tedit 0)
+  (pad 1 smd rect (at 0 0
+"""
+
+
+class TestFootprintInfo(unittest.TestCase):
+
+    def setUp(self):
+        self.dir = tempfile.mkdtemp()
+        self.lib = os.path.join(self.dir, "test.pretty")
+        os.mkdir(self.lib)
+
+        # The footprint info index goes to the KiCad config path: keep it out of the
+        # user's one (XDG_CONFIG_HOME is read on each GetKicadConfigPath() call)
+        self.config_home = os.environ.get("XDG_CONFIG_HOME")
+        os.environ["XDG_CONFIG_HOME"] = os.path.join(self.dir, "config")
+        self.assertTrue(pcbnew.GetKicadConfigPath().startswith(self.dir))
+
+        with open(os.path.join(self.lib, "good.kicad_mod"), "w") as f:
+            f.write(GOOD_FOOTPRINT)
+
+    def tearDown(self):
+        if self.config_home is None:
+            del os.environ["XDG_CONFIG_HOME"]
+        else:
+            os.environ["XDG_CONFIG_HOME"] = self.config_home
+
+        shutil.rmtree(self.dir)
+
+    def add_broken_footprint(self):
+        with open(os.path.join(self.lib, "broken.kicad_mod"), "w") as f:
+            f.write(BROKEN_FOOTPRINT)
+
+    def test_good_library(self):
+        self.assertEqual(list(pcbnew.ReadFootprintInfo(self.lib)), [u'good'])
+        self.assertEqual(len(pcbnew.ReadFootprintInfo(self.lib, True)), 0)
+
+    def test_broken_footprint(self):
+        self.add_broken_footprint()
+
+        # The broken footprint is reported, not listed, and does not stop the others
+        self.assertEqual(list(pcbnew.ReadFootprintInfo(self.lib)), [u'good'])
+        self.assertEqual(len(pcbnew.ReadFootprintInfo(self.lib, True)), 1)
+
+    def test_broken_footprint_not_indexed(self):
+        # Index the clean library, then break it: the error must come back every time
+        self.assertEqual(len(pcbnew.ReadFootprintInfo(self.lib, True)), 0)
+        self.add_broken_footprint()
+
+        for i in range(2):
+            self.assertEqual(len(pcbnew.ReadFootprintInfo(self.lib, True)), 1)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,115 @@
+import unittest
+import pcbnew
+
+
+class TestUndoRoundTrip(unittest.TestCase):
+    """Commands recorded in a PICKED_ITEMS_LIST, undone and redone like the board editor does."""
+
+    def setUp(self):
+        self.pcb = pcbnew.LoadBoard("data/complex_hierarchy.kicad_pcb")
+        self.io = pcbnew.PCB_IO()
+
+    def format(self, item):
+        self.io.Format(item)
+        return self.io.GetStringOutput(True)
+
+    def pick(self, command, item, status, image=None):
+        picker = pcbnew.ITEM_PICKER(item, status)
+
+        if image is not None:
+            picker.SetLink(image)
+
+        command.PushItem(picker)
+
+    def restore(self, command, redo):
+        # Same order as PCB_EDIT_FRAME::PutDataInPreviousState(): last picked item first,
+        # then the list is reversed before it goes to the other history
+        for ii in reversed(range(command.GetCount())):
+            item = pcbnew.Cast_to_BOARD_ITEM(command.GetPickedItem(ii))
+            image = command.GetPickedItemLink(ii)
+
+            if image is not None:
+                image = pcbnew.Cast_to_BOARD_ITEM(image)
+
+            self.assertTrue(item.UndoRedoPicked(command.GetPickedItemStatus(ii), image,
+                                                command.m_TransformPoint, 900, redo))
+
+        command.ReversePickersListOrder()
+
+    def test_move(self):
+        # A move of footprints and a filled zone is saved as the move vector, without copies
+        vector = pcbnew.wxPointMM(12.7, -3.81)
+        items = [module for module in self.pcb.GetModules()][:10]
+        items.append(self.pcb.GetArea(0))
+
+        command = pcbnew.PICKED_ITEMS_LIST()
+        command.m_TransformPoint = vector
+
+        for item in items:
+            self.pick(command, item, pcbnew.UR_MOVED)
+
+        before = [self.format(item) for item in items]
+
+        for item in items:
+            item.Move(vector)
+
+        after = [self.format(item) for item in items]
+        self.assertNotEqual(after, before)
+
+        for ii in range(command.GetCount()):
+            self.assertIsNone(command.GetPickedItemLink(ii))
+
+        self.restore(command, False)                            # undo
+        self.assertEqual([self.format(item) for item in items], before)
+
+        self.restore(command, True)                             # redo
+        self.assertEqual([self.format(item) for item in items], after)
+
+    def test_zone_outline(self):
+        # An outline edit saves the zone without its filled areas, which are left alone
+        zone = self.pcb.GetArea(0)
+        self.assertTrue(zone.GetFilledPolysList().OutlineCount() > 0)
+
+        command = pcbnew.PICKED_ITEMS_LIST()
+        image = zone.CloneWithoutFill()
+        self.assertEqual(image.GetFilledPolysList().OutlineCount(), 0)
+        self.pick(command, zone, pcbnew.UR_ZONE_OUTLINE, image)
+
+        before = self.format(zone)
+        zone.Outline().MoveCorner(0, zone.GetCornerPosition(0).x + pcbnew.FromMM(1.0),
+                                  zone.GetCornerPosition(0).y)
+        zone.SetZoneClearance(zone.GetZoneClearance() * 2)
+        after = self.format(zone)
+        self.assertNotEqual(after, before)
+
+        self.restore(command, False)                            # undo
+        self.assertEqual(self.format(zone), before)
+
+        self.restore(command, True)                             # redo
+        self.assertEqual(self.format(zone), after)
+
+    def test_zone_fill(self):
+        # A refill moves the old filled areas to a copy without outline data
+        zone = self.pcb.GetArea(0)
+        before = self.format(zone)
+
+        command = pcbnew.PICKED_ITEMS_LIST()
+        image = zone.CloneWithoutFill()
+        image.SwapFill(zone)
+        self.pick(command, zone, pcbnew.UR_ZONE_FILL, image)
+
+        zone.SetMinThickness(zone.GetMinThickness() * 2)
+        self.assertTrue(zone.BuildFilledSolidAreasPolygons(self.pcb))
+        zone.SetMinThickness(zone.GetMinThickness() // 2)
+        after = self.format(zone)
+        self.assertNotEqual(after, before)
+
+        self.restore(command, False)                            # undo
+        self.assertEqual(self.format(zone), before)
+
+        self.restore(command, True)                             # redo
+        self.assertEqual(self.format(zone), after)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,53 @@
+import os
+import shutil
+import tempfile
+import unittest
+import pcbnew
+
+
+class TestSnapshotRoundTrip(unittest.TestCase):
+    """A board saved as a snapshot and loaded back formats like the original."""
+
+    def setUp(self):
+        self.pcb = pcbnew.LoadBoard("data/complex_hierarchy.kicad_pcb")
+        self.dir = tempfile.mkdtemp()
+        self.path = os.path.join(self.dir, "board.kicad_snap")
+
+    def tearDown(self):
+        shutil.rmtree(self.dir)
+
+    def format(self, item):
+        io = pcbnew.PCB_IO()
+        io.Format(item)
+        return io.GetStringOutput(True)
+
+    def round_trip(self):
+        pcbnew.IO_MGR.Save(pcbnew.IO_MGR.KICAD_SNAPSHOT, self.path, self.pcb)
+        return pcbnew.IO_MGR.Load(pcbnew.IO_MGR.KICAD_SNAPSHOT, self.path)
+
+    def test_board(self):
+        board = self.round_trip()
+
+        self.assertEqual(len(list(board.GetModules())), len(list(self.pcb.GetModules())))
+        self.assertEqual(self.format(board), self.format(self.pcb))
+
+    def test_moved_module(self):
+        # The footprint items are placed back from the moved and rotated footprint
+        module = self.pcb.FindModuleByReference("P1")
+        module.Rotate(module.GetPosition(), 450)
+        module.Move(pcbnew.wxPointMM(3.3, -1.7))
+
+        board = self.round_trip()
+
+        self.assertEqual(self.format(board.FindModuleByReference("P1")), self.format(module))
+        self.assertEqual(self.format(board), self.format(self.pcb))
+
+    def test_not_a_snapshot(self):
+        with open(self.path, "w") as f:
+            f.write("(kicad_pcb (version 4))\n")
+
+        self.assertRaises(Exception, pcbnew.IO_MGR.Load, pcbnew.IO_MGR.KICAD_SNAPSHOT, self.path)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,390 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Randomized differential test of the PNS_NODE branches. Random trees of branches are
+ * built over a root node holding random track segments, with segments added to and
+ * removed from random branches (including branches which have children), random branches
+ * deleted and committed to the root, and deep chains of branches. After each step, the
+ * modified branch is compared with a flat root node holding copies of the items the
+ * branch must contain: the items of each net, the joints at the item ends, hit tests,
+ * collision queries, assembled lines and the updated items against the root must match.
+ *
+ * usage: pns_node_branch_test [steps] [seed]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <profile.h>
+#include <router/pns_node.h>
+#include <router/pns_segment.h>
+#include <router/pns_line.h>
+#include <router/pns_pool.h>
+
+static const int GRID_SIZE  = 40;
+static const int GRID_STEP  = 1000000;      // 1 mm
+static const int NETS       = 6;
+static const int ROOT_ITEMS = 2000;
+
+typedef std::set<PNS_ITEM*>             ITEM_SET;
+typedef std::map<PNS_ITEM*, PNS_ITEM*>  ITEM_MAP;
+
+struct TEST_NODE
+{
+    PNS_NODE*   m_node;
+    TEST_NODE*  m_parent;
+    ITEM_SET    m_items;        ///< the items the node must contain
+};
+
+
+static int failures = 0;
+
+
+static void fail( const char* aWhat, int aStep )
+{
+    printf( "step %d: %s differs\n", aStep, aWhat );
+    failures++;
+}
+
+
+static VECTOR2I randomPoint()
+{
+    return VECTOR2I( ( rand() % GRID_SIZE ) * GRID_STEP, ( rand() % GRID_SIZE ) * GRID_STEP );
+}
+
+
+static PNS_SEGMENT* randomSegment()
+{
+    VECTOR2I a = randomPoint();
+    VECTOR2I b;
+
+    // short segments, so that joints are shared by several segments
+    do
+    {
+        b = a + VECTOR2I( ( rand() % 5 - 2 ) * GRID_STEP, ( rand() % 5 - 2 ) * GRID_STEP );
+    } while( b == a );
+
+    PNS_SEGMENT* seg = new PNS_SEGMENT( SEG( a, b ), 1 + rand() % NETS );
+
+    seg->SetLayer( rand() % 2 );
+    seg->SetWidth( 100000 + ( rand() % 3 ) * 100000 );
+
+    return seg;
+}
+
+
+static PNS_ITEM* randomItem( const ITEM_SET& aItems )
+{
+    ITEM_SET::const_iterator i = aItems.begin();
+
+    std::advance( i, rand() % aItems.size() );
+
+    return *i;
+}
+
+
+// maps a set of items of the tested node to the copies of the flat node
+static ITEM_SET mapped( const ITEM_SET& aItems, const ITEM_MAP& aMap )
+{
+    ITEM_SET result;
+
+    for( PNS_ITEM* item : aItems )
+    {
+        ITEM_MAP::const_iterator i = aMap.find( item );
+        result.insert( i == aMap.end() ? NULL : i->second );
+    }
+
+    return result;
+}
+
+
+static ITEM_SET itemSet( const PNS_ITEMSET& aItems )
+{
+    ITEM_SET result;
+
+    for( PNS_ITEM* item : aItems.CItems() )
+        result.insert( item );
+
+    return result;
+}
+
+
+static ITEM_SET obstacleSet( const PNS_NODE::OBSTACLES& aObstacles )
+{
+    ITEM_SET result;
+
+    for( const PNS_OBSTACLE& obs : aObstacles )
+        result.insert( obs.m_item );
+
+    return result;
+}
+
+
+static bool sameJoints( PNS_NODE* aNode, PNS_NODE* aFlat, const VECTOR2I& aPos, int aLayer,
+                        int aNet, const ITEM_MAP& aMap )
+{
+    PNS_JOINT* joint = aNode->FindJoint( aPos, aLayer, aNet );
+    PNS_JOINT* flatJoint = aFlat->FindJoint( aPos, aLayer, aNet );
+
+    if( !joint || !flatJoint )
+        return !joint && !flatJoint;
+
+    return joint->LinkCount() == flatJoint->LinkCount() &&
+           mapped( itemSet( joint->CLinks() ), aMap ) == itemSet( flatJoint->CLinks() );
+}
+
+
+static void compare( TEST_NODE& aTest, const ITEM_SET& aRootItems, int aStep )
+{
+    PNS_NODE*   node = aTest.m_node;
+    PNS_NODE    flat;
+    ITEM_MAP    copies;
+
+    for( PNS_ITEM* item : aTest.m_items )
+    {
+        PNS_ITEM* copy = item->Clone();
+
+        copies[item] = copy;
+        flat.Add( copy, true );
+    }
+
+    for( int net = 1; net <= NETS; net++ )
+    {
+        ITEM_SET items, flatItems;
+
+        node->AllItemsInNet( net, items );
+        flat.AllItemsInNet( net, flatItems );
+
+        if( mapped( items, copies ) != flatItems )
+            fail( "AllItemsInNet()", aStep );
+    }
+
+    for( PNS_ITEM* item : aTest.m_items )
+    {
+        PNS_SEGMENT* seg = static_cast<PNS_SEGMENT*>( item );
+
+        if( !sameJoints( node, &flat, seg->Seg().A, seg->Layer(), seg->Net(), copies ) ||
+            !sameJoints( node, &flat, seg->Seg().B, seg->Layer(), seg->Net(), copies ) )
+        {
+            fail( "FindJoint()", aStep );
+            break;
+        }
+    }
+
+    for( int i = 0; i < 20; i++ )
+    {
+        VECTOR2I p = randomPoint();
+
+        if( mapped( itemSet( node->HitTest( p ) ), copies ) != itemSet( flat.HitTest( p ) ) )
+            fail( "HitTest()", aStep );
+    }
+
+    for( int i = 0; i < 10; i++ )
+    {
+        PNS_SEGMENT*        probe = randomSegment();
+        PNS_NODE::OBSTACLES obstacles, flatObstacles;
+
+        node->QueryColliding( probe, obstacles );
+        flat.QueryColliding( probe, flatObstacles );
+
+        if( mapped( obstacleSet( obstacles ), copies ) != obstacleSet( flatObstacles ) )
+            fail( "QueryColliding()", aStep );
+
+        delete probe;
+    }
+
+    for( int i = 0; i < 5 && !aTest.m_items.empty(); i++ )
+    {
+        PNS_SEGMENT* seg = static_cast<PNS_SEGMENT*>( randomItem( aTest.m_items ) );
+        PNS_LINE     line = node->AssembleLine( seg );
+        PNS_LINE     flatLine = flat.AssembleLine( static_cast<PNS_SEGMENT*>( copies[seg] ) );
+        ITEM_SET     segs, flatSegs;
+
+        for( PNS_SEGMENT* s : *line.LinkedSegments() )
+            segs.insert( s );
+
+        for( PNS_SEGMENT* s : *flatLine.LinkedSegments() )
+            flatSegs.insert( s );
+
+        if( line.SegmentCount() != flatLine.SegmentCount() || mapped( segs, copies ) != flatSegs )
+            fail( "AssembleLine()", aStep );
+    }
+
+    if( node->Depth() > 0 )
+    {
+        PNS_NODE::ITEM_VECTOR removed, added;
+        ITEM_SET expectedRemoved, expectedAdded;
+
+        node->GetUpdatedItems( removed, added );
+
+        for( PNS_ITEM* item : aRootItems )
+        {
+            if( !aTest.m_items.count( item ) )
+                expectedRemoved.insert( item );
+        }
+
+        for( PNS_ITEM* item : aTest.m_items )
+        {
+            if( !aRootItems.count( item ) )
+                expectedAdded.insert( item );
+        }
+
+        if( ITEM_SET( removed.begin(), removed.end() ) != expectedRemoved ||
+            ITEM_SET( added.begin(), added.end() ) != expectedAdded ||
+            removed.size() != expectedRemoved.size() || added.size() != expectedAdded.size() )
+            fail( "GetUpdatedItems()", aStep );
+    }
+}
+
+
+static bool hasChildren( const std::vector<TEST_NODE*>& aNodes, const TEST_NODE* aNode )
+{
+    for( const TEST_NODE* test : aNodes )
+    {
+        if( test->m_parent == aNode )
+            return true;
+    }
+
+    return false;
+}
+
+
+int main( int argc, char** argv )
+{
+    int steps = argc > 1 ? atoi( argv[1] ) : 5000;
+    int seed = argc > 2 ? atoi( argv[2] ) : 1;
+
+    srand( seed );
+
+    std::vector<TEST_NODE*> nodes;
+    TEST_NODE* root = new TEST_NODE;
+
+    root->m_node = new PNS_NODE;
+    root->m_parent = NULL;
+    nodes.push_back( root );
+
+    for( int i = 0; i < ROOT_ITEMS; i++ )
+    {
+        PNS_SEGMENT* seg = randomSegment();
+
+        root->m_node->Add( seg, true );
+        root->m_items.insert( seg );
+    }
+
+    prof_counter cnt;
+    prof_start( &cnt );
+
+    for( int step = 0; step < steps; step++ )
+    {
+        int         op = rand() % 100;
+        TEST_NODE*  test;
+
+        // branch, preferably from the newest branch, to get deep chains
+        if( op < 30 || nodes.size() == 1 )
+        {
+            TEST_NODE* parent = rand() % 2 ? nodes.back() : nodes[rand() % nodes.size()];
+
+            test = new TEST_NODE;
+            test->m_node = parent->m_node->Branch();
+            test->m_parent = parent;
+            test->m_items = parent->m_items;
+            nodes.push_back( test );
+        }
+        else
+        {
+            // the router does not modify the root while it has branches
+            test = nodes[1 + rand() % ( nodes.size() - 1 )];
+
+            if( op < 60 )
+            {
+                PNS_SEGMENT* seg = randomSegment();
+
+                test->m_node->Add( seg, true );
+                test->m_items.insert( seg );
+            }
+            else if( op < 90 )
+            {
+                if( test->m_items.empty() )
+                    continue;
+
+                PNS_ITEM* item = randomItem( test->m_items );
+
+                test->m_node->Remove( item );
+                test->m_items.erase( item );
+            }
+            else if( op < 97 )
+            {
+                if( hasChildren( nodes, test ) )
+                    continue;
+
+                for( unsigned i = 0; i < nodes.size(); i++ )
+                {
+                    if( nodes[i] == test )
+                        nodes.erase( nodes.begin() + i );
+                }
+
+                delete test->m_node;
+                delete test;
+                continue;
+            }
+            else
+            {
+                // the commit releases all the branches
+                root->m_node->Commit( test->m_node );
+                root->m_items = test->m_items;
+
+                for( unsigned i = 1; i < nodes.size(); i++ )
+                    delete nodes[i];
+
+                nodes.resize( 1 );
+                test = root;
+            }
+        }
+
+        compare( *test, root->m_items, step );
+    }
+
+    prof_end( &cnt );
+
+    printf( "%d steps, %d nodes left, %d root items: %.1f ms\n", steps, (int) nodes.size(),
+            (int) root->m_items.size(), cnt.msecs() );
+
+    root->m_node->KillChildren();
+
+    for( unsigned i = 1; i < nodes.size(); i++ )
+        delete nodes[i];
+
+    delete root->m_node;
+    delete root;
+
+    PNS_POOL::ReleaseMemory();
+
+    printf( "%d failures\n", failures );
+
+    return failures ? 1 : 0;
+}
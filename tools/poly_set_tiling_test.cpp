@@ -0,0 +1,306 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Checks the tiled boolean operations of SHAPE_POLY_SET against the single pass ones, on
+ * random zone fills (an outline minus many clearance holes), unions of overlapping pads
+ * and tracks, intersections and inflations, with several strip counts. The results must
+ * cover the same area (up to the rounding of the points where the edges cross the strip
+ * borders) and have the same number of outlines and holes. The time of both versions is
+ * reported for the largest case.
+ *
+ * usage: poly_set_tiling_test [holes in the large zone fill]
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include <profile.h>
+#include <geometry/shape_poly_set.h>
+
+using namespace ClipperLib;
+
+static const int BOARD_SIZE = 100000000;    // 100 mm
+
+
+static SHAPE_LINE_CHAIN circle( const VECTOR2I& aCenter, int aRadius, int aSegments )
+{
+    SHAPE_LINE_CHAIN chain;
+
+    for( int i = 0; i < aSegments; i++ )
+    {
+        double a = 2.0 * M_PI * i / aSegments;
+        chain.Append( aCenter + VECTOR2I( aRadius * cos( a ), aRadius * sin( a ) ) );
+    }
+
+    chain.SetClosed( true );
+
+    return chain;
+}
+
+
+// a track segment with square ends, at any angle
+static SHAPE_LINE_CHAIN track( const VECTOR2I& aStart, const VECTOR2I& aEnd, int aWidth )
+{
+    VECTOR2I d = aEnd - aStart;
+    VECTOR2I n = d.Perpendicular().Resize( aWidth / 2 );
+    SHAPE_LINE_CHAIN chain( aStart + n, aEnd + n, aEnd - n, aStart - n );
+
+    chain.SetClosed( true );
+
+    return chain;
+}
+
+
+static VECTOR2I randomPoint( int aMargin = 0 )
+{
+    return VECTOR2I( aMargin + rand() % ( BOARD_SIZE - 2 * aMargin ),
+                     aMargin + rand() % ( BOARD_SIZE - 2 * aMargin ) );
+}
+
+
+// random pads and tracks, many of them overlapping
+static SHAPE_POLY_SET randomItems( int aCount )
+{
+    SHAPE_POLY_SET items;
+
+    for( int i = 0; i < aCount; i++ )
+    {
+        VECTOR2I p = randomPoint( 5000000 );
+
+        if( rand() % 2 )
+        {
+            items.AddOutline( circle( p, 200000 + rand() % 1500000, 16 + rand() % 32 ) );
+        }
+        else
+        {
+            VECTOR2I q = p + VECTOR2I( rand() % 8000000 - 4000000, rand() % 8000000 - 4000000 );
+
+            if( q != p )
+                items.AddOutline( track( p, q, 150000 + rand() % 600000 ) );
+        }
+    }
+
+    return items;
+}
+
+
+// a non convex zone outline, with a hole
+static SHAPE_POLY_SET zoneOutline()
+{
+    SHAPE_POLY_SET zone;
+    SHAPE_LINE_CHAIN outline;
+
+    for( int i = 0; i < 64; i++ )
+    {
+        double a = 2.0 * M_PI * i / 64;
+        double r = BOARD_SIZE * ( 0.35 + 0.12 * ( i % 2 ) );
+
+        outline.Append( VECTOR2I( BOARD_SIZE / 2 + r * cos( a ), BOARD_SIZE / 2 + r * sin( a ) ) );
+    }
+
+    outline.SetClosed( true );
+    zone.AddOutline( outline );
+    zone.AddHole( circle( VECTOR2I( BOARD_SIZE / 2, BOARD_SIZE / 2 ), BOARD_SIZE / 10, 32 ) );
+
+    return zone;
+}
+
+
+static Paths toPaths( const SHAPE_POLY_SET& aSet )
+{
+    Paths paths;
+
+    for( int i = 0; i < aSet.OutlineCount(); i++ )
+    {
+        for( const SHAPE_LINE_CHAIN& chain : aSet.CPolygon( i ) )
+        {
+            Path path;
+
+            for( int j = 0; j < chain.PointCount(); j++ )
+                path.push_back( IntPoint( chain.CPoint( j ).x, chain.CPoint( j ).y ) );
+
+            paths.push_back( path );
+        }
+    }
+
+    return paths;
+}
+
+
+static double area( const Paths& aPaths )
+{
+    double sum = 0.0;
+
+    for( const Path& path : aPaths )
+        sum += Area( path );
+
+    return sum;
+}
+
+
+static int holeCount( const SHAPE_POLY_SET& aSet )
+{
+    int count = 0;
+
+    for( int i = 0; i < aSet.OutlineCount(); i++ )
+        count += aSet.HoleCount( i );
+
+    return count;
+}
+
+
+static int failures = 0;
+
+
+static void compare( const char* aName, int aTiles, const SHAPE_POLY_SET& aReference,
+                     const SHAPE_POLY_SET& aResult, int aBorderCrossings )
+{
+    Clipper c;
+    Paths ref = toPaths( aReference );
+    Paths res = toPaths( aResult );
+    Paths diff;
+
+    c.AddPaths( ref, ptSubject, true );
+    c.AddPaths( res, ptClip, true );
+    c.Execute( ctXor, diff, pftEvenOdd, pftEvenOdd );
+
+    double refArea = area( ref );
+    double diffArea = std::abs( area( diff ) );
+
+    // the crossing points are rounded, by less than one unit each
+    double tolerance = 2.0 * BOARD_SIZE * aBorderCrossings;
+
+    bool ok = diffArea <= tolerance &&
+              aReference.OutlineCount() == aResult.OutlineCount() &&
+              holeCount( aReference ) == holeCount( aResult );
+
+    printf( "%-28s tiles %d: %6d outlines %6d holes, area %.6e, xor %.1f %s\n", aName,
+            aTiles, aResult.OutlineCount(), holeCount( aResult ), refArea, diffArea,
+            ok ? "ok" : "FAILED" );
+
+    if( !ok )
+    {
+        printf( "    reference: %d outlines %d holes\n", aReference.OutlineCount(),
+                holeCount( aReference ) );
+        failures++;
+    }
+}
+
+
+enum OPERATION
+{
+    OP_ADD, OP_SUBTRACT, OP_INTERSECT, OP_SIMPLIFY, OP_INFLATE, OP_FRACTURE
+};
+
+
+static SHAPE_POLY_SET run( OPERATION aOp, const SHAPE_POLY_SET& aA, const SHAPE_POLY_SET& aB,
+                           SHAPE_POLY_SET::POLYGON_MODE aMode )
+{
+    SHAPE_POLY_SET result( aA );
+
+    switch( aOp )
+    {
+    case OP_ADD:        result.BooleanAdd( aB, aMode );             break;
+    case OP_SUBTRACT:   result.BooleanSubtract( aB, aMode );        break;
+    case OP_INTERSECT:  result.BooleanIntersection( aB, aMode );    break;
+    case OP_SIMPLIFY:   result.Simplify( aMode );                   break;
+    case OP_INFLATE:    result.Inflate( 300000, 16 );               break;
+    case OP_FRACTURE:   result.Fracture( aMode );                   break;
+    }
+
+    return result;
+}
+
+
+static void check( const char* aName, OPERATION aOp, const SHAPE_POLY_SET& aA,
+                   const SHAPE_POLY_SET& aB, SHAPE_POLY_SET::POLYGON_MODE aMode )
+{
+    static const int tileCounts[] = { 2, 3, 5, 8 };
+
+    SHAPE_POLY_SET::SetTileCount( 1 );
+    SHAPE_POLY_SET reference = run( aOp, aA, aB, aMode );
+
+    for( int tiles : tileCounts )
+    {
+        SHAPE_POLY_SET::SetTileCount( tiles );
+        SHAPE_POLY_SET result = run( aOp, aA, aB, aMode );
+
+        compare( aName, tiles, reference, result, aA.TotalVertices() + aB.TotalVertices() );
+    }
+
+    SHAPE_POLY_SET::SetTileCount( 0 );
+}
+
+
+int main( int argc, char** argv )
+{
+    int holeCount = argc > 1 ? atoi( argv[1] ) : 20000;
+
+    srand( 1 );
+
+    const SHAPE_POLY_SET::POLYGON_MODE fast = SHAPE_POLY_SET::PM_FAST;
+    const SHAPE_POLY_SET::POLYGON_MODE strict = SHAPE_POLY_SET::PM_STRICTLY_SIMPLE;
+    SHAPE_POLY_SET empty;
+
+    for( int round = 0; round < 4; round++ )
+    {
+        SHAPE_POLY_SET zone = zoneOutline();
+        SHAPE_POLY_SET holes = randomItems( 200 + round * 300 );
+        SHAPE_POLY_SET others = randomItems( 200 );
+
+        check( "zone fill (fast)", OP_SUBTRACT, zone, holes, fast );
+        check( "zone fill (strictly simple)", OP_SUBTRACT, zone, holes, strict );
+        check( "union", OP_ADD, holes, others, fast );
+        check( "simplify", OP_SIMPLIFY, holes, empty, strict );
+        check( "intersection", OP_INTERSECT, zone, holes, fast );
+        check( "inflate", OP_INFLATE, holes, empty, fast );
+        check( "fracture", OP_FRACTURE, holes, empty, fast );
+    }
+
+    // a large zone fill, timed
+    SHAPE_POLY_SET zone = zoneOutline();
+    SHAPE_POLY_SET holes = randomItems( holeCount );
+    prof_counter singleTime, tiledTime;
+
+    check( "large zone fill", OP_SUBTRACT, zone, holes, fast );
+
+    SHAPE_POLY_SET::SetTileCount( 1 );
+    prof_start( &singleTime );
+    run( OP_SUBTRACT, zone, holes, fast );
+    prof_end( &singleTime );
+
+    SHAPE_POLY_SET::SetTileCount( 0 );
+    prof_start( &tiledTime );
+    run( OP_SUBTRACT, zone, holes, fast );
+    prof_end( &tiledTime );
+
+    printf( "zone fill with %d holes: single pass %.1f ms, tiled %.1f ms (%.2fx)\n",
+            holeCount, singleTime.msecs(), tiledTime.msecs(),
+            singleTime.msecs() / tiledTime.msecs() );
+
+    printf( "%d failures\n", failures );
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Compares the segment by segment collision test of SHAPE_LINE_CHAIN with the
+ * SEG_BATCH kernels, on random tracks shaped like the ones of the router.
+ *
+ * usage: seg_batch_bench [chain count] [segments per chain]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <profile.h>
+#include <geometry/seg_batch.h>
+#include <geometry/shape_line_chain.h>
+
+static const int CLEARANCE = 200000;    // 0.2 mm
+
+
+// a random walk of 45 degree segments, within a 100 x 100 mm area
+static SHAPE_LINE_CHAIN randomTrack( int aSegments )
+{
+    static const int dirs[8][2] =
+    {
+        { 1, 0 }, { 1, 1 }, { 0, 1 }, { -1, 1 }, { -1, 0 }, { -1, -1 }, { 0, -1 }, { 1, -1 }
+    };
+
+    SHAPE_LINE_CHAIN chain;
+    VECTOR2I p( rand() % 100000000, rand() % 100000000 );
+
+    chain.Append( p );
+
+    for( int i = 0; i < aSegments; i++ )
+    {
+        int d = rand() % 8;
+        int len = 500000 + rand() % 5000000;
+
+        p += VECTOR2I( dirs[d][0] * len, dirs[d][1] * len );
+        chain.Append( p );
+    }
+
+    return chain;
+}
+
+
+int main( int argc, char** argv )
+{
+    int chainCount = argc > 1 ? atoi( argv[1] ) : 2000;
+    int segCount = argc > 2 ? atoi( argv[2] ) : 64;
+
+    srand( 1 );
+
+    std::vector<SHAPE_LINE_CHAIN> chains;
+
+    for( int i = 0; i < chainCount; i++ )
+        chains.push_back( randomTrack( segCount ) );
+
+    // reference: each segment of the second chain against the first chain
+    prof_counter scalarTime;
+    int scalarHits = 0;
+
+    prof_start( &scalarTime );
+
+    for( int i = 0; i < chainCount; i++ )
+    {
+        const SHAPE_LINE_CHAIN& a = chains[i];
+        const SHAPE_LINE_CHAIN& b = chains[( i * 7 + 1 ) % chainCount];
+
+        for( int s = 0; s < b.SegmentCount(); s++ )
+            if( a.Collide( b.CSegment( s ), CLEARANCE ) )
+                scalarHits++;
+    }
+
+    prof_end( &scalarTime );
+
+    prof_counter batchTime;
+    int batchHits = 0;
+    SEG_BATCH batch;
+
+    prof_start( &batchTime );
+
+    for( int i = 0; i < chainCount; i++ )
+    {
+        const SHAPE_LINE_CHAIN& a = chains[i];
+        const SHAPE_LINE_CHAIN& b = chains[( i * 7 + 1 ) % chainCount];
+
+        batch.Clear();
+        batch.Add( a );
+
+        for( int s = 0; s < b.SegmentCount(); s++ )
+            if( batch.Collide( b.CSegment( s ), CLEARANCE ) >= 0 )
+                batchHits++;
+    }
+
+    prof_end( &batchTime );
+
+    printf( "%d pairs of %d segment chains\n", chainCount, segCount );
+    printf( "scalar:    %8.3f ms, %d collisions\n", scalarTime.msecs(), scalarHits );
+    printf( "SEG_BATCH: %8.3f ms, %d collisions (%.2fx)\n", batchTime.msecs(), batchHits,
+            scalarTime.msecs() / batchTime.msecs() );
+
+    return scalarHits == batchHits ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2016 KiCad Developers, see change_log.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Compares the point in polygon and distance queries of a large zone-like outline,
+ * answered through its SEG_TREE, with plain scans of all its segments.
+ *
+ * usage: seg_tree_bench [outline vertices] [query points]
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+#include <vector>
+
+#include <profile.h>
+#include <geometry/seg_tree.h>
+#include <geometry/shape_line_chain.h>
+#include <geometry/shape_poly_set.h>
+
+static const int RADIUS = 50000000;    // 50 mm
+
+
+// a star shaped, non convex outline with a jagged edge
+static SHAPE_LINE_CHAIN randomOutline( int aVertices )
+{
+    SHAPE_LINE_CHAIN chain;
+
+    for( int i = 0; i < aVertices; i++ )
+    {
+        double a = 2.0 * M_PI * i / aVertices;
+        double r = RADIUS * ( 0.9 + 0.1 * ( rand() % 1000 ) / 1000.0 );
+
+        chain.Append( VECTOR2I( r * cos( a ), r * sin( a ) ) );
+    }
+
+    chain.SetClosed( true );
+
+    return chain;
+}
+
+
+// the even-odd test of SHAPE_POLY_SET, over all edges
+static bool scanPointInPolygon( const SHAPE_LINE_CHAIN& aPath, const VECTOR2I& aP )
+{
+    int result = 0;
+    int cnt = aPath.PointCount();
+    VECTOR2I ip = aPath.CPoint( 0 );
+
+    for( int i = 1; i <= cnt; ++i )
+    {
+        VECTOR2I ipNext = ( i == cnt ? aPath.CPoint( 0 ) : aPath.CPoint( i ) );
+
+        if( ipNext.y == aP.y )
+        {
+            if( ( ipNext.x == aP.x ) || ( ip.y == aP.y &&
+                ( ( ipNext.x > aP.x ) == ( ip.x < aP.x ) ) ) )
+                return true;
+        }
+
+        if( ( ip.y < aP.y ) != ( ipNext.y < aP.y ) )
+        {
+            if( ip.x >= aP.x && ipNext.x > aP.x )
+            {
+                result = 1 - result;
+            }
+            else if( ip.x >= aP.x || ipNext.x > aP.x )
+            {
+                int64_t d = (int64_t)( ip.x - aP.x ) * (int64_t)( ipNext.y - aP.y ) -
+                            (int64_t)( ipNext.x - aP.x ) * (int64_t)( ip.y - aP.y );
+
+                if( !d )
+                    return true;
+
+                if( ( d > 0 ) == ( ipNext.y > ip.y ) )
+                    result = 1 - result;
+            }
+        }
+
+        ip = ipNext;
+    }
+
+    return result ? true : false;
+}
+
+
+static int scanDistance( const SHAPE_LINE_CHAIN& aPath, const VECTOR2I& aP )
+{
+    int d = INT_MAX;
+
+    for( int s = 0; s < aPath.SegmentCount(); s++ )
+        d = std::min( d, aPath.CSegment( s ).Distance( aP ) );
+
+    return d;
+}
+
+
+int main( int argc, char** argv )
+{
+    int vertexCount = argc > 1 ? atoi( argv[1] ) : 5000;
+    int queryCount = argc > 2 ? atoi( argv[2] ) : 20000;
+
+    srand( 1 );
+
+    SHAPE_POLY_SET zone;
+    zone.AddOutline( randomOutline( vertexCount ) );
+
+    const SHAPE_LINE_CHAIN& outline = zone.COutline( 0 );
+    std::vector<VECTOR2I> points;
+
+    for( int i = 0; i < queryCount; i++ )
+        points.push_back( VECTOR2I( rand() % ( 2 * RADIUS ) - RADIUS,
+                                    rand() % ( 2 * RADIUS ) - RADIUS ) );
+
+    prof_counter scanTime, treeTime, buildTime;
+    int scanInside = 0, treeInside = 0, mismatches = 0;
+    std::vector<int> scanDist( queryCount );
+
+    prof_start( &buildTime );
+    outline.SegmentTree();
+    prof_end( &buildTime );
+
+    prof_start( &scanTime );
+
+    for( int i = 0; i < queryCount; i++ )
+    {
+        if( scanPointInPolygon( outline, points[i] ) )
+            scanInside++;
+
+        scanDist[i] = scanDistance( outline, points[i] );
+    }
+
+    prof_end( &scanTime );
+
+    prof_start( &treeTime );
+
+    for( int i = 0; i < queryCount; i++ )
+    {
+        if( zone.Contains( points[i] ) )
+            treeInside++;
+
+        if( outline.Distance( points[i] ) != scanDist[i] && !outline.PointInside( points[i] ) )
+            mismatches++;
+    }
+
+    prof_end( &treeTime );
+
+    printf( "%d queries on a %d vertex outline\n", queryCount, vertexCount );
+    printf( "tree build: %8.3f ms\n", buildTime.msecs() );
+    printf( "scan:       %8.3f ms, %d points inside\n", scanTime.msecs(), scanInside );
+    printf( "SEG_TREE:   %8.3f ms, %d points inside (%.2fx), %d distance mismatches\n",
+            treeTime.msecs(), treeInside, scanTime.msecs() / treeTime.msecs(), mismatches );
+
+    return scanInside == treeInside && !mismatches ? 0 : 1;
+}